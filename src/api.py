@@ -0,0 +1,269 @@
+"""
+Library API for the C++ Preprocessor Directive Analysis Tool.
+Provides stable batch entry points for embedding the analyzer in other tools
+without going through argument parsing, printed errors or JSON round-trips.
+
+Example:
+    from src.api import AnalysisOptions, analyze_paths
+
+    result = analyze_paths(["src/"], AnalysisOptions(include_headers=True))
+    for define in result.get_all_defines():
+        print(define.symbol_name, define.context)
+"""
+
+import sys
+from collections import deque
+from dataclasses import dataclass, field
+from typing import Callable, Dict, Iterable, Iterator, List, Mapping, Optional, TypeVar, Union
+
+from .file_scanner import FileScanner
+from .preprocessor_parser import PreprocessorParser
+from .context_analyzer import ContextAnalyzer
+from .data_models import AnalysisResult, FileAnalysisResult
+
+
+T = TypeVar('T')
+R = TypeVar('R')
+# Tasks submitted ahead of the one being consumed, per worker thread
+QUEUED_PER_WORKER = 4
+
+
+def free_threading_enabled() -> bool:
+    """Whether Python threads run in parallel, i.e. a free-threaded build with the GIL disabled."""
+    is_gil_enabled = getattr(sys, "_is_gil_enabled", None)
+    return is_gil_enabled is not None and not is_gil_enabled()
+
+
+@dataclass
+class AnalysisOptions:
+    """
+    Options controlling file discovery and per-file analysis.
+
+    Attributes:
+        recursive: Whether to scan directories recursively
+        include_headers: Whether to include header files when scanning directories
+        exclude_patterns: Glob patterns of files/directories to skip
+        validate: Run the DirectiveValidator and attach its errors to each file result
+        strict: Enable strict validation rules (implies nothing unless validate is set)
+        check_balance: Check directive nesting balance during validation
+        workers: Threads analyzing files concurrently; more than one is only
+            used on free-threaded builds, elsewhere files are analyzed in the
+            calling thread
+    """
+    recursive: bool = True
+    include_headers: bool = False
+    exclude_patterns: List[str] = field(default_factory=list)
+    validate: bool = False
+    strict: bool = False
+    check_balance: bool = True
+    workers: int = 1
+
+
+class Analyzer:
+    """
+    Reusable analysis engine.
+
+    Holds one scanner, parser, context analyzer and (lazily) validator so that
+    repeated calls share their precompiled state. Results are returned as
+    data model objects; nothing is printed or serialized.
+
+    Parsing and context analysis keep no per-call state on these objects, so
+    analyze_file and analyze_buffer may be called from several threads at
+    once; cross-file results are combined by AnalysisResult.add_file_result.
+    """
+
+    def __init__(self, options: Optional[AnalysisOptions] = None):
+        self.options = options or AnalysisOptions()
+        self.file_scanner = FileScanner()
+        self.preprocessor_parser = PreprocessorParser()
+        self.context_analyzer = ContextAnalyzer()
+        self._validator = None
+
+    @property
+    def validator(self):
+        """DirectiveValidator instance, created on first use."""
+        if self._validator is None:
+            from .validation import DirectiveValidator
+            self._validator = DirectiveValidator()
+        return self._validator
+
+    def collect_files(self, paths: Union[str, Iterable[str]]) -> List[str]:
+        """
+        Expand files and directories into the list of files to analyze.
+
+        Args:
+            paths: A single path or an iterable of file/directory paths
+
+        Returns:
+            De-duplicated list of absolute file paths, in scan order
+
+        Raises:
+            ValueError: If a path does not exist
+        """
+        if isinstance(paths, str):
+            paths = [paths]
+
+        files = []
+        seen = set()
+        for path in paths:
+            for file_path in self.file_scanner.scan(
+                path=path,
+                recursive=self.options.recursive,
+                include_headers=self.options.include_headers,
+                exclude_patterns=self.options.exclude_patterns
+            ):
+                if file_path not in seen:
+                    seen.add(file_path)
+                    files.append(file_path)
+        return files
+
+    def analyze_file(self, file_path: str) -> FileAnalysisResult:
+        """Parse, analyze and optionally validate a single file."""
+        file_result = self.preprocessor_parser.parse_file(file_path)
+        return self._finish(file_result)
+
+    def analyze_buffer(self, text, file_path: str = "<buffer>") -> FileAnalysisResult:
+        """
+        Parse, analyze and optionally validate an in-memory buffer.
+
+        Args:
+            text: Buffer contents as a string or list of lines
+            file_path: Name the buffer is reported under
+        """
+        file_result = self.preprocessor_parser.parse_buffer(text, file_path)
+        return self._finish(file_result)
+
+    def iter_file_results(self,
+                          paths: Union[str, Iterable[str]] = (),
+                          buffers: Optional[Mapping[str, object]] = None) -> Iterator[FileAnalysisResult]:
+        """
+        Lazily yield one FileAnalysisResult per file or buffer.
+
+        Args:
+            paths: Files and/or directories to analyze
+            buffers: Mapping of buffer name to contents, analyzed after paths
+
+        Yields:
+            FileAnalysisResult objects with contexts already assigned, in
+            input order also when several worker threads analyze them
+        """
+        yield from self.map(self.analyze_file, self.collect_files(paths))
+        yield from self.map(lambda item: self.analyze_buffer(item[1], item[0]), (buffers or {}).items())
+
+    @property
+    def workers(self) -> int:
+        """Worker threads map will use: options.workers where threads run in parallel, else 1."""
+        return max(1, self.options.workers) if free_threading_enabled() else 1
+
+    def map(self, function: Callable[[T], R], items: Iterable[T]) -> Iterator[R]:
+        """
+        Apply a function to items, on worker threads when more than one is used.
+
+        Items are consumed from the iterable in the calling thread and at
+        most a few per worker are in flight, so lazy inputs (such as an
+        archive stream) are not read ahead unboundedly.
+
+        Args:
+            function: Called once per item; must be safe to call concurrently
+            items: Inputs, possibly a lazy iterator
+
+        Yields:
+            Results in item order; an exception is raised where its item's
+            result would have been
+        """
+        workers = self.workers
+        if workers == 1:
+            for item in items:
+                yield function(item)
+            return
+
+        if self.options.validate:
+            # Create the lazy validator here, so worker threads do not each create one
+            self.validator
+        from concurrent.futures import ThreadPoolExecutor
+        with ThreadPoolExecutor(max_workers=workers) as executor:
+            pending = deque()
+            for item in items:
+                pending.append(executor.submit(function, item))
+                if len(pending) >= workers * QUEUED_PER_WORKER:
+                    yield pending.popleft().result()
+            while pending:
+                yield pending.popleft().result()
+
+    def analyze_paths(self,
+                      paths: Union[str, Iterable[str]] = (),
+                      buffers: Optional[Mapping[str, object]] = None) -> AnalysisResult:
+        """
+        Analyze files, directories and buffers into one AnalysisResult.
+
+        Files may be analyzed on worker threads (see AnalysisOptions.workers);
+        they are reduced into the result in input order by this thread.
+        """
+        analysis_result = AnalysisResult()
+        for file_result in self.iter_file_results(paths, buffers):
+            analysis_result.add_file_result(file_result)
+        return analysis_result
+
+    def _finish(self, file_result: FileAnalysisResult) -> FileAnalysisResult:
+        """Run context analysis and optional validation on a parsed file."""
+        self.context_analyzer.analyze(file_result)
+
+        if self.options.validate:
+            for error in self.validator.validate(
+                file_result,
+                strict=self.options.strict,
+                check_balance=self.options.check_balance
+            ):
+                file_result.add_error(error)
+
+        return file_result
+
+
+def analyze_paths(paths: Union[str, Iterable[str]] = (),
+                  options: Optional[AnalysisOptions] = None,
+                  buffers: Optional[Mapping[str, object]] = None) -> AnalysisResult:
+    """
+    Analyze files, directories and in-memory buffers.
+
+    Args:
+        paths: A single path or an iterable of file/directory paths
+        options: Discovery and validation options (defaults to AnalysisOptions())
+        buffers: Optional mapping of buffer name to contents (string or lines)
+
+    Returns:
+        AnalysisResult aggregating every file and buffer
+
+    Raises:
+        ValueError: If a path does not exist
+    """
+    return Analyzer(options).analyze_paths(paths, buffers)
+
+
+def iter_file_results(paths: Union[str, Iterable[str]] = (),
+                      options: Optional[AnalysisOptions] = None,
+                      buffers: Optional[Mapping[str, object]] = None) -> Iterator[FileAnalysisResult]:
+    """
+    Lazily analyze files, directories and buffers one file at a time.
+
+    Useful for large trees where holding every result in memory is not needed.
+
+    Raises:
+        ValueError: If a path does not exist
+    """
+    return Analyzer(options).iter_file_results(paths, buffers)
+
+
+def analyze_buffers(buffers: Mapping[str, object],
+                    options: Optional[AnalysisOptions] = None) -> Dict[str, FileAnalysisResult]:
+    """
+    Analyze named in-memory buffers.
+
+    Args:
+        buffers: Mapping of buffer name to contents (string or list of lines)
+        options: Validation options; discovery options are ignored
+
+    Returns:
+        Dictionary mapping buffer name to its FileAnalysisResult
+    """
+    analyzer = Analyzer(options)
+    return {name: analyzer.analyze_buffer(text, name) for name, text in buffers.items()}
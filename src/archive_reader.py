@@ -0,0 +1,81 @@
+"""
+Archive reader module.
+Streams the C++ members of .tar (optionally gzip, xz or bzip2 compressed)
+and .zip archives without extracting them. Member names go through the
+same extension and exclude rules as files on disk, and each member is
+decoded into lines for the parser as it is read from the archive stream.
+"""
+
+import io
+import posixpath
+import tarfile
+import zipfile
+from typing import Iterator, List, Optional, Tuple
+
+from .file_scanner import FileScanner
+
+
+# Names of supported archives (compressed tarballs are detected by content)
+ARCHIVE_SUFFIXES = ('.tar.gz', '.tar.xz', '.tar.bz2', '.tgz', '.txz', '.tbz2', '.tar', '.zip')
+
+
+def is_archive(path: str) -> bool:
+    """Check whether a path names a supported archive by its suffix."""
+    return path.lower().endswith(ARCHIVE_SUFFIXES)
+
+
+def decode_lines(data: bytes) -> List[str]:
+    """Decode file contents into lines the way PreprocessorParser.parse_file reads files."""
+    return io.TextIOWrapper(io.BytesIO(data), encoding='utf-8', errors='ignore').readlines()
+
+
+def iter_archive_sources(path: str,
+                         include_headers: bool = False,
+                         exclude_patterns: Optional[List[str]] = None,
+                         scanner: Optional[FileScanner] = None) -> Iterator[Tuple[str, List[str]]]:
+    """
+    Yield the C++ members of an archive with their lines.
+
+    Tar archives are read as a stream, one member after another, so
+    compressed tarballs are decompressed once and never seeked; zip
+    members are decompressed one at a time. Only regular files are read.
+    Archives are always read whole, whatever their directory layout.
+
+    Args:
+        path: Archive file
+        include_headers: Whether header members are yielded
+        exclude_patterns: Glob patterns matched against member names
+        scanner: FileScanner whose rules select members
+
+    Yields:
+        (name reported for the member, i.e. "<archive>/<member>", its lines)
+
+    Raises:
+        ValueError: If the file is not a supported archive
+    """
+    scanner = scanner or FileScanner()
+    exclude_patterns = exclude_patterns or []
+
+    def accepted(member: str) -> Optional[str]:
+        member = posixpath.normpath(member)
+        if scanner.accepts(member, include_headers, exclude_patterns):
+            return f"{path}/{member}"
+        return None
+
+    if path.lower().endswith('.zip'):
+        with zipfile.ZipFile(path) as archive:
+            for info in archive.infolist():
+                name = None if info.is_dir() else accepted(info.filename)
+                if name is not None:
+                    with archive.open(info) as member:
+                        yield name, decode_lines(member.read())
+        return
+
+    if not is_archive(path):
+        raise ValueError(f"'{path}' is not a supported archive")
+    # "r|*" reads a non-seekable stream with transparent decompression
+    with tarfile.open(path, mode='r|*') as archive:
+        for info in archive:
+            name = accepted(info.name) if info.isfile() else None
+            if name is not None:
+                yield name, decode_lines(archive.extractfile(info).read())
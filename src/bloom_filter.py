@@ -0,0 +1,264 @@
+"""
+Bloom filter module.
+Keeps a compact Bloom filter of the identifiers each file defines or
+references, so a query for a set of macros discards most files without
+touching their directives. Only files whose filter answers "maybe" are
+loaded and checked exactly. The data models are imported when directives
+are read, so testing a saved filter table stays cheap to start.
+"""
+
+import base64
+import hashlib
+import math
+import re
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, Iterable, List, Optional, Set, Tuple
+
+
+IDENTIFIER = re.compile(r'[A-Za-z_]\w*')
+DEFAULT_FALSE_POSITIVE_RATE = 0.01
+# Smallest filter, so files with few identifiers still get a usable rate
+MIN_BITS = 64
+
+
+def directive_identifiers(directives: Iterable['Directive']) -> Set[str]:
+    """Identifiers a file's directives define or reference, without directive keywords."""
+    from .data_models import DirectiveType
+    identifiers = set()
+    for directive in directives:
+        if directive.symbol_name:
+            identifiers.add(directive.symbol_name)
+        if directive.type == DirectiveType.INCLUDE:
+            continue
+        names = IDENTIFIER.findall(directive.content)
+        identifiers.update(names[1:])  # names[0] is define, ifdef, ...
+    return identifiers
+
+
+def code_identifiers(text: str) -> Set[str]:
+    """Identifiers on the lines of a source text that are not directives."""
+    identifiers = set()
+    for line in text.splitlines():
+        if not line.lstrip().startswith('#'):
+            identifiers.update(IDENTIFIER.findall(line))
+    return identifiers
+
+
+def symbol_hashes(symbol: str) -> Tuple[int, int]:
+    """Two independent 64-bit hashes of a symbol, for double hashing."""
+    digest = hashlib.blake2b(symbol.encode('utf-8'), digest_size=16).digest()
+    return int.from_bytes(digest[:8], 'little'), int.from_bytes(digest[8:], 'little')
+
+
+def bit_positions(hashes: Tuple[int, int], size: int, hash_count: int) -> List[int]:
+    """
+    Bit positions of a symbol in a filter of a given shape.
+
+    Uses enhanced double hashing (h1 + i*h2 + (i^3 - i)/6), whose false
+    positive rate stays at that of independent hash functions where plain
+    double hashing degrades when h2 shares a factor with the size.
+    """
+    h1, h2 = hashes
+    return [(h1 + i * h2 + (i * i * i - i) // 6) % size for i in range(hash_count)]
+
+
+class BloomFilter:
+    """
+    Set membership with false positives but no false negatives.
+
+    Bit positions are derived from two hashes of the symbol (see
+    bit_positions), so a symbol is hashed once however many filters it is
+    tested against, and positions are shared by filters of the same shape.
+    """
+
+    def __init__(self, size: int, hash_count: int, bits: Optional[bytearray] = None):
+        self.size = size
+        self.hash_count = hash_count
+        self.bits = bits if bits is not None else bytearray((size + 7) // 8)
+
+    @classmethod
+    def for_capacity(cls, items: int, false_positive_rate: float = DEFAULT_FALSE_POSITIVE_RATE) -> 'BloomFilter':
+        """
+        Create a filter sized for a number of items.
+
+        Args:
+            items: Expected number of distinct items
+            false_positive_rate: Target probability that an absent item tests present
+
+        Returns:
+            Empty filter with the optimal size and hash count for the rate
+        """
+        if not 0 < false_positive_rate < 1:
+            raise ValueError("False positive rate must be between 0 and 1")
+        items = max(1, items)
+        size = max(MIN_BITS, math.ceil(-items * math.log(false_positive_rate) / math.log(2) ** 2))
+        size = (size + 7) // 8 * 8
+        hash_count = max(1, round(size / items * math.log(2)))
+        return cls(size, hash_count)
+
+    def add(self, symbol: str) -> None:
+        """Add a symbol."""
+        for position in bit_positions(symbol_hashes(symbol), self.size, self.hash_count):
+            self.bits[position >> 3] |= 1 << (position & 7)
+
+    def contains_positions(self, positions: List[int]) -> bool:
+        """Test a symbol by its precomputed bit_positions for this filter's shape."""
+        bits = self.bits
+        for position in positions:
+            if not bits[position >> 3] & (1 << (position & 7)):
+                return False
+        return True
+
+    def __contains__(self, symbol: str) -> bool:
+        return self.contains_positions(bit_positions(symbol_hashes(symbol), self.size, self.hash_count))
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert filter to dictionary for serialization."""
+        return {
+            "size": self.size,
+            "hash_count": self.hash_count,
+            "bits": base64.b64encode(bytes(self.bits)).decode('ascii')
+        }
+
+    @classmethod
+    def from_dict(cls, data: Dict[str, Any]) -> 'BloomFilter':
+        """Restore a saved filter."""
+        return cls(data["size"], data["hash_count"], bytearray(base64.b64decode(data["bits"])))
+
+
+@dataclass
+class MentionQuery:
+    """
+    Outcome of finding the files that mention a set of symbols.
+
+    Attributes:
+        symbols: Symbols queried
+        files: Files confirmed to mention the symbols
+        candidates: Files whose filters passed, before verification
+        total_files: Files with a filter
+    """
+    symbols: List[str]
+    files: List[str] = field(default_factory=list)
+    candidates: int = 0
+    total_files: int = 0
+
+    @property
+    def false_positives(self) -> int:
+        """Candidates that verification rejected."""
+        return self.candidates - len(self.files)
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert query outcome to dictionary for serialization."""
+        return {
+            "symbols": list(self.symbols),
+            "files": list(self.files),
+            "candidates": self.candidates,
+            "total_files": self.total_files
+        }
+
+
+class FileFilterIndex:
+    """
+    Per-file Bloom filters of the identifiers in directives, and optionally
+    in code lines.
+
+    Attributes:
+        filters: File mapped to its filter, in analysis order
+        false_positive_rate: Rate every filter was sized for
+        code_usage: Whether code lines were scanned as well as directives
+    """
+
+    def __init__(self, false_positive_rate: float = DEFAULT_FALSE_POSITIVE_RATE, code_usage: bool = False):
+        self.filters: Dict[str, BloomFilter] = {}
+        self.false_positive_rate = false_positive_rate
+        self.code_usage = code_usage
+
+    @classmethod
+    def from_analysis(cls, result: 'AnalysisResult',
+                      false_positive_rate: float = DEFAULT_FALSE_POSITIVE_RATE,
+                      read_text: Optional[Callable[[str], Optional[str]]] = None) -> 'FileFilterIndex':
+        """
+        Build filters for every file of an analysis.
+
+        Args:
+            result: Analysis result
+            false_positive_rate: Target false positive rate of each filter
+            read_text: Returns a file's source text to scan code lines too,
+                or None when it is unavailable; directives only if not given
+        """
+        index = cls(false_positive_rate, code_usage=read_text is not None)
+        for file_result in result.file_results.values():
+            identifiers = directive_identifiers(file_result.directives)
+            text = read_text(file_result.file_path) if read_text else None
+            if text is not None:
+                identifiers |= code_identifiers(text)
+            index.add_file(file_result.file_path, identifiers)
+        return index
+
+    def add_file(self, file_path: str, identifiers: Set[str]) -> None:
+        """Replace the filter of a file with one holding its identifiers."""
+        bloom = BloomFilter.for_capacity(len(identifiers), self.false_positive_rate)
+        for identifier in identifiers:
+            bloom.add(identifier)
+        self.filters[file_path] = bloom
+
+    def __len__(self) -> int:
+        return len(self.filters)
+
+    def candidates(self, symbols: Iterable[str], any_symbol: bool = False) -> List[str]:
+        """
+        Files whose filters may hold every symbol (or any, with any_symbol).
+
+        Each symbol is hashed once and its bit positions computed once per
+        filter shape; testing a file stops at the first symbol that settles it.
+        """
+        hashes = [symbol_hashes(symbol) for symbol in symbols]
+        test = any if any_symbol else all
+        shapes: Dict[Tuple[int, int], List[List[int]]] = {}
+        result = []
+        for path, bloom in self.filters.items():
+            shape = (bloom.size, bloom.hash_count)
+            positions = shapes.get(shape)
+            if positions is None:
+                positions = shapes[shape] = [bit_positions(h, *shape) for h in hashes]
+            if test(bloom.contains_positions(p) for p in positions):
+                result.append(path)
+        return result
+
+    def query(self, symbols: List[str], load: Callable[[str], Optional[Set[str]]],
+              any_symbol: bool = False) -> MentionQuery:
+        """
+        Find the files that mention symbols, loading only filter hits.
+
+        Args:
+            symbols: Symbols to find
+            load: Returns the exact identifiers of a file, or None if they
+                cannot be loaded (the file then counts as a match)
+            any_symbol: Match files mentioning any symbol instead of all
+
+        Returns:
+            Confirmed files with candidate counts
+        """
+        outcome = MentionQuery(symbols=list(symbols), total_files=len(self))
+        test = any if any_symbol else all
+        for file_path in self.candidates(symbols, any_symbol):
+            outcome.candidates += 1
+            identifiers = load(file_path)
+            if identifiers is None or test(symbol in identifiers for symbol in symbols):
+                outcome.files.append(file_path)
+        return outcome
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert index to dictionary for serialization."""
+        return {
+            "false_positive_rate": self.false_positive_rate,
+            "code_usage": self.code_usage,
+            "filters": {path: bloom.to_dict() for path, bloom in self.filters.items()}
+        }
+
+    @classmethod
+    def from_dict(cls, data: Dict[str, Any]) -> 'FileFilterIndex':
+        """Restore a saved index."""
+        index = cls(data.get("false_positive_rate", DEFAULT_FALSE_POSITIVE_RATE), data.get("code_usage", False))
+        index.filters = {path: BloomFilter.from_dict(bloom) for path, bloom in data.get("filters", {}).items()}
+        return index
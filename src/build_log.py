@@ -0,0 +1,200 @@
+"""
+Build log module for deriving per-file build configurations without a
+compilation database.
+Reads the compiler invocations printed by `make -n`, `ninja -t commands` or a
+verbose build log, extracts each source file's -D/-U/-I flags, and interns
+identical flag sets so every distinct configuration that is actually built
+becomes one shared Configuration.
+"""
+
+import os
+import re
+from typing import Dict, Iterable, List, Optional, Tuple
+
+from .compilation_database import CompileCommand, configuration_from_arguments
+from .data_models import Configuration
+
+
+# A shell word (runs of unquoted text, quoted strings and escapes) or an
+# unquoted command separator
+SHELL_TOKEN = re.compile(r"""((?:[^\s'"\\;&|]+|'[^']*'|"(?:[^"\\]|\\.)*"|\\.)+)|([;&|]+)""", re.DOTALL)
+# Pieces of a word that need unquoting
+SHELL_PIECE = re.compile(r"""'([^']*)'|"((?:[^"\\]|\\.)*)"|\\(.)|([^'"\\]+)""", re.DOTALL)
+# Backslash escapes that keep their meaning inside double quotes
+DOUBLE_QUOTE_ESCAPE = re.compile(r'\\([\\"$`\n])')
+
+COMPILER = re.compile(r'^(?:.*-)?(?:cc|c\+\+|gcc|g\+\+|clang|clang\+\+|icc|icpc|icx|icpx)(?:-[\d.]+)?(?:\.exe)?$')
+COMPILER_LAUNCHERS = {"ccache", "sccache", "distcc", "icecc", "env"}
+ENV_ASSIGNMENT = re.compile(r'^[A-Za-z_]\w*=')
+SOURCE_EXTENSIONS = {".c", ".cc", ".cp", ".cpp", ".cxx", ".c++", ".C", ".m", ".mm"}
+# Options whose separate argument is a file that is not compiled
+OUTPUT_FLAGS = {"-o", "-MF", "-MT", "-MQ", "-x", "-include", "-imacros"}
+NINJA_STATUS = re.compile(r'^\s*\[\d+/\d+\]\s*')
+MAKE_DIRECTORY = re.compile(r"""^\S*make(?:\[\d+\])?: (Entering|Leaving) directory [`'"](.*)['"]\s*$""")
+
+
+def tokenize_command_line(line: str) -> List[List[str]]:
+    """
+    Split a shell command line into commands and their arguments.
+
+    Handles single and double quotes and backslash escapes like a POSIX
+    shell, and splits at unquoted `;`, `&&`, `||` and `|`. Words without
+    quotes or escapes are taken as they are, which is the common case for
+    compiler flags.
+
+    Args:
+        line: One logical command line, continuations already joined
+
+    Returns:
+        Argument lists of the commands on the line, in order
+    """
+    commands: List[List[str]] = [[]]
+    for match in SHELL_TOKEN.finditer(line):
+        word = match.group(1)
+        if word is None:
+            if commands[-1]:
+                commands.append([])
+            continue
+        if '"' in word or "'" in word or '\\' in word:
+            word = _unquote(word)
+        commands[-1].append(word)
+    if not commands[-1]:
+        commands.pop()
+    return commands
+
+
+def _unquote(word: str) -> str:
+    """Remove the quoting of a shell word."""
+    parts = []
+    for single, double, escaped, plain in SHELL_PIECE.findall(word):
+        if plain:
+            parts.append(plain)
+        elif escaped:
+            parts.append(escaped)
+        elif double:
+            parts.append(DOUBLE_QUOTE_ESCAPE.sub(r'\1', double))
+        else:
+            parts.append(single)
+    return "".join(parts)
+
+
+def compiled_sources(arguments: List[str]) -> List[str]:
+    """
+    Get the source files a command compiles, or nothing if it is not a compiler.
+
+    Leading variable assignments and launchers such as ccache are skipped
+    to find the compiler; only GCC-style drivers (gcc, clang, cc and their
+    cross and versioned variants) are recognized.
+    """
+    index = 0
+    while index < len(arguments) and (ENV_ASSIGNMENT.match(arguments[index]) or
+                                      os.path.basename(arguments[index]) in COMPILER_LAUNCHERS):
+        index += 1
+    if index >= len(arguments) or not COMPILER.match(os.path.basename(arguments[index])):
+        return []
+
+    sources = []
+    skip_next = False
+    for argument in arguments[index + 1:]:
+        if skip_next:
+            skip_next = False
+        elif argument in OUTPUT_FLAGS:
+            skip_next = True
+        elif not argument.startswith('-') and os.path.splitext(argument)[1] in SOURCE_EXTENSIONS:
+            sources.append(argument)
+    return sources
+
+
+def parse_build_log(lines: Iterable[str], directory: str = "") -> List[CompileCommand]:
+    """
+    Extract compile commands from build tool output.
+
+    Accepts `make -n`, `ninja -t commands` and verbose build logs; lines
+    that are not compiler invocations are ignored. Continuation lines are
+    joined, ninja's `[n/m]` progress prefix is dropped, and `cd DIR &&`
+    prefixes and make's "Entering directory" messages change the directory
+    relative paths are resolved against. Commands with identical -D/-U/-I
+    flags share one Configuration, named build-1, build-2, ... in order of
+    first use.
+
+    Args:
+        lines: Log lines
+        directory: Directory the build ran in
+
+    Returns:
+        One CompileCommand per compiled source file, in log order
+    """
+    directory = os.path.abspath(directory or os.getcwd())
+    directories = [directory]
+    interned: Dict[Tuple, Configuration] = {}
+    commands: List[CompileCommand] = []
+
+    pending = ""
+    for raw in lines:
+        line = raw.rstrip('\r\n')
+        if line.endswith('\\'):
+            pending += line[:-1]
+            continue
+        line, pending = pending + line, ""
+
+        match = MAKE_DIRECTORY.match(line)
+        if match:
+            if match.group(1) == "Entering":
+                directories.append(os.path.join(directories[-1], match.group(2)))
+            elif len(directories) > 1:
+                directories.pop()
+            continue
+        # Cheap filter before tokenizing: compile lines always name a source file
+        if not any(extension in line for extension in SOURCE_EXTENSIONS):
+            continue
+
+        working = directories[-1]
+        for arguments in tokenize_command_line(NINJA_STATUS.sub("", line, count=1)):
+            if arguments[0] == "cd" and len(arguments) > 1:
+                working = os.path.normpath(os.path.join(working, arguments[1]))
+                continue
+            sources = compiled_sources(arguments)
+            if not sources:
+                continue
+            configuration = configuration_from_arguments(arguments, working)
+            key = (
+                tuple(sorted(configuration.defines.items())),
+                tuple(configuration.undefs),
+                tuple(configuration.include_paths)
+            )
+            shared = interned.get(key)
+            if shared is None:
+                configuration.name = f"build-{len(interned) + 1}"
+                shared = interned[key] = configuration
+            for source in sources:
+                commands.append(CompileCommand(
+                    file=os.path.normpath(os.path.join(working, source)),
+                    directory=working,
+                    configuration=shared
+                ))
+    return commands
+
+
+def load_build_log(path: str, directory: Optional[str] = None) -> List[CompileCommand]:
+    """
+    Load compile commands from a saved build log.
+
+    Args:
+        path: File holding `make -n`, `ninja -t commands` or compiler output
+        directory: Directory the build ran in (default: the log's directory)
+
+    Returns:
+        One CompileCommand per compiled source file, in log order
+    """
+    if directory is None:
+        directory = os.path.dirname(os.path.abspath(path))
+    with open(path, 'r', encoding='utf-8', errors='replace') as f:
+        return parse_build_log(f, directory)
+
+
+def distinct_configurations(commands: Iterable[CompileCommand]) -> List[Configuration]:
+    """Get the distinct configurations of a set of commands, in order of first use."""
+    seen: Dict[int, Configuration] = {}
+    for command in commands:
+        seen.setdefault(id(command.configuration), command.configuration)
+    return list(seen.values())
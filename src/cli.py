@@ -3,37 +3,214 @@ Command-line interface for the C++ Preprocessor Directive Analysis Tool.
 Provides argument parsing and command routing for analyze, report, and validate commands.
 """
 
+from __future__ import annotations
+
 import argparse
 import sys
 import os
-import json
-from typing import List, Optional
 
-from .file_scanner import FileScanner
-from .preprocessor_parser import PreprocessorParser
-from .context_analyzer import ContextAnalyzer
-from .report_generator import ReportGenerator
-from .validation import DirectiveValidator
-from .data_models import AnalysisResult
+# typing is only needed by type checkers; a cold `lookup` would otherwise
+# import it for nothing
+TYPE_CHECKING = False
+if TYPE_CHECKING:
+    from typing import List, Optional
+
+# Analysis, reporting and validation modules are imported lazily by the
+# subcommand that needs them so that short-lived invocations (editor hooks,
+# pre-commit checks) only pay for what they use.
+
+
+def _terminal_width() -> int:
+    """Terminal width found the way shutil.get_terminal_size() finds it."""
+    try:
+        columns = int(os.environ["COLUMNS"])
+        if columns > 0:
+            return columns
+    except (KeyError, ValueError):
+        pass
+    try:
+        return os.get_terminal_size(sys.__stdout__.fileno()).columns or 80
+    except (AttributeError, ValueError, OSError):
+        return 80
+
+
+def _help_formatter(formatter_class):
+    """
+    Formatter factory that passes argparse the terminal width itself.
+
+    argparse otherwise imports shutil (and with it bz2, lzma and zlib) for
+    every parser it builds, which is a noticeable part of a cold start.
+    """
+    return lambda prog: formatter_class(prog, width=_terminal_width() - 2)
 
 
 class CLI:
     """Main CLI class for handling command-line operations."""
     
+    # Subcommand name -> (help, description)
+    COMMANDS = {
+        "analyze": (
+            "Analyze preprocessor directives in C++ files",
+            "Parse C++ files and analyze preprocessor directive usage patterns"
+        ),
+        "report": (
+            "Generate reports from analysis results",
+            "Generate formatted reports from previously saved analysis data"
+        ),
+        "search": (
+            "Search conditions and define values of saved analysis results",
+            "Find directives whose canonical condition or #define value contains a substring "
+            "or matches a regular expression, using a trigram index"
+        ),
+        "query": (
+            "Query saved analysis results by context semantics",
+            "Select directives with a small query language, e.g. `defines where context "
+            "implies ENABLE_LOGGING and not WINDOWS`, deciding implication per distinct context"
+        ),
+        "lookup": (
+            "Look up macros in a symbol table file",
+            "Probe the memory-mapped symbol table written by analyze --symbol-table for "
+            "the definitions and undefinitions of macros"
+        ),
+        "timeline": (
+            "Show where a macro is defined and undefined, or its state at a line",
+            "Index the #define/#undef events of a macro per file in line order and answer "
+            "whether it is defined at FILE:LINE by binary search, weighing conditional events"
+        ),
+        "mentions": (
+            "Find the files that mention macros, pruning with Bloom filters",
+            "Test the per-file Bloom filters written by analyze --bloom-filters and "
+            "verify only the files that may mention every queried macro"
+        ),
+        "validate": (
+            "Validate preprocessor directive syntax",
+            "Check for syntax errors and nesting issues in preprocessor directives"
+        ),
+        "macros": (
+            "Print the macros in effect after preprocessing files",
+            "Compute effective macro tables like `gcc -dM -E`, sharing header work across files"
+        ),
+        "pch": (
+            "Recommend precompiled headers",
+            "Rank headers by translation units including them times transitive bytes and "
+            "suggest a precompiled header per target directory"
+        ),
+        "unity": (
+            "Plan unity (jumbo) build batches",
+            "Group translation units into size-balanced unity batches without conflicting macros"
+        ),
+        "conflicts": (
+            "Find macros defined differently by headers of one translation unit",
+            "Report, per translation unit, macros whose value depends on include order "
+            "because reachable headers define them differently"
+        ),
+        "deps": (
+            "Load the include graph recorded in ninja's deps log",
+            "Read .ninja_deps to get every translation unit's headers without resolving "
+            "#includes, and cross-check them against static resolution"
+        ),
+        "configs": (
+            "Enumerate or sample valid build configurations",
+            "List the feature-macro configurations of files, pruning every combination "
+            "that reaches an #error"
+        ),
+        "cnf": (
+            "Export the feature model as DIMACS CNF",
+            "Encode #error constraints and conditional-define implications as a "
+            "Tseitin-encoded DIMACS CNF formula with a variable map"
+        ),
+        "values": (
+            "Tabulate folded macro values per configuration",
+            "Fold object-like macros to integer or string constants under each configuration "
+            "and print a symbol x configuration matrix"
+        ),
+        "cost": (
+            "Estimate compiled lines and bytes per configuration",
+            "Count the active physical lines and bytes of each translation unit and the "
+            "headers it includes under each configuration"
+        ),
+        "coverage": (
+            "Find feature contexts that tests never exercise",
+            "Map gcov line coverage onto preprocessor contexts and report the feature-flag "
+            "contexts whose code never ran"
+        ),
+        "history": (
+            "Track preprocessor metrics across git commits",
+            "Read commits straight from git objects through one cat-file process, parse only "
+            "blobs not seen in earlier commits, and print a time series of flag counts, "
+            "nesting depth and error counts"
+        ),
+        "lsp": (
+            "Run a Language Server Protocol server on stdio",
+            "Serve hover contexts, inactive regions and diagnostics to an editor over stdio"
+        ),
+    }
+    
+    # Path argument that selects standard input instead of a file
+    STDIN_PATH = "-"
+    
     def __init__(self):
-        self.parser = self._create_parser()
-        self.file_scanner = FileScanner()
-        self.preprocessor_parser = PreprocessorParser()
-        self.context_analyzer = ContextAnalyzer()
-        self.report_generator = ReportGenerator()
-        self.validator = DirectiveValidator()
-
-    def _create_parser(self) -> argparse.ArgumentParser:
-        """Create the main argument parser with subcommands."""
+        self.parser = None
+        self._analyzer = None
+        self._preprocessor_parser = None
+        self._report_generator = None
+        self._validator = None
+
+    @property
+    def analyzer(self):
+        """Analysis engine, created on first use."""
+        if self._analyzer is None:
+            from .api import Analyzer
+            self._analyzer = Analyzer()
+            self._preprocessor_parser = self._analyzer.preprocessor_parser
+        return self._analyzer
+
+    @property
+    def file_scanner(self):
+        """File scanner shared with the analysis engine."""
+        return self.analyzer.file_scanner
+
+    @property
+    def context_analyzer(self):
+        """Context analyzer shared with the analysis engine."""
+        return self.analyzer.context_analyzer
+
+    @property
+    def preprocessor_parser(self):
+        """Directive parser; does not pull in the context analyzer."""
+        if self._preprocessor_parser is None:
+            from .preprocessor_parser import PreprocessorParser
+            self._preprocessor_parser = PreprocessorParser()
+        return self._preprocessor_parser
+
+    @property
+    def report_generator(self):
+        """Report generator, created on first use."""
+        if self._report_generator is None:
+            from .report_generator import ReportGenerator
+            self._report_generator = ReportGenerator()
+        return self._report_generator
+
+    @property
+    def validator(self):
+        """Directive validator, created on first use."""
+        if self._validator is None:
+            from .validation import DirectiveValidator
+            self._validator = DirectiveValidator()
+        return self._validator
+
+    def _create_parser(self, command: Optional[str] = None) -> argparse.ArgumentParser:
+        """
+        Create the main argument parser with subcommands.
+        
+        Args:
+            command: Subcommand about to run; when given, only that
+                subcommand is registered
+        """
         parser = argparse.ArgumentParser(
             prog="cpp-preprocessor-analyzer",
             description="Analyze C++ preprocessor directives and their contexts",
-            formatter_class=argparse.RawDescriptionHelpFormatter,
+            formatter_class=_help_formatter(argparse.RawDescriptionHelpFormatter),
             epilog="""
 Examples:
   %(prog)s analyze src/
@@ -49,37 +226,36 @@ Examples:
             metavar="COMMAND"
         )
         
-        # Analyze command
-        analyze_parser = subparsers.add_parser(
-            "analyze",
-            help="Analyze preprocessor directives in C++ files",
-            description="Parse C++ files and analyze preprocessor directive usage patterns"
-        )
-        self._add_analyze_arguments(analyze_parser)
-        
-        # Report command
-        report_parser = subparsers.add_parser(
-            "report",
-            help="Generate reports from analysis results",
-            description="Generate formatted reports from previously saved analysis data"
-        )
-        self._add_report_arguments(report_parser)
-        
-        # Validate command
-        validate_parser = subparsers.add_parser(
-            "validate",
-            help="Validate preprocessor directive syntax",
-            description="Check for syntax errors and nesting issues in preprocessor directives"
-        )
-        self._add_validate_arguments(validate_parser)
+        # Building a subparser costs about a millisecond, so a known command
+        # gets only its own; help and unknown commands list them all
+        names = [command] if command is not None else list(self.COMMANDS)
+        for name in names:
+            help_text, description = self.COMMANDS[name]
+            command_parser = subparsers.add_parser(
+                name,
+                help=help_text,
+                description=description,
+                formatter_class=_help_formatter(argparse.HelpFormatter)
+            )
+            getattr(self, f"_add_{name.replace('-', '_')}_arguments")(command_parser)
         
         return parser
 
+    def _peek_command(self, args: Optional[List[str]]) -> Optional[str]:
+        """Return the subcommand named in args, if it is a known one."""
+        if args is None:
+            args = sys.argv[1:]
+        for arg in args:
+            if not arg.startswith("-"):
+                return arg if arg in self.COMMANDS else None
+        return None
+
     def _add_analyze_arguments(self, parser: argparse.ArgumentParser) -> None:
         """Add arguments for the analyze command."""
         parser.add_argument(
             "path",
-            help="Path to C++ file or directory to analyze"
+            help="Path to C++ file, directory or .tar/.tar.gz/.tar.xz/.zip archive to analyze "
+                 "('-' reads standard input)"
         )
         parser.add_argument(
             "--recursive", "-r",
@@ -101,16 +277,70 @@ Examples:
             default="json",
             help="Output format for results (default: json)"
         )
+        parser.add_argument(
+            "--search-index",
+            metavar="FILE",
+            help="Write a trigram index of conditions and define values to a memory-mapped "
+                 "search table file (used by the search command)"
+        )
+        parser.add_argument(
+            "--bloom-filters",
+            metavar="FILE",
+            help="Write a Bloom filter of each file's identifiers to a filter table file "
+                 "pointing into the results saved with --output (used by the mentions command)"
+        )
+        parser.add_argument(
+            "--bloom-rate",
+            type=float,
+            default=0.01,
+            metavar="RATE",
+            help="False positive rate the Bloom filters are sized for (default: 0.01)"
+        )
+        parser.add_argument(
+            "--symbol-table",
+            metavar="FILE",
+            help="Write every #define and #undef to a memory-mapped symbol table file "
+                 "(used by the lookup command)"
+        )
+        parser.add_argument(
+            "--scan-code",
+            action="store_true",
+            help="Also put identifiers used on code lines in the Bloom filters"
+        )
         parser.add_argument(
             "--exclude",
             action="append",
             help="Patterns to exclude from analysis (can be used multiple times)"
         )
+        parser.add_argument(
+            "--rev",
+            metavar="REV",
+            help="Analyze the directory as of a git revision, reading files from git objects "
+                 "instead of the working tree"
+        )
+        parser.add_argument(
+            "--jobs", "-j",
+            type=int,
+            default=1,
+            metavar="N",
+            help="Analyze files on N threads; takes effect on free-threaded Python builds, "
+                 "elsewhere files are analyzed one after another (default: 1)"
+        )
         parser.add_argument(
             "--verbose", "-v",
             action="store_true",
             help="Enable verbose output"
         )
+        self._add_stdin_name_argument(parser)
+
+    def _add_stdin_name_argument(self, parser: argparse.ArgumentParser) -> None:
+        """Add the option naming a buffer read from standard input."""
+        parser.add_argument(
+            "--stdin-name",
+            default="<stdin>",
+            metavar="NAME",
+            help="File name to report standard input under (default: <stdin>)"
+        )
 
     def _add_report_arguments(self, parser: argparse.ArgumentParser) -> None:
         """Add arguments for the report command."""
@@ -144,12 +374,135 @@ Examples:
             help="Group defines by their conditional contexts"
         )
 
+    def _add_search_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the search command."""
+        parser.add_argument(
+            "input",
+            help="Search table written by analyze --search-index, or analysis data file "
+                 "saved by analyze -o (JSON format) to index on the fly"
+        )
+        parser.add_argument(
+            "query",
+            help="Substring to find, or a regular expression with --regex"
+        )
+        parser.add_argument(
+            "--regex", "-E",
+            action="store_true",
+            help="Treat the query as a regular expression"
+        )
+        parser.add_argument(
+            "--ignore-case", "-i",
+            action="store_true",
+            help="Match case-insensitively"
+        )
+        kinds = parser.add_mutually_exclusive_group()
+        kinds.add_argument(
+            "--conditions",
+            action="store_true",
+            help="Search only #if/#ifdef/#ifndef/#elif conditions"
+        )
+        kinds.add_argument(
+            "--defines",
+            action="store_true",
+            help="Search only #define values"
+        )
+        parser.add_argument(
+            "--limit",
+            type=int,
+            metavar="N",
+            help="Print at most N matches"
+        )
+
+    def _add_query_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the query command."""
+        parser.add_argument(
+            "input",
+            help="Analysis data file saved by analyze -o (JSON format)"
+        )
+        parser.add_argument(
+            "query",
+            help="Query, e.g. \"defines where context implies FEATURE and not WINDOWS\""
+        )
+        parser.add_argument(
+            "--limit",
+            type=int,
+            metavar="N",
+            help="Print at most N matches"
+        )
+        parser.add_argument(
+            "--output", "-o",
+            help="Output file for the matching directives (JSON format)"
+        )
+
+    def _add_lookup_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the lookup command."""
+        parser.add_argument(
+            "table",
+            help="Symbol table file written by analyze --symbol-table"
+        )
+        parser.add_argument(
+            "names",
+            nargs="+",
+            help="Macro names to look up"
+        )
+        parser.add_argument(
+            "--json",
+            action="store_true",
+            help="Print the definitions as JSON"
+        )
+
+    def _add_timeline_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the timeline command."""
+        parser.add_argument(
+            "input",
+            help="Analysis data file saved by analyze -o (JSON format)"
+        )
+        parser.add_argument(
+            "symbol",
+            help="Macro name"
+        )
+        parser.add_argument(
+            "--at",
+            metavar="FILE:LINE",
+            help="Print whether the macro is defined at a line (FILE may be a path suffix)"
+        )
+        parser.add_argument(
+            "--json",
+            action="store_true",
+            help="Print the events or state as JSON"
+        )
+
+    def _add_mentions_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the mentions command."""
+        parser.add_argument(
+            "input",
+            help="Filter table written by analyze --bloom-filters, or analysis data file "
+                 "saved by analyze -o (JSON format) to build filters for on the fly"
+        )
+        parser.add_argument(
+            "symbols",
+            nargs="+",
+            help="Macros or identifiers to find"
+        )
+        parser.add_argument(
+            "--any",
+            action="store_true",
+            help="List files mentioning any of the symbols instead of all of them"
+        )
+        parser.add_argument(
+            "--false-positive-rate",
+            type=float,
+            default=0.01,
+            metavar="RATE",
+            help="Rate of the filters built for results saved without them (default: 0.01)"
+        )
+
     def _add_validate_arguments(self, parser: argparse.ArgumentParser) -> None:
         """Add arguments for the validate command."""
         parser.add_argument(
             "files",
             nargs="+",
-            help="C++ files to validate"
+            help="C++ files to validate ('-' reads standard input, at most once)"
         )
         parser.add_argument(
             "--strict",
@@ -165,22 +518,411 @@ Examples:
             "--output", "-o",
             help="Output file for validation results"
         )
+        self._add_stdin_name_argument(parser)
+
+    def _add_macros_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the macros command."""
+        parser.add_argument(
+            "files",
+            nargs="*",
+            help="Translation units to preprocess (default: every file in --compile-commands or --build-log)"
+        )
+        parser.add_argument(
+            "--compile-commands",
+            metavar="PATH",
+            help="compile_commands.json (or its directory) supplying per-file -D/-U/-I flags"
+        )
+        parser.add_argument(
+            "--build-log",
+            metavar="PATH",
+            help="Output of `make -n`, `ninja -t commands` or a verbose build supplying per-file -D/-U/-I flags"
+        )
+        parser.add_argument(
+            "--line",
+            type=int,
+            help="Report the macros in effect just before this line of each file"
+        )
+        parser.add_argument(
+            "--output", "-o",
+            help="Output file for the macro tables (JSON format)"
+        )
+        parser.add_argument(
+            "--verbose", "-v",
+            action="store_true",
+            help="Print header summary cache statistics"
+        )
+        self._add_configuration_arguments(parser)
+
+    def _add_pch_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the pch command."""
+        parser.add_argument(
+            "files",
+            nargs="*",
+            help="Translation units to consider (default: every file in --compile-commands or --build-log)"
+        )
+        parser.add_argument(
+            "--compile-commands",
+            metavar="PATH",
+            help="compile_commands.json (or its directory) supplying per-file -D/-U/-I flags"
+        )
+        parser.add_argument(
+            "--build-log",
+            metavar="PATH",
+            help="Output of `make -n`, `ninja -t commands` or a verbose build supplying per-file -D/-U/-I flags"
+        )
+        parser.add_argument(
+            "--min-share",
+            type=float,
+            default=0.5,
+            help="Fraction of a directory's files that must include a header (default: 0.5)"
+        )
+        parser.add_argument(
+            "--max-headers",
+            type=int,
+            help="Maximum number of headers per suggested PCH"
+        )
+        parser.add_argument(
+            "--output", "-o",
+            help="Output file for the recommendations (JSON format)"
+        )
+        self._add_configuration_arguments(parser)
+
+    def _add_unity_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the unity command."""
+        parser.add_argument(
+            "files",
+            nargs="*",
+            help="Translation units to batch (default: every file in --compile-commands or --build-log)"
+        )
+        parser.add_argument(
+            "--compile-commands",
+            metavar="PATH",
+            help="compile_commands.json (or its directory) supplying per-file -D/-U/-I flags"
+        )
+        parser.add_argument(
+            "--build-log",
+            metavar="PATH",
+            help="Output of `make -n`, `ninja -t commands` or a verbose build supplying per-file -D/-U/-I flags"
+        )
+        parser.add_argument(
+            "--max-batch-bytes",
+            type=int,
+            default=512 * 1024,
+            help="Maximum source bytes per batch (default: 524288)"
+        )
+        parser.add_argument(
+            "--max-files",
+            type=int,
+            help="Maximum number of files per batch"
+        )
+        parser.add_argument(
+            "--output", "-o",
+            help="Output file for the batching plan (JSON format)"
+        )
+        self._add_configuration_arguments(parser)
+
+    def _add_conflicts_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the conflicts command."""
+        parser.add_argument(
+            "files",
+            nargs="*",
+            help="Translation units to check (default: every file in --compile-commands or --build-log)"
+        )
+        parser.add_argument(
+            "--compile-commands",
+            metavar="PATH",
+            help="compile_commands.json (or its directory) supplying per-file -I flags"
+        )
+        parser.add_argument(
+            "--build-log",
+            metavar="PATH",
+            help="Output of `make -n`, `ninja -t commands` or a verbose build supplying per-file -I flags"
+        )
+        parser.add_argument(
+            "--ninja-deps",
+            metavar="PATH",
+            help="Take each unit's headers from ninja's .ninja_deps (or its build directory) where it is up to date"
+        )
+        parser.add_argument(
+            "--output", "-o",
+            help="Output file for the conflicts (JSON format)"
+        )
+        self._add_configuration_arguments(parser)
+
+    def _add_deps_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the deps command."""
+        parser.add_argument(
+            "ninja_deps",
+            metavar="DEPS_LOG",
+            help=".ninja_deps file, or the ninja build directory containing it"
+        )
+        parser.add_argument(
+            "files",
+            nargs="*",
+            help="Translation units to load (default: every file in --compile-commands or --build-log, "
+                 "else every unit in the log)"
+        )
+        parser.add_argument(
+            "--compile-commands",
+            metavar="PATH",
+            help="compile_commands.json (or its directory) supplying per-file -I flags"
+        )
+        parser.add_argument(
+            "--build-log",
+            metavar="PATH",
+            help="Output of `make -n`, `ninja -t commands` or a verbose build supplying per-file -I flags"
+        )
+        parser.add_argument(
+            "--check",
+            action="store_true",
+            help="Compare the recorded headers with those static #include resolution reaches"
+        )
+        parser.add_argument(
+            "--output", "-o",
+            help="Output file for the include graph and discrepancies (JSON format)"
+        )
+        self._add_configuration_arguments(parser)
+
+    def _add_configs_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the configs command."""
+        parser.add_argument(
+            "paths",
+            nargs="+",
+            help="Files or directories whose conditionals span the configuration space"
+        )
+        parser.add_argument(
+            "--limit",
+            type=int,
+            default=100,
+            help="Maximum number of configurations to enumerate (default: 100)"
+        )
+        parser.add_argument(
+            "--sample",
+            type=int,
+            metavar="N",
+            help="Draw N random valid configurations instead of enumerating"
+        )
+        parser.add_argument(
+            "--seed",
+            type=int,
+            help="Random seed for --sample"
+        )
+        parser.add_argument(
+            "--build-log",
+            metavar="PATH",
+            help="Check the configurations a `make -n` / `ninja -t commands` log builds instead of enumerating"
+        )
+        parser.add_argument(
+            "--output", "-o",
+            help="Output file for the constraints and configurations (JSON format)"
+        )
+        self._add_configuration_arguments(parser)
+
+    def _add_cnf_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the cnf command."""
+        parser.add_argument(
+            "paths",
+            nargs="+",
+            help="Files or directories to build the feature model from"
+        )
+        parser.add_argument(
+            "--output", "-o",
+            help="Output file for the DIMACS formula (default: standard output)"
+        )
+        parser.add_argument(
+            "--variable-map",
+            metavar="FILE",
+            help="Also write the variable map (name -> index) as JSON"
+        )
+        self._add_configuration_arguments(parser)
+
+    def _add_values_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the values command."""
+        parser.add_argument(
+            "files",
+            nargs="*",
+            help="Translation units to preprocess (default: every file in --compile-commands or --build-log)"
+        )
+        parser.add_argument(
+            "--compile-commands",
+            metavar="PATH",
+            help="compile_commands.json (or its directory) supplying per-file -D/-U/-I flags"
+        )
+        parser.add_argument(
+            "--build-log",
+            metavar="PATH",
+            help="Output of `make -n`, `ninja -t commands` or a verbose build supplying per-file -D/-U/-I flags"
+        )
+        parser.add_argument(
+            "--config",
+            action="append",
+            default=[],
+            metavar="NAME:FLAGS",
+            help="A configuration column, e.g. 'debug-win: -DDEBUG -DWINDOWS' (can be used multiple times)"
+        )
+        parser.add_argument(
+            "--all",
+            action="store_true",
+            help="Print every macro, not only those whose value differs between columns"
+        )
+        parser.add_argument(
+            "--output", "-o",
+            help="Output file for the value matrices (JSON format)"
+        )
+        self._add_configuration_arguments(parser)
+
+    def _add_cost_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the cost command."""
+        parser.add_argument(
+            "files",
+            nargs="*",
+            help="Translation units to measure (default: every file in --compile-commands or --build-log)"
+        )
+        parser.add_argument(
+            "--compile-commands",
+            metavar="PATH",
+            help="compile_commands.json (or its directory) supplying per-file -D/-U/-I flags"
+        )
+        parser.add_argument(
+            "--build-log",
+            metavar="PATH",
+            help="Output of `make -n`, `ninja -t commands` or a verbose build supplying per-file -D/-U/-I flags"
+        )
+        parser.add_argument(
+            "--config",
+            action="append",
+            default=[],
+            metavar="NAME:FLAGS",
+            help="A configuration column, e.g. 'debug-win: -DDEBUG -DWINDOWS' (can be used multiple times)"
+        )
+        parser.add_argument(
+            "--output", "-o",
+            help="Output file for the cost matrix (JSON format)"
+        )
+        self._add_configuration_arguments(parser)
+
+    def _add_coverage_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the coverage command."""
+        parser.add_argument(
+            "paths",
+            nargs="+",
+            help=".gcov files, or directories searched recursively for them"
+        )
+        parser.add_argument(
+            "--source-root",
+            metavar="DIR",
+            help="Directory the sources named in the .gcov files are relative to "
+                 "(default: each .gcov file's directory)"
+        )
+        parser.add_argument(
+            "--all",
+            action="store_true",
+            help="Print the coverage of every context, not only the unexercised ones"
+        )
+        parser.add_argument(
+            "--output", "-o",
+            help="Output file for the coverage per context (JSON format)"
+        )
+
+    def _add_history_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the history command."""
+        parser.add_argument(
+            "repository",
+            nargs="?",
+            default=".",
+            help="Path inside the git repository (default: current directory)"
+        )
+        parser.add_argument(
+            "--rev",
+            default="HEAD",
+            help="Newest commit to measure (default: HEAD)"
+        )
+        parser.add_argument(
+            "--max-count", "-n",
+            type=int,
+            default=2000,
+            metavar="N",
+            help="Measure the N newest commits (default: 2000)"
+        )
+        parser.add_argument(
+            "--first-parent",
+            action="store_true",
+            help="Follow only the first parent of merges"
+        )
+        parser.add_argument(
+            "--include-headers",
+            action="store_true",
+            help="Include header files (.h, .hpp, .hxx) in the metrics"
+        )
+        parser.add_argument(
+            "--exclude",
+            action="append",
+            help="Patterns of repository paths to exclude (can be used multiple times)"
+        )
+        parser.add_argument(
+            "--format",
+            choices=["table", "csv"],
+            default="table",
+            help="Format of the printed time series (default: table)"
+        )
+        parser.add_argument(
+            "--output", "-o",
+            help="Output file for the time series (JSON format)"
+        )
+
+    def _add_lsp_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add arguments for the lsp command."""
+        self._add_configuration_arguments(parser)
+
+    def _add_configuration_arguments(self, parser: argparse.ArgumentParser) -> None:
+        """Add -D/-U options describing the configuration to evaluate under."""
+        parser.add_argument(
+            "--define", "-D",
+            action="append",
+            default=[],
+            metavar="NAME[=VALUE]",
+            help="Predefine a macro (can be used multiple times)"
+        )
+        parser.add_argument(
+            "--undef", "-U",
+            action="append",
+            default=[],
+            metavar="NAME",
+            help="Undefine a macro (can be used multiple times)"
+        )
+        parser.add_argument(
+            "--include-path", "-I",
+            action="append",
+            default=[],
+            metavar="DIR",
+            help="Add a directory to the include search path (can be used multiple times)"
+        )
+        parser.add_argument(
+            "--config-name",
+            default="default",
+            help="Name of the configuration formed by -D/-U (default: default)"
+        )
+
+    def _configuration_from_args(self, args):
+        """Build a Configuration from -D/-U/-I options."""
+        from .data_models import Configuration
+        configuration = Configuration.from_flags(args.define, args.undef, args.config_name)
+        configuration.include_paths = list(args.include_path)
+        return configuration
 
     def run(self, args: Optional[List[str]] = None) -> int:
         """Run the CLI with the given arguments."""
         try:
+            self.parser = self._create_parser(self._peek_command(args))
             parsed_args = self.parser.parse_args(args)
             
             if not parsed_args.command:
                 self.parser.print_help()
                 return 1
             
-            if parsed_args.command == "analyze":
-                return self._handle_analyze(parsed_args)
-            elif parsed_args.command == "report":
-                return self._handle_report(parsed_args)
-            elif parsed_args.command == "validate":
-                return self._handle_validate(parsed_args)
+            if parsed_args.command in self.COMMANDS:
+                handler = getattr(self, f"_handle_{parsed_args.command.replace('-', '_')}")
+                return handler(parsed_args)
             else:
                 print(f"Unknown command: {parsed_args.command}")
                 return 1
@@ -194,56 +936,125 @@ Examples:
         if args.verbose:
             print(f"Analyzing path: {args.path}")
         
+        reading_stdin = args.path == self.STDIN_PATH
+        
         # Check if path exists
-        if not os.path.exists(args.path):
+        if not reading_stdin and not os.path.exists(args.path):
             print(f"Error: Path '{args.path}' does not exist")
             return 1
+        if args.rev and not os.path.isdir(args.path):
+            print(f"Error: --rev needs a directory inside a git repository, got '{args.path}'")
+            return 1
+        if args.bloom_filters and (not args.output or args.format != "json"):
+            print("Error: --bloom-filters needs JSON results saved with --output, which the filters point into")
+            return 1
         
         try:
-            # Scan for C++ files
-            files = self.file_scanner.scan(
-                path=args.path,
-                recursive=args.recursive,
-                include_headers=args.include_headers,
-                exclude_patterns=args.exclude or []
-            )
+            # Archive members and git blobs are streamed as (name, lines)
+            sources = None
+            files = []
+            buffers = {}
+            if reading_stdin:
+                # Standard input is analyzed as one named in-memory buffer
+                buffers = {args.stdin_name: self._read_stdin()}
+            elif args.rev:
+                from .git_history import iter_tree_sources
+                sources = iter_tree_sources(args.path, args.rev, args.include_headers, args.exclude)
+            else:
+                if os.path.isfile(args.path):
+                    from .archive_reader import is_archive, iter_archive_sources
+                    if is_archive(args.path):
+                        sources = iter_archive_sources(args.path, args.include_headers, args.exclude,
+                                                       self.file_scanner)
+                if sources is None:
+                    # Scan for C++ files
+                    files = self.file_scanner.scan(
+                        path=args.path,
+                        recursive=args.recursive,
+                        include_headers=args.include_headers,
+                        exclude_patterns=args.exclude or []
+                    )
             
-            if not files:
+            if not files and not buffers and sources is None:
                 print("No C++ files found to analyze")
                 return 0
             
-            if args.verbose:
+            if args.verbose and sources is None:
                 print(f"Found {len(files)} files to analyze")
             
             # Perform analysis
+            from .data_models import AnalysisResult
             analysis_result = AnalysisResult()
+            # Files may be analyzed on worker threads; results are merged here in order
+            self.analyzer.options.workers = args.jobs
             
-            for file_path in files:
-                if args.verbose:
-                    print(f"Processing: {file_path}")
-                
+            def analyze(source):
+                # Files on disk come as (path, None), buffers as (name, contents)
+                name, contents = source
                 try:
-                    # Parse directives
-                    file_result = self.preprocessor_parser.parse_file(file_path)
-                    
-                    # Analyze contexts
-                    self.context_analyzer.analyze(file_result)
-                    
-                    # Add to overall results
-                    analysis_result.add_file_result(file_result)
-                    
+                    # Parse directives and analyze contexts
+                    if contents is None:
+                        return name, self.analyzer.analyze_file(name), None
+                    return name, self.analyzer.analyze_buffer(contents, name), None
                 except Exception as e:
-                    print(f"Warning: Failed to process {file_path}: {e}")
+                    return name, None, e
+            
+            from itertools import chain
+            inputs = chain(((file_path, None) for file_path in files), buffers.items(), sources or ())
+            streamed = set()
+            for name, file_result, error in self.analyzer.map(analyze, inputs):
+                if args.verbose:
+                    print(f"Processing: {name}")
+                if error is None:
+                    try:
+                        # Add to overall results
+                        analysis_result.add_file_result(file_result)
+                    except Exception as e:
+                        error = e
+                if error is not None:
+                    print(f"Warning: Failed to process {name}: {error}")
+                elif sources is not None:
+                    streamed.add(name)
+            
+            if sources is not None and not streamed:
+                print("No C++ files found to analyze")
+                return 0
             
             # Output results
             if args.output:
-                self._save_results(analysis_result, args.output, args.format)
+                spans = self._save_results(analysis_result, args.output, args.format)
                 if args.verbose:
                     print(f"Results saved to: {args.output}")
+                if args.bloom_filters:
+                    from .bloom_filter import FileFilterIndex
+                    from .filter_table import write_filter_table
+                    read_text = None
+                    if args.scan_code:
+                        # Streamed sources are not kept: their filters hold directives only
+                        read_text = lambda path: buffers[path] if path in buffers else (
+                            None if path in streamed else self._read_text(path))
+                    index = FileFilterIndex.from_analysis(analysis_result, args.bloom_rate, read_text)
+                    count = write_filter_table(index, spans, args.output, args.bloom_filters)
+                    if args.verbose:
+                        print(f"Bloom filters of {count} file(s) saved to: {args.bloom_filters}")
             else:
                 # Print summary to stdout
                 self._print_analysis_summary(analysis_result)
             
+            if args.search_index:
+                from .search_index import DirectiveSearchIndex
+                from .search_table import write_search_table
+                count = write_search_table(DirectiveSearchIndex.from_analysis(analysis_result), args.search_index)
+                if args.verbose:
+                    print(f"Search table of {count} string(s) saved to: {args.search_index}")
+            
+            if args.symbol_table:
+                from .symbol_index import SymbolIndex
+                from .symbol_table import write_symbol_table
+                count = write_symbol_table(SymbolIndex.from_analysis(analysis_result), args.symbol_table)
+                if args.verbose:
+                    print(f"Symbol table of {count} symbol(s) saved to: {args.symbol_table}")
+            
             return 0
             
         except Exception as e:
@@ -258,6 +1069,7 @@ Examples:
                 print(f"Error: Input file '{args.input}' does not exist")
                 return 1
             
+            import json
             with open(args.input, 'r') as f:
                 data = json.load(f)
             
@@ -284,19 +1096,266 @@ Examples:
             print(f"Report generation failed: {e}")
             return 1
 
+    def _handle_search(self, args) -> int:
+        """Handle the search command."""
+        try:
+            if not os.path.exists(args.input):
+                print(f"Error: Input file '{args.input}' does not exist")
+                return 1
+            
+            from .search_table import SearchTable
+            if args.conditions:
+                kinds = ("condition",)
+            elif args.defines:
+                kinds = ("define",)
+            else:
+                kinds = SearchTable.KINDS
+            try:
+                table = SearchTable(args.input)
+            except ValueError:
+                table = None
+            if table is not None:
+                # Only the posting lists, strings and locations a query touches are read
+                with table:
+                    matches = table.search(args.query, kinds, regex=args.regex,
+                                           ignore_case=args.ignore_case, limit=args.limit)
+            else:
+                # Saved analyses are indexed on the fly
+                import json
+                from .search_index import DirectiveSearchIndex
+                with open(args.input, 'r') as f:
+                    index = DirectiveSearchIndex.from_analysis_dict(json.load(f))
+                matches = index.search(args.query, kinds, regex=args.regex,
+                                       ignore_case=args.ignore_case, limit=args.limit)
+            
+            for match in matches:
+                if match.kind == "define":
+                    print(f"{match.file_path}:{match.line_number}: #define {match.symbol} {match.text}")
+                else:
+                    print(f"{match.file_path}:{match.line_number}: #if {match.text}")
+            print(f"{len(matches)} match(es)")
+            return 0 if matches else 1
+            
+        except Exception as e:
+            print(f"Search failed: {e}")
+            return 1
+
+    def _handle_query(self, args) -> int:
+        """Handle the query command."""
+        try:
+            if not os.path.exists(args.input):
+                print(f"Error: Input file '{args.input}' does not exist")
+                return 1
+            
+            import json
+            from .context_query import parse_query, run_query
+            from .data_models import Directive
+            query = parse_query(args.query)
+            with open(args.input, 'r') as f:
+                data = json.load(f)
+            
+            directives = (Directive.from_dict(d)
+                          for file_data in data.get("file_results", {}).values()
+                          for d in file_data.get("directives", []))
+            result = run_query(query, directives, limit=args.limit)
+            
+            if args.output:
+                with open(args.output, 'w') as f:
+                    json.dump(result.to_dict(), f, indent=2)
+                print(f"Query results saved to: {args.output}")
+            else:
+                for directive in result.matches:
+                    context = f" [{' && '.join(directive.context)}]" if directive.context else ""
+                    print(f"{directive.file_path}:{directive.line_number}: {directive.content}{context}")
+            print(f"{len(result.matches)} match(es) among {result.directives} {query.target}; "
+                  f"{result.contexts} distinct context(s), {result.evaluations} evaluation(s)")
+            if result.undecided:
+                print(f"Warning: {result.undecided} context(s) have too many atoms to decide")
+            return 0 if result.matches else 1
+            
+        except Exception as e:
+            print(f"Query failed: {e}")
+            return 1
+
+    def _handle_lookup(self, args) -> int:
+        """Handle the lookup command."""
+        try:
+            if not os.path.exists(args.table):
+                print(f"Error: Symbol table '{args.table}' does not exist")
+                return 1
+            
+            # Only the probed slots and records are read from the mapped file
+            from .symbol_table import SymbolTable
+            found = 0
+            entries = []
+            with SymbolTable(args.table) as table:
+                for name in args.names:
+                    definitions = table.definitions_of(name)
+                    undefinitions = table.undefinitions_of(name)
+                    found += bool(definitions or undefinitions)
+                    entries.extend(definitions + undefinitions)
+                    if args.json:
+                        continue
+                    if not definitions and not undefinitions:
+                        print(f"{name}: not defined")
+                    for entry in definitions + undefinitions:
+                        directive = f"#undef {name}" if entry.value is None else f"#define {name} {entry.value}".rstrip()
+                        context = f" [{' && '.join(entry.context)}]" if entry.context else ""
+                        print(f"{entry.file_path}:{entry.line_number}: {directive}{context}")
+            
+            if args.json:
+                import json
+                print(json.dumps([entry.to_dict() for entry in entries], indent=2))
+            return 0 if found == len(args.names) else 1
+            
+        except Exception as e:
+            print(f"Lookup failed: {e}")
+            return 1
+
+    def _handle_timeline(self, args) -> int:
+        """Handle the timeline command."""
+        try:
+            if not os.path.exists(args.input):
+                print(f"Error: Input file '{args.input}' does not exist")
+                return 1
+            
+            import json
+            from .macro_timeline import MacroTimeline
+            with open(args.input, 'r') as f:
+                timeline = MacroTimeline.from_analysis_dict(json.load(f))
+            
+            if args.at:
+                file_name, _, line = args.at.rpartition(':')
+                if not file_name or not line.isdigit():
+                    print(f"Error: Expected FILE:LINE, got '{args.at}'")
+                    return 1
+                matches = [path for path in timeline.files
+                           if path == file_name or path.endswith(os.sep + file_name)]
+                if len(matches) != 1:
+                    print(f"Error: '{file_name}' matches {len(matches)} analyzed file(s)")
+                    return 1
+                state = timeline.state_at(args.symbol, matches[0], int(line))
+                if args.json:
+                    print(json.dumps(state.to_dict(), indent=2))
+                    return 0
+                description = {
+                    "defined": f"defined as `{state.value}`",
+                    "undefined": "undefined",
+                    "conditional": "defined or not depending on the configuration",
+                    "unknown": "not defined or undefined earlier in the file",
+                }[state.status]
+                print(f"{args.symbol} at {matches[0]}:{line}: {description}")
+                for event in state.events:
+                    context = f" [{' && '.join(event.context)}]" if event.context else ""
+                    print(f"  line {event.line_number}: #{event.kind}{context}")
+                return 0
+            
+            found = False
+            for file_path in timeline.files:
+                events = timeline.events_of(args.symbol, file_path)
+                found = found or bool(events)
+                if args.json:
+                    continue
+                for event in events:
+                    directive = f"#undef {args.symbol}" if event.kind == "undef" else \
+                        f"#define {args.symbol}{event.parameters or ''} {event.value}".rstrip()
+                    context = f" [{' && '.join(event.context)}]" if event.context else ""
+                    print(f"{file_path}:{event.line_number}: {directive}{context}")
+            if args.json:
+                print(json.dumps(timeline.to_dict().get(args.symbol, {}), indent=2))
+            elif not found:
+                print(f"{args.symbol}: not defined or undefined")
+            return 0 if found else 1
+            
+        except Exception as e:
+            print(f"Timeline failed: {e}")
+            return 1
+
+    def _handle_mentions(self, args) -> int:
+        """Handle the mentions command."""
+        try:
+            if not os.path.exists(args.input):
+                print(f"Error: Input file '{args.input}' does not exist")
+                return 1
+            
+            from .bloom_filter import code_identifiers, directive_identifiers
+            from .filter_table import FilterTable
+            try:
+                table = FilterTable(args.input)
+            except ValueError:
+                table = None
+            
+            def identifiers(file_path, file_data, code_usage):
+                if file_data is None:
+                    return None
+                from .data_models import Directive
+                found = directive_identifiers(
+                    Directive.from_dict(d) for d in file_data.get("directives", []))
+                if code_usage:
+                    text = self._read_text(file_path)
+                    if text is None:
+                        return None
+                    found |= code_identifiers(text)
+                return found
+            
+            if table is not None:
+                # Only filter hits get to load, and each parses just its own
+                # entry of the analysis, found by the byte range in the table
+                with table:
+                    outcome = table.query(
+                        args.symbols,
+                        lambda path: identifiers(path, table.file_data(path), table.code_usage),
+                        any_symbol=args.any)
+            else:
+                # Saved analyses get filters on the fly; everything is loaded already
+                import json
+                from .bloom_filter import FileFilterIndex
+                from .data_models import Directive
+                with open(args.input, 'r') as f:
+                    file_results = json.load(f).get("file_results", {})
+                index = FileFilterIndex(args.false_positive_rate)
+                for file_path, file_data in file_results.items():
+                    index.add_file(file_path, directive_identifiers(
+                        Directive.from_dict(d) for d in file_data.get("directives", [])))
+                outcome = index.query(
+                    args.symbols,
+                    lambda path: identifiers(path, file_results.get(path), False),
+                    any_symbol=args.any)
+            for file_path in outcome.files:
+                print(file_path)
+            symbols = (" or " if args.any else " and ").join(args.symbols)
+            print(f"{len(outcome.files)} file(s) mention {symbols}; "
+                  f"filters passed {outcome.candidates} of {outcome.total_files} file(s), "
+                  f"{outcome.false_positives} false positive(s)")
+            return 0 if outcome.files else 1
+            
+        except Exception as e:
+            print(f"Mention query failed: {e}")
+            return 1
+
     def _handle_validate(self, args) -> int:
         """Handle the validate command."""
+        # Standard input can only be read once
+        if args.files.count(self.STDIN_PATH) > 1:
+            print(f"Error: '{self.STDIN_PATH}' (standard input) may be given only once")
+            return 1
+        
         try:
             errors_found = False
             all_errors = []
             
             for file_path in args.files:
-                if not os.path.exists(file_path):
+                if file_path == self.STDIN_PATH:
+                    file_result = self.preprocessor_parser.parse_buffer(
+                        self._read_stdin(), args.stdin_name
+                    )
+                elif not os.path.exists(file_path):
                     print(f"Warning: File '{file_path}' does not exist")
                     continue
+                else:
+                    file_result = self.preprocessor_parser.parse_file(file_path)
                 
-                # Parse and validate
-                file_result = self.preprocessor_parser.parse_file(file_path)
+                # Validate
                 errors = self.validator.validate(
                     file_result,
                     strict=args.strict,
@@ -312,6 +1371,7 @@ Examples:
             
             # Save validation results if requested
             if args.output:
+                import json
                 validation_data = {
                     "files_validated": len(args.files),
                     "errors_found": len(all_errors),
@@ -326,13 +1386,602 @@ Examples:
             print(f"Validation failed: {e}")
             return 1
 
-    def _save_results(self, result: AnalysisResult, output_path: str, format_type: str) -> None:
-        """Save analysis results to file."""
+    def _handle_macros(self, args) -> int:
+        """Handle the macros command."""
+        try:
+            from .header_summary import HeaderSummaryCache
+            
+            targets = self._translation_units(args)
+            if not targets:
+                print("No files to preprocess")
+                return 1
+            
+            cache = HeaderSummaryCache(parser=self.preprocessor_parser)
+            tables = {}
+            for file_path, file_configuration in targets:
+                tables[file_path] = cache.effective_macros(
+                    os.path.abspath(file_path), file_configuration, args.line
+                )
+            
+            if args.output:
+                import json
+                with open(args.output, 'w') as f:
+                    json.dump({"files": tables, "cache": cache.stats()}, f, indent=2)
+            else:
+                for file_path, macros in tables.items():
+                    if len(tables) > 1:
+                        print(f"// {file_path}")
+                    for name in sorted(macros):
+                        print(f"#define {name} {macros[name]}".rstrip())
+            
+            if args.verbose:
+                stats = cache.stats()
+                print(f"Header summaries: {stats['summaries']} computed, "
+                      f"{stats['hits']} reused across {len(tables)} file(s)", file=sys.stderr)
+            
+            return 0
+            
+        except Exception as e:
+            print(f"Macro computation failed: {e}")
+            return 1
+
+    def _handle_pch(self, args) -> int:
+        """Handle the pch command."""
+        try:
+            from .header_summary import HeaderSummaryCache
+            from .pch_recommender import PchRecommender
+            
+            targets = self._translation_units(args)
+            if not targets:
+                print("No files to analyze")
+                return 1
+            
+            recommender = PchRecommender(HeaderSummaryCache(parser=self.preprocessor_parser))
+            for file_path, configuration in targets:
+                recommender.add_translation_unit(os.path.abspath(file_path), configuration)
+            recommendations = recommender.recommend(args.min_share, args.max_headers)
+            
+            if args.output:
+                import json
+                data = {
+                    "translation_units": len(targets),
+                    "recommendations": [r.to_dict() for r in recommendations],
+                    "ranking": [c.to_dict() for c in recommender.rank()[:50]]
+                }
+                with open(args.output, 'w') as f:
+                    json.dump(data, f, indent=2)
+                print(f"PCH recommendations saved to: {args.output}")
+            elif not recommendations:
+                print("No precompiled header candidates found")
+            else:
+                for recommendation in recommendations:
+                    print(f"{recommendation.directory} ({recommendation.translation_units} files): "
+                          f"~{recommendation.estimated_bytes_saved} bytes saved, "
+                          f"PCH covers {recommendation.pch_bytes} bytes")
+                    for header in recommendation.headers:
+                        print(f"  {header.path}: {header.translation_units} files x "
+                              f"{header.transitive_bytes} bytes")
+            
+            return 0
+            
+        except Exception as e:
+            print(f"PCH recommendation failed: {e}")
+            return 1
+
+    def _handle_unity(self, args) -> int:
+        """Handle the unity command."""
+        try:
+            from .header_summary import HeaderSummaryCache
+            from .unity_planner import UnityPlanner
+            
+            targets = self._translation_units(args)
+            if not targets:
+                print("No files to batch")
+                return 1
+            
+            planner = UnityPlanner(HeaderSummaryCache(parser=self.preprocessor_parser))
+            for file_path, configuration in targets:
+                planner.add_translation_unit(os.path.abspath(file_path), configuration)
+            plan = planner.plan(args.max_batch_bytes, args.max_files)
+            
+            if args.output:
+                import json
+                with open(args.output, 'w') as f:
+                    json.dump(plan.to_dict(), f, indent=2)
+                print(f"Unity plan saved to: {args.output}")
+            
+            print(f"{len(targets)} files in {len(plan.batches)} unity batches")
+            if not args.output:
+                for batch in plan.batches:
+                    print(f"  {batch.name}: {len(batch.files)} files, {batch.bytes} bytes")
+                    for file_path in batch.files:
+                        print(f"    {file_path}")
+            if plan.conflicting_macros:
+                top = sorted(plan.conflicting_macros.items(), key=lambda x: (-x[1], x[0]))[:5]
+                print("Conflicting macros: " + ", ".join(f"{name} ({count} files)" for name, count in top))
+            
+            return 0
+            
+        except Exception as e:
+            print(f"Unity planning failed: {e}")
+            return 1
+
+    def _handle_conflicts(self, args) -> int:
+        """Handle the conflicts command."""
+        try:
+            from .macro_conflicts import MacroConflictDetector
+            
+            targets = self._translation_units(args)
+            if not targets:
+                print("No files to check")
+                return 1
+            
+            deps_log = None
+            if args.ninja_deps:
+                from .ninja_deps import NinjaDepsLog
+                deps_log = NinjaDepsLog.load(args.ninja_deps)
+            detector = MacroConflictDetector.from_translation_units(targets, self.analyzer, deps_log)
+            found = detector.detect(file_path for file_path, _ in targets)
+            
+            if args.output:
+                import json
+                with open(args.output, 'w') as f:
+                    json.dump({path: [c.to_dict() for c in conflicts]
+                               for path, conflicts in found.items()}, f, indent=2)
+                print(f"Conflicts saved to: {args.output}")
+            
+            for file_path, conflicts in found.items():
+                print(f"{file_path}: {len(conflicts)} conflicting macro(s)")
+                if args.output:
+                    continue
+                for conflict in conflicts:
+                    print(f"  {conflict.macro}")
+                    for definition in conflict.definitions:
+                        print(f"    {definition.file_path}:{definition.line_number}: {definition.value}")
+            
+            if found:
+                return 1
+            print(f"No conflicting macros in {len(targets)} translation unit(s)")
+            return 0
+            
+        except Exception as e:
+            print(f"Conflict detection failed: {e}")
+            return 1
+
+    def _handle_deps(self, args) -> int:
+        """Handle the deps command."""
+        try:
+            from .include_graph import IncludeResolver
+            from .ninja_deps import NinjaDepsLog, build_include_graph, cross_check
+            
+            deps_log = NinjaDepsLog.load(args.ninja_deps)
+            entries = deps_log.entries()
+            targets = self._translation_units(args)
+            if not targets and not args.files:
+                configuration = self._configuration_from_args(args)
+                targets = [(source, configuration) for source in entries]
+            
+            resolvers = {}
+            sources = []
+            for file_path, configuration in targets:
+                include_paths = tuple(configuration.include_paths) if configuration else ()
+                if include_paths not in resolvers:
+                    resolvers[include_paths] = IncludeResolver(include_paths)
+                sources.append((os.path.normpath(os.path.abspath(file_path)), resolvers[include_paths]))
+            
+            directives = {}
+            
+            def load(file_path):
+                if file_path not in directives:
+                    directives[file_path] = self.analyzer.analyze_file(file_path).directives
+                return directives[file_path]
+            
+            graph, fallback = build_include_graph(sources, load, deps_log)
+            discrepancies = cross_check(sources, load, deps_log) if args.check else []
+            
+            if args.output:
+                import json
+                with open(args.output, 'w') as f:
+                    json.dump({
+                        "translation_units": {path: graph.files(graph.closure(path)) for path, _ in sources},
+                        "fallback": fallback,
+                        "discrepancies": [d.to_dict() for d in discrepancies]
+                    }, f, indent=2)
+                print(f"Include graph saved to: {args.output}")
+            
+            print(f"{len(entries)} translation unit(s) recorded, "
+                  f"{len(sources) - len(fallback)} of {len(sources)} loaded from the log")
+            if not args.output:
+                for file_path, _ in sources:
+                    headers = bin(graph.closure(file_path)).count("1") - 1
+                    note = " (resolved statically)" if file_path in fallback else ""
+                    print(f"  {file_path}: {headers} header(s){note}")
+            for discrepancy in discrepancies:
+                print(f"{discrepancy.translation_unit}: {len(discrepancy.missing)} recorded header(s) "
+                      f"not resolved, {len(discrepancy.extra)} resolved header(s) not read")
+                for path in discrepancy.missing:
+                    print(f"  - {path}")
+            
+            return 0
+            
+        except Exception as e:
+            print(f"Deps log loading failed: {e}")
+            return 1
+
+    def _handle_configs(self, args) -> int:
+        """Handle the configs command."""
+        try:
+            from .api import AnalysisOptions, Analyzer
+            from .configuration_space import ConfigurationSpace
+            
+            analyzer = Analyzer(AnalysisOptions(include_headers=True))
+            space = ConfigurationSpace.from_file_results(
+                analyzer.iter_file_results(args.paths), self._configuration_from_args(args)
+            )
+            if args.build_log:
+                from .build_log import distinct_configurations, load_build_log
+                configurations = distinct_configurations(load_build_log(args.build_log))
+            elif args.sample is not None:
+                configurations = space.sample(args.sample, seed=args.seed)
+            else:
+                configurations = list(space.enumerate(args.limit))
+            
+            if args.output:
+                import json
+                with open(args.output, 'w') as f:
+                    json.dump({
+                        "symbols": space.symbols,
+                        "constraints": [c.to_dict() for c in space.constraints],
+                        "configurations": [c.to_dict() for c in configurations]
+                    }, f, indent=2)
+                print(f"Configurations saved to: {args.output}")
+            
+            print(f"{len(space.symbols)} feature macros, {len(space.constraints)} #error constraint(s)")
+            for constraint in space.constraints:
+                print(f"  {constraint.file_path}:{constraint.line_number}: never {constraint.condition}")
+            if args.build_log:
+                invalid = 0
+                print(f"{len(configurations)} configuration(s) built")
+                for configuration in configurations:
+                    violations = space.violations(configuration)
+                    invalid += bool(violations)
+                    reached = ", ".join(f"{v.file_path}:{v.line_number}" for v in violations)
+                    flags = " ".join([f"-D{name}" if value == "1" else f"-D{name}={value}"
+                                      for name, value in configuration.defines.items()] +
+                                     [f"-U{name}" for name in configuration.undefs])
+                    print(f"  {configuration.name}: {flags}" + (f" (reaches #error at {reached})" if reached else ""))
+                return 1 if invalid else 0
+            
+            print(f"{len(configurations)} valid configuration(s) listed, "
+                  f"{space.size()} before pruning")
+            if not args.output:
+                for configuration in configurations:
+                    print(f"  {configuration.name}")
+            
+            return 0
+            
+        except Exception as e:
+            print(f"Configuration enumeration failed: {e}")
+            return 1
+
+    def _handle_cnf(self, args) -> int:
+        """Handle the cnf command."""
+        try:
+            from .api import AnalysisOptions, Analyzer
+            from .feature_model import build_feature_model
+            
+            analyzer = Analyzer(AnalysisOptions(include_headers=True))
+            base = self._configuration_from_args(args)
+            formula = build_feature_model(
+                analyzer.iter_file_results(args.paths),
+                base if base.defines or base.undefs else None
+            )
+            
+            if args.variable_map:
+                import json
+                with open(args.variable_map, 'w') as f:
+                    json.dump(formula.variables, f, indent=2)
+            
+            if args.output:
+                with open(args.output, 'w') as f:
+                    f.write(formula.to_dimacs())
+                print(f"{formula.variable_count} variables ({len(formula.variables)} named), "
+                      f"{len(formula.clauses)} clauses written to: {args.output}")
+            else:
+                sys.stdout.write(formula.to_dimacs())
+            
+            return 0
+            
+        except Exception as e:
+            print(f"CNF export failed: {e}")
+            return 1
+
+    def _handle_values(self, args) -> int:
+        """Handle the values command."""
+        try:
+            from .header_summary import HeaderSummaryCache
+            from .macro_values import MacroValueFolder
+            
+            targets = self._translation_units(args)
+            if not targets:
+                print("No files to preprocess")
+                return 1
+            
+            columns = self._configuration_columns(args)
+            folder = MacroValueFolder(HeaderSummaryCache(parser=self.preprocessor_parser))
+            matrices = []
+            for file_path, configuration in targets:
+                configurations = self._column_configurations(configuration, columns)
+                matrices.append(folder.matrix(os.path.abspath(file_path), configurations))
+            
+            if args.output:
+                import json
+                with open(args.output, 'w') as f:
+                    json.dump([m.to_dict() for m in matrices], f, indent=2)
+                print(f"Value matrices saved to: {args.output}")
+                return 0
+            
+            for matrix in matrices:
+                rows = matrix.rows if args.all or len(matrix.configurations) == 1 else matrix.differing()
+                print(f"// {matrix.file_path}: {len(rows)} of {len(matrix.rows)} macros")
+                table = [["MACRO"] + matrix.configurations]
+                for name, values in rows.items():
+                    table.append([name] + ["-" if v is None else str(v) for v in values])
+                widths = [max(len(row[i]) for row in table) for i in range(len(table[0]))]
+                for row in table:
+                    print("  ".join(cell.ljust(width) for cell, width in zip(row, widths)).rstrip())
+            
+            return 0
+            
+        except Exception as e:
+            print(f"Value folding failed: {e}")
+            return 1
+
+    def _handle_cost(self, args) -> int:
+        """Handle the cost command."""
+        try:
+            from .compile_cost import CompileCostEstimator
+            from .header_summary import HeaderSummaryCache
+            
+            targets = self._translation_units(args)
+            if not targets:
+                print("No files to measure")
+                return 1
+            
+            columns = self._configuration_columns(args)
+            estimator = CompileCostEstimator(HeaderSummaryCache(parser=self.preprocessor_parser))
+            matrix = estimator.matrix(
+                (os.path.abspath(file_path), self._column_configurations(configuration, columns))
+                for file_path, configuration in targets
+            )
+            
+            if args.output:
+                import json
+                with open(args.output, 'w') as f:
+                    json.dump(matrix.to_dict(), f, indent=2)
+                print(f"Cost matrix saved to: {args.output}")
+                return 0
+            
+            header = ["TRANSLATION UNIT"]
+            for name in matrix.configurations:
+                header.extend([f"{name} lines", f"{name} bytes"])
+            table = [header]
+            for file_path, costs in list(matrix.rows.items()) + [("TOTAL", matrix.totals())]:
+                row = [file_path]
+                for cost in costs:
+                    row.extend([f"{cost.active_lines}/{cost.lines}", f"{cost.active_bytes}/{cost.bytes}"])
+                table.append(row)
+            widths = [max(len(row[i]) for row in table) for i in range(len(header))]
+            for row in table:
+                print("  ".join(cell.ljust(width) for cell, width in zip(row, widths)).rstrip())
+            
+            return 0
+            
+        except Exception as e:
+            print(f"Cost estimation failed: {e}")
+            return 1
+
+    def _handle_coverage(self, args) -> int:
+        """Handle the coverage command."""
+        try:
+            from .coverage_mapper import CoverageMapper
+            
+            gcov_files = []
+            for path in args.paths:
+                if os.path.isdir(path):
+                    for directory, _, names in os.walk(path):
+                        gcov_files.extend(os.path.join(directory, n) for n in sorted(names) if n.endswith(".gcov"))
+                elif os.path.isfile(path):
+                    gcov_files.append(path)
+                else:
+                    print(f"Warning: Path '{path}' does not exist")
+            if not gcov_files:
+                print("No .gcov files found")
+                return 1
+            
+            mapper = CoverageMapper(self.analyzer, args.source_root)
+            for gcov_file in gcov_files:
+                mapper.add_gcov_file(gcov_file)
+            report = mapper.report()
+            
+            if args.output:
+                import json
+                with open(args.output, 'w') as f:
+                    json.dump(report.to_dict(), f, indent=2)
+                print(f"Coverage saved to: {args.output}")
+            
+            unexercised = report.unexercised()
+            print(f"{len(gcov_files)} .gcov file(s), {len(report.source_files)} source file(s), "
+                  f"{len(report.contexts)} context(s)")
+            for file_path in report.missing_files:
+                print(f"Warning: Source '{file_path}' not found")
+            if args.all:
+                for coverage in sorted(report.contexts.values(), key=lambda c: c.context):
+                    print(f"  {coverage.context or 'global'}: "
+                          f"{coverage.covered_lines}/{coverage.executable_lines} line(s) covered")
+            print(f"{len(unexercised)} context(s) never exercised")
+            for coverage in unexercised:
+                file_path, line_number = coverage.locations[0]
+                print(f"  {coverage.context}: {coverage.executable_lines} line(s) in "
+                      f"{len(coverage.locations)} file(s), first at {file_path}:{line_number}")
+            
+            return 0
+            
+        except Exception as e:
+            print(f"Coverage mapping failed: {e}")
+            return 1
+
+    def _translation_units(self, args):
+        """
+        Collect (file, configuration) pairs from positional files, --compile-commands
+        and --build-log.
+        
+        Each file runs under its compile command's flags, with -D/-U/-I from
+        the command line applied on top.
+        """
+        configuration = self._configuration_from_args(args)
+        commands = []
+        if args.compile_commands:
+            from .compilation_database import load_compile_commands
+            commands = load_compile_commands(args.compile_commands)
+        if args.build_log:
+            from .build_log import load_build_log
+            commands += load_build_log(args.build_log)
+        
+        targets = []
+        by_file = {command.file: command.configuration for command in commands}
+        for file_path in args.files or list(by_file):
+            absolute = os.path.normpath(os.path.abspath(file_path))
+            if not os.path.isfile(absolute):
+                print(f"Warning: File '{file_path}' does not exist")
+                continue
+            targets.append((file_path, self._merge_configurations(by_file.get(absolute), configuration)))
+        return targets
+
+    def _merge_configurations(self, base, overrides):
+        """Apply command-line -D/-U/-I on top of a file's own configuration."""
+        if base is None:
+            return overrides
+        from .data_models import Configuration
+        defines = dict(base.defines)
+        undefs = [name for name in base.undefs if name not in overrides.defines]
+        for name in overrides.undefs:
+            defines.pop(name, None)
+        defines.update(overrides.defines)
+        return Configuration(
+            name=base.name,
+            defines=defines,
+            undefs=undefs + list(overrides.undefs),
+            include_paths=list(base.include_paths) + list(overrides.include_paths)
+        )
+
+    def _configuration_columns(self, args):
+        """Parse each --config 'NAME: FLAGS' into a named configuration."""
+        import shlex
+        from .compilation_database import configuration_from_arguments
+        columns = []
+        for spec in args.config:
+            name, _, flags = spec.partition(':')
+            columns.append(configuration_from_arguments(shlex.split(flags), os.getcwd(), name.strip()))
+        return columns
+
+    def _column_configurations(self, configuration, columns):
+        """Apply each column on top of a file's configuration, or keep it alone without columns."""
+        configurations = []
+        for column in columns:
+            merged = self._merge_configurations(configuration, column)
+            merged.name = column.name
+            configurations.append(merged)
+        return configurations or [configuration]
+
+    def _handle_history(self, args) -> int:
+        """Handle the history command."""
+        try:
+            from .git_history import HistoryMiner
+            from .api import AnalysisOptions, Analyzer
+            
+            analyzer = Analyzer(AnalysisOptions(validate=True))
+            with HistoryMiner(args.repository, analyzer, include_headers=args.include_headers,
+                              exclude_patterns=args.exclude) as miner:
+                points = miner.mine(args.rev, args.max_count, args.first_parent)
+            
+            if args.output:
+                import json
+                with open(args.output, 'w') as f:
+                    json.dump([point.to_dict() for point in points], f, indent=2)
+                print(f"Time series saved to: {args.output}")
+            else:
+                columns = ["commit", "timestamp", "files", "directives", "conditionals",
+                           "flags", "max_depth", "errors", "parsed_files"]
+                rows = []
+                for point in points:
+                    values = point.to_dict()
+                    values["commit"] = values["commit"] if args.format == "csv" else values["commit"][:12]
+                    rows.append([str(values[column]) for column in columns])
+                if args.format == "csv":
+                    import csv
+                    writer = csv.writer(sys.stdout, lineterminator="\n")
+                    writer.writerow(columns)
+                    writer.writerows(rows)
+                else:
+                    table = [[column.upper() for column in columns]] + rows
+                    widths = [max(len(row[i]) for row in table) for i in range(len(columns))]
+                    for row in table:
+                        print("  ".join(cell.ljust(width) for cell, width in zip(row, widths)).rstrip())
+            print(f"{len(points)} commit(s) measured; {miner.parsed_blobs} blob(s) parsed, "
+                  f"{miner.cached_trees} unchanged tree(s) reused", file=sys.stderr if args.format == "csv" else sys.stdout)
+            return 0
+            
+        except Exception as e:
+            print(f"History failed: {e}")
+            return 1
+
+    def _handle_lsp(self, args) -> int:
+        """Handle the lsp command."""
+        from .lsp_server import LanguageServer
+        server = LanguageServer(self._configuration_from_args(args))
+        return server.serve()
+
+    def _read_text(self, path: str):
+        """Read a source file like parse_file, or None if it cannot be read."""
+        try:
+            with open(path, 'r', encoding='utf-8', errors='ignore') as f:
+                return f.read()
+        except OSError:
+            return None
+
+    def _read_stdin(self) -> str:
+        """Read standard input as text, tolerating undecodable bytes like parse_file."""
+        return sys.stdin.buffer.read().decode('utf-8', errors='ignore')
+
+    def _save_results(self, result: 'AnalysisResult', output_path: str,
+                      format_type: str) -> dict:
+        """
+        Save analysis results to file.
+        
+        Returns:
+            Byte offset and length of each file's entry in "file_results",
+            so a single file's results can be read without the rest
+        """
         data = result.to_dict()
         
         if format_type == "json":
-            with open(output_path, 'w') as f:
-                json.dump(data, f, indent=2)
+            import json
+            # Written piece by piece to record the spans; the text is the
+            # same as json.dump(data, f, indent=2), and ASCII-only
+            spans = {}
+            file_results = data.pop("file_results")
+            with open(output_path, 'wb') as f:
+                f.write(b'{\n  "file_results": {')
+                for number, (file_path, file_data) in enumerate(file_results.items()):
+                    f.write(f'{"," if number else ""}\n    {json.dumps(file_path)}: '.encode('ascii'))
+                    entry = json.dumps(file_data, indent=2).replace("\n", "\n    ").encode('ascii')
+                    spans[file_path] = (f.tell(), len(entry))
+                    f.write(entry)
+                f.write(b'\n  }' if file_results else b'}')
+                rest = json.dumps(data, indent=2)
+                f.write((",\n" + rest[2:] if data else "\n}").encode('ascii'))
+            return spans
         elif format_type == "xml":
             # TODO: Implement XML output
             raise NotImplementedError("XML output not yet implemented")
@@ -342,7 +1991,7 @@ Examples:
         else:
             raise ValueError(f"Unsupported format: {format_type}")
 
-    def _print_analysis_summary(self, result: AnalysisResult) -> None:
+    def _print_analysis_summary(self, result: 'AnalysisResult') -> None:
         """Print a summary of analysis results to stdout."""
         print("\n=== Analysis Summary ===")
         print(f"Files processed: {result.total_files}")
@@ -360,6 +2009,12 @@ Examples:
             for condition, count in sorted_conditions[:5]:
                 print(f"  {condition}: {count} times")
         
+        if result.atoms_usage:
+            print("\nMost used condition atoms:")
+            sorted_atoms = sorted(result.atoms_usage.items(), key=lambda x: x[1], reverse=True)
+            for atom, count in sorted_atoms[:5]:
+                print(f"  {atom}: {count} conditions")
+        
         if result.validation_errors:
             print("\nValidation errors:")
             for error in result.validation_errors[:5]:  # Show first 5 errors
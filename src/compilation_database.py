@@ -0,0 +1,133 @@
+"""
+Compilation database module for reading per-file build configurations.
+Loads compile_commands.json and turns each entry's -D/-U/-I flags into a
+Configuration, so configuration-aware analyses see what is actually built.
+"""
+
+import json
+import os
+import shlex
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional
+
+from .data_models import Configuration
+
+
+# Include search options whose directory is searched like -I
+INCLUDE_PATH_FLAGS = ("-I", "-isystem", "-iquote", "-idirafter")
+
+
+@dataclass
+class CompileCommand:
+    """
+    One translation unit and the configuration it is compiled with.
+
+    Attributes:
+        file: Absolute path of the source file
+        directory: Working directory of the compile command
+        configuration: Macros and include paths taken from the command line
+    """
+    file: str
+    directory: str
+    configuration: Configuration = field(default_factory=Configuration)
+
+
+def configuration_from_arguments(arguments: List[str],
+                                 directory: str = "",
+                                 name: str = "default") -> Configuration:
+    """
+    Extract -D/-U/-I flags from a compiler argument list.
+
+    Both "-DNAME" and "-D NAME" forms are accepted. Later flags for the
+    same macro win, matching compiler behavior. Relative include paths are
+    resolved against directory.
+
+    Args:
+        arguments: Compiler arguments, including the compiler itself
+        directory: Working directory the arguments are relative to
+        name: Name for the resulting configuration
+
+    Returns:
+        Configuration with the command's defines, undefs and include paths
+    """
+    defines: Dict[str, str] = {}
+    undefs: List[str] = []
+    include_paths: List[str] = []
+
+    index = 0
+    while index < len(arguments):
+        argument = arguments[index]
+        index += 1
+
+        flag, value = _split_flag(argument, ("-D", "-U") + INCLUDE_PATH_FLAGS)
+        if flag is None:
+            continue
+        if not value and index < len(arguments):
+            value = arguments[index]
+            index += 1
+
+        if flag == "-D":
+            symbol, has_value, replacement = value.partition('=')
+            defines[symbol] = replacement if has_value else "1"
+            if symbol in undefs:
+                undefs.remove(symbol)
+        elif flag == "-U":
+            defines.pop(value, None)
+            undefs.append(value)
+        else:
+            include_paths.append(os.path.normpath(os.path.join(directory, value)))
+
+    return Configuration(name=name, defines=defines, undefs=undefs, include_paths=include_paths)
+
+
+def _split_flag(argument: str, flags) -> tuple:
+    """Split an argument into (flag, attached value), or (None, None)."""
+    for flag in flags:
+        if argument.startswith(flag):
+            return flag, argument[len(flag):]
+    return None, None
+
+
+def load_compile_commands(path: str) -> List[CompileCommand]:
+    """
+    Load a compile_commands.json compilation database.
+
+    Args:
+        path: Path to compile_commands.json, or the directory containing it
+
+    Returns:
+        One CompileCommand per entry, in file order
+
+    Raises:
+        ValueError: If the database is not a JSON list of entries
+    """
+    if os.path.isdir(path):
+        path = os.path.join(path, "compile_commands.json")
+
+    with open(path, 'r', encoding='utf-8') as f:
+        entries = json.load(f)
+    if not isinstance(entries, list):
+        raise ValueError(f"Compilation database '{path}' must contain a list of entries")
+
+    commands = []
+    for entry in entries:
+        directory = entry.get("directory", os.path.dirname(os.path.abspath(path)))
+        arguments = entry.get("arguments")
+        if arguments is None:
+            arguments = shlex.split(entry.get("command", ""))
+        file_path = os.path.normpath(os.path.join(directory, entry["file"]))
+        commands.append(CompileCommand(
+            file=file_path,
+            directory=directory,
+            configuration=configuration_from_arguments(arguments, directory, name=file_path)
+        ))
+    return commands
+
+
+def find_command(commands: List[CompileCommand], file_path: str) -> Optional[CompileCommand]:
+    """Return the command compiling file_path, if any."""
+    target = os.path.normpath(os.path.abspath(file_path))
+    for command in commands:
+        if command.file == target:
+            return command
+    return None
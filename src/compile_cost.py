@@ -0,0 +1,201 @@
+"""
+Compile cost module.
+Estimates how much code each configuration compiles: active physical lines
+and bytes per file, from the skipped ranges of its conditional blocks, summed
+over everything a translation unit includes. Line byte offsets are read once
+per file, so a configuration costs one pass over its skipped ranges and each
+header summary shared between translation units or configurations is
+totalled once.
+"""
+
+from dataclasses import dataclass, field
+from typing import Any, Dict, Iterable, List, Optional, Set, Tuple
+
+from .data_models import Configuration
+from .header_summary import HeaderSummary, HeaderSummaryCache
+
+
+@dataclass
+class CompileCost:
+    """
+    Size of one translation unit under one configuration.
+
+    Attributes:
+        translation_unit: Source file
+        configuration: Configuration name
+        files: Number of files entered; unguarded headers count each time they are entered
+        lines: Physical lines of every file entered
+        bytes: Bytes of every file entered
+        active_lines: Lines outside skipped conditional blocks
+        active_bytes: Bytes of the active lines, a proxy for preprocessed size
+    """
+    translation_unit: str
+    configuration: str
+    files: int = 0
+    lines: int = 0
+    bytes: int = 0
+    active_lines: int = 0
+    active_bytes: int = 0
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert cost to dictionary for serialization."""
+        return {
+            "translation_unit": self.translation_unit,
+            "configuration": self.configuration,
+            "files": self.files,
+            "lines": self.lines,
+            "bytes": self.bytes,
+            "active_lines": self.active_lines,
+            "active_bytes": self.active_bytes
+        }
+
+
+@dataclass
+class CompileCostMatrix:
+    """
+    Compile costs of translation units across configurations.
+
+    Attributes:
+        configurations: Configuration names, one per column
+        rows: Translation unit mapped to its cost in each configuration
+    """
+    configurations: List[str] = field(default_factory=list)
+    rows: Dict[str, List[CompileCost]] = field(default_factory=dict)
+
+    def totals(self) -> List[CompileCost]:
+        """Cost of the whole build in each configuration."""
+        totals = [CompileCost(translation_unit="*", configuration=name) for name in self.configurations]
+        for costs in self.rows.values():
+            for total, cost in zip(totals, costs):
+                total.files += cost.files
+                total.lines += cost.lines
+                total.bytes += cost.bytes
+                total.active_lines += cost.active_lines
+                total.active_bytes += cost.active_bytes
+        return totals
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert matrix to dictionary for serialization."""
+        return {
+            "configurations": list(self.configurations),
+            "rows": {path: [c.to_dict() for c in costs] for path, costs in self.rows.items()},
+            "totals": [c.to_dict() for c in self.totals()]
+        }
+
+
+class CompileCostEstimator:
+    """
+    Computes active lines and bytes through a shared HeaderSummaryCache.
+
+    Each summary records the skipped ranges of its file under the inputs it
+    was computed for, and which headers it entered; the cost of each
+    summary's own file is memoized by summary.
+    """
+
+    def __init__(self, cache: Optional[HeaderSummaryCache] = None):
+        self.cache = cache or HeaderSummaryCache()
+        self._offsets: Dict[str, List[int]] = {}
+        self._costs: Dict[int, Tuple[int, int, int, int]] = {}
+
+    def line_offsets(self, file_path: str) -> List[int]:
+        """
+        Byte offset of the start of every line, plus the file size.
+
+        Entry i is where line i + 1 starts, so the bytes of lines a..b
+        (1-based, inclusive) are offsets[b] - offsets[a - 1].
+        """
+        offsets = self._offsets.get(file_path)
+        if offsets is None:
+            offsets = [0]
+            try:
+                with open(file_path, 'rb') as f:
+                    for line in f:
+                        offsets.append(offsets[-1] + len(line))
+            except OSError:
+                pass
+            self._offsets[file_path] = offsets
+        return offsets
+
+    def file_cost(self, summary: HeaderSummary) -> Tuple[int, int, int, int]:
+        """
+        Size of the file a summary describes, not counting its includes.
+
+        Returns:
+            (lines, bytes, active lines, active bytes)
+        """
+        offsets = self.line_offsets(summary.path)
+        line_count = len(offsets) - 1
+        inactive_lines = 0
+        inactive_bytes = 0
+        for start, end in summary.inactive_ranges:
+            end = min(end, line_count)
+            if end < start:
+                continue
+            inactive_lines += end - start + 1
+            inactive_bytes += offsets[end] - offsets[start - 1]
+        return line_count, offsets[-1], line_count - inactive_lines, offsets[-1] - inactive_bytes
+
+    def estimate(self, file_path: str, configuration: Optional[Configuration] = None) -> CompileCost:
+        """
+        Estimate the size of a translation unit under a configuration.
+
+        Args:
+            file_path: Translation unit
+            configuration: Predefined macros and include paths
+
+        Returns:
+            CompileCost summed over the unit and every header it enters
+        """
+        configuration = configuration or Configuration()
+        summary = self.cache.summarize_translation_unit(file_path, configuration)
+        files, lines, size, active_lines, active_bytes = self._total(summary)
+        return CompileCost(
+            translation_unit=file_path,
+            configuration=configuration.name,
+            files=files,
+            lines=lines,
+            bytes=size,
+            active_lines=active_lines,
+            active_bytes=active_bytes
+        )
+
+    def matrix(self, translation_units: Iterable[Tuple[str, List[Configuration]]]) -> CompileCostMatrix:
+        """
+        Estimate every translation unit under each of its configurations.
+
+        Args:
+            translation_units: (file, configurations) pairs; every unit must
+                list the same number of configurations, named alike
+
+        Returns:
+            CompileCostMatrix with one row per translation unit
+        """
+        result = CompileCostMatrix()
+        for file_path, configurations in translation_units:
+            if not result.configurations:
+                result.configurations = [c.name for c in configurations]
+            result.rows[file_path] = [self.estimate(file_path, c) for c in configurations]
+        return result
+
+    def _total(self, root: HeaderSummary) -> Tuple[int, int, int, int, int]:
+        """(files, lines, bytes, active lines, active bytes) of a summary tree."""
+        totals = [0, 0, 0, 0, 0]
+        entered: Set[str] = set()
+        # Pre-order without recursion, since include chains can be deep. A
+        # summary may list a guarded header its includer already entered,
+        # where the compiler skips it, so those count once per unit.
+        stack = [root]
+        while stack:
+            summary = stack.pop()
+            if summary.guard is not None:
+                if summary.path in entered:
+                    continue
+                entered.add(summary.path)
+            cost = self._costs.get(id(summary))
+            if cost is None:
+                cost = self._costs[id(summary)] = self.file_cost(summary)
+            totals[0] += 1
+            for index, value in enumerate(cost):
+                totals[index + 1] += value
+            stack.extend(reversed(summary.children))
+        return tuple(totals)
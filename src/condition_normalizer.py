@@ -0,0 +1,136 @@
+"""
+Condition normalizer module.
+Rewrites the condition of a conditional directive into a canonical text, so
+that spellings of the same test count as one: `#ifdef X`, `#if defined X`
+and `#if defined( X )` all become `defined(X)`. Canonical forms and atoms
+are cached by raw text.
+"""
+
+from functools import lru_cache
+from typing import List, Optional, Tuple
+
+from .condition_parser import (
+    Binary, Conditional, ConditionSyntaxError, Unary, format_condition, parse_condition
+)
+from .data_models import Directive, DirectiveType
+
+
+# Operators whose operands can be reordered and regrouped freely
+COMMUTATIVE_CHAINS = {'&&', '||', '&', '|', '^', '+', '*'}
+# Chains where a repeated operand changes nothing
+IDEMPOTENT = {'&&', '||', '&', '|'}
+# Two-operand operators whose operands can be swapped
+SYMMETRIC = {'==', '!='}
+# Logical structure that atoms are taken apart from
+LOGICAL = {'&&', '||'}
+
+
+def directive_condition(directive: Directive) -> Optional[str]:
+    """
+    Get the canonical condition of a conditional directive.
+
+    Returns:
+        Canonical #if expression for #if, #ifdef, #ifndef and #elif, or
+        None for other directives
+    """
+    if directive.type == DirectiveType.IFDEF:
+        return normalize_condition(f"defined({directive.symbol_name})")
+    if directive.type == DirectiveType.IFNDEF:
+        return normalize_condition(f"!defined({directive.symbol_name})")
+    if directive.type in (DirectiveType.IF, DirectiveType.ELIF) and directive.condition:
+        return normalize_condition(directive.condition)
+    return None
+
+
+def normalize_condition(text: str) -> str:
+    """
+    Canonicalize an #if expression.
+
+    Whitespace, comments and redundant parentheses are dropped, both
+    `defined` forms become `defined(NAME)`, operands of commutative
+    operators are sorted (and repeats of idempotent ones removed).
+    Conditions that cannot be parsed only have their whitespace collapsed.
+    """
+    return _normalize(text)[0]
+
+
+def condition_atoms(text: str) -> Tuple[str, ...]:
+    """
+    Get the distinct atoms of an #if expression, canonicalized and sorted.
+
+    Atoms are what the logical operators `&&`, `||` and `!` combine:
+    `defined(X)` tests, bare macros, comparisons and other arithmetic.
+    """
+    return _normalize(text)[1]
+
+
+@lru_cache(maxsize=65536)
+def _normalize(text: str) -> Tuple[str, Tuple[str, ...]]:
+    try:
+        tree = canonical_tree(parse_condition(text))
+    except ConditionSyntaxError:
+        collapsed = " ".join(text.split())
+        return collapsed, (collapsed,)
+    return format_condition(tree), tuple(sorted(set(_atoms(tree))))
+
+
+def canonical_tree(node):
+    """Rewrite an expression tree into its canonical shape."""
+    if isinstance(node, Unary):
+        return Unary(node.op, canonical_tree(node.operand))
+    if isinstance(node, Conditional):
+        return Conditional(canonical_tree(node.cond), canonical_tree(node.then), canonical_tree(node.otherwise))
+    if not isinstance(node, Binary):
+        return node
+
+    if node.op in COMMUTATIVE_CHAINS:
+        keyed = {} if node.op in IDEMPOTENT else None
+        operands = []
+        for operand in _chain(node):
+            operand = canonical_tree(operand)
+            key = format_condition(operand)
+            if keyed is not None:
+                if key in keyed:
+                    continue
+                keyed[key] = operand
+            operands.append((key, operand))
+        operands.sort(key=lambda item: item[0])
+        result = operands[0][1]
+        for _, operand in operands[1:]:
+            result = Binary(node.op, result, operand)
+        return result
+
+    left = canonical_tree(node.left)
+    right = canonical_tree(node.right)
+    if node.op in SYMMETRIC and format_condition(right) < format_condition(left):
+        left, right = right, left
+    return Binary(node.op, left, right)
+
+
+def _chain(node: Binary) -> List[object]:
+    """Operands of a tree of the same operator, in order, without recursing."""
+    operands = []
+    stack = [node]
+    while stack:
+        current = stack.pop()
+        if isinstance(current, Binary) and current.op == node.op:
+            stack.append(current.right)
+            stack.append(current.left)
+        else:
+            operands.append(current)
+    return operands
+
+
+def _atoms(node) -> List[str]:
+    atoms = []
+    stack = [node]
+    while stack:
+        current = stack.pop()
+        if isinstance(current, Binary) and current.op in LOGICAL:
+            stack.append(current.right)
+            stack.append(current.left)
+        elif isinstance(current, Unary) and current.op == '!':
+            stack.append(current.operand)
+        else:
+            atoms.append(format_condition(current))
+    return atoms
@@ -0,0 +1,453 @@
+"""
+Condition parser module for #if/#elif expressions.
+Tokenizes and parses preprocessor conditions into an expression tree and
+evaluates them against a set of macro definitions.
+"""
+
+import re
+from dataclasses import dataclass
+from functools import lru_cache
+from typing import Mapping, Optional, Set, Tuple
+
+
+class ConditionSyntaxError(ValueError):
+    """Raised when a condition expression cannot be parsed."""
+
+
+@dataclass(frozen=True)
+class Number:
+    """Integer literal."""
+    value: int
+
+
+@dataclass(frozen=True)
+class Identifier:
+    """Macro name used as a value."""
+    name: str
+
+
+@dataclass(frozen=True)
+class Defined:
+    """defined(NAME) / defined NAME test."""
+    name: str
+
+
+@dataclass(frozen=True)
+class Call:
+    """Function-like macro invocation such as __has_include(<x>)."""
+    name: str
+    args: Tuple[str, ...] = ()
+
+
+@dataclass(frozen=True)
+class Unary:
+    """Unary operator application (!, ~, -, +)."""
+    op: str
+    operand: object
+
+
+@dataclass(frozen=True)
+class Binary:
+    """Binary operator application."""
+    op: str
+    left: object
+    right: object
+
+
+@dataclass(frozen=True)
+class Conditional:
+    """Ternary cond ? then : otherwise."""
+    cond: object
+    then: object
+    otherwise: object
+
+
+# Binary operator precedence, higher binds tighter
+BINARY_PRECEDENCE = {
+    '||': 1,
+    '&&': 2,
+    '|': 3,
+    '^': 4,
+    '&': 5,
+    '==': 6, '!=': 6,
+    '<': 7, '<=': 7, '>': 7, '>=': 7,
+    '<<': 8, '>>': 8,
+    '+': 9, '-': 9,
+    '*': 10, '/': 10, '%': 10,
+}
+
+TOKEN_PATTERN = re.compile(r'''
+    (?P<space>\s+|/\*.*?\*/|//.*$)
+  | (?P<number>0[xX][0-9A-Fa-f]+|0[bB][01]+|\d+)(?:[uUlL]*)
+  | (?P<char>'(?:\\.|[^\\'])+')
+  | (?P<ident>[A-Za-z_][A-Za-z0-9_]*)
+  | (?P<op>&&|\|\||<<|>>|<=|>=|==|!=|[!~+\-*/%<>&^|?:(),])
+''', re.VERBOSE)
+
+CHAR_ESCAPES = {'n': 10, 't': 9, 'r': 13, '0': 0, '\\': 92, "'": 39, '"': 34, 'a': 7, 'b': 8, 'f': 12, 'v': 11}
+
+# Maximum nesting of macro expansion while evaluating
+MAX_EXPANSION_DEPTH = 64
+
+
+def tokenize(text: str):
+    """
+    Split a condition into (kind, value) tokens.
+
+    Raises:
+        ConditionSyntaxError: On characters that cannot start a token and
+            malformed integer literals
+    """
+    tokens = []
+    position = 0
+    while position < len(text):
+        match = TOKEN_PATTERN.match(text, position)
+        if not match:
+            raise ConditionSyntaxError(f"Unexpected character {text[position]!r} in condition")
+        position = match.end()
+        kind = match.lastgroup
+        if kind == 'space':
+            continue
+        if kind == 'number':
+            tokens.append(('number', _parse_int(match.group('number'))))
+        elif kind == 'char':
+            tokens.append(('number', _parse_char(match.group('char'))))
+        else:
+            tokens.append((kind, match.group(kind)))
+    return tokens
+
+
+def _parse_int(text: str) -> int:
+    """
+    Parse a C integer literal without suffix.
+
+    Raises:
+        ConditionSyntaxError: On digits invalid for the literal's base, e.g. 08
+    """
+    try:
+        if text[:2] in ('0x', '0X'):
+            return int(text[2:], 16)
+        if text[:2] in ('0b', '0B'):
+            return int(text[2:], 2)
+        if len(text) > 1 and text.startswith('0'):
+            return int(text, 8)
+        return int(text)
+    except ValueError:
+        raise ConditionSyntaxError(f"Invalid integer literal {text!r} in condition") from None
+
+
+def _parse_char(text: str) -> int:
+    """Parse a simple character literal to its code."""
+    body = text[1:-1]
+    if body.startswith('\\'):
+        return CHAR_ESCAPES.get(body[1:2], ord(body[1:2]))
+    return ord(body[0])
+
+
+class _Parser:
+    """Recursive descent parser over a token list."""
+
+    def __init__(self, tokens):
+        self.tokens = tokens
+        self.position = 0
+
+    def peek(self):
+        if self.position < len(self.tokens):
+            return self.tokens[self.position]
+        return (None, None)
+
+    def advance(self):
+        token = self.peek()
+        self.position += 1
+        return token
+
+    def expect(self, value: str) -> None:
+        kind, token = self.advance()
+        if token != value:
+            raise ConditionSyntaxError(f"Expected '{value}' but found {token!r}")
+
+    def parse(self):
+        if not self.tokens:
+            raise ConditionSyntaxError("Empty condition expression")
+        node = self.parse_conditional()
+        if self.position != len(self.tokens):
+            raise ConditionSyntaxError(f"Unexpected token {self.peek()[1]!r}")
+        return node
+
+    def parse_conditional(self):
+        node = self.parse_binary(1)
+        if self.peek() == ('op', '?'):
+            self.advance()
+            then = self.parse_conditional()
+            self.expect(':')
+            otherwise = self.parse_conditional()
+            node = Conditional(node, then, otherwise)
+        return node
+
+    def parse_binary(self, min_precedence: int):
+        left = self.parse_unary()
+        while True:
+            kind, op = self.peek()
+            precedence = BINARY_PRECEDENCE.get(op) if kind == 'op' else None
+            if precedence is None or precedence < min_precedence:
+                return left
+            self.advance()
+            right = self.parse_binary(precedence + 1)
+            left = Binary(op, left, right)
+
+    def parse_unary(self):
+        kind, value = self.peek()
+        if kind == 'op' and value in ('!', '~', '-', '+'):
+            self.advance()
+            return Unary(value, self.parse_unary())
+        return self.parse_primary()
+
+    def parse_primary(self):
+        kind, value = self.advance()
+        if kind == 'number':
+            return Number(value)
+        if kind == 'op' and value == '(':
+            node = self.parse_conditional()
+            self.expect(')')
+            return node
+        if kind == 'ident':
+            if value == 'defined':
+                return self.parse_defined()
+            if value in ('true', 'false'):
+                return Number(1 if value == 'true' else 0)
+            if self.peek() == ('op', '('):
+                return self.parse_call(value)
+            return Identifier(value)
+        raise ConditionSyntaxError(f"Unexpected token {value!r}")
+
+    def parse_defined(self):
+        parenthesized = self.peek() == ('op', '(')
+        if parenthesized:
+            self.advance()
+        kind, name = self.advance()
+        if kind != 'ident':
+            raise ConditionSyntaxError("defined requires a macro name")
+        if parenthesized:
+            self.expect(')')
+        return Defined(name)
+
+    def parse_call(self, name: str):
+        # Arguments are kept as raw token text; their meaning is macro-specific
+        self.expect('(')
+        args = []
+        current = []
+        depth = 0
+        while True:
+            kind, value = self.advance()
+            if kind is None:
+                raise ConditionSyntaxError(f"Unterminated call to {name}")
+            if value == '(':
+                depth += 1
+            elif value == ')':
+                if depth == 0:
+                    break
+                depth -= 1
+            elif value == ',' and depth == 0:
+                args.append(' '.join(str(v) for v in current))
+                current = []
+                continue
+            current.append(value)
+        if current or args:
+            args.append(' '.join(str(v) for v in current))
+        return Call(name, tuple(args))
+
+
+@lru_cache(maxsize=65536)
+def parse_condition(text: str):
+    """
+    Parse a condition expression into an expression tree.
+
+    Results are cached by raw text, so repeated conditions are parsed once.
+
+    Raises:
+        ConditionSyntaxError: If the expression is malformed
+    """
+    return _Parser(tokenize(text)).parse()
+
+
+def referenced_symbols(node) -> Set[str]:
+    """Return all macro names referenced by an expression tree."""
+    symbols = set()
+    stack = [node]
+    while stack:
+        current = stack.pop()
+        if isinstance(current, (Identifier, Defined)):
+            symbols.add(current.name)
+        elif isinstance(current, Unary):
+            stack.append(current.operand)
+        elif isinstance(current, Binary):
+            stack.append(current.left)
+            stack.append(current.right)
+        elif isinstance(current, Conditional):
+            stack.extend((current.cond, current.then, current.otherwise))
+    return symbols
+
+
+# Precedence used when formatting unary operands and the ternary operator
+UNARY_PRECEDENCE = 11
+CONDITIONAL_PRECEDENCE = 0
+
+
+def format_condition(node) -> str:
+    """
+    Format an expression tree back into condition text.
+
+    Parentheses are only emitted where precedence requires them, so
+    equivalent spellings of a condition format identically.
+    """
+    return _format(node, CONDITIONAL_PRECEDENCE)
+
+
+def _format(node, parent_precedence: int) -> str:
+    if isinstance(node, Number):
+        return str(node.value)
+    if isinstance(node, Identifier):
+        return node.name
+    if isinstance(node, Defined):
+        return f"defined({node.name})"
+    if isinstance(node, Call):
+        return f"{node.name}({', '.join(node.args)})"
+    if isinstance(node, Unary):
+        operand = _format(node.operand, UNARY_PRECEDENCE)
+        separator = " " if operand[:1] == node.op and node.op in "+-" else ""
+        return f"{node.op}{separator}{operand}"
+    if isinstance(node, Binary):
+        precedence = BINARY_PRECEDENCE[node.op]
+        # Walk left-nested chains of the same operator without recursing
+        rights = []
+        current = node
+        while isinstance(current, Binary) and current.op == node.op:
+            rights.append(current.right)
+            current = current.left
+        parts = [_format(current, precedence)]
+        parts.extend(_format(right, precedence + 1) for right in reversed(rights))
+        text = f" {node.op} ".join(parts)
+        return f"({text})" if precedence < parent_precedence else text
+    if isinstance(node, Conditional):
+        text = (f"{_format(node.cond, CONDITIONAL_PRECEDENCE + 1)} ? "
+                f"{_format(node.then, CONDITIONAL_PRECEDENCE)} : "
+                f"{_format(node.otherwise, CONDITIONAL_PRECEDENCE)}")
+        return f"({text})" if parent_precedence > CONDITIONAL_PRECEDENCE else text
+    raise ConditionSyntaxError(f"Cannot format node {node!r}")
+
+
+def evaluate(node, macros: Mapping[str, Optional[str]], _depth: int = 0, _expanding: frozenset = frozenset()) -> int:
+    """
+    Evaluate an expression tree the way the preprocessor would.
+
+    Args:
+        node: Expression tree from parse_condition
+        macros: Mapping of defined macro names to their replacement text
+            (empty string for macros defined without a value)
+
+    Returns:
+        Integer value of the expression; undefined identifiers are 0
+    """
+    if isinstance(node, Number):
+        return node.value
+    if isinstance(node, Defined):
+        return 1 if node.name in macros else 0
+    if isinstance(node, Identifier):
+        return _expand_identifier(node.name, macros, _depth, _expanding)
+    if isinstance(node, Call):
+        return 0
+    if isinstance(node, Unary):
+        value = evaluate(node.operand, macros, _depth, _expanding)
+        if node.op == '!':
+            return 0 if value else 1
+        if node.op == '~':
+            return ~value
+        if node.op == '-':
+            return -value
+        return value
+    if isinstance(node, Binary):
+        op = node.op
+        left = evaluate(node.left, macros, _depth, _expanding)
+        # Short-circuit like C so that guarded divisions stay valid
+        if op == '&&':
+            return 1 if left and evaluate(node.right, macros, _depth, _expanding) else 0
+        if op == '||':
+            return 1 if left or evaluate(node.right, macros, _depth, _expanding) else 0
+        right = evaluate(node.right, macros, _depth, _expanding)
+        return _apply_binary(op, left, right)
+    if isinstance(node, Conditional):
+        if evaluate(node.cond, macros, _depth, _expanding):
+            return evaluate(node.then, macros, _depth, _expanding)
+        return evaluate(node.otherwise, macros, _depth, _expanding)
+    raise ConditionSyntaxError(f"Cannot evaluate node {node!r}")
+
+
+def _expand_identifier(name: str, macros: Mapping[str, Optional[str]], depth: int, expanding: frozenset) -> int:
+    """Evaluate an identifier by expanding its object-like macro value."""
+    if name not in macros or name in expanding or depth >= MAX_EXPANSION_DEPTH:
+        return 0
+    value = macros[name]
+    if not value:
+        return 0
+    try:
+        expansion = parse_condition(value)
+    except ConditionSyntaxError:
+        return 0
+    return evaluate(expansion, macros, depth + 1, expanding | {name})
+
+
+def _apply_binary(op: str, left: int, right: int) -> int:
+    """Apply a non-short-circuit binary operator."""
+    if op == '|':
+        return left | right
+    if op == '^':
+        return left ^ right
+    if op == '&':
+        return left & right
+    if op == '==':
+        return 1 if left == right else 0
+    if op == '!=':
+        return 1 if left != right else 0
+    if op == '<':
+        return 1 if left < right else 0
+    if op == '<=':
+        return 1 if left <= right else 0
+    if op == '>':
+        return 1 if left > right else 0
+    if op == '>=':
+        return 1 if left >= right else 0
+    if op == '<<':
+        return left << right if 0 <= right < 64 else 0
+    if op == '>>':
+        return left >> right if 0 <= right < 64 else 0
+    if op == '+':
+        return left + right
+    if op == '-':
+        return left - right
+    if op == '*':
+        return left * right
+    if right == 0:
+        # Division by zero is an error in the preprocessor; treat as false
+        return 0
+    # Integer division truncating toward zero, as in C, without going through floats
+    quotient = abs(left) // abs(right)
+    if (left < 0) != (right < 0):
+        quotient = -quotient
+    if op == '/':
+        return quotient
+    if op == '%':
+        return left - quotient * right
+    raise ConditionSyntaxError(f"Unknown operator {op}")
+
+
+def evaluate_condition(text: str, macros: Mapping[str, Optional[str]]) -> Optional[bool]:
+    """
+    Parse and evaluate a condition string.
+
+    Returns:
+        True/False, or None if the condition could not be parsed
+    """
+    try:
+        return bool(evaluate(parse_condition(text), macros))
+    except ConditionSyntaxError:
+        return None
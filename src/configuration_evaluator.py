@@ -0,0 +1,205 @@
+"""
+Configuration evaluator module for resolving conditional compilation.
+Walks a file's directives under a concrete configuration, deciding which
+branches are taken, which line ranges are skipped and which macros end up
+defined.
+"""
+
+import re
+from bisect import bisect_right
+from dataclasses import dataclass, field
+from typing import Callable, Dict, List, MutableMapping, Optional, Tuple, Union
+
+from .data_models import Configuration, Directive, DirectiveType
+from .condition_parser import evaluate_condition
+
+
+DEFINE_PARTS = re.compile(
+    r'^\s*#\s*define\s+([A-Za-z_][A-Za-z0-9_]*)(\([^)]*\))?\s*(.*?)\s*(?://.*)?$'
+)
+
+OPENING_TYPES = (DirectiveType.IF, DirectiveType.IFDEF, DirectiveType.IFNDEF)
+
+
+def split_define(content: str) -> Tuple[Optional[str], Optional[str], str]:
+    """
+    Split #define directive content into name, parameter list and value.
+
+    Returns:
+        (name, parameters or None for object-like macros, replacement text)
+    """
+    match = DEFINE_PARTS.match(content)
+    if not match:
+        return None, None, ""
+    value = re.sub(r'/\*.*?\*/', ' ', match.group(3)).strip()
+    return match.group(1), match.group(2), value
+
+
+@dataclass
+class EvaluationResult:
+    """
+    Outcome of evaluating one file under a configuration.
+
+    Attributes:
+        inactive_ranges: Skipped line ranges, 1-based and inclusive, in file order
+        taken: Line of each conditional directive mapped to whether its branch is active
+        macros: Macro table at the end of the file
+        unparsed_lines: Lines of conditions that could not be parsed (treated as false)
+        errors: #error directives reached, i.e. the configuration cannot compile
+    """
+    inactive_ranges: List[Tuple[int, int]] = field(default_factory=list)
+    taken: Dict[int, bool] = field(default_factory=dict)
+    macros: Dict[str, str] = field(default_factory=dict)
+    unparsed_lines: List[int] = field(default_factory=list)
+    errors: List[Directive] = field(default_factory=list)
+
+    def is_line_active(self, line_number: int) -> bool:
+        """Check whether a line is compiled under the configuration."""
+        index = bisect_right(self.inactive_ranges, (line_number, float('inf'))) - 1
+        return index < 0 or self.inactive_ranges[index][1] < line_number
+
+    def inactive_line_count(self) -> int:
+        """Get the number of skipped lines."""
+        return sum(end - start + 1 for start, end in self.inactive_ranges)
+
+
+class _Frame:
+    """State of one open conditional group."""
+    __slots__ = ('parent_active', 'any_taken', 'active', 'inactive_start')
+
+    def __init__(self, parent_active: bool):
+        self.parent_active = parent_active
+        self.any_taken = False
+        self.active = False
+        self.inactive_start = 0
+
+
+class ConfigurationEvaluator:
+    """
+    Evaluates conditional compilation under a configuration.
+    Unlike ContextAnalyzer, which records symbolic contexts, this decides
+    concretely which branches are compiled.
+    """
+
+    def evaluate(self,
+                 directives: List[Directive],
+                 configuration: Union[Configuration, Dict[str, str], None] = None,
+                 line_count: int = 0) -> EvaluationResult:
+        """
+        Evaluate a file's directives under a configuration.
+
+        Args:
+            directives: Directives in file order
+            configuration: Configuration or initial macro table
+            line_count: Number of lines in the file, used to close unterminated blocks
+
+        Returns:
+            EvaluationResult with skipped ranges, branch decisions and final macros
+        """
+        if isinstance(configuration, Configuration):
+            macros = configuration.initial_macros()
+        else:
+            macros = dict(configuration or {})
+
+        result = EvaluationResult(macros=macros)
+        self.walk(directives, macros, result, line_count)
+        return result
+
+    def walk(self,
+             directives: List[Directive],
+             macros: MutableMapping[str, str],
+             result: EvaluationResult,
+             line_count: int = 0,
+             on_include: Optional[Callable[[Directive, MutableMapping[str, str]], None]] = None) -> None:
+        """
+        Evaluate directives against a macro table, updating it in place.
+
+        Args:
+            directives: Directives in file order
+            macros: Macro table to read conditions from and apply defines/undefs to
+            result: Result receiving branch decisions and skipped ranges
+            line_count: Number of lines in the file, used to close unterminated blocks
+            on_include: Called with each active #include directive and the macro
+                table at that point, so callers can splice in the header's effects
+        """
+        stack: List[_Frame] = []
+
+        for directive in directives:
+            active = not stack or stack[-1].active
+            directive_type = directive.type
+
+            if directive_type in OPENING_TYPES:
+                frame = _Frame(active)
+                stack.append(frame)
+                self._enter_branch(frame, directive, macros, result)
+
+            elif directive_type in (DirectiveType.ELIF, DirectiveType.ELSE):
+                if not stack:
+                    continue
+                frame = stack[-1]
+                self._leave_branch(frame, directive.line_number, result)
+                self._enter_branch(frame, directive, macros, result)
+
+            elif directive_type == DirectiveType.ENDIF:
+                if not stack:
+                    continue
+                self._leave_branch(stack.pop(), directive.line_number, result)
+
+            elif not active:
+                continue
+
+            elif directive_type == DirectiveType.DEFINE:
+                name, _, value = split_define(directive.content)
+                if name:
+                    macros[name] = value
+
+            elif directive_type == DirectiveType.UNDEF and directive.symbol_name:
+                macros.pop(directive.symbol_name, None)
+
+            elif directive_type == DirectiveType.INCLUDE and on_include is not None:
+                on_include(directive, macros)
+
+            elif directive_type == DirectiveType.ERROR:
+                result.errors.append(directive)
+
+        # Unterminated blocks run to the end of the file
+        while stack:
+            self._leave_branch(stack.pop(), line_count + 1, result)
+
+    def _enter_branch(self, frame: _Frame, directive: Directive,
+                      macros: Dict[str, str], result: EvaluationResult) -> None:
+        """Decide whether the branch starting at directive is active."""
+        if not frame.parent_active or frame.any_taken:
+            taken = False
+        elif directive.type == DirectiveType.ELSE:
+            taken = True
+        else:
+            taken = self._condition_holds(directive, macros, result)
+
+        frame.active = taken
+        frame.any_taken = frame.any_taken or taken
+        result.taken[directive.line_number] = taken
+
+        if frame.parent_active and not taken:
+            frame.inactive_start = directive.line_number + 1
+
+    def _leave_branch(self, frame: _Frame, end_line: int, result: EvaluationResult) -> None:
+        """Close the skipped range of the current branch, if any."""
+        if frame.parent_active and not frame.active and frame.inactive_start:
+            if frame.inactive_start <= end_line - 1:
+                result.inactive_ranges.append((frame.inactive_start, end_line - 1))
+        frame.inactive_start = 0
+
+    def _condition_holds(self, directive: Directive, macros: Dict[str, str],
+                         result: EvaluationResult) -> bool:
+        """Evaluate the condition of an opening or #elif directive."""
+        if directive.type == DirectiveType.IFDEF:
+            return directive.symbol_name in macros
+        if directive.type == DirectiveType.IFNDEF:
+            return directive.symbol_name not in macros
+
+        value = evaluate_condition(directive.condition or "", macros)
+        if value is None:
+            result.unparsed_lines.append(directive.line_number)
+            return False
+        return value
@@ -0,0 +1,315 @@
+"""
+Configuration space module.
+Enumerates and samples the configurations a code base can be built in, where
+each feature macro is either defined or not. The branch conditions leading
+to every #error are extracted as constraints: configurations satisfying one
+must never occur, so they are pruned as soon as the macros a constraint reads
+are all decided instead of being discovered by a failed build.
+"""
+
+import random
+import re
+from dataclasses import dataclass, field
+from typing import Any, Dict, Iterable, Iterator, List, Optional, Set, Tuple
+
+from .condition_parser import ConditionSyntaxError, parse_condition, referenced_symbols, evaluate
+from .data_models import Configuration, Directive, DirectiveType, FileAnalysisResult
+from .header_summary import include_guard
+
+
+ERROR_MESSAGE = re.compile(r'^\s*#\s*(?:error|warning)\b\s*(.*?)\s*$')
+
+CONDITIONAL_TYPES = (DirectiveType.IF, DirectiveType.IFDEF, DirectiveType.IFNDEF, DirectiveType.ELIF)
+
+
+@dataclass
+class ErrorConstraint:
+    """
+    Branch condition under which an #error is reached.
+
+    Attributes:
+        condition: Conjunction of the conditions enclosing the #error
+        message: Text of the #error
+        file_path: File containing the #error
+        line_number: Line of the #error (1-based)
+        symbols: Macros the condition reads, sorted
+    """
+    condition: str
+    message: str
+    file_path: str
+    line_number: int
+    symbols: List[str] = field(default_factory=list)
+
+    def __post_init__(self):
+        self._tree = parse_condition(self.condition)
+
+    def violated_by(self, macros: Dict[str, str]) -> bool:
+        """Check whether a macro table reaches the #error."""
+        return bool(evaluate(self._tree, macros))
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert constraint to dictionary for serialization."""
+        return {
+            "condition": self.condition,
+            "message": self.message,
+            "file_path": self.file_path,
+            "line_number": self.line_number,
+            "symbols": list(self.symbols)
+        }
+
+
+def directive_message(directive: Directive) -> str:
+    """Get the text of an #error or #warning directive."""
+    match = ERROR_MESSAGE.match(directive.content)
+    return match.group(1) if match else ""
+
+
+def _branch_condition(directive: Directive) -> str:
+    """Condition of an opening or #elif directive as an #if expression."""
+    if directive.type == DirectiveType.IFDEF:
+        return f"defined({directive.symbol_name})"
+    if directive.type == DirectiveType.IFNDEF:
+        return f"!defined({directive.symbol_name})"
+    return directive.condition or ""
+
+
+def branch_conditions(directives: List[Directive]) -> Iterator[Tuple[Directive, str]]:
+    """
+    Pair each non-conditional directive with the condition under which it is reached.
+
+    The condition is the conjunction of the enclosing branches, including the
+    negation of earlier #if/#elif branches of the same group, written as an
+    #if expression ("1" at top level). The file's include guard is left out.
+
+    Args:
+        directives: Directives of one file, in file order
+
+    Yields:
+        (directive, condition) for every directive that is not a conditional
+    """
+    guard_pending = include_guard(directives) is not None
+    # Each frame holds (condition, negated) for earlier branches and the current one
+    stack: List[List[Tuple[str, bool]]] = []
+
+    for directive in directives:
+        directive_type = directive.type
+        if directive_type in (DirectiveType.IF, DirectiveType.IFDEF, DirectiveType.IFNDEF):
+            if guard_pending:
+                guard_pending = False
+                stack.append([])
+            else:
+                stack.append([(_branch_condition(directive), False)])
+        elif directive_type in (DirectiveType.ELIF, DirectiveType.ELSE):
+            if stack:
+                frame = stack[-1]
+                if frame:
+                    frame[-1] = (frame[-1][0], True)
+                if directive_type == DirectiveType.ELIF:
+                    frame.append((_branch_condition(directive), False))
+        elif directive_type == DirectiveType.ENDIF:
+            if stack:
+                stack.pop()
+        else:
+            terms = [f"!({condition})" if negated else f"({condition})"
+                     for frame in stack for condition, negated in frame]
+            yield directive, " && ".join(terms) or "1"
+
+
+def extract_constraints(directives: List[Directive]) -> List[ErrorConstraint]:
+    """
+    Derive the configurations that must never occur from a file's #error directives.
+
+    Each #error contributes its branch condition (see branch_conditions).
+    Macros the file itself defines before the #error are not taken into
+    account, and an #error under a condition that cannot be parsed yields
+    no constraint.
+
+    Args:
+        directives: Directives of one file, in file order
+
+    Returns:
+        One constraint per #error whose enclosing conditions could be parsed
+    """
+    constraints = []
+    for directive, condition in branch_conditions(directives):
+        if directive.type != DirectiveType.ERROR:
+            continue
+        try:
+            symbols = sorted(referenced_symbols(parse_condition(condition)))
+        except ConditionSyntaxError:
+            continue
+        constraints.append(ErrorConstraint(
+            condition=condition,
+            message=directive_message(directive),
+            file_path=directive.file_path,
+            line_number=directive.line_number,
+            symbols=symbols
+        ))
+    return constraints
+
+
+class ConfigurationSpace:
+    """
+    The configurations over a set of feature macros, minus those reaching an #error.
+
+    Each feature macro is either defined (to 1) or left undefined, on top of
+    a base configuration. Constraints are checked as soon as the last macro
+    they read is decided, so a forbidden combination prunes every
+    configuration sharing it at once.
+    """
+
+    def __init__(self, symbols: Iterable[str],
+                 constraints: Iterable[ErrorConstraint] = (),
+                 base: Optional[Configuration] = None):
+        self.base = base or Configuration()
+        fixed = set(self.base.defines) | set(self.base.undefs)
+        self.symbols: List[str] = sorted(set(symbols) - fixed)
+        self.constraints: List[ErrorConstraint] = list(constraints)
+
+        # Constraints grouped by the depth at which they become decidable
+        position = {symbol: index + 1 for index, symbol in enumerate(self.symbols)}
+        self._checks: List[List[ErrorConstraint]] = [[] for _ in range(len(self.symbols) + 1)]
+        for constraint in self.constraints:
+            depth = max((position.get(symbol, 0) for symbol in constraint.symbols), default=0)
+            self._checks[depth].append(constraint)
+
+    @classmethod
+    def from_file_results(cls, file_results: Iterable[FileAnalysisResult],
+                          base: Optional[Configuration] = None) -> 'ConfigurationSpace':
+        """
+        Build the space of a set of files.
+
+        Feature macros are those read by any conditional except include
+        guards; constraints come from every #error.
+        """
+        symbols: Set[str] = set()
+        guards: Set[str] = set()
+        constraints: List[ErrorConstraint] = []
+        for file_result in file_results:
+            directives = file_result.directives
+            guard = include_guard(directives)
+            if guard is not None:
+                guards.add(guard)
+            constraints.extend(extract_constraints(directives))
+            for directive in directives:
+                if directive.type not in CONDITIONAL_TYPES:
+                    continue
+                try:
+                    symbols |= referenced_symbols(parse_condition(_branch_condition(directive)))
+                except ConditionSyntaxError:
+                    continue
+        return cls(symbols - guards, constraints, base)
+
+    def violations(self, configuration: Configuration) -> List[ErrorConstraint]:
+        """Get the constraints a configuration violates."""
+        macros = configuration.initial_macros()
+        return [c for c in self.constraints if c.violated_by(macros)]
+
+    def is_valid(self, configuration: Configuration) -> bool:
+        """Check that a configuration reaches no #error."""
+        return not self.violations(configuration)
+
+    def size(self) -> int:
+        """Number of configurations before pruning."""
+        return 1 << len(self.symbols)
+
+    def enumerate(self, limit: Optional[int] = None) -> Iterator[Configuration]:
+        """
+        Yield every valid configuration, all macros undefined first.
+
+        Args:
+            limit: Stop after this many configurations
+
+        Yields:
+            Configurations on top of the base configuration
+        """
+        if limit is not None and limit <= 0:
+            return
+        macros = self.base.initial_macros()
+        if self._violates(0, macros):
+            return
+
+        produced = 0
+        # Depth-first over (depth, next choice); choice 0 leaves the macro undefined
+        stack = [0]
+        while stack:
+            depth = len(stack) - 1
+            if depth == len(self.symbols):
+                yield self._configuration(macros)
+                produced += 1
+                if limit is not None and produced >= limit:
+                    return
+                stack.pop()
+                continue
+
+            choice = stack[-1]
+            symbol = self.symbols[depth]
+            macros.pop(symbol, None)
+            if choice > 1:
+                stack.pop()
+                continue
+            stack[-1] = choice + 1
+            if choice:
+                macros[symbol] = "1"
+            if not self._violates(depth + 1, macros):
+                stack.append(0)
+
+    def sample(self, count: int, seed: Optional[int] = None,
+               max_attempts: Optional[int] = None) -> List[Configuration]:
+        """
+        Draw distinct valid configurations uniformly per macro.
+
+        Each macro is decided in turn; when a choice completes a forbidden
+        combination the other value is taken instead, and a draw is only
+        abandoned if neither value is allowed.
+
+        Args:
+            count: Number of configurations wanted
+            seed: Seed for reproducible samples
+            max_attempts: Number of draws before giving up (default: 20 * count)
+
+        Returns:
+            Up to count distinct configurations
+        """
+        rng = random.Random(seed)
+        attempts = max_attempts if max_attempts is not None else 20 * count
+        base = self.base.initial_macros()
+        if self._violates(0, base):
+            return []
+
+        seen = set()
+        samples = []
+        while len(samples) < count and attempts > 0:
+            attempts -= 1
+            macros = dict(base)
+            for depth, symbol in enumerate(self.symbols, 1):
+                first = rng.random() < 0.5
+                for defined in (first, not first):
+                    if defined:
+                        macros[symbol] = "1"
+                    else:
+                        macros.pop(symbol, None)
+                    if not self._violates(depth, macros):
+                        break
+                else:
+                    break
+            else:
+                key = tuple(symbol in macros for symbol in self.symbols)
+                if key not in seen:
+                    seen.add(key)
+                    samples.append(self._configuration(macros))
+        return samples
+
+    def _violates(self, depth: int, macros: Dict[str, str]) -> bool:
+        return any(constraint.violated_by(macros) for constraint in self._checks[depth])
+
+    def _configuration(self, macros: Dict[str, str]) -> Configuration:
+        defined = [symbol for symbol in self.symbols if symbol in macros]
+        defines = dict(self.base.defines)
+        defines.update((symbol, "1") for symbol in defined)
+        return Configuration(
+            name="+".join(defined) or self.base.name,
+            defines=defines,
+            undefs=list(self.base.undefs),
+            include_paths=list(self.base.include_paths)
+        )
@@ -4,37 +4,66 @@ Analyzes the conditional compilation hierarchy and determines the context
 under which each #define directive is declared.
 """
 
-from typing import List, Dict, Optional, Set
+import re
+from dataclasses import dataclass, field
+from typing import Iterable, List, Dict, Mapping, Optional, Set
 from .data_models import (
     Directive, DirectiveType, FileAnalysisResult, 
     ContextStack, ValidationError, ErrorSeverity
 )
 
 
+@dataclass
+class ContextState:
+    """
+    Per-call state of context analysis.
+    
+    Attributes:
+        stack: Conditional blocks open at the current directive
+        dependencies: Symbol (or #if condition) mapped to the symbols it references
+    """
+    stack: ContextStack = field(default_factory=ContextStack)
+    dependencies: Dict[str, Set[str]] = field(default_factory=dict)
+    
+    def add_dependency(self, symbol: str, dependency: str) -> None:
+        """Record that a symbol depends on another."""
+        if symbol not in self.dependencies:
+            self.dependencies[symbol] = set()
+        self.dependencies[symbol].add(dependency)
+
+
 class ContextAnalyzer:
     """
     Analyzes conditional compilation contexts in C++ preprocessor directives.
     Tracks the nested conditional blocks and determines the context for each directive.
+    
+    All state of an analysis lives in a ContextState created per call and in
+    the analyzed file result, so one analyzer can be shared by any number of
+    threads. Dependencies are left on each file result; AnalysisResult
+    merges them across files.
     """
     
-    def __init__(self):
-        self.context_stack = ContextStack()
-        self.dependency_graph: Dict[str, Set[str]] = {}
-        
+    # Patterns used for dependency extraction, compiled once per process
+    CONDITION_OPERATORS = re.compile(r'[()&|!<>=+\-*/\s]')
+    NUMBER = re.compile(r'\b\d+\b')
+    DEFINED_KEYWORD = re.compile(r'\bdefined\b')
+    IDENTIFIER = re.compile(r'\b[A-Za-z_][A-Za-z0-9_]*\b')
+    DEFINE_VALUE = re.compile(r'^\s*#\s*define\s+[A-Za-z_][A-Za-z0-9_]*\s+(.*?)(?://.*)?$')
+    
     def analyze(self, file_result: FileAnalysisResult) -> None:
         """
         Analyze the conditional compilation contexts for all directives in a file.
         
         Args:
-            file_result: FileAnalysisResult to analyze and update with context information
+            file_result: FileAnalysisResult to analyze and update with context
+                information, errors and the file's symbol dependencies
         """
-        self.context_stack = ContextStack()
-        self.context_stack.file_context = file_result.file_path
+        state = ContextState(ContextStack(file_context=file_result.file_path))
         
         # Process directives in order to maintain proper context tracking
         for directive in file_result.directives:
             try:
-                self._process_directive(directive, file_result)
+                self._process_directive(directive, file_result, state)
             except Exception as e:
                 error = ValidationError(
                     severity=ErrorSeverity.ERROR,
@@ -46,67 +75,74 @@ class ContextAnalyzer:
                 file_result.add_error(error)
         
         # Check for unmatched conditional blocks
-        if self.context_stack.depth > 0:
+        if state.stack.depth > 0:
             error = ValidationError(
                 severity=ErrorSeverity.ERROR,
-                message=f"Unmatched conditional directive(s): {self.context_stack.depth} unclosed block(s)",
+                message=f"Unmatched conditional directive(s): {state.stack.depth} unclosed block(s)",
                 file_path=file_result.file_path,
                 line_number=file_result.line_count,
                 suggestion="Add missing #endif directive(s)"
             )
             file_result.add_error(error)
+        
+        file_result.dependencies = state.dependencies
     
-    def _process_directive(self, directive: Directive, file_result: FileAnalysisResult) -> None:
+    def _process_directive(self, directive: Directive, file_result: FileAnalysisResult,
+                           state: ContextState) -> None:
         """
         Process a single directive and update the context accordingly.
         
         Args:
             directive: Directive to process
             file_result: Current file analysis result for error reporting
+            state: State of the analysis the directive belongs to
         """
         if directive.type == DirectiveType.IFDEF:
-            self._handle_ifdef(directive)
+            self._handle_ifdef(directive, state)
         elif directive.type == DirectiveType.IFNDEF:
-            self._handle_ifndef(directive)
+            self._handle_ifndef(directive, state)
         elif directive.type == DirectiveType.IF:
-            self._handle_if(directive)
+            self._handle_if(directive, state)
         elif directive.type == DirectiveType.ELSE:
-            self._handle_else(directive, file_result)
+            self._handle_else(directive, file_result, state)
         elif directive.type == DirectiveType.ELIF:
-            self._handle_elif(directive, file_result)
+            self._handle_elif(directive, file_result, state)
         elif directive.type == DirectiveType.ENDIF:
-            self._handle_endif(directive, file_result)
+            self._handle_endif(directive, file_result, state)
         elif directive.type == DirectiveType.DEFINE:
-            self._handle_define(directive)
+            self._handle_define(directive, state)
         elif directive.type == DirectiveType.UNDEF:
-            self._handle_undef(directive)
+            self._handle_undef(directive, state)
+        elif directive.type in (DirectiveType.ERROR, DirectiveType.WARNING, DirectiveType.PRAGMA):
+            self._handle_diagnostic(directive, state)
     
-    def _handle_ifdef(self, directive: Directive) -> None:
+    def _handle_ifdef(self, directive: Directive, state: ContextState) -> None:
         """Handle #ifdef directive."""
         if directive.symbol_name:
-            self.context_stack.push_condition(directive.symbol_name, negated=False)
-            directive.context = self.context_stack.get_current_context()
+            state.stack.push_condition(directive.symbol_name, negated=False)
+            directive.context = state.stack.get_current_context()
     
-    def _handle_ifndef(self, directive: Directive) -> None:
+    def _handle_ifndef(self, directive: Directive, state: ContextState) -> None:
         """Handle #ifndef directive."""
         if directive.symbol_name:
-            self.context_stack.push_condition(directive.symbol_name, negated=True)
-            directive.context = self.context_stack.get_current_context()
+            state.stack.push_condition(directive.symbol_name, negated=True)
+            directive.context = state.stack.get_current_context()
     
-    def _handle_if(self, directive: Directive) -> None:
+    def _handle_if(self, directive: Directive, state: ContextState) -> None:
         """Handle #if directive."""
         if directive.condition:
             # Parse the condition to extract dependencies
             dependencies = self._extract_dependencies_from_condition(directive.condition)
             for dep in dependencies:
-                self._add_dependency(directive.condition, dep)
+                state.add_dependency(directive.condition, dep)
             
-            self.context_stack.push_condition(directive.condition, negated=False)
-            directive.context = self.context_stack.get_current_context()
+            state.stack.push_condition(directive.condition, negated=False)
+            directive.context = state.stack.get_current_context()
     
-    def _handle_else(self, directive: Directive, file_result: FileAnalysisResult) -> None:
+    def _handle_else(self, directive: Directive, file_result: FileAnalysisResult,
+                     state: ContextState) -> None:
         """Handle #else directive."""
-        if self.context_stack.depth == 0:
+        if state.stack.depth == 0:
             error = ValidationError(
                 severity=ErrorSeverity.ERROR,
                 message="Orphaned #else directive without matching conditional",
@@ -118,13 +154,14 @@ class ContextAnalyzer:
             return
         
         # Negate the top condition
-        if self.context_stack.conditions:
-            self.context_stack.negations[-1] = not self.context_stack.negations[-1]
-            directive.context = self.context_stack.get_current_context()
+        if state.stack.conditions:
+            state.stack.negations[-1] = not state.stack.negations[-1]
+            directive.context = state.stack.get_current_context()
     
-    def _handle_elif(self, directive: Directive, file_result: FileAnalysisResult) -> None:
+    def _handle_elif(self, directive: Directive, file_result: FileAnalysisResult,
+                     state: ContextState) -> None:
         """Handle #elif directive."""
-        if self.context_stack.depth == 0:
+        if state.stack.depth == 0:
             error = ValidationError(
                 severity=ErrorSeverity.ERROR,
                 message="Orphaned #elif directive without matching conditional",
@@ -136,18 +173,18 @@ class ContextAnalyzer:
             return
         
         # Replace the top condition with the new elif condition
-        if directive.condition and self.context_stack.conditions:
+        if directive.condition and state.stack.conditions:
             dependencies = self._extract_dependencies_from_condition(directive.condition)
             for dep in dependencies:
-                self._add_dependency(directive.condition, dep)
+                state.add_dependency(directive.condition, dep)
             
-            self.context_stack.conditions[-1] = directive.condition
-            self.context_stack.negations[-1] = False
-            directive.context = self.context_stack.get_current_context()
+            state.stack.next_branch(directive.condition)
+            directive.context = state.stack.get_current_context()
     
-    def _handle_endif(self, directive: Directive, file_result: FileAnalysisResult) -> None:
+    def _handle_endif(self, directive: Directive, file_result: FileAnalysisResult,
+                      state: ContextState) -> None:
         """Handle #endif directive."""
-        if self.context_stack.depth == 0:
+        if state.stack.depth == 0:
             error = ValidationError(
                 severity=ErrorSeverity.ERROR,
                 message="Orphaned #endif directive without matching conditional",
@@ -158,13 +195,13 @@ class ContextAnalyzer:
             file_result.add_error(error)
             return
         
-        self.context_stack.pop_condition()
-        directive.context = self.context_stack.get_current_context()
+        state.stack.pop_condition()
+        directive.context = state.stack.get_current_context()
     
-    def _handle_define(self, directive: Directive) -> None:
+    def _handle_define(self, directive: Directive, state: ContextState) -> None:
         """Handle #define directive."""
         # Assign current context to the define
-        directive.context = self.context_stack.get_current_context()
+        directive.context = state.stack.get_current_context()
         
         # Track dependencies if the define has a value that references other symbols
         if directive.symbol_name and directive.content:
@@ -173,11 +210,15 @@ class ContextAnalyzer:
             if define_value:
                 dependencies = self._extract_symbol_references(define_value)
                 for dep in dependencies:
-                    self._add_dependency(directive.symbol_name, dep)
+                    state.add_dependency(directive.symbol_name, dep)
     
-    def _handle_undef(self, directive: Directive) -> None:
+    def _handle_undef(self, directive: Directive, state: ContextState) -> None:
         """Handle #undef directive."""
-        directive.context = self.context_stack.get_current_context()
+        directive.context = state.stack.get_current_context()
+    
+    def _handle_diagnostic(self, directive: Directive, state: ContextState) -> None:
+        """Handle #error, #warning and #pragma directives."""
+        directive.context = state.stack.get_current_context()
     
     def _extract_dependencies_from_condition(self, condition: str) -> Set[str]:
         """
@@ -189,19 +230,17 @@ class ContextAnalyzer:
         Returns:
             Set of symbol names referenced in the condition
         """
-        import re
-        
         # Remove common operators and whitespace to find symbol names
         # This is a simplified approach - a full C preprocessor would need more complex parsing
         symbols = set()
         
         # Remove operators, numbers, and common keywords
-        cleaned = re.sub(r'[()&|!<>=+\-*/\s]', ' ', condition)
-        cleaned = re.sub(r'\b\d+\b', ' ', cleaned)  # Remove numbers
-        cleaned = re.sub(r'\bdefined\b', ' ', cleaned)  # Remove 'defined' keyword
+        cleaned = self.CONDITION_OPERATORS.sub(' ', condition)
+        cleaned = self.NUMBER.sub(' ', cleaned)  # Remove numbers
+        cleaned = self.DEFINED_KEYWORD.sub(' ', cleaned)  # Remove 'defined' keyword
         
         # Extract potential symbol names
-        potential_symbols = re.findall(r'\b[A-Za-z_][A-Za-z0-9_]*\b', cleaned)
+        potential_symbols = self.IDENTIFIER.findall(cleaned)
         
         for symbol in potential_symbols:
             if symbol and not symbol.isdigit():
@@ -219,10 +258,8 @@ class ContextAnalyzer:
         Returns:
             The value part of the define, or empty string if none
         """
-        import re
-        
         # Match #define SYMBOL VALUE
-        match = re.match(r'^\s*#\s*define\s+[A-Za-z_][A-Za-z0-9_]*\s+(.*?)(?://.*)?$', define_content)
+        match = self.DEFINE_VALUE.match(define_content)
         if match:
             return match.group(1).strip()
         return ""
@@ -237,11 +274,9 @@ class ContextAnalyzer:
         Returns:
             Set of symbol names found
         """
-        import re
-        
         symbols = set()
         # Find potential symbol names in the text
-        potential_symbols = re.findall(r'\b[A-Za-z_][A-Za-z0-9_]*\b', text)
+        potential_symbols = self.IDENTIFIER.findall(text)
         
         for symbol in potential_symbols:
             if symbol and not symbol.isdigit():
@@ -249,30 +284,13 @@ class ContextAnalyzer:
         
         return symbols
     
-    def _add_dependency(self, symbol: str, dependency: str) -> None:
+    def find_circular_dependencies(self, dependency_graph: Mapping[str, Iterable[str]]) -> List[List[str]]:
         """
-        Add a dependency relationship between symbols.
+        Find circular dependencies in a symbol dependency graph.
         
         Args:
-            symbol: Symbol that depends on another
-            dependency: Symbol that is depended upon
-        """
-        if symbol not in self.dependency_graph:
-            self.dependency_graph[symbol] = set()
-        self.dependency_graph[symbol].add(dependency)
-    
-    def get_dependency_graph(self) -> Dict[str, List[str]]:
-        """
-        Get the complete dependency graph as a dictionary.
-        
-        Returns:
-            Dictionary mapping symbols to their dependencies
-        """
-        return {symbol: list(deps) for symbol, deps in self.dependency_graph.items()}
-    
-    def find_circular_dependencies(self) -> List[List[str]]:
-        """
-        Find circular dependencies in the symbol dependency graph.
+            dependency_graph: Symbols mapped to their dependencies, e.g.
+                AnalysisResult.dependency_graph
         
         Returns:
             List of circular dependency chains
@@ -295,13 +313,13 @@ class ContextAnalyzer:
             visited.add(symbol)
             path.append(symbol)
             
-            if symbol in self.dependency_graph:
-                for dependency in self.dependency_graph[symbol]:
+            if symbol in dependency_graph:
+                for dependency in dependency_graph[symbol]:
                     dfs(dependency)
             
             path.pop()
         
-        for symbol in self.dependency_graph:
+        for symbol in dependency_graph:
             if symbol not in visited:
                 dfs(symbol)
         
@@ -0,0 +1,563 @@
+"""
+Context query module.
+A small query language over analyzed directives, such as
+
+    defines where context implies ENABLE_LOGGING and not WINDOWS
+    directives where context is unsatisfiable
+
+Semantic predicates compare the conditional context of a directive with a
+condition as propositional formulas. Each formula is evaluated to a truth
+table held in an integer bitset, and results are memoized per unique
+context, so a query costs one evaluation per distinct context rather than
+per directive.
+"""
+
+import fnmatch
+import re
+from dataclasses import dataclass, field
+from typing import Any, Dict, Iterable, List, Optional, Tuple
+
+from .condition_parser import (
+    Binary, ConditionSyntaxError, Conditional, Defined, Identifier, Number, Unary,
+    format_condition, parse_condition
+)
+from .data_models import Directive, DirectiveType
+
+
+class QuerySyntaxError(ValueError):
+    """Raised when a query cannot be parsed."""
+
+
+# Query target -> directive types it selects (None selects every directive)
+TARGETS = {
+    "directives": None,
+    "defines": {DirectiveType.DEFINE},
+    "undefs": {DirectiveType.UNDEF},
+    "includes": {DirectiveType.INCLUDE},
+    "conditions": {DirectiveType.IF, DirectiveType.IFDEF, DirectiveType.IFNDEF, DirectiveType.ELIF},
+    "errors": {DirectiveType.ERROR},
+    "warnings": {DirectiveType.WARNING},
+    "pragmas": {DirectiveType.PRAGMA},
+}
+
+# Words that start a predicate, ending a condition operand before them
+PREDICATE_WORDS = {"context", "symbol", "file"}
+# Query words spelled as C operators inside conditions
+CONDITION_WORDS = {"and": "&&", "or": "||", "not": "!"}
+
+QUERY_TOKEN = re.compile(r"""\s*(?:('(?:[^'\\]|\\.)*'|"(?:[^"\\]|\\.)*")|"""
+                         r"""(&&|\|\||==|!=|<=|>=|<<|>>|[()!<>+\-*/%&|^~?:,])|([A-Za-z_]\w*|\d\w*))""")
+
+# Contexts and conditions over more atoms than this are left undecided
+MAX_ATOMS = 20
+
+
+def _operands(node: Binary) -> List[object]:
+    """Operands of a chain of the same operator, in order, without recursing."""
+    operands = []
+    stack = [node]
+    while stack:
+        current = stack.pop()
+        if isinstance(current, Binary) and current.op == node.op:
+            stack.append(current.right)
+            stack.append(current.left)
+        else:
+            operands.append(current)
+    return operands
+
+
+def _atom_name(node) -> str:
+    """
+    Variable of an atom: `defined(X)` and a bare `X` are the same feature
+    (undefined, or defined to 1, as in the configuration space); anything
+    else is an opaque variable named by its canonical text.
+    """
+    if isinstance(node, (Defined, Identifier)):
+        return node.name
+    return format_condition(node)
+
+
+def _collect_atoms(node, atoms: Dict[str, None]) -> None:
+    if isinstance(node, Number):
+        return
+    if isinstance(node, Unary) and node.op == '!':
+        _collect_atoms(node.operand, atoms)
+    elif isinstance(node, Binary) and node.op in ('&&', '||'):
+        for operand in _operands(node):
+            _collect_atoms(operand, atoms)
+    elif isinstance(node, Conditional):
+        for part in (node.cond, node.then, node.otherwise):
+            _collect_atoms(part, atoms)
+    else:
+        atoms.setdefault(_atom_name(node), None)
+
+
+def truth_table(node, variables: Dict[str, int], full: int) -> int:
+    """
+    Evaluate an expression tree over every assignment of its atoms at once.
+
+    Args:
+        node: Expression tree used as a truth value
+        variables: Atom name mapped to the bitset of assignments where it is true
+        full: Bitset of every assignment
+
+    Returns:
+        Bitset of the assignments under which the expression is true
+    """
+    if isinstance(node, Number):
+        return full if node.value else 0
+    if isinstance(node, Unary) and node.op == '!':
+        return full & ~truth_table(node.operand, variables, full)
+    if isinstance(node, Binary) and node.op in ('&&', '||'):
+        tables = (truth_table(operand, variables, full) for operand in _operands(node))
+        result = full if node.op == '&&' else 0
+        for table in tables:
+            result = result & table if node.op == '&&' else result | table
+        return result
+    if isinstance(node, Conditional):
+        condition = truth_table(node.cond, variables, full)
+        return ((condition & truth_table(node.then, variables, full)) |
+                (full & ~condition & truth_table(node.otherwise, variables, full)))
+    return variables[_atom_name(node)]
+
+
+def _variables(atoms: Iterable[str]) -> Tuple[Dict[str, int], int]:
+    """
+    Truth-table bitsets of atoms: assignment number n makes atom i true
+    when bit i of n is set.
+    """
+    atoms = list(atoms)
+    size = 1 << len(atoms)
+    full = (1 << size) - 1
+    variables = {}
+    for index, atom in enumerate(atoms):
+        # Runs of 2^index false assignments then 2^index true ones, doubled
+        # until they cover every assignment
+        pattern = ((1 << (1 << index)) - 1) << (1 << index)
+        length = 1 << (index + 1)
+        while length < size:
+            pattern |= pattern << length
+            length *= 2
+        variables[atom] = pattern
+    return variables, full
+
+
+def condition_tree(text: str):
+    """Parse a condition, making unparseable text one opaque atom."""
+    try:
+        return parse_condition(text)
+    except ConditionSyntaxError:
+        return Identifier(" ".join(text.split()))
+
+
+class ContextSemantics:
+    """
+    Propositional view of conditional contexts, memoized by context id.
+
+    A context (the list of conditions enclosing a directive) is interned to
+    an id the first time it is seen; its formula, atoms and satisfiability
+    are computed once per id, and implication checks once per id and
+    condition.
+
+    Attributes:
+        evaluations: Truth tables computed, for checking the memoization
+        undecided: Context ids with more than MAX_ATOMS atoms
+    """
+
+    def __init__(self):
+        self._ids: Dict[Tuple[str, ...], int] = {}
+        self._trees: List[object] = []
+        self._atoms: List[Dict[str, None]] = []
+        self._satisfiable: Dict[int, Optional[bool]] = {}
+        self._implies: Dict[Tuple[int, str], Optional[bool]] = {}
+        self._excludes: Dict[Tuple[int, str], Optional[bool]] = {}
+        self.evaluations = 0
+        self.undecided = set()
+
+    def context_id(self, context: List[str]) -> int:
+        """Intern a context."""
+        key = tuple(context)
+        context_id = self._ids.get(key)
+        if context_id is None:
+            context_id = self._ids[key] = len(self._trees)
+            parts = [condition_tree(part) for part in key]
+            tree = parts[0] if parts else Number(1)
+            for part in parts[1:]:
+                tree = Binary('&&', tree, part)
+            atoms: Dict[str, None] = {}
+            _collect_atoms(tree, atoms)
+            self._trees.append(tree)
+            self._atoms.append(atoms)
+        return context_id
+
+    @property
+    def context_count(self) -> int:
+        """Number of distinct contexts seen."""
+        return len(self._trees)
+
+    def formula(self, context_id: int):
+        """Conjunction of a context's conditions as a condition tree."""
+        return self._trees[context_id]
+
+    def is_global(self, context_id: int) -> bool:
+        """Whether a context has no enclosing condition."""
+        return self._trees[context_id] == Number(1)
+
+    def satisfiable(self, context_id: int) -> Optional[bool]:
+        """Whether some configuration reaches the context (None if undecided)."""
+        if context_id not in self._satisfiable:
+            tables = self._tables(context_id, None)
+            self._satisfiable[context_id] = None if tables is None else tables[0] != 0
+        return self._satisfiable[context_id]
+
+    def implies(self, context_id: int, condition) -> Optional[bool]:
+        """
+        Whether the context is reachable and every configuration reaching
+        it satisfies a condition.
+        """
+        key = (context_id, format_condition(condition))
+        if key not in self._implies:
+            tables = self._tables(context_id, condition)
+            self._implies[key] = None if tables is None else (
+                tables[0] != 0 and tables[0] & ~tables[1] == 0)
+        return self._implies[key]
+
+    def excludes(self, context_id: int, condition) -> Optional[bool]:
+        """
+        Whether the context is reachable and no configuration reaching it
+        satisfies a condition.
+        """
+        key = (context_id, format_condition(condition))
+        if key not in self._excludes:
+            tables = self._tables(context_id, condition)
+            self._excludes[key] = None if tables is None else (
+                tables[0] != 0 and tables[0] & tables[1] == 0)
+        return self._excludes[key]
+
+    def _tables(self, context_id: int, condition) -> Optional[Tuple[int, int]]:
+        """Truth tables of a context and a condition over their combined atoms."""
+        atoms = dict(self._atoms[context_id])
+        if condition is not None:
+            _collect_atoms(condition, atoms)
+        if len(atoms) > MAX_ATOMS:
+            self.undecided.add(context_id)
+            return None
+        self.evaluations += 1
+        variables, full = _variables(atoms)
+        context = truth_table(self._trees[context_id], variables, full)
+        return context, truth_table(condition, variables, full) if condition is not None else full
+
+
+class _Predicate:
+    """
+    Node of a query's where clause.
+
+    Predicates are three-valued: None means the context was too large to
+    decide, and stays None through `not`, so an undecided context never
+    matches a where clause that depends on it.
+    """
+
+    def matches(self, directive: Directive, context_id: int, semantics: ContextSemantics) -> Optional[bool]:
+        raise NotImplementedError
+
+
+@dataclass
+class _Not(_Predicate):
+    operand: _Predicate
+
+    def matches(self, directive, context_id, semantics):
+        value = self.operand.matches(directive, context_id, semantics)
+        return None if value is None else not value
+
+
+@dataclass
+class _Junction(_Predicate):
+    op: str
+    operands: List[_Predicate]
+
+    def matches(self, directive, context_id, semantics):
+        # The value that settles the junction: False for and, True for or
+        settling = self.op != "and"
+        result = not settling
+        for operand in self.operands:
+            value = operand.matches(directive, context_id, semantics)
+            if value is settling:
+                return settling
+            if value is None:
+                result = None
+        return result
+
+
+@dataclass
+class _ContextRelation(_Predicate):
+    relation: str
+    condition: object
+
+    def matches(self, directive, context_id, semantics):
+        if self.relation == "implies":
+            return semantics.implies(context_id, self.condition)
+        return semantics.excludes(context_id, self.condition)
+
+
+@dataclass
+class _ContextIs(_Predicate):
+    state: str
+
+    def matches(self, directive, context_id, semantics):
+        if self.state == "global":
+            return semantics.is_global(context_id)
+        satisfiable = semantics.satisfiable(context_id)
+        if satisfiable is None:
+            return None
+        return satisfiable == (self.state == "satisfiable")
+
+
+@dataclass
+class _SymbolIs(_Predicate):
+    name: str
+
+    def matches(self, directive, context_id, semantics):
+        return directive.symbol_name == self.name
+
+
+@dataclass
+class _Matches(_Predicate):
+    attribute: str
+    pattern: str
+
+    def __post_init__(self):
+        if self.attribute == "symbol":
+            self._regex = re.compile(self.pattern)
+
+    def matches(self, directive, context_id, semantics):
+        if self.attribute == "symbol":
+            return directive.symbol_name is not None and bool(self._regex.search(directive.symbol_name))
+        return fnmatch.fnmatch(directive.file_path, self.pattern)
+
+
+@dataclass
+class Query:
+    """
+    A parsed query.
+
+    Attributes:
+        text: Query as written
+        target: Kind of directive selected (a TARGETS key)
+        predicate: Where clause, or None to select every directive of the kind
+    """
+    text: str
+    target: str
+    predicate: Optional[_Predicate] = None
+
+    def selects(self, directive: Directive) -> bool:
+        """Whether a directive is of the queried kind."""
+        types = TARGETS[self.target]
+        return types is None or directive.type in types
+
+
+def parse_query(text: str) -> Query:
+    """
+    Parse a query.
+
+    Grammar (keywords are case-sensitive):
+
+        query     := TARGET ['where' expr]
+        expr      := term ('or' term)*        term := factor ('and' factor)*
+        factor    := 'not' factor | '(' expr ')' | predicate
+        predicate := 'context' ('implies' | 'excludes') CONDITION
+                   | 'context' 'is' ['not'] ('satisfiable' | 'unsatisfiable' | 'global')
+                   | 'symbol' 'is' NAME | 'symbol' 'matches' 'REGEX'
+                   | 'file' 'matches' 'GLOB'
+
+    A CONDITION is an #if expression in which `and`, `or` and `not` may be
+    spelled out; it extends up to an `and`/`or` followed by another
+    predicate, or to an unmatched `)`. Unreachable contexts imply and
+    exclude nothing; `context is unsatisfiable` finds them.
+
+    Raises:
+        QuerySyntaxError: If the query is malformed
+    """
+    return _QueryParser(text).parse()
+
+
+class _QueryParser:
+
+    def __init__(self, text: str):
+        self.text = text
+        self.tokens: List[str] = []
+        position = 0
+        text = text.rstrip()
+        while position < len(text):
+            match = QUERY_TOKEN.match(text, position)
+            if not match or match.end() == position:
+                raise QuerySyntaxError(f"Unexpected character at {position + 1}: {text[position:position + 10]!r}")
+            self.tokens.append(match.group(match.lastindex))
+            position = match.end()
+        self.index = 0
+
+    def peek(self, offset: int = 0) -> Optional[str]:
+        index = self.index + offset
+        return self.tokens[index] if index < len(self.tokens) else None
+
+    def advance(self) -> str:
+        token = self.peek()
+        if token is None:
+            raise QuerySyntaxError("Unexpected end of query")
+        self.index += 1
+        return token
+
+    def expect(self, *words: str) -> str:
+        token = self.advance()
+        if token not in words:
+            raise QuerySyntaxError(f"Expected {' or '.join(repr(w) for w in words)}, got {token!r}")
+        return token
+
+    def parse(self) -> Query:
+        target = self.advance()
+        if target not in TARGETS:
+            raise QuerySyntaxError(f"Unknown query target {target!r} (expected one of {', '.join(TARGETS)})")
+        query = Query(self.text, target)
+        if self.peek() is not None:
+            self.expect("where")
+            query.predicate = self.parse_or()
+            if self.peek() is not None:
+                raise QuerySyntaxError(f"Unexpected {self.peek()!r}")
+        return query
+
+    def parse_or(self) -> _Predicate:
+        operands = [self.parse_and()]
+        while self.peek() == "or":
+            self.advance()
+            operands.append(self.parse_and())
+        return operands[0] if len(operands) == 1 else _Junction("or", operands)
+
+    def parse_and(self) -> _Predicate:
+        operands = [self.parse_factor()]
+        while self.peek() == "and":
+            self.advance()
+            operands.append(self.parse_factor())
+        return operands[0] if len(operands) == 1 else _Junction("and", operands)
+
+    def parse_factor(self) -> _Predicate:
+        token = self.advance()
+        if token == "not":
+            return _Not(self.parse_factor())
+        if token == "(":
+            predicate = self.parse_or()
+            self.expect(")")
+            return predicate
+        if token == "context":
+            relation = self.expect("implies", "excludes", "is")
+            if relation != "is":
+                return _ContextRelation(relation, self.parse_condition())
+            negated = self.peek() == "not"
+            if negated:
+                self.advance()
+            state = self.expect("satisfiable", "unsatisfiable", "global")
+            predicate = _ContextIs(state)
+            return _Not(predicate) if negated else predicate
+        if token == "symbol":
+            if self.expect("is", "matches") == "is":
+                return _SymbolIs(self.advance())
+            return _Matches("symbol", self.parse_string())
+        if token == "file":
+            self.expect("matches")
+            return _Matches("file", self.parse_string())
+        raise QuerySyntaxError(f"Expected a predicate, got {token!r}")
+
+    def parse_string(self) -> str:
+        token = self.advance()
+        if token[:1] in ("'", '"') and len(token) > 1:
+            return re.sub(r'\\(.)', r'\1', token[1:-1])
+        return token
+
+    def parse_condition(self):
+        parts = []
+        depth = 0
+        while self.peek() is not None:
+            token = self.peek()
+            if token == ")" and depth == 0:
+                break
+            if token in ("and", "or") and depth == 0 and self._predicate_follows(1):
+                break
+            depth += (token == "(") - (token == ")")
+            parts.append(CONDITION_WORDS.get(token, token))
+            self.index += 1
+        if not parts:
+            raise QuerySyntaxError("Expected a condition")
+        try:
+            return parse_condition(" ".join(parts))
+        except ConditionSyntaxError as e:
+            raise QuerySyntaxError(f"Invalid condition {' '.join(parts)!r}: {e}") from None
+
+    def _predicate_follows(self, offset: int) -> bool:
+        """Whether the tokens from an offset start a predicate (after any not or '(')."""
+        while self.peek(offset) in ("not", "("):
+            offset += 1
+        return self.peek(offset) in PREDICATE_WORDS
+
+
+@dataclass
+class QueryResult:
+    """
+    Directives a query selected.
+
+    Attributes:
+        query: Query as written
+        matches: Matching directives, in file order
+        directives: Directives of the queried kind that were tested
+        contexts: Distinct contexts among them
+        evaluations: Truth tables computed
+        undecided: Contexts too large to decide, which never match a predicate that depends on them, even negated
+    """
+    query: str
+    matches: List[Directive] = field(default_factory=list)
+    directives: int = 0
+    contexts: int = 0
+    evaluations: int = 0
+    undecided: int = 0
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert result to dictionary for serialization."""
+        return {
+            "query": self.query,
+            "matches": [d.to_dict() for d in self.matches],
+            "directives": self.directives,
+            "contexts": self.contexts,
+            "evaluations": self.evaluations,
+            "undecided": self.undecided
+        }
+
+
+def run_query(query: Query, directives: Iterable[Directive],
+              semantics: Optional[ContextSemantics] = None, limit: Optional[int] = None) -> QueryResult:
+    """
+    Select the directives a query matches.
+
+    Args:
+        query: Parsed query
+        directives: Directives with their contexts, from the context analyzer
+        semantics: Context memo to reuse across queries
+        limit: Stop after this many matches
+
+    Returns:
+        QueryResult with the matches and evaluation counts
+    """
+    semantics = semantics if semantics is not None else ContextSemantics()
+    evaluations = semantics.evaluations
+    result = QueryResult(query.text)
+    seen = set()
+    for directive in directives:
+        if not query.selects(directive):
+            continue
+        result.directives += 1
+        context_id = semantics.context_id(directive.context)
+        seen.add(context_id)
+        if query.predicate is None or query.predicate.matches(directive, context_id, semantics) is True:
+            result.matches.append(directive)
+            if limit is not None and len(result.matches) >= limit:
+                break
+    result.contexts = len(seen)
+    result.evaluations = semantics.evaluations - evaluations
+    result.undecided = len(seen & semantics.undecided)
+    return result
@@ -0,0 +1,238 @@
+"""
+Coverage mapping module.
+Joins gcov line coverage with the conditional context of every line, to find
+feature-flag contexts that tests never exercise. `.gcov` files are streamed
+line by line, so a dump holding many sources is never loaded whole, and each
+source's contexts are indexed once as sorted line intervals.
+"""
+
+import os
+from bisect import bisect_right
+from dataclasses import dataclass, field
+from typing import Any, Dict, Iterable, Iterator, List, Optional, Tuple
+
+from .data_models import Directive, DirectiveType
+
+
+# Directives after which the lines that follow run in a new context
+CONDITIONAL_TYPES = (DirectiveType.IF, DirectiveType.IFDEF, DirectiveType.IFNDEF,
+                     DirectiveType.ELIF, DirectiveType.ELSE, DirectiveType.ENDIF)
+
+GCOV_SOURCE = "Source:"
+# Counts gcov prints for executable lines that never ran
+UNEXECUTED_MARKS = ("#", "=", "%", "$")
+
+
+class ContextIntervals:
+    """
+    Conditional context of every line of one file.
+
+    Each conditional directive starts an interval, running to the next one,
+    whose lines share the directive's context; a line is looked up by
+    bisecting the interval starts. Contexts are joined with " && ", the
+    global context being "".
+    """
+
+    def __init__(self, starts: List[int], contexts: List[str]):
+        self.starts = starts
+        self.contexts = contexts
+
+    @classmethod
+    def from_directives(cls, directives: Iterable[Directive]) -> 'ContextIntervals':
+        """Index the contexts of a file from its directives, in file order."""
+        starts = [0]
+        contexts = [""]
+        for directive in directives:
+            if directive.type not in CONDITIONAL_TYPES:
+                continue
+            context = " && ".join(directive.context)
+            if context != contexts[-1]:
+                starts.append(directive.line_number + 1)
+                contexts.append(context)
+        return cls(starts, contexts)
+
+    def context_at(self, line_number: int) -> str:
+        """Get the context of a 1-based line."""
+        return self.contexts[bisect_right(self.starts, line_number) - 1]
+
+
+@dataclass
+class ContextCoverage:
+    """
+    Coverage of the lines under one conditional context, across files.
+
+    Attributes:
+        context: Conjunction of the enclosing conditions ("" for global code)
+        executable_lines: Lines gcov reports as executable
+        covered_lines: Executable lines that ran at least once
+        locations: (file, first executable line) of each file with the context
+    """
+    context: str
+    executable_lines: int = 0
+    covered_lines: int = 0
+    locations: List[Tuple[str, int]] = field(default_factory=list)
+
+    @property
+    def exercised(self) -> bool:
+        """Whether any line under the context ran."""
+        return self.covered_lines > 0
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert coverage to dictionary for serialization."""
+        return {
+            "context": self.context,
+            "executable_lines": self.executable_lines,
+            "covered_lines": self.covered_lines,
+            "locations": [{"file_path": path, "line_number": line} for path, line in self.locations]
+        }
+
+
+@dataclass
+class CoverageReport:
+    """
+    Line coverage grouped by conditional context.
+
+    Attributes:
+        contexts: Context mapped to its coverage
+        source_files: Sources with coverage data that could be analyzed
+        missing_files: Sources named in coverage data that were not found
+    """
+    contexts: Dict[str, ContextCoverage] = field(default_factory=dict)
+    source_files: List[str] = field(default_factory=list)
+    missing_files: List[str] = field(default_factory=list)
+
+    def unexercised(self) -> List[ContextCoverage]:
+        """Feature contexts with executable lines of which none ran, largest first."""
+        return sorted((c for c in self.contexts.values() if c.context and not c.exercised),
+                      key=lambda c: (-c.executable_lines, c.context))
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert report to dictionary for serialization."""
+        return {
+            "source_files": list(self.source_files),
+            "missing_files": list(self.missing_files),
+            "contexts": [c.to_dict() for c in self.contexts.values()],
+            "unexercised": [c.context for c in self.unexercised()]
+        }
+
+
+def parse_gcov(lines: Iterable[str]) -> Iterator[Tuple[str, int, Optional[bool]]]:
+    """
+    Stream the line records of gcov text output.
+
+    Several sources may follow each other, as in `gcov --stdout` dumps;
+    each starts with a `-: 0:Source:` header. Function, branch and call
+    summaries are skipped, and lines repeated in per-instantiation sections
+    are yielded again.
+
+    Args:
+        lines: Lines of one or more .gcov files
+
+    Yields:
+        (source as named in the header, line number, covered) where covered
+        is None for lines that are not executable
+    """
+    source = None
+    for line in lines:
+        count, separator, rest = line.partition(':')
+        if not separator:
+            continue
+        number, separator, text = rest.partition(':')
+        if not separator:
+            continue
+        number = number.strip()
+        if not number.isdigit():
+            continue
+        line_number = int(number)
+        count = count.strip()
+        if line_number == 0:
+            if text.startswith(GCOV_SOURCE):
+                source = text[len(GCOV_SOURCE):].rstrip('\r\n')
+            continue
+        if source is None or not count:
+            continue
+        if count == "-":
+            yield source, line_number, None
+        elif count[0] in UNEXECUTED_MARKS:
+            yield source, line_number, False
+        else:
+            yield source, line_number, count.rstrip('*').strip('0.') != ""
+
+
+class CoverageMapper:
+    """
+    Accumulates gcov coverage per conditional context.
+
+    Every source is analyzed once, the first time coverage names it, and
+    its context intervals are kept for the rest of the run. A line counts as
+    covered if it ran in any record for it.
+    """
+
+    def __init__(self, analyzer=None, source_root: Optional[str] = None):
+        if analyzer is None:
+            from .api import Analyzer
+            analyzer = Analyzer()
+        self.analyzer = analyzer
+        self.source_root = source_root
+        self._intervals: Dict[str, Optional[ContextIntervals]] = {}
+        # file -> line -> covered, for executable lines
+        self._lines: Dict[str, Dict[int, bool]] = {}
+        self._missing: Dict[str, None] = {}
+
+    def add_gcov_file(self, path: str) -> None:
+        """Add the coverage of a .gcov file, resolving sources against its directory."""
+        base_directory = self.source_root or os.path.dirname(os.path.abspath(path))
+        with open(path, 'r', encoding='utf-8', errors='replace') as f:
+            self.add_gcov_lines(f, base_directory)
+
+    def add_gcov_lines(self, lines: Iterable[str], base_directory: str = "") -> None:
+        """
+        Add coverage from gcov text output.
+
+        Args:
+            lines: Lines of one or more .gcov files
+            base_directory: Directory relative source names are resolved against
+        """
+        base_directory = base_directory or self.source_root or os.getcwd()
+        current_name = None
+        current: Optional[Dict[int, bool]] = None
+        for source, line_number, covered in parse_gcov(lines):
+            if covered is None:
+                continue
+            if source != current_name:
+                current_name = source
+                file_path = os.path.normpath(os.path.join(base_directory, source))
+                current = self._lines.setdefault(file_path, {}) if self._index(file_path) is not None else None
+            if current is not None:
+                current[line_number] = current.get(line_number, False) or covered
+
+    def report(self) -> CoverageReport:
+        """Group the accumulated coverage by context."""
+        report = CoverageReport(missing_files=list(self._missing))
+        for file_path, lines in self._lines.items():
+            report.source_files.append(file_path)
+            intervals = self._intervals[file_path]
+            seen = set()
+            for line_number in sorted(lines):
+                context = intervals.context_at(line_number)
+                coverage = report.contexts.get(context)
+                if coverage is None:
+                    coverage = report.contexts[context] = ContextCoverage(context)
+                coverage.executable_lines += 1
+                coverage.covered_lines += lines[line_number]
+                if context not in seen:
+                    seen.add(context)
+                    coverage.locations.append((file_path, line_number))
+        return report
+
+    def _index(self, file_path: str) -> Optional[ContextIntervals]:
+        """Get the context intervals of a source, analyzing it on first use."""
+        if file_path not in self._intervals:
+            intervals = None
+            if os.path.isfile(file_path):
+                result = self.analyzer.analyze_file(file_path)
+                intervals = ContextIntervals.from_directives(result.directives)
+            else:
+                self._missing[file_path] = None
+            self._intervals[file_path] = intervals
+        return self._intervals[file_path]
@@ -3,11 +3,42 @@ Data models for the C++ Preprocessor Directive Analysis Tool.
 Defines the core data structures used throughout the application.
 """
 
-from typing import List, Dict, Any, Optional
+import re
+from typing import List, Dict, Any, Optional, Set
 from dataclasses import dataclass, field
 from enum import Enum
 
 
+# A condition that needs no parentheses when negated or combined with &&
+CONDITION_ATOM = re.compile(r'^(?:[A-Za-z_]\w*|defined\s*\(\s*[A-Za-z_]\w*\s*\)|defined\s+[A-Za-z_]\w*)$')
+
+
+def negate_condition(condition: str) -> str:
+    """Negate a condition string, parenthesizing it unless it is a single atom."""
+    condition = condition.strip()
+    if CONDITION_ATOM.match(condition):
+        return f"!{condition}"
+    if condition.startswith("!") and CONDITION_ATOM.match(condition[1:].strip()):
+        return condition[1:].strip()
+    return f"!({condition})"
+
+
+def _conjunct(condition: str) -> str:
+    """Parenthesize a condition for use as an operand of &&, unless it is already safe."""
+    if CONDITION_ATOM.match(condition.lstrip("!").strip()):
+        return condition
+    body = condition[1:] if condition.startswith("!") else condition
+    if body.startswith("(") and body.endswith(")"):
+        depth = 0
+        for index, char in enumerate(body):
+            depth += {"(": 1, ")": -1}.get(char, 0)
+            if depth == 0:
+                if index == len(body) - 1:
+                    return condition
+                break
+    return f"({condition})"
+
+
 class DirectiveType(Enum):
     """Enumeration of preprocessor directive types."""
     DEFINE = "define"
@@ -19,6 +50,9 @@ class DirectiveType(Enum):
     ENDIF = "endif"
     UNDEF = "undef"
     INCLUDE = "include"
+    ERROR = "error"
+    WARNING = "warning"
+    PRAGMA = "pragma"
     UNKNOWN = "unknown"
 
 
@@ -63,6 +97,19 @@ class Directive:
             "symbol_name": self.symbol_name
         }
 
+    @classmethod
+    def from_dict(cls, data: Dict[str, Any]) -> 'Directive':
+        """Create a directive from its dictionary form."""
+        return cls(
+            type=DirectiveType(data["type"]),
+            content=data.get("content", ""),
+            line_number=data.get("line_number", 0),
+            file_path=data.get("file_path", ""),
+            condition=data.get("condition"),
+            context=list(data.get("context", [])),
+            symbol_name=data.get("symbol_name")
+        )
+
 
 @dataclass
 class ContextStack:
@@ -72,11 +119,14 @@ class ContextStack:
     Attributes:
         conditions: Stack of active conditions
         negations: Whether each condition is negated
+        previous: Conditions of the earlier branches of each block (already
+            negated where their branch was), which the current branch excludes
         depth: Current nesting depth
         file_context: Current file being processed
     """
     conditions: List[str] = field(default_factory=list)
     negations: List[bool] = field(default_factory=list)
+    previous: List[List[str]] = field(default_factory=list)
     depth: int = 0
     file_context: str = ""
 
@@ -84,6 +134,7 @@ class ContextStack:
         """Push a new condition onto the stack."""
         self.conditions.append(condition)
         self.negations.append(negated)
+        self.previous.append([])
         self.depth += 1
 
     def pop_condition(self) -> Optional[str]:
@@ -91,18 +142,33 @@ class ContextStack:
         if self.depth > 0:
             condition = self.conditions.pop()
             self.negations.pop()
+            self.previous.pop()
             self.depth -= 1
             return condition
         return None
 
+    def next_branch(self, condition: str) -> None:
+        """Replace the top condition with an #elif condition, excluding the branches before it."""
+        self.previous[-1].append(self._branch_condition(len(self.conditions) - 1))
+        self.conditions[-1] = condition
+        self.negations[-1] = False
+
+    def _branch_condition(self, level: int) -> str:
+        condition = self.conditions[level]
+        return negate_condition(condition) if self.negations[level] else condition
+
     def get_current_context(self) -> List[str]:
-        """Get the current context as a list of condition strings."""
+        """
+        Get the current context as a list of condition strings, one per block.
+
+        A branch after #elif or #else is the conjunction of its own condition
+        and the negation of each earlier branch of its block.
+        """
         context = []
-        for i, condition in enumerate(self.conditions):
-            if self.negations[i]:
-                context.append(f"!{condition}")
-            else:
-                context.append(condition)
+        for level in range(len(self.conditions)):
+            terms = [negate_condition(condition) for condition in self.previous[level]]
+            terms.append(self._branch_condition(level))
+            context.append(terms[0] if len(terms) == 1 else " && ".join(_conjunct(term) for term in terms))
         return context
 
     def get_context_expression(self) -> str:
@@ -110,25 +176,79 @@ class ContextStack:
         if not self.conditions:
             return ""
         
-        expressions = []
-        for i, condition in enumerate(self.conditions):
-            if self.negations[i]:
-                expressions.append(f"!{condition}")
-            else:
-                expressions.append(condition)
-        
-        return " && ".join(expressions)
+        context = self.get_current_context()
+        if len(context) == 1:
+            return context[0]
+        return " && ".join(_conjunct(condition) for condition in context)
 
     def copy(self) -> 'ContextStack':
         """Create a deep copy of the context stack."""
         return ContextStack(
             conditions=self.conditions.copy(),
             negations=self.negations.copy(),
+            previous=[branches.copy() for branches in self.previous],
             depth=self.depth,
             file_context=self.file_context
         )
 
 
+@dataclass
+class Configuration:
+    """
+    Represents a build configuration: the macros predefined for a translation unit.
+    
+    Attributes:
+        name: Human-readable configuration name
+        defines: Predefined macros mapped to their replacement text ("" for no value)
+        undefs: Macros explicitly undefined (-U) after the defines are applied
+        include_paths: Include search directories (-I) in search order
+    """
+    name: str = "default"
+    defines: Dict[str, str] = field(default_factory=dict)
+    undefs: List[str] = field(default_factory=list)
+    include_paths: List[str] = field(default_factory=list)
+
+    def initial_macros(self) -> Dict[str, str]:
+        """Get the macro table a translation unit starts with."""
+        macros = dict(self.defines)
+        for symbol in self.undefs:
+            macros.pop(symbol, None)
+        return macros
+
+    @classmethod
+    def from_flags(cls, defines: List[str], undefs: List[str] = None,
+                   name: str = "default") -> 'Configuration':
+        """
+        Create a configuration from compiler-style NAME[=VALUE] define flags.
+        
+        A define without a value gets the value 1, as with -DNAME.
+        """
+        macros = {}
+        for flag in defines:
+            symbol, has_value, value = flag.partition('=')
+            macros[symbol.strip()] = value if has_value else "1"
+        return cls(name=name, defines=macros, undefs=list(undefs or []))
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert configuration to dictionary for serialization."""
+        return {
+            "name": self.name,
+            "defines": dict(self.defines),
+            "undefs": list(self.undefs),
+            "include_paths": list(self.include_paths)
+        }
+
+    @classmethod
+    def from_dict(cls, data: Dict[str, Any]) -> 'Configuration':
+        """Create a configuration from its dictionary form."""
+        return cls(
+            name=data.get("name", "default"),
+            defines=dict(data.get("defines", {})),
+            undefs=list(data.get("undefs", [])),
+            include_paths=list(data.get("include_paths", []))
+        )
+
+
 @dataclass
 class ValidationError:
     """
@@ -173,6 +293,8 @@ class FileAnalysisResult:
         errors: List of validation errors found
         line_count: Total number of lines in the file
         directive_count: Total number of directives found
+        dependencies: Symbol dependencies found by context analysis; merged
+            into AnalysisResult.dependency_graph rather than serialized per file
     """
     file_path: str
     directives: List[Directive] = field(default_factory=list)
@@ -180,6 +302,7 @@ class FileAnalysisResult:
     errors: List[ValidationError] = field(default_factory=list)
     line_count: int = 0
     directive_count: int = 0
+    dependencies: Dict[str, Set[str]] = field(default_factory=dict, repr=False, compare=False)
 
     def add_directive(self, directive: Directive) -> None:
         """Add a directive to the results."""
@@ -215,7 +338,9 @@ class AnalysisResult:
         total_files: Total number of files processed
         total_directives: Total number of directives found
         total_defines: Total number of define directives found
-        conditions_usage: Dictionary mapping conditions to usage count
+        conditions_usage: Dictionary mapping canonical conditions to usage count
+        atoms_usage: Dictionary mapping condition atoms to the number of
+            conditions using them
         dependency_graph: Symbol dependency relationships
         validation_errors: All validation errors found
     """
@@ -224,22 +349,38 @@ class AnalysisResult:
     total_directives: int = 0
     total_defines: int = 0
     conditions_usage: Dict[str, int] = field(default_factory=dict)
+    atoms_usage: Dict[str, int] = field(default_factory=dict)
     dependency_graph: Dict[str, List[str]] = field(default_factory=dict)
     validation_errors: List[ValidationError] = field(default_factory=list)
 
     def add_file_result(self, result: FileAnalysisResult) -> None:
-        """Add a file analysis result to the overall results."""
+        """
+        Add a file analysis result to the overall results.
+
+        This is the only place per-file results are combined, so files can
+        be analyzed independently (and concurrently) and reduced here in any
+        thread that owns the AnalysisResult.
+        """
+        # Canonicalize conditions first, so a failure leaves the totals untouched
+        from .condition_normalizer import condition_atoms, directive_condition
+        conditions = [c for c in map(directive_condition, result.directives) if c is not None]
+        atoms = [atom for condition in conditions for atom in condition_atoms(condition)]
+
         self.file_results[result.file_path] = result
         self.total_files += 1
         self.total_directives += result.directive_count
         self.total_defines += len(result.defines)
         self.validation_errors.extend(result.errors)
 
-        # Update conditions usage count
-        for directive in result.directives:
-            if directive.condition:
-                self.conditions_usage[directive.condition] = \
-                    self.conditions_usage.get(directive.condition, 0) + 1
+        for symbol, dependencies in result.dependencies.items():
+            merged = self.dependency_graph.setdefault(symbol, [])
+            merged.extend(sorted(dependencies.difference(merged)))
+
+        # Update usage counts; equivalent spellings share one canonical key
+        for condition in conditions:
+            self.conditions_usage[condition] = self.conditions_usage.get(condition, 0) + 1
+        for atom in atoms:
+            self.atoms_usage[atom] = self.atoms_usage.get(atom, 0) + 1
 
     def get_all_defines(self) -> List[Directive]:
         """Get all define directives from all files."""
@@ -267,6 +408,7 @@ class AnalysisResult:
             "total_directives": self.total_directives,
             "total_defines": self.total_defines,
             "conditions_usage": self.conditions_usage,
+            "atoms_usage": self.atoms_usage,
             "dependency_graph": self.dependency_graph,
             "validation_errors": [e.to_dict() for e in self.validation_errors]
         }
\ No newline at end of file
@@ -0,0 +1,234 @@
+"""
+Feature model module.
+Encodes what the preprocessor directives say about valid configurations as a
+propositional formula in conjunctive normal form, for SAT-based tools:
+#error conditions must be false, and a macro defined under a condition is
+defined whenever that condition holds. Conditions are Tseitin-encoded, so the
+formula grows linearly with the size of the expressions.
+"""
+
+from dataclasses import dataclass, field
+from typing import Any, Dict, Iterable, List, Optional, Set, Tuple, Union
+
+from .condition_parser import (
+    Binary, Call, ConditionSyntaxError, Conditional, Defined, Identifier, Number, Unary,
+    format_condition, parse_condition, referenced_symbols
+)
+from .configuration_space import ConfigurationSpace, branch_conditions
+from .configuration_evaluator import split_define
+from .data_models import Configuration, DirectiveType, FileAnalysisResult
+
+
+# A literal is a signed DIMACS variable index, or a constant after folding
+Literal = Union[int, bool]
+
+
+@dataclass
+class CnfFormula:
+    """
+    A formula in conjunctive normal form.
+
+    Attributes:
+        variables: Named variables (feature macros and opaque conditions) mapped
+            to their DIMACS index; Tseitin auxiliaries are unnamed
+        variable_count: Number of variables, auxiliaries included
+        clauses: Clauses as tuples of signed variable indices
+    """
+    variables: Dict[str, int] = field(default_factory=dict)
+    variable_count: int = 0
+    clauses: List[Tuple[int, ...]] = field(default_factory=list)
+
+    def to_dimacs(self) -> str:
+        """Render the formula as DIMACS CNF, with the variable map as comments."""
+        lines = [f"c {index} {name}" for name, index in sorted(self.variables.items(), key=lambda x: x[1])]
+        lines.append(f"p cnf {self.variable_count} {len(self.clauses)}")
+        lines.extend(" ".join(map(str, clause + (0,))) for clause in self.clauses)
+        return "\n".join(lines) + "\n"
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert formula to dictionary for serialization."""
+        return {
+            "variables": dict(self.variables),
+            "variable_count": self.variable_count,
+            "clause_count": len(self.clauses)
+        }
+
+
+class TseitinEncoder:
+    """
+    Builds a CnfFormula from condition expression trees.
+
+    `defined(X)` and a bare `X` both map to the variable X, matching the
+    configuration space where each feature is either undefined or 1.
+    Comparisons, arithmetic and calls are not modeled; each distinct one
+    becomes an opaque variable named by its canonical text. And/or gates
+    are shared between identical operand sets.
+    """
+
+    def __init__(self):
+        self.formula = CnfFormula()
+        self._gates: Dict[Tuple[int, ...], int] = {}
+
+    def variable(self, name: str) -> int:
+        """Get the variable of a feature or opaque condition, creating it if needed."""
+        index = self.formula.variables.get(name)
+        if index is None:
+            index = self._new_variable()
+            self.formula.variables[name] = index
+        return index
+
+    def add_clause(self, literals: Iterable[Literal]) -> None:
+        """Add a clause, dropping false literals and skipping satisfied clauses."""
+        clause = []
+        for literal in literals:
+            if literal is True:
+                return
+            if literal is not False:
+                clause.append(literal)
+        self.formula.clauses.append(tuple(clause))
+
+    def require(self, condition: str) -> None:
+        """Add the constraint that a condition holds."""
+        self.add_clause([self.encode(parse_condition(condition))])
+
+    def forbid(self, condition: str) -> None:
+        """Add the constraint that a condition never holds."""
+        self.add_clause([_negate(self.encode(parse_condition(condition)))])
+
+    def implies(self, condition: str, literal: Literal) -> None:
+        """Add the constraint that a condition implies a literal."""
+        self.add_clause([_negate(self.encode(parse_condition(condition))), literal])
+
+    def encode(self, node) -> Literal:
+        """
+        Get a literal equivalent to an expression tree used as a truth value.
+
+        Returns:
+            Signed variable index, or True/False when the expression folds
+        """
+        if isinstance(node, Number):
+            return node.value != 0
+        if isinstance(node, (Defined, Identifier)):
+            return self.variable(node.name)
+        if isinstance(node, Unary) and node.op == '!':
+            return _negate(self.encode(node.operand))
+        if isinstance(node, Binary) and node.op in ('&&', '||'):
+            operands = [self.encode(operand) for operand in _flatten(node)]
+            if node.op == '&&':
+                return self._and(operands)
+            return _negate(self._and([_negate(operand) for operand in operands]))
+        if isinstance(node, Conditional):
+            condition = self.encode(node.cond)
+            then = self._and([condition, self.encode(node.then)])
+            otherwise = self._and([_negate(condition), self.encode(node.otherwise)])
+            return _negate(self._and([_negate(then), _negate(otherwise)]))
+        if isinstance(node, (Unary, Binary, Call)):
+            return self.variable(format_condition(node))
+        raise ConditionSyntaxError(f"Cannot encode node {node!r}")
+
+    def _and(self, operands: List[Literal]) -> Literal:
+        """Literal for the conjunction of operands, with a gate per distinct operand set."""
+        literals: Set[int] = set()
+        for operand in operands:
+            if operand is False:
+                return False
+            if operand is not True:
+                literals.add(operand)
+        if any(-literal in literals for literal in literals):
+            return False
+        if not literals:
+            return True
+        if len(literals) == 1:
+            return next(iter(literals))
+
+        key = tuple(sorted(literals))
+        gate = self._gates.get(key)
+        if gate is None:
+            gate = self._new_variable()
+            self._gates[key] = gate
+            clauses = self.formula.clauses
+            # gate <-> l1 & ... & ln
+            for literal in key:
+                clauses.append((-gate, literal))
+            clauses.append((gate,) + tuple(-literal for literal in key))
+        return gate
+
+    def _new_variable(self) -> int:
+        self.formula.variable_count += 1
+        return self.formula.variable_count
+
+
+def _negate(literal: Literal) -> Literal:
+    if isinstance(literal, bool):
+        return not literal
+    return -literal
+
+
+def _flatten(node: Binary) -> List[object]:
+    """Operands of a chain of the same && or || operator, in order, without recursing."""
+    operands = []
+    stack = [node]
+    while stack:
+        current = stack.pop()
+        if isinstance(current, Binary) and current.op == node.op:
+            stack.append(current.right)
+            stack.append(current.left)
+        else:
+            operands.append(current)
+    return operands
+
+
+def build_feature_model(file_results: Iterable[FileAnalysisResult],
+                        base: Optional[Configuration] = None) -> CnfFormula:
+    """
+    Encode the configuration constraints of a set of files as CNF.
+
+    Variables 1..n are the feature macros of the files' ConfigurationSpace,
+    in sorted order; macros the files define conditionally follow. A
+    variable is true when its macro is defined. Clauses state that:
+      - no #error condition holds;
+      - a macro defined under some condition is defined when it holds
+        (skipped for macros that are ever #undef'd, where it need not, and
+        for `#ifndef NAME` defaults, which hold either way);
+      - macros given with -D / -U in base are defined / undefined.
+    Conditions that cannot be parsed contribute nothing.
+
+    Args:
+        file_results: Parsed files
+        base: Configuration whose defines and undefs are fixed
+
+    Returns:
+        CnfFormula with the feature variable map
+    """
+    file_results = list(file_results)
+    space = ConfigurationSpace.from_file_results(file_results)
+    encoder = TseitinEncoder()
+    features = set(space.symbols)
+    for symbol in space.symbols:
+        encoder.variable(symbol)
+
+    for constraint in space.constraints:
+        encoder.forbid(constraint.condition)
+
+    undefined = {d.symbol_name for result in file_results for d in result.directives
+                 if d.type == DirectiveType.UNDEF}
+    for file_result in file_results:
+        for directive, condition in branch_conditions(file_result.directives):
+            if directive.type != DirectiveType.DEFINE:
+                continue
+            name = split_define(directive.content)[0]
+            if not name or name in undefined or (condition == "1" and name not in features):
+                continue
+            try:
+                if name in referenced_symbols(parse_condition(condition)):
+                    continue  # #ifndef NAME default: defined either way
+                encoder.implies(condition, encoder.variable(name))
+            except ConditionSyntaxError:
+                continue
+
+    if base is not None:
+        for name in base.initial_macros():
+            encoder.add_clause([encoder.variable(name)])
+        for name in base.undefs:
+            encoder.add_clause([-encoder.variable(name)])
+    return encoder.formula
@@ -117,6 +117,30 @@ class FileScanner:
         
         return files
     
+    def accepts(self,
+                path: str,
+                include_headers: bool = False,
+                exclude_patterns: List[str] = None,
+                directory: bool = False) -> bool:
+        """
+        Check whether a path found outside the filesystem would be scanned.
+
+        Applies the same extension and exclude rules as scan to names read
+        from other sources, such as git trees or archive members.
+
+        Args:
+            path: Path of the file or directory, relative or absolute
+            include_headers: Whether header files are scanned
+            exclude_patterns: List of glob patterns to exclude
+            directory: Whether the path is a directory to descend into
+
+        Returns:
+            True if the file would be analyzed, or the directory descended into
+        """
+        if self._should_exclude(path, exclude_patterns or []):
+            return False
+        return directory or self._is_cpp_file(path, self.get_supported_extensions(include_headers))
+
     def _is_cpp_file(self, file_path: str, extensions: Set[str]) -> bool:
         """
         Check if a file is a C++ source file based on its extension.
@@ -0,0 +1,188 @@
+"""
+Filter table file module.
+Writes the per-file Bloom filters of an analysis to their own file, with
+the byte range of each file's results in the saved analysis JSON, and tests
+a memory map of it. A mention query therefore touches only the filters and
+then parses just the results of the files that pass, instead of loading
+the whole analysis first.
+"""
+
+import json
+import mmap
+import os
+import struct
+from typing import Dict, Iterable, List, Optional, Tuple
+
+from .bloom_filter import FileFilterIndex, bit_positions, symbol_hashes
+from .symbol_table import STRING_LENGTH
+
+
+MAGIC = b"PPFILTER"
+VERSION = 1
+# Set when code lines were scanned as well as directives
+CODE_USAGE = 1
+# magic, version, flags, false positive rate, file count, size of the
+# analysis file, its path string ref, and the offsets of the record, bits
+# and string regions
+HEADER = struct.Struct('<8sIIdQQQQQQ')
+# path string ref, bits offset, size in bits, hash count, and the offset
+# and length of the file's results in the analysis file
+RECORD = struct.Struct('<QQQQQQ')
+
+
+class FilterTable(FileFilterIndex):
+    """
+    Read-only FileFilterIndex over a memory-mapped filter table file.
+
+    The file is a header, one record per file in analysis order, the filter
+    bits of every file, and a region of length-prefixed strings. The path
+    of the analysis the records point into is stored relative to the
+    table's directory, with its size to detect that it was rewritten.
+    """
+
+    def __init__(self, path: str):
+        with open(path, 'rb') as f:
+            try:
+                self._map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+            except ValueError:
+                raise ValueError(f"'{path}' is not a filter table") from None
+        if len(self._map) < HEADER.size:
+            self._map.close()
+            raise ValueError(f"'{path}' is not a filter table")
+        (magic, version, flags, self.false_positive_rate, self.file_count, self._analysis_size,
+         analysis_ref, self._records, self._bits, self._strings) = HEADER.unpack_from(self._map, 0)
+        if magic != MAGIC or version != VERSION:
+            self._map.close()
+            raise ValueError(f"'{path}' is not a version {VERSION} filter table")
+        self.code_usage = bool(flags & CODE_USAGE)
+        self.analysis_path = os.path.join(os.path.dirname(path), self._string(analysis_ref))
+        self._spans: Dict[str, Tuple[int, int]] = {}
+        self._analysis = None
+
+    def close(self) -> None:
+        """Unmap the file and close the analysis, if it was read."""
+        if self._analysis is not None:
+            self._analysis.close()
+        self._map.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc_info):
+        self.close()
+
+    def __len__(self) -> int:
+        return self.file_count
+
+    def add_file(self, file_path, identifiers) -> None:
+        raise TypeError("filter tables are read-only")
+
+    def candidates(self, symbols: Iterable[str], any_symbol: bool = False) -> List[str]:
+        """
+        Files whose filters may hold every symbol (or any, with any_symbol).
+
+        Bits are tested in place in the mapped file; only the paths of
+        files that pass are decoded.
+        """
+        hashes = [symbol_hashes(symbol) for symbol in symbols]
+        test = any if any_symbol else all
+        shapes: Dict[Tuple[int, int], List[List[int]]] = {}
+        data = self._map
+        result = []
+        for number in range(self.file_count):
+            path_ref, bits, size, hash_count, offset, length = RECORD.unpack_from(
+                data, self._records + number * RECORD.size)
+            shape = (size, hash_count)
+            positions = shapes.get(shape)
+            if positions is None:
+                positions = shapes[shape] = [bit_positions(h, *shape) for h in hashes]
+            start = self._bits + bits
+            if test(all(data[start + (p >> 3)] & (1 << (p & 7)) for p in symbol_positions)
+                    for symbol_positions in positions):
+                file_path = self._string(path_ref)
+                self._spans[file_path] = (offset, length)
+                result.append(file_path)
+        return result
+
+    def file_data(self, file_path: str) -> Optional[dict]:
+        """
+        Read one file's saved results from the analysis, by its byte range.
+
+        Returns:
+            The file's entry of the analysis "file_results", or None when
+            the file has no record
+        """
+        span = self._spans.get(file_path)
+        if span is None:
+            for number in range(self.file_count):
+                record = RECORD.unpack_from(self._map, self._records + number * RECORD.size)
+                if self._string(record[0]) == file_path:
+                    span = self._spans[file_path] = record[4:]
+                    break
+            else:
+                return None
+        if self._analysis is None:
+            analysis = open(self.analysis_path, 'rb')
+            if os.fstat(analysis.fileno()).st_size != self._analysis_size:
+                analysis.close()
+                raise ValueError(f"'{self.analysis_path}' changed since its filters were written")
+            self._analysis = analysis
+        offset, length = span
+        self._analysis.seek(offset)
+        return json.loads(self._analysis.read(length))
+
+    def _string(self, ref: int) -> str:
+        start = self._strings + ref
+        length = STRING_LENGTH.unpack_from(self._map, start)[0]
+        start += STRING_LENGTH.size
+        return self._map[start:start + length].decode('utf-8', errors='surrogateescape')
+
+
+def write_filter_table(index: FileFilterIndex, spans: Dict[str, Tuple[int, int]],
+                       analysis_path: str, path: str) -> int:
+    """
+    Write per-file Bloom filters as a filter table file.
+
+    The file is written next to its destination and renamed over it, so
+    processes that have the previous table mapped keep a consistent view.
+
+    Args:
+        index: In-memory FileFilterIndex
+        spans: Byte offset and length of each file's results in the analysis
+        analysis_path: Saved analysis JSON the spans point into
+        path: Destination file
+
+    Returns:
+        Number of files written
+    """
+    strings = bytearray()
+
+    def intern(text: str) -> int:
+        ref = len(strings)
+        encoded = text.encode('utf-8', errors='surrogateescape')
+        strings.extend(STRING_LENGTH.pack(len(encoded)))
+        strings.extend(encoded)
+        return ref
+
+    analysis_ref = intern(os.path.relpath(os.path.abspath(analysis_path),
+                                          os.path.dirname(os.path.abspath(path))))
+    records = bytearray()
+    bits = bytearray()
+    for file_path, bloom in index.filters.items():
+        offset, length = spans[file_path]
+        records.extend(RECORD.pack(intern(file_path), len(bits), bloom.size, bloom.hash_count, offset, length))
+        bits.extend(bloom.bits)
+
+    records_offset = HEADER.size
+    bits_offset = records_offset + len(records)
+    strings_offset = bits_offset + len(bits)
+    temporary = f"{path}.tmp{os.getpid()}"
+    with open(temporary, 'wb') as f:
+        f.write(HEADER.pack(MAGIC, VERSION, CODE_USAGE if index.code_usage else 0, index.false_positive_rate,
+                            len(index.filters), os.path.getsize(analysis_path), analysis_ref,
+                            records_offset, bits_offset, strings_offset))
+        f.write(records)
+        f.write(bits)
+        f.write(strings)
+    os.replace(temporary, path)
+    return len(index.filters)
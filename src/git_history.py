@@ -0,0 +1,386 @@
+"""
+Git history module.
+Computes preprocessor metrics for every commit in a range of a git
+repository, and reads the files of a single revision, without checking
+anything out. Commits, trees and blobs are read through one persistent
+`git cat-file --batch` process; when mining history each blob is parsed at
+most once (its metrics are cached by object id) and each subtree's totals
+are cached by path and tree id, so a commit only costs the files and
+directories it changed.
+"""
+
+import os
+import subprocess
+from dataclasses import dataclass
+from typing import Any, Callable, Dict, FrozenSet, Iterator, List, Optional, Tuple
+
+from .condition_normalizer import directive_condition
+from .condition_parser import ConditionSyntaxError, parse_condition, referenced_symbols
+from .data_models import DirectiveType, ErrorSeverity, FileAnalysisResult
+from .file_scanner import FileScanner
+
+
+# Directives that open a conditional block
+CONDITIONAL_TYPES = {DirectiveType.IF, DirectiveType.IFDEF, DirectiveType.IFNDEF}
+# Tree entry modes of subdirectories and regular files (submodules and
+# symlinks are skipped)
+TREE_MODE = b"40000"
+FILE_MODES = {b"100644", b"100755"}
+
+
+class GitError(RuntimeError):
+    """Raised when git cannot read the repository or an object."""
+
+
+class GitObjectReader:
+    """
+    Reads objects from a repository through a persistent `git cat-file --batch`.
+
+    One process serves every read, so reading a commit's changed blobs costs
+    a pipe round trip each instead of a process start.
+    """
+
+    def __init__(self, repository: str, git: str = "git"):
+        self.repository = repository
+        self.git = git
+        try:
+            self._process = subprocess.Popen(
+                [git, "-C", repository, "cat-file", "--batch"],
+                stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL
+            )
+        except OSError as e:
+            raise GitError(f"Cannot run {git}: {e}") from None
+
+    def read(self, name: str) -> Tuple[str, bytes]:
+        """
+        Read an object.
+
+        Args:
+            name: Object id, or any name cat-file accepts (e.g. "HEAD^{tree}")
+
+        Returns:
+            (object type, raw contents)
+
+        Raises:
+            GitError: If the object does not exist
+        """
+        self._process.stdin.write(name.encode('utf-8') + b"\n")
+        self._process.stdin.flush()
+        header = self._process.stdout.readline()
+        if not header:
+            raise GitError(f"git cat-file exited while reading '{name}'")
+        parts = header.split()
+        if len(parts) != 3:
+            raise GitError(f"Cannot read object '{name}': {header.decode('utf-8', 'replace').strip()}")
+        size = int(parts[2])
+        data = self._process.stdout.read(size)
+        self._process.stdout.read(1)  # Newline after the contents
+        return parts[1].decode('ascii'), data
+
+    def rev_list(self, revision: str = "HEAD", max_count: Optional[int] = None,
+                 first_parent: bool = False) -> List[str]:
+        """Commit ids reachable from a revision, newest first."""
+        command = [self.git, "-C", self.repository, "rev-list"]
+        if max_count is not None:
+            command.append(f"--max-count={max_count}")
+        if first_parent:
+            command.append("--first-parent")
+        command.extend([revision, "--"])
+        completed = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        if completed.returncode != 0:
+            raise GitError(completed.stderr.decode('utf-8', 'replace').strip() or f"git rev-list {revision} failed")
+        return completed.stdout.decode('ascii').split()
+
+    def close(self) -> None:
+        """Stop the cat-file process."""
+        if self._process.poll() is None:
+            self._process.stdin.close()
+            self._process.wait()
+        self._process.stdout.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc_info):
+        self.close()
+
+
+def parse_tree(data: bytes, id_length: int = 20) -> List[Tuple[bytes, str, str]]:
+    """
+    Split raw tree contents into entries.
+
+    Args:
+        data: Tree object contents
+        id_length: Bytes per object id (20 for SHA-1, 32 for SHA-256 repositories)
+
+    Returns:
+        (mode, name, object id) per entry
+    """
+    entries = []
+    position = 0
+    end = len(data)
+    while position < end:
+        space = data.index(b" ", position)
+        null = data.index(b"\0", space)
+        object_id = data[null + 1:null + 1 + id_length].hex()
+        entries.append((data[position:space], data[space + 1:null].decode('utf-8', 'surrogateescape'), object_id))
+        position = null + 1 + id_length
+    return entries
+
+
+def iter_tree_sources(path: str, revision: str,
+                      include_headers: bool = False,
+                      exclude_patterns: Optional[List[str]] = None,
+                      git: str = "git") -> Iterator[Tuple[str, List[str]]]:
+    """
+    Yield the C++ files of a directory as of a git revision, without checking it out.
+
+    Args:
+        path: Directory inside a repository
+        revision: Commit whose tree is read
+        include_headers: Whether header files are yielded
+        exclude_patterns: Glob patterns matched against paths relative to path
+        git: git executable
+
+    Yields:
+        (path joined with the file's relative path, its lines), each
+        directory's files before its subdirectories
+    """
+    from .archive_reader import decode_lines
+    scanner = FileScanner()
+    exclude_patterns = exclude_patterns or []
+    with GitObjectReader(path, git) as reader:
+        commits = reader.rev_list(revision, max_count=1)
+        if not commits:
+            raise GitError(f"'{revision}' does not name a commit")
+        id_length = len(commits[0]) // 2
+        # <rev>:./ is the tree of the reader's working directory, i.e. path
+        object_type, data = reader.read(f"{commits[0]}:./")
+        if object_type != "tree":
+            raise GitError(f"'{path}' is not a directory at {revision}")
+        stack = [("", data)]
+        while stack:
+            prefix, data = stack.pop()
+            subtrees = []
+            for mode, name, object_id in parse_tree(data, id_length):
+                relative = prefix + name
+                if mode == TREE_MODE:
+                    if scanner.accepts(relative, exclude_patterns=exclude_patterns, directory=True):
+                        subtrees.append((relative + "/", object_id))
+                elif mode in FILE_MODES and scanner.accepts(relative, include_headers, exclude_patterns):
+                    yield os.path.join(path, relative), decode_lines(reader.read(object_id)[1])
+            for subtree_prefix, object_id in reversed(subtrees):
+                stack.append((subtree_prefix, reader.read(object_id)[1]))
+
+
+@dataclass(frozen=True)
+class TreeMetrics:
+    """
+    Preprocessor metrics of a file or of every analyzed file under a tree.
+
+    Attributes:
+        files: Files analyzed
+        directives: Directives found
+        conditionals: #if, #ifdef and #ifndef directives
+        flags: Distinct macros tested by conditions
+        max_depth: Deepest conditional nesting
+        errors: Errors (not warnings) the analyzer attached to the files
+    """
+    files: int = 0
+    directives: int = 0
+    conditionals: int = 0
+    flags: FrozenSet[str] = frozenset()
+    max_depth: int = 0
+    errors: int = 0
+
+    @classmethod
+    def of_file(cls, result: FileAnalysisResult) -> 'TreeMetrics':
+        """Measure one analyzed file."""
+        flags = set()
+        conditionals = 0
+        for directive in result.directives:
+            if directive.type in CONDITIONAL_TYPES:
+                conditionals += 1
+            condition = directive_condition(directive)
+            if condition is not None:
+                try:
+                    flags.update(referenced_symbols(parse_condition(condition)))
+                except ConditionSyntaxError:
+                    pass
+        return cls(
+            files=1,
+            directives=result.directive_count,
+            conditionals=conditionals,
+            flags=frozenset(flags),
+            max_depth=max((len(d.context) for d in result.directives
+                           if d.type in CONDITIONAL_TYPES), default=0),
+            errors=sum(1 for e in result.errors if e.severity != ErrorSeverity.WARNING)
+        )
+
+    @classmethod
+    def total(cls, parts: List['TreeMetrics']) -> 'TreeMetrics':
+        """Combine the metrics of the files and subtrees of a tree."""
+        if len(parts) == 1:
+            return parts[0]
+        return cls(
+            files=sum(part.files for part in parts),
+            directives=sum(part.directives for part in parts),
+            conditionals=sum(part.conditionals for part in parts),
+            flags=frozenset().union(*(part.flags for part in parts)),
+            max_depth=max((part.max_depth for part in parts), default=0),
+            errors=sum(part.errors for part in parts)
+        )
+
+
+@dataclass
+class HistoryPoint:
+    """
+    Metrics of one commit.
+
+    Attributes:
+        commit: Commit id
+        timestamp: Committer time (seconds since the epoch)
+        subject: First line of the commit message
+        metrics: Totals over the commit's analyzed files
+        parsed_files: Blobs parsed for this commit, i.e. not seen in earlier commits
+    """
+    commit: str
+    timestamp: int
+    subject: str
+    metrics: TreeMetrics
+    parsed_files: int = 0
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert point to dictionary for serialization."""
+        return {
+            "commit": self.commit,
+            "timestamp": self.timestamp,
+            "subject": self.subject,
+            "files": self.metrics.files,
+            "directives": self.metrics.directives,
+            "conditionals": self.metrics.conditionals,
+            "flags": len(self.metrics.flags),
+            "max_depth": self.metrics.max_depth,
+            "errors": self.metrics.errors,
+            "parsed_files": self.parsed_files
+        }
+
+
+class HistoryMiner:
+    """
+    Time series of preprocessor metrics over the commits of a repository.
+
+    Blob metrics are cached by object id and subtree totals by (path, tree
+    id), across every commit mined by the same instance, so an unchanged
+    directory is not even listed again and a file seen in any earlier
+    commit is not parsed again.
+
+    Attributes:
+        parsed_blobs: Blobs parsed so far
+        cached_trees: Subtree totals reused so far
+    """
+
+    def __init__(self, repository: str, analyzer=None,
+                 include_headers: bool = False, exclude_patterns: Optional[List[str]] = None,
+                 git: str = "git"):
+        """
+        Args:
+            repository: Path inside the repository
+            analyzer: api.Analyzer used to parse and analyze blobs (by default
+                one that also validates, so errors include validation errors)
+            include_headers: Whether header files are analyzed
+            exclude_patterns: Glob patterns of repository paths to skip
+            git: git executable
+        """
+        if analyzer is None:
+            from .api import AnalysisOptions, Analyzer
+            analyzer = Analyzer(AnalysisOptions(validate=True))
+        self.analyzer = analyzer
+        self.include_headers = include_headers
+        self.exclude_patterns = exclude_patterns or []
+        self.scanner = FileScanner()
+        self.reader = GitObjectReader(repository, git)
+        self.parsed_blobs = 0
+        self.cached_trees = 0
+        self._id_length = 20
+        self._blobs: Dict[str, TreeMetrics] = {}
+        self._trees: Dict[Tuple[str, str], TreeMetrics] = {}
+
+    def close(self) -> None:
+        """Stop the git process."""
+        self.reader.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc_info):
+        self.close()
+
+    def mine(self, revision: str = "HEAD", max_count: Optional[int] = None,
+             first_parent: bool = False,
+             progress: Optional[Callable[[HistoryPoint], None]] = None) -> List[HistoryPoint]:
+        """
+        Measure the commits reachable from a revision.
+
+        Args:
+            revision: Newest commit (any revision git rev-list accepts)
+            max_count: Measure at most this many commits, the newest ones
+            first_parent: Follow only first parents, i.e. the mainline of merges
+            progress: Called with each point as it is measured
+
+        Returns:
+            One point per commit, oldest first
+        """
+        points = []
+        for commit in reversed(self.reader.rev_list(revision, max_count, first_parent)):
+            point = self.measure(commit)
+            points.append(point)
+            if progress is not None:
+                progress(point)
+        return points
+
+    def measure(self, commit: str) -> HistoryPoint:
+        """Measure one commit."""
+        object_type, data = self.reader.read(commit)
+        if object_type != "commit":
+            raise GitError(f"'{commit}' is a {object_type}, not a commit")
+        headers, _, message = data.partition(b"\n\n")
+        tree = None
+        timestamp = 0
+        for line in headers.split(b"\n"):
+            if line.startswith(b"tree "):
+                tree = line[5:].decode('ascii')
+            elif line.startswith(b"committer "):
+                timestamp = int(line.rsplit(b" ", 2)[1])
+        parsed = self.parsed_blobs
+        self._id_length = len(commit) // 2
+        metrics = self._tree(tree, "")
+        subject = message.split(b"\n", 1)[0].decode('utf-8', 'replace')
+        return HistoryPoint(commit, timestamp, subject, metrics, self.parsed_blobs - parsed)
+
+    def _tree(self, tree: str, prefix: str) -> TreeMetrics:
+        """Totals of a tree at a path, from the cache when seen before."""
+        key = (prefix, tree)
+        metrics = self._trees.get(key)
+        if metrics is not None:
+            self.cached_trees += 1
+            return metrics
+        parts = []
+        for mode, name, object_id in parse_tree(self.reader.read(tree)[1], self._id_length):
+            path = prefix + name
+            if mode == TREE_MODE:
+                if self.scanner.accepts(path, exclude_patterns=self.exclude_patterns, directory=True):
+                    parts.append(self._tree(object_id, path + "/"))
+            elif mode in FILE_MODES and self.scanner.accepts(path, self.include_headers, self.exclude_patterns):
+                parts.append(self._blob(object_id, path))
+        metrics = self._trees[key] = TreeMetrics.total(parts)
+        return metrics
+
+    def _blob(self, blob: str, path: str) -> TreeMetrics:
+        """Metrics of a file's contents, parsing them only the first time."""
+        metrics = self._blobs.get(blob)
+        if metrics is None:
+            text = self.reader.read(blob)[1].decode('utf-8', errors='ignore')
+            metrics = self._blobs[blob] = TreeMetrics.of_file(self.analyzer.analyze_buffer(text, path))
+            self.parsed_blobs += 1
+        return metrics
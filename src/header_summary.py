@@ -0,0 +1,560 @@
+"""
+Header summary module for computing effective macro tables per translation unit.
+Each file is preprocessed symbolically once per relevant input: its summary
+records which incoming macros its conditionals read and which macros it
+defines or undefines as a result. Summaries are cached by the values of the
+macros they read only, so translation units that differ in unrelated macros
+share all header work, much like compiler modules. Include guards count only
+where they change the result: a guarded header whose effects are already in
+place expands the same whether or not it is entered again.
+"""
+
+import re
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, Iterator, List, Mapping, MutableMapping, Optional, Set, Tuple
+
+from .data_models import Configuration, Directive, DirectiveType, FileAnalysisResult
+from .preprocessor_parser import PreprocessorParser
+from .configuration_evaluator import ConfigurationEvaluator, EvaluationResult, split_define
+from .include_graph import IncludeResolver
+
+
+PRAGMA_ONCE = re.compile(r'^\s*#\s*pragma\s+once\b')
+GUARD_CONDITION = re.compile(r'^!\s*defined\s*\(?\s*([A-Za-z_][A-Za-z0-9_]*)\s*\)?$')
+
+# Directives ignored when looking for the conditional that spans a whole file
+UNSTRUCTURED_TYPES = (DirectiveType.UNKNOWN, DirectiveType.ERROR,
+                      DirectiveType.WARNING, DirectiveType.PRAGMA)
+
+# Pseudo-macro prefix marking a #pragma once file as already included; it
+# cannot clash with real macro names and is stripped from reported tables
+PRAGMA_ONCE_MARKER = "#once:"
+# Pseudo-macro prefix set to a token of a guarded file's effects when it is entered
+ENTERED_MARKER = "#entered:"
+MARKER_PREFIXES = (PRAGMA_ONCE_MARKER, ENTERED_MARKER)
+
+
+@dataclass
+class HeaderSummary:
+    """
+    Effect of preprocessing one file, including everything it includes.
+
+    Attributes:
+        path: File the summary describes
+        guard: Include guard or #pragma once marker of the file, if any
+        inputs: Macros read before the file wrote them, here or in an
+            included file, mapped to the value they had (None when undefined)
+        tests: The file's own inputs as (name, value) and its includes as
+            (IncludeTest, True), in the order they were made; the summary is
+            valid for any macro table that passes all of them
+        names: Every macro the tests look up, directly or through includes
+        effects: Macros the file leaves changed, mapped to their final value
+            (None when undefined)
+        includes: Files included directly from active regions, in order
+        unresolved: Include names in active regions that could not be found
+        children: Summaries of the included files, as spliced in
+        taken: Line of each conditional directive mapped to whether its branch is active
+        inactive_ranges: Skipped line ranges of the file itself, 1-based and inclusive
+    """
+    path: str
+    guard: Optional[str] = None
+    inputs: Dict[str, Optional[str]] = field(default_factory=dict)
+    tests: List[Tuple[Any, Any]] = field(default_factory=list)
+    names: Set[str] = field(default_factory=set)
+    effects: Dict[str, Optional[str]] = field(default_factory=dict)
+    includes: List[str] = field(default_factory=list)
+    unresolved: List[str] = field(default_factory=list)
+    children: List['HeaderSummary'] = field(default_factory=list)
+    taken: Dict[int, bool] = field(default_factory=dict)
+    inactive_ranges: List[Tuple[int, int]] = field(default_factory=list)
+
+    def apply(self, macros: Dict[str, str]) -> None:
+        """Apply the summary's effects to a macro table."""
+        for name, value in self.effects.items():
+            if value is None:
+                macros.pop(name, None)
+            else:
+                macros[name] = value
+
+
+Lookup = Callable[[str], Optional[str]]
+
+
+def tests_hold(tests: List[Tuple[Any, Any]], lookup: Lookup) -> bool:
+    """Check a summary's tests against a macro table's lookup function."""
+    for test, outcome in tests:
+        if type(test) is str:
+            if lookup(test) != outcome:
+                return False
+        elif not test.holds(lookup):
+            return False
+    return True
+
+
+class IncludeTest:
+    """
+    Test that an #include expands as an included file's summary says.
+
+    It holds when the file has no guard, or its guard is undefined, and the
+    summary's own tests hold; or when the guard is set and skipping the
+    file, as the compiler does, leaves the same macros as entering it: the
+    file was entered before with the same effects, and no macro it writes
+    that another file also writes has changed since. Includers therefore do
+    not depend on which guarded headers were included before them, unless
+    one was redefined since. Macros the includer wrote before the #include
+    are fixed in `writes`.
+    """
+
+    __slots__ = ('guard', 'summary', 'writes', 'token', 'names', '_contested', '_contested_count', '_checked')
+
+    def __init__(self, guard: Optional[str], summary: 'HeaderSummary', writes: Dict[str, Optional[str]],
+                 token: str, contested: Set[str]):
+        self.guard = guard
+        self.summary = summary
+        self.writes = writes
+        self.token = token
+        names = set(summary.names)
+        names.update(summary.effects)
+        if guard is not None:
+            names.add(guard)
+            names.add(ENTERED_MARKER + summary.path)
+        self.names = names.difference(writes)
+        # Effects to compare when the file is skipped; contested only grows
+        self._contested = contested
+        self._contested_count = -1
+        self._checked: List[Tuple[str, Optional[str]]] = []
+
+    def holds(self, lookup: Lookup) -> bool:
+        writes = self.writes
+        if writes:
+            outer = lookup
+            lookup = lambda name: writes[name] if name in writes else outer(name)
+        if self.guard is None or lookup(self.guard) is None:
+            return tests_hold(self.summary.tests, lookup)
+        if lookup(ENTERED_MARKER + self.summary.path) != self.token:
+            return False
+        contested = self._contested
+        if self._contested_count != len(contested):
+            self._contested_count = len(contested)
+            self._checked = [(name, value) for name, value in self.summary.effects.items() if name in contested]
+        for name, value in self._checked:
+            if lookup(name) != value:
+                return False
+        return True
+
+
+def include_guard(directives: List[Directive]) -> Optional[str]:
+    """
+    Get the include guard macro of a file, if the whole file is guarded.
+
+    Recognizes `#ifndef X` / `#if !defined(X)` as the first conditional
+    with its matching #endif as the last directive.
+    """
+    conditionals = [d for d in directives if d.type not in UNSTRUCTURED_TYPES]
+    if len(conditionals) < 2 or conditionals[-1].type != DirectiveType.ENDIF:
+        return None
+    first = conditionals[0]
+    if first.type == DirectiveType.IFNDEF:
+        guard = first.symbol_name
+    elif first.type == DirectiveType.IF:
+        match = GUARD_CONDITION.match((first.condition or "").strip())
+        guard = match.group(1) if match else None
+    else:
+        return None
+
+    # The opening #ifndef must stay open until the last directive
+    depth = 0
+    for directive in conditionals[:-1]:
+        if directive.type in (DirectiveType.IF, DirectiveType.IFDEF, DirectiveType.IFNDEF):
+            depth += 1
+        elif directive.type == DirectiveType.ENDIF:
+            depth -= 1
+        elif directive.type in (DirectiveType.ELIF, DirectiveType.ELSE) and depth == 1:
+            return None
+        if depth == 0:
+            return None
+    return guard
+
+
+class _MacroScope(MutableMapping):
+    """
+    Macro table seen while preprocessing one file.
+
+    Writes stay local; reads of macros the file has not written yet are
+    recorded as inputs together with the value they had, and as tests when
+    this file made them rather than an included one.
+    """
+
+    def __init__(self, base):
+        self.base = base
+        self.writes: Dict[str, Optional[str]] = {}
+        self.reads: Dict[str, Optional[str]] = {}
+        self.tests: List[Tuple[Any, Any]] = []
+        self._tested: Dict[str, Optional[str]] = {}
+
+    def lookup(self, name: str) -> Optional[str]:
+        """Get a macro's value without recording a read."""
+        scope = self
+        while True:
+            writes = scope.writes
+            if name in writes:
+                return writes[name]
+            base = scope.base
+            if type(base) is not _MacroScope:
+                return base.get(name)
+            scope = base
+
+    def read(self, name: str) -> Optional[str]:
+        """Get a macro's value, recording it as an input if not written here."""
+        if name in self.writes:
+            return self.writes[name]
+        if name in self._tested:
+            return self._tested[name]
+        value = self.lookup(name)
+        self._tested[name] = value
+        self.tests.append((name, value))
+        self.reads.setdefault(name, value)
+        return value
+
+    def include(self, summary: HeaderSummary, test: IncludeTest) -> None:
+        """Splice an included file's summary into this scope."""
+        for name, value in summary.inputs.items():
+            if name != test.guard and name not in self.writes and name not in self.reads:
+                self.reads[name] = value
+        self.tests.append((test, True))
+        self.writes.update(summary.effects)
+
+    def __contains__(self, name) -> bool:
+        return self.read(name) is not None
+
+    def __getitem__(self, name: str) -> str:
+        value = self.read(name)
+        if value is None:
+            raise KeyError(name)
+        return value
+
+    def __setitem__(self, name: str, value: str) -> None:
+        self.writes[name] = value
+
+    def __delitem__(self, name: str) -> None:
+        self.writes[name] = None
+
+    def pop(self, name, default=None):
+        # Undefining does not depend on whether the macro was defined
+        self.writes[name] = None
+        return default
+
+    def materialize(self) -> Dict[str, str]:
+        """Get the full macro table as a plain dictionary."""
+        if isinstance(self.base, _MacroScope):
+            macros = self.base.materialize()
+        else:
+            macros = dict(self.base)
+        for name, value in self.writes.items():
+            if value is None:
+                macros.pop(name, None)
+            else:
+                macros[name] = value
+        return macros
+
+    def __iter__(self) -> Iterator[str]:
+        return iter(self.materialize())
+
+    def __len__(self) -> int:
+        return len(self.materialize())
+
+
+class _SummaryIndex:
+    """
+    Summaries of one file, indexed by the tests they were made under.
+
+    Each node maps the tests made next to their outcomes and the nodes
+    below, so summaries sharing a prefix of tests share its nodes. A lookup
+    only follows branches whose outcome agrees with the macro table.
+    """
+
+    __slots__ = ('branches', 'summary')
+
+    def __init__(self):
+        self.branches: Dict[Any, Dict[Any, '_SummaryIndex']] = {}
+        self.summary: Optional[HeaderSummary] = None
+
+    def add(self, summary: HeaderSummary) -> None:
+        node = self
+        for test, outcome in summary.tests:
+            node = node.branches.setdefault(test, {}).setdefault(outcome, _SummaryIndex())
+        node.summary = summary
+
+    def find(self, lookup: Lookup) -> Optional[HeaderSummary]:
+        """Get a summary whose tests all agree with a macro table."""
+        stack = [self]
+        while stack:
+            node = stack.pop()
+            if node.summary is not None:
+                return node.summary
+            for test, outcomes in node.branches.items():
+                if type(test) is str:
+                    child = outcomes.get(lookup(test))
+                else:
+                    child = outcomes.get(True) if test.holds(lookup) else None
+                if child is not None:
+                    stack.append(child)
+        return None
+
+
+class HeaderSummaryCache:
+    """
+    Memoized per-file summaries and effective macro tables.
+
+    Summaries are stored per (file, include paths) in a _SummaryIndex keyed
+    by the macros they read and the IncludeTests of their includes, so an
+    entry is reused whenever the macros that matter agree.
+    """
+
+    def __init__(self,
+                 parser: Optional[PreprocessorParser] = None,
+                 evaluator: Optional[ConfigurationEvaluator] = None):
+        self.parser = parser or PreprocessorParser()
+        self.evaluator = evaluator or ConfigurationEvaluator()
+        self._files: Dict[str, Tuple[List[Directive], int, bool, Optional[str]]] = {}
+        self._resolvers: Dict[Tuple[str, ...], IncludeResolver] = {}
+        self._summaries: Dict[Tuple[str, Tuple[str, ...]], _SummaryIndex] = {}
+        self._include_tests: Dict[tuple, IncludeTest] = {}
+        self._tokens: Dict[tuple, str] = {}
+        self._child_tokens: Dict[int, str] = {}
+        # Macros defined or undefined by more than one file
+        self._writers: Dict[str, str] = {}
+        self._contested: Set[str] = set()
+        self._variants: Dict[str, List[HeaderSummary]] = {}
+        self._guards: Set[str] = set()
+        self._in_progress: List[str] = []
+        self._cyclic = False
+        self.hits = 0
+        self.misses = 0
+
+    def add_file_result(self, file_result: FileAnalysisResult) -> None:
+        """Use already parsed directives for a file instead of reading it."""
+        self._files[file_result.file_path] = self._file_entry(file_result)
+
+    def effective_macros(self,
+                         file_path: str,
+                         configuration: Optional[Configuration] = None,
+                         line_number: Optional[int] = None) -> Dict[str, str]:
+        """
+        Compute the macros defined after preprocessing a file, like `gcc -dM -E`.
+
+        Args:
+            file_path: Translation unit or header to preprocess
+            configuration: Predefined macros and include paths
+            line_number: If given, stop just before this line of file_path
+
+        Returns:
+            Macro names mapped to their replacement text
+        """
+        configuration = configuration or Configuration()
+        macros = configuration.initial_macros()
+        resolver = self.resolver(configuration.include_paths)
+
+        if line_number is None:
+            self.summarize(file_path, macros, resolver).apply(macros)
+        else:
+            directives = self._load(file_path)[0]
+            scope = _MacroScope(macros)
+            self._walk(file_path, [d for d in directives if d.line_number < line_number],
+                       scope, resolver, HeaderSummary(path=file_path))
+            macros = scope.materialize()
+
+        return {name: value for name, value in macros.items()
+                if not name.startswith(MARKER_PREFIXES)}
+
+    def summarize_translation_unit(self, file_path: str,
+                                   configuration: Optional[Configuration] = None) -> HeaderSummary:
+        """Get the summary of a file preprocessed from the start of a translation unit."""
+        configuration = configuration or Configuration()
+        return self.summarize(file_path, configuration.initial_macros(),
+                              self.resolver(configuration.include_paths))
+
+    def variants(self, file_path: str) -> List[HeaderSummary]:
+        """Get every cached summary of a file, across inputs and include paths."""
+        return self._variants.get(file_path, [])
+
+    def resolver(self, include_paths) -> IncludeResolver:
+        """Get the shared resolver for a list of include paths."""
+        key = tuple(include_paths)
+        if key not in self._resolvers:
+            self._resolvers[key] = IncludeResolver(key)
+        return self._resolvers[key]
+
+    def summarize(self, file_path: str, macros: Mapping[str, str],
+                  resolver: IncludeResolver) -> HeaderSummary:
+        """
+        Get the summary of a file for an incoming macro table.
+
+        Args:
+            file_path: File to summarize
+            macros: Macro table at the point the file is entered
+            resolver: Resolver for the file's #include directives
+
+        Returns:
+            Cached or freshly computed HeaderSummary
+        """
+        lookup = macros.lookup if isinstance(macros, _MacroScope) else macros.get
+        index = self._summaries.setdefault((file_path, resolver.include_paths), _SummaryIndex())
+        summary = index.find(lookup)
+        if summary is not None:
+            self.hits += 1
+            return summary
+
+        self.misses += 1
+        summary = HeaderSummary(path=file_path, guard=self._marker(file_path))
+        if file_path in self._in_progress:
+            # Unguarded include cycle: stop here, and do not cache anything
+            # whose result depended on where the cycle was entered
+            self._cyclic = True
+            return summary
+
+        directives, line_count = self._load(file_path)[:2]
+        scope = _MacroScope(macros)
+        outer_cyclic = self._cyclic
+        self._cyclic = False
+        self._in_progress.append(file_path)
+        try:
+            self._walk(file_path, directives, scope, resolver, summary, line_count)
+        finally:
+            self._in_progress.pop()
+
+        summary.inputs = scope.reads
+        summary.tests = scope.tests
+        summary.effects = scope.writes
+        summary.names = set(scope._tested)
+        for test, _ in scope.tests:
+            if type(test) is not str:
+                summary.names |= test.names
+        if not self._cyclic:
+            index.add(summary)
+            self._variants.setdefault(file_path, []).append(summary)
+        self._cyclic = self._cyclic or outer_cyclic
+        return summary
+
+    def _walk(self, file_path: str, directives: List[Directive], scope: _MacroScope,
+              resolver: IncludeResolver, summary: HeaderSummary, line_count: int = 0) -> None:
+        """Preprocess directives into scope, splicing in included files' summaries."""
+
+        def on_include(directive: Directive, macros: MutableMapping[str, str]) -> None:
+            target = resolver.resolve_directive(directive)
+            if target is None:
+                summary.unresolved.append(directive.condition or "")
+                return
+            summary.includes.append(target)
+
+            marker = self._marker(target)
+            if marker is not None and scope.lookup(marker) is not None:
+                if target in self._in_progress:
+                    scope.read(marker)
+                    return
+                # The compiler skips the file. If its effects are all in place
+                # anyway, entering it is the same, and this summary can be
+                # shared with includers that do enter it.
+                unguarded = _MacroScope(scope)
+                unguarded.writes[marker] = None
+                child = self.summarize(target, unguarded, resolver)
+                test = self._include_test(marker, child, scope.writes)
+                if not test.holds(scope.lookup):
+                    scope.read(marker)
+                    return
+            else:
+                child = self.summarize(target, scope, resolver)
+                test = self._include_test(marker, child, scope.writes)
+            summary.children.append(child)
+            scope.include(child, test)
+            if marker is not None:
+                scope[ENTERED_MARKER + target] = test.token
+                if marker.startswith(PRAGMA_ONCE_MARKER):
+                    scope[marker] = ""
+
+        result = EvaluationResult()
+        self.evaluator.walk(directives, scope, result, line_count, on_include)
+        summary.taken = result.taken
+        summary.inactive_ranges = result.inactive_ranges
+
+    def _marker(self, file_path: str) -> Optional[str]:
+        """Macro that is set once a file was entered and makes it skip itself, if any."""
+        _, _, once, guard = self._load(file_path)
+        return PRAGMA_ONCE_MARKER + file_path if once else guard
+
+    def _include_test(self, guard: Optional[str], child: HeaderSummary,
+                      writes: Dict[str, Optional[str]]) -> IncludeTest:
+        """Get the shared IncludeTest for entering a summary after the includer's writes."""
+        if len(writes) > len(child.names) + len(child.effects):
+            fixed = {name: writes[name] for name in child.names.union(child.effects) if name in writes}
+        else:
+            fixed = {name: value for name, value in writes.items()
+                     if name in child.names or name in child.effects}
+        if guard is not None:
+            for name in (guard, ENTERED_MARKER + child.path):
+                if name in writes:
+                    fixed[name] = writes[name]
+        key = (guard, id(child), frozenset(fixed.items()))
+        test = self._include_tests.get(key)
+        if test is None:
+            test = self._include_tests[key] = IncludeTest(guard, child, fixed, self._token(child), self._contested)
+        return test
+
+    def _token(self, child: HeaderSummary) -> str:
+        """Get the entered-marker value for a summary; summaries with the same effects share one."""
+        token = self._child_tokens.get(id(child))
+        if token is None:
+            effects = tuple(sorted(child.effects.items(), key=lambda item: item[0]))
+            token = self._tokens.setdefault(effects, str(len(self._tokens)))
+            self._child_tokens[id(child)] = token
+        return token
+
+    def _load(self, file_path: str) -> Tuple[List[Directive], int, bool, Optional[str]]:
+        """Get a file's directives, line count, #pragma once flag and include guard."""
+        entry = self._files.get(file_path)
+        if entry is None:
+            entry = self._file_entry(self.parser.parse_file(file_path))
+            self._files[file_path] = entry
+        return entry
+
+    def _file_entry(self, file_result: FileAnalysisResult) -> Tuple[List[Directive], int, bool, Optional[str]]:
+        directives = file_result.directives
+        once = any(d.type == DirectiveType.PRAGMA and PRAGMA_ONCE.match(d.content)
+                   for d in directives)
+        guard = include_guard(directives)
+        if guard is not None:
+            self._guards.add(guard)
+        for directive in directives:
+            if directive.type == DirectiveType.DEFINE:
+                name = split_define(directive.content)[0]
+            elif directive.type == DirectiveType.UNDEF:
+                name = directive.symbol_name
+            else:
+                continue
+            if name and self._writers.setdefault(name, file_result.file_path) != file_result.file_path:
+                self._contested.add(name)
+        return directives, file_result.line_count, once, guard
+
+    def function_like_macros(self) -> Set[str]:
+        """Names given a parameter list by a #define in any file loaded so far."""
+        names = set()
+        for directives, _, _, _ in self._files.values():
+            for directive in directives:
+                if directive.type == DirectiveType.DEFINE:
+                    name, parameters, _ = split_define(directive.content)
+                    if name and parameters is not None:
+                        names.add(name)
+        return names
+
+    def is_include_marker(self, name: str) -> bool:
+        """Check whether a macro is an include guard or #pragma once marker."""
+        return name in self._guards or name.startswith(MARKER_PREFIXES)
+
+    def stats(self) -> Dict[str, int]:
+        """Get cache statistics."""
+        return {
+            "files": len(self._files),
+            "summaries": sum(len(variants) for variants in self._variants.values()),
+            "hits": self.hits,
+            "misses": self.misses,
+        }
@@ -0,0 +1,241 @@
+"""
+Include graph module for resolving #include directives to files.
+Maps include names to paths the way the compiler searches for them:
+quoted includes look next to the including file first, then every include
+path in order; angle-bracket includes only search the include paths.
+The static include graph links every file to everything it may include and
+answers transitive closures as integer bitsets.
+"""
+
+import os
+import re
+from typing import Callable, Dict, Iterable, List, Optional, Tuple
+
+from .data_models import Directive, DirectiveType
+
+
+INCLUDE_DELIMITER = re.compile(r'#\s*include\s*([<"])')
+
+
+def include_target(directive: Directive) -> Tuple[str, bool]:
+    """
+    Get the name an #include directive refers to.
+
+    Returns:
+        (included name, True for "quoted" and False for <angle> includes)
+    """
+    match = INCLUDE_DELIMITER.search(directive.content)
+    quoted = match is None or match.group(1) == '"'
+    return directive.condition or "", quoted
+
+
+class IncludeResolver:
+    """
+    Resolves include names against a fixed list of include paths.
+    Lookups are cached, so each (directory, name) pair hits the filesystem once.
+    """
+
+    def __init__(self, include_paths: Iterable[str] = ()):
+        self.include_paths = tuple(os.path.abspath(p) for p in include_paths)
+        self._cache: Dict[Tuple[Optional[str], str], Optional[str]] = {}
+
+    def resolve(self, name: str, including_file: Optional[str] = None,
+                quoted: bool = True) -> Optional[str]:
+        """
+        Resolve an include name to an absolute file path.
+
+        Args:
+            name: Name as written between the delimiters
+            including_file: File containing the #include, for quoted lookups
+            quoted: Whether the include used "quotes" rather than <angles>
+
+        Returns:
+            Absolute normalized path, or None if no candidate exists
+        """
+        directory = os.path.dirname(os.path.abspath(including_file)) if quoted and including_file else None
+        key = (directory, name)
+        if key in self._cache:
+            return self._cache[key]
+
+        resolved = None
+        if os.path.isabs(name):
+            resolved = os.path.normpath(name) if os.path.isfile(name) else None
+        else:
+            search = ((directory,) if directory else ()) + self.include_paths
+            for base in search:
+                candidate = os.path.normpath(os.path.join(base, name))
+                if os.path.isfile(candidate):
+                    resolved = candidate
+                    break
+
+        self._cache[key] = resolved
+        return resolved
+
+    def resolve_directive(self, directive: Directive) -> Optional[str]:
+        """Resolve an #include directive relative to the file it appears in."""
+        name, quoted = include_target(directive)
+        if not name:
+            return None
+        return self.resolve(name, directive.file_path, quoted)
+
+
+class IncludeGraph:
+    """
+    Static include graph over every #include, whichever branch it sits in.
+
+    Files are numbered in discovery order so that sets of files are integer
+    bitsets. Transitive closures are computed once per strongly connected
+    component, so include cycles cost nothing extra.
+    """
+
+    def __init__(self):
+        self.paths: List[str] = []
+        self.edges: List[List[int]] = []
+        self.unresolved: Dict[str, List[str]] = {}
+        self._index: Dict[str, int] = {}
+        self._closures: Optional[List[int]] = None
+
+    @classmethod
+    def build(cls, sources: Iterable[Tuple[str, IncludeResolver]],
+              load: Callable[[str], List[Directive]]) -> 'IncludeGraph':
+        """
+        Discover every file reachable from a set of source files.
+
+        A header reached from several sources is expanded once, with the
+        resolver of the first source that reached it.
+
+        Args:
+            sources: (file, resolver for its include paths) pairs
+            load: Returns the directives of a file
+
+        Returns:
+            IncludeGraph containing the sources and everything they include
+        """
+        graph = cls()
+        for file_path, resolver in sources:
+            graph.expand(file_path, resolver, load)
+        return graph
+
+    def expand(self, file_path: str, resolver: IncludeResolver,
+               load: Callable[[str], List[Directive]]) -> None:
+        """
+        Add a file and every file reachable from it by resolving its #includes.
+
+        Files already in the graph are not expanded again.
+        """
+        if self.position(file_path) is not None:
+            return
+        pending = [self.node(file_path)]
+        while pending:
+            current = self.paths[pending.pop()]
+            for directive in load(current):
+                if directive.type != DirectiveType.INCLUDE:
+                    continue
+                target = resolver.resolve_directive(directive)
+                if target is None:
+                    self.unresolved.setdefault(current, []).append(directive.condition or "")
+                    continue
+                known = self.position(target) is not None
+                self.add_include(current, target)
+                if not known:
+                    pending.append(self.position(target))
+
+    def node(self, path: str) -> int:
+        """Get the bit position of a file, adding it if needed."""
+        position = self._index.get(path)
+        if position is None:
+            position = len(self.paths)
+            self._index[path] = position
+            self.paths.append(path)
+            self.edges.append([])
+            self._closures = None
+        return position
+
+    def position(self, path: str) -> Optional[int]:
+        """Get the bit position of a file, or None if it is not in the graph."""
+        return self._index.get(path)
+
+    def add_include(self, source: str, target: str) -> None:
+        """Record that source includes target."""
+        source_position = self.node(source)
+        target_position = self.node(target)
+        if target_position not in self.edges[source_position]:
+            self.edges[source_position].append(target_position)
+            self._closures = None
+
+    def closure(self, path: str) -> int:
+        """Bitset of a file and every file it includes, directly or not."""
+        position = self._index.get(path)
+        if position is None:
+            return 0
+        if self._closures is None:
+            self._closures = self._compute_closures()
+        return self._closures[position]
+
+    def files(self, bits: int) -> List[str]:
+        """Get the paths of the files in a bitset."""
+        paths = []
+        while bits:
+            lowest = bits & -bits
+            paths.append(self.paths[lowest.bit_length() - 1])
+            bits ^= lowest
+        return paths
+
+    def _compute_closures(self) -> List[int]:
+        """Closures of every node via an iterative Tarjan SCC pass."""
+        count = len(self.paths)
+        index = [-1] * count
+        low = [0] * count
+        on_stack = [False] * count
+        stack: List[int] = []
+        closures = [0] * count
+        counter = 0
+
+        for root in range(count):
+            if index[root] != -1:
+                continue
+            index[root] = low[root] = counter
+            counter += 1
+            stack.append(root)
+            on_stack[root] = True
+            work = [(root, 0)]
+            while work:
+                node, next_edge = work[-1]
+                edges = self.edges[node]
+                if next_edge < len(edges):
+                    work[-1] = (node, next_edge + 1)
+                    successor = edges[next_edge]
+                    if index[successor] == -1:
+                        index[successor] = low[successor] = counter
+                        counter += 1
+                        stack.append(successor)
+                        on_stack[successor] = True
+                        work.append((successor, 0))
+                    elif on_stack[successor]:
+                        low[node] = min(low[node], index[successor])
+                    continue
+
+                work.pop()
+                if work:
+                    parent = work[-1][0]
+                    low[parent] = min(low[parent], low[node])
+                if low[node] != index[node]:
+                    continue
+
+                # node roots a component; every successor outside it is done
+                members = []
+                bits = 0
+                while True:
+                    member = stack.pop()
+                    on_stack[member] = False
+                    members.append(member)
+                    bits |= 1 << member
+                    if member == node:
+                        break
+                for member in members:
+                    for successor in self.edges[member]:
+                        if not bits >> successor & 1:
+                            bits |= closures[successor]
+                for member in members:
+                    closures[member] = bits
+        return closures
@@ -0,0 +1,800 @@
+"""
+Incremental document module for editor and watch integrations.
+Keeps a document's directives and contexts up to date across text edits:
+only the touched lines are reparsed, unchanged Directive objects are reused
+with shifted line numbers, and contexts are recomputed only until the
+conditional stack re-converges with its state before the edit.
+Validation and configuration evaluation follow the same edits: only new
+directives are validated, and branch decisions are re-evaluated only where
+the conditional stack or a macro they read may have changed.
+"""
+
+from dataclasses import dataclass
+from typing import Callable, Dict, List, Optional, Set, Tuple, Union
+
+from .data_models import (
+    Configuration, ContextStack, Directive, DirectiveType, FileAnalysisResult,
+    ValidationError, ErrorSeverity
+)
+from .preprocessor_parser import PreprocessorParser
+from .context_analyzer import ContextAnalyzer, ContextState
+from .configuration_evaluator import OPENING_TYPES, ConfigurationEvaluator, EvaluationResult, split_define
+from .validation import DirectiveValidator
+
+
+# Directives that start a branch of a conditional group
+BRANCH_TYPES = OPENING_TYPES + (DirectiveType.ELIF, DirectiveType.ELSE)
+
+
+def _bisect_line(directives: List[Directive], line_number: int) -> int:
+    """Index of the first directive at or after line_number."""
+    low, high = 0, len(directives)
+    while low < high:
+        middle = (low + high) // 2
+        if directives[middle].line_number < line_number:
+            low = middle + 1
+        else:
+            high = middle
+    return low
+
+
+def _insert_by_line(directives: List[Directive], directive: Directive) -> None:
+    """Insert a directive into a list kept in line order."""
+    directives.insert(_bisect_line(directives, directive.line_number), directive)
+
+
+def _remove_by_line(directives: List[Directive], directive: Directive, first_line: Optional[int] = None) -> None:
+    """
+    Remove a directive from a list kept in line order.
+
+    Directives an edit removed keep their old line numbers while the ones
+    after them are already shifted; for those, first_line is the first
+    edited line, before which the list is still in order.
+    """
+    index = _bisect_line(directives, directive.line_number if first_line is None else first_line)
+    while directives[index] is not directive:
+        index += 1
+    del directives[index]
+
+
+def _first_edited_line(directives: List[Directive], edit: 'DirectiveEdit') -> int:
+    """A line after every directive before an edit and at or before every other one."""
+    return directives[edit.start - 1].line_number + 1 if edit.start else 0
+
+
+@dataclass
+class DirectiveEdit:
+    """
+    Directives replaced by one edit of an IncrementalDocument.
+
+    Attributes:
+        start: Index of the first new directive
+        inserted: Number of new directives beginning at start
+        removed: Directives they replaced, no longer in the document
+        first_line: First replaced line (1-based), or 0 when the whole
+            document was reparsed
+        line_delta: Lines the edit added (negative when it removed lines);
+            directives after the replaced lines moved by it
+        reanalyzed: Directives from start whose contexts were recomputed,
+            the new ones and any later ones whose context changed
+    """
+    start: int
+    inserted: int
+    removed: List[Directive]
+    first_line: int = 0
+    line_delta: int = 0
+    reanalyzed: int = 0
+
+
+class IncrementalDocument:
+    """
+    In-memory document with incrementally maintained analysis results.
+
+    Lines are stored without terminators. apply_change takes 0-based
+    (line, column) positions as editors report them; apply_edit takes
+    1-based inclusive line numbers like Directive.line_number.
+
+    Callables in listeners receive a DirectiveEdit after every edit, once
+    contexts are up to date, so derived results can follow it.
+    """
+
+    def __init__(self,
+                 file_path: str,
+                 text: str,
+                 parser: Optional[PreprocessorParser] = None,
+                 context_analyzer: Optional[ContextAnalyzer] = None):
+        self.file_path = file_path
+        self.parser = parser or PreprocessorParser()
+        self.context_analyzer = context_analyzer or ContextAnalyzer()
+        self.lines: List[str] = text.split('\n')
+        self.file_result = FileAnalysisResult(file_path=file_path)
+        # Conditional stack after each directive, aligned with the directive list
+        self._states: List[Tuple[tuple, tuple, tuple]] = []
+        # Context analysis errors keyed by id() of the directive they belong to
+        self._directive_errors: Dict[int, Tuple[Directive, List[ValidationError]]] = {}
+        self._eof_errors: List[ValidationError] = []
+        self.last_reanalyzed = 0
+        self.listeners: List[Callable[[DirectiveEdit], None]] = []
+        self._reparse_all()
+
+    @classmethod
+    def from_file(cls, file_path: str, **kwargs) -> 'IncrementalDocument':
+        """Load a document from disk."""
+        with open(file_path, 'r', encoding='utf-8', errors='ignore') as f:
+            text = f.read()
+        return cls(file_path, text, **kwargs)
+
+    @property
+    def text(self) -> str:
+        """Current document text."""
+        return '\n'.join(self.lines)
+
+    def set_text(self, text: str) -> None:
+        """Replace the whole document."""
+        self.lines = text.split('\n')
+        self._reparse_all()
+
+    def apply_change(self,
+                     start: Tuple[int, int],
+                     end: Tuple[int, int],
+                     new_text: str) -> None:
+        """
+        Replace the text between two positions.
+
+        Args:
+            start: 0-based (line, column) of the first replaced character
+            end: 0-based (line, column) just past the last replaced character
+            new_text: Replacement text, may contain newlines
+        """
+        start_line, start_column = start
+        end_line, end_column = end
+        last_index = len(self.lines) - 1
+        start_line = min(start_line, last_index)
+        end_line = min(end_line, last_index)
+
+        prefix = self.lines[start_line][:start_column]
+        suffix = self.lines[end_line][end_column:]
+        self.replace_lines(start_line, end_line, (prefix + new_text + suffix).split('\n'))
+
+    def apply_edit(self, first_line: int, last_line: int, replacement: str) -> None:
+        """
+        Replace whole lines first_line..last_line (1-based, inclusive).
+
+        Args:
+            first_line: First replaced line
+            last_line: Last replaced line; first_line - 1 inserts before first_line
+            replacement: New text for the range; an empty string deletes the lines
+        """
+        new_lines = replacement.split('\n') if replacement else []
+        if new_lines and replacement.endswith('\n'):
+            new_lines.pop()
+        self.replace_lines(first_line - 1, last_line - 1, new_lines)
+
+    def replace_lines(self, first_line: int, last_line: int, new_lines: List[str]) -> None:
+        """
+        Replace lines first_line..last_line (0-based, inclusive) with new_lines.
+
+        Directives outside the replaced span are kept and shifted; only the
+        new lines are parsed.
+        """
+        self.lines[first_line:last_line + 1] = new_lines
+        delta = len(new_lines) - (last_line - first_line + 1)
+
+        result = self.file_result
+        directives = result.directives
+        # Directive line numbers are 1-based; locate spans before shifting
+        low = _bisect_line(directives, first_line + 1)
+        high = _bisect_line(directives, last_line + 2)
+        define_low = _bisect_line(result.defines, first_line + 1)
+        define_high = _bisect_line(result.defines, last_line + 2)
+
+        replacement = []
+        for offset, line in enumerate(new_lines):
+            directive = self.parser._parse_line(line, first_line + 1 + offset, self.file_path)
+            if directive:
+                replacement.append(directive)
+
+        removed = directives[low:high]
+        for directive in removed:
+            self._directive_errors.pop(id(directive), None)
+
+        if delta:
+            for index in range(high, len(directives)):
+                directives[index].line_number += delta
+
+        directives[low:high] = replacement
+        result.defines[define_low:define_high] = [
+            d for d in replacement if d.type == DirectiveType.DEFINE
+        ]
+        result.directive_count = len(directives)
+        self._update_line_count()
+        self._reanalyze_from(low, len(replacement), high - low)
+        self._notify(DirectiveEdit(low, len(replacement), removed, first_line + 1, delta, self.last_reanalyzed))
+
+    def _reparse_all(self) -> None:
+        """Parse and analyze every line from scratch."""
+        removed = self.file_result.directives
+        self.file_result = FileAnalysisResult(file_path=self.file_path)
+        for line_number, line in enumerate(self.lines, 1):
+            directive = self.parser._parse_line(line, line_number, self.file_path)
+            if directive:
+                self.file_result.add_directive(directive)
+        self._update_line_count()
+        self._states = []
+        self._directive_errors = {}
+        self._reanalyze_from(0, len(self.file_result.directives), 0)
+        self._notify(DirectiveEdit(0, len(self.file_result.directives), removed,
+                                   reanalyzed=len(self.file_result.directives)))
+
+    def _notify(self, edit: DirectiveEdit) -> None:
+        for listener in self.listeners:
+            listener(edit)
+
+    def _update_line_count(self) -> None:
+        """Line count as parse_file reports it (no phantom line after a final newline)."""
+        self.file_result.line_count = len(self.lines) - (1 if self.lines and self.lines[-1] == '' else 0)
+
+    def _reanalyze_from(self, start: int, inserted: int, removed: int) -> None:
+        """
+        Recompute contexts from directive index start until the stack re-converges.
+
+        Args:
+            start: Index of the first new directive
+            inserted: Number of new directives beginning at start
+            removed: Number of old directives they replaced
+        """
+        directives = self.file_result.directives
+        old_states = self._states
+        offset = removed - inserted
+
+        stack = ContextStack(file_context=self.file_path)
+        if start > 0:
+            conditions, negations, previous = old_states[start - 1]
+            stack.conditions = list(conditions)
+            stack.negations = list(negations)
+            stack.previous = [list(branches) for branches in previous]
+            stack.depth = len(conditions)
+
+        analyzer = self.context_analyzer
+        context_state = ContextState(stack)
+        sink = FileAnalysisResult(file_path=self.file_path)
+        new_states = old_states[:start]
+        converged = False
+
+        index = start
+        while index < len(directives):
+            directive = directives[index]
+            directive.context = []
+            sink.errors = []
+            try:
+                analyzer._process_directive(directive, sink, context_state)
+            except Exception as e:
+                sink.add_error(ValidationError(
+                    severity=ErrorSeverity.ERROR,
+                    message=f"Context analysis error: {str(e)}",
+                    file_path=directive.file_path,
+                    line_number=directive.line_number,
+                    directive_content=directive.content
+                ))
+            if sink.errors:
+                self._directive_errors[id(directive)] = (directive, sink.errors)
+            else:
+                self._directive_errors.pop(id(directive), None)
+
+            state = (tuple(stack.conditions), tuple(stack.negations),
+                     tuple(tuple(branches) for branches in stack.previous))
+            new_states.append(state)
+            index += 1
+
+            # Past the new directives, an unchanged stack means every later
+            # context is unchanged too
+            old_index = index - 1 + offset
+            if index >= start + inserted and 0 <= old_index < len(old_states) and old_states[old_index] == state:
+                new_states.extend(old_states[index + offset:])
+                converged = True
+                break
+
+        self._states = new_states
+        self.last_reanalyzed = index - start
+
+        if not converged:
+            self._eof_errors = []
+            if stack.depth > 0:
+                self._eof_errors.append(ValidationError(
+                    severity=ErrorSeverity.ERROR,
+                    message=f"Unmatched conditional directive(s): {stack.depth} unclosed block(s)",
+                    file_path=self.file_path,
+                    line_number=self.file_result.line_count,
+                    suggestion="Add missing #endif directive(s)"
+                ))
+        self._collect_errors()
+
+    def errors_of(self, directive: Directive) -> List[ValidationError]:
+        """Context analysis errors of one directive."""
+        entry = self._directive_errors.get(id(directive))
+        return entry[1] if entry else []
+
+    @property
+    def end_errors(self) -> List[ValidationError]:
+        """Errors found at end of file, such as unclosed conditionals."""
+        for error in self._eof_errors:
+            error.line_number = self.file_result.line_count
+        return list(self._eof_errors)
+
+    def _collect_errors(self) -> None:
+        """Rebuild file_result.errors from per-directive and end-of-file errors."""
+        errors = []
+        for directive, directive_errors in self._directive_errors.values():
+            for error in directive_errors:
+                error.line_number = directive.line_number
+            errors.extend(directive_errors)
+        errors.sort(key=lambda error: error.line_number)
+        for error in self._eof_errors:
+            error.line_number = self.file_result.line_count
+            errors.append(error)
+        self.file_result.errors = errors
+
+
+class IncrementalValidation:
+    """
+    Validation errors of an IncrementalDocument, kept up to date per edit.
+
+    Syntax checks only depend on the directive itself, so they run once per
+    new directive. Redefinition and undefined-symbol warnings depend on
+    every directive naming the same symbol; they are kept per symbol and
+    recomputed only for symbols named by changed directives. After each
+    update, changed lists the directives whose errors may differ.
+    """
+
+    def __init__(self,
+                 document: IncrementalDocument,
+                 validator: Optional[DirectiveValidator] = None,
+                 strict: bool = False):
+        self.document = document
+        self.validator = validator or DirectiveValidator()
+        self.strict = strict
+        # Syntax errors keyed by id() of the directive they belong to
+        self._syntax: Dict[int, Tuple[Directive, List[ValidationError]]] = {}
+        # #define and #ifdef/#ifndef directives per symbol, in line order
+        self._defines: Dict[str, List[Directive]] = {}
+        self._references: Dict[str, List[Directive]] = {}
+        # Per symbol: (redefinition, its first definition) or (undefined reference, None)
+        self._semantic: Dict[str, List[Tuple[Directive, Optional[Directive]]]] = {}
+        # The same pairs keyed by id() of the redefinition or reference
+        self._pairs: Dict[int, Tuple[Directive, Optional[Directive]]] = {}
+        self.changed: List[Directive] = []
+        self.update(DirectiveEdit(0, len(document.file_result.directives), []))
+        document.listeners.append(self.update)
+
+    def _index_of(self, directive: Directive) -> Optional[Dict[str, List[Directive]]]:
+        if not directive.symbol_name:
+            return None
+        if directive.type == DirectiveType.DEFINE:
+            return self._defines
+        if directive.type in (DirectiveType.IFDEF, DirectiveType.IFNDEF):
+            return self._references
+        return None
+
+    def update(self, edit: DirectiveEdit) -> None:
+        """Follow an edit of the document."""
+        symbols = set()
+        new = self.document.file_result.directives[edit.start:edit.start + edit.inserted]
+        self.changed = list(new)
+        first_line = _first_edited_line(self.document.file_result.directives, edit)
+        for directive in edit.removed:
+            self._syntax.pop(id(directive), None)
+            index = self._index_of(directive)
+            if index is not None:
+                _remove_by_line(index[directive.symbol_name], directive, first_line)
+                symbols.add(directive.symbol_name)
+
+        for directive in new:
+            errors = self.validator._validate_directive_syntax(directive, self.strict)
+            if errors:
+                self._syntax[id(directive)] = (directive, errors)
+            index = self._index_of(directive)
+            if index is not None:
+                _insert_by_line(index.setdefault(directive.symbol_name, []), directive)
+                symbols.add(directive.symbol_name)
+
+        for symbol in symbols:
+            for directive, _ in self._semantic.pop(symbol, ()):
+                self._pairs.pop(id(directive), None)
+            defines = self._defines.get(symbol)
+            if defines:
+                pairs = [(define, defines[0]) for define in defines[1:]]
+            else:
+                pairs = [(reference, None) for reference in self._references.get(symbol, ())]
+            if pairs:
+                self._semantic[symbol] = pairs
+                for pair in pairs:
+                    self._pairs[id(pair[0])] = pair
+            self.changed.extend(self._defines.get(symbol, ()))
+            self.changed.extend(self._references.get(symbol, ()))
+
+    def errors_of(self, directive: Directive) -> List[ValidationError]:
+        """Errors of one directive, as errors reports them."""
+        entry = self._syntax.get(id(directive))
+        errors = list(entry[1]) if entry else []
+        pair = self._pairs.get(id(directive))
+        if pair is not None:
+            errors.append(self._semantic_error(*pair))
+        return errors
+
+    def _semantic_error(self, directive: Directive, first: Optional[Directive]) -> ValidationError:
+        if first is None:
+            return self.validator._undefined_symbol_error(directive)
+        return self.validator._redefinition_error(directive, first)
+
+    @property
+    def errors(self) -> List[ValidationError]:
+        """Errors DirectiveValidator.validate reports without the balance check, in line order."""
+        errors = []
+        for directive, directive_errors in self._syntax.values():
+            for error in directive_errors:
+                error.line_number = directive.line_number
+            errors.extend(directive_errors)
+        for pairs in self._semantic.values():
+            errors.extend(self._semantic_error(directive, first) for directive, first in pairs)
+        errors.sort(key=lambda error: error.line_number)
+        return errors
+
+
+class _Outcome:
+    """Evaluation state of one directive."""
+    __slots__ = ('active', 'frames', 'taken', 'reads', 'unparsed', 'written', 'value')
+
+    def __init__(self, written: Optional[str], value: Optional[str]):
+        self.active = False
+        # Open groups after the directive, as (parent active, any branch taken, active)
+        self.frames: tuple = ()
+        self.taken: Optional[bool] = None
+        self.reads: Tuple[str, ...] = ()
+        self.unparsed = False
+        # Macro a #define/#undef writes, and the value it writes (None for #undef)
+        self.written = written
+        self.value = value
+
+
+class _MacrosBefore:
+    """
+    Macro table just before a line, resolved from the writes preceding it.
+
+    Supports the lookups condition evaluation makes and records every name
+    looked up.
+    """
+
+    def __init__(self, evaluation: 'IncrementalEvaluation', line_number: int):
+        self.evaluation = evaluation
+        self.line_number = line_number
+        self.reads: Set[str] = set()
+
+    def get(self, name: str, default=None):
+        self.reads.add(name)
+        value = self.evaluation._value_before(name, self.line_number)
+        return default if value is None else value
+
+    def __contains__(self, name) -> bool:
+        return self.get(name) is not None
+
+    def __getitem__(self, name: str) -> str:
+        value = self.get(name)
+        if value is None:
+            raise KeyError(name)
+        return value
+
+
+class IncrementalEvaluation:
+    """
+    ConfigurationEvaluator results for an IncrementalDocument, kept up to
+    date per edit.
+
+    Each directive keeps its branch decision, the open groups after it and
+    the macros its condition read. Macro values are resolved from per-macro
+    lists of #define/#undef directives instead of copying the macro table.
+    After an edit, directives are re-evaluated from the first new one until
+    the open groups match their state before the edit; past that point,
+    only conditions that read a macro whose value may have changed are
+    re-evaluated. Skipped ranges are kept per branch directive that starts
+    one, with the directive ending it, and re-found only around directives
+    that were re-evaluated.
+    """
+
+    def __init__(self,
+                 document: IncrementalDocument,
+                 configuration: Union[Configuration, Dict[str, str], None] = None,
+                 evaluator: Optional[ConfigurationEvaluator] = None):
+        self.document = document
+        self.evaluator = evaluator or ConfigurationEvaluator()
+        self._outcomes: Dict[int, _Outcome] = {}
+        # #define/#undef directives per macro, and conditions per macro they read, in line order
+        self._writes: Dict[str, List[Directive]] = {}
+        self._readers: Dict[str, List[Directive]] = {}
+        # Branch directives starting a skipped range, in line order, and the
+        # directive ending each one's range (None at end of file)
+        self._openers: List[Directive] = []
+        self._closers: Dict[int, Optional[Directive]] = {}
+        # Directives the last walk re-evaluated
+        self._stepped: List[Directive] = []
+        self._result: Optional[EvaluationResult] = None
+        self.last_evaluated = 0
+        self._add(document.file_result.directives)
+        self.set_configuration(configuration)
+        document.listeners.append(self.update)
+
+    def set_configuration(self, configuration: Union[Configuration, Dict[str, str], None]) -> None:
+        """Evaluate the whole document under another configuration or initial macro table."""
+        if isinstance(configuration, Configuration):
+            self.initial = configuration.initial_macros()
+        else:
+            self.initial = dict(configuration or {})
+        self._walk(0, len(self.document.file_result.directives), set())
+        self._rebuild_ranges()
+
+    def update(self, edit: DirectiveEdit) -> None:
+        """Follow an edit of the document."""
+        if not edit.inserted and not edit.removed:
+            # Only lines without directives changed; line numbers are read when materializing
+            self.last_evaluated = 0
+            self._result = None
+            return
+        directives = self.document.file_result.directives
+        if edit.removed:
+            boundary = self._outcomes[id(edit.removed[-1])].frames
+        else:
+            boundary = self._outcomes[id(directives[edit.start - 1])].frames if edit.start else ()
+        changed = set()
+        first_line = _first_edited_line(directives, edit)
+        for directive in edit.removed:
+            outcome = self._outcomes.pop(id(directive))
+            self._set_reads(directive, outcome, (), first_line)
+            if outcome.written is not None:
+                _remove_by_line(self._writes[outcome.written], directive, first_line)
+                changed.add(outcome.written)
+        for outcome in self._add(directives[edit.start:edit.start + edit.inserted]):
+            if outcome.written is not None:
+                changed.add(outcome.written)
+        self._walk(edit.start, edit.start + edit.inserted, changed, boundary)
+        self._update_ranges(edit.removed, first_line)
+
+    def _add(self, directives: List[Directive]) -> List[_Outcome]:
+        """Create outcomes for new directives and index their writes."""
+        added = []
+        for directive in directives:
+            written = value = None
+            if directive.type == DirectiveType.DEFINE:
+                written, _, value = split_define(directive.content)
+            elif directive.type == DirectiveType.UNDEF:
+                written = directive.symbol_name
+            outcome = self._outcomes[id(directive)] = _Outcome(written, value)
+            if written is not None:
+                _insert_by_line(self._writes.setdefault(written, []), directive)
+            added.append(outcome)
+        return added
+
+    def _value_before(self, name: str, line_number: int) -> Optional[str]:
+        """Value of a macro just before a line; None when undefined."""
+        writes = self._writes.get(name)
+        if writes:
+            index = _bisect_line(writes, line_number) - 1
+            while index >= 0:
+                outcome = self._outcomes[id(writes[index])]
+                if outcome.active:
+                    return outcome.value
+                index -= 1
+        return self.initial.get(name)
+
+    def _set_reads(self, directive: Directive, outcome: _Outcome, reads, first_line: Optional[int] = None) -> None:
+        """Record the macros a condition read, keeping the reader lists in sync."""
+        reads = tuple(sorted(reads))
+        if reads == outcome.reads:
+            return
+        for name in outcome.reads:
+            readers = self._readers[name]
+            _remove_by_line(readers, directive, first_line)
+            if not readers:
+                del self._readers[name]
+        for name in reads:
+            _insert_by_line(self._readers.setdefault(name, []), directive)
+        outcome.reads = reads
+
+    def _walk(self, index: int, until: int, changed: Set[str], boundary: Optional[tuple] = None) -> None:
+        """
+        Re-evaluate directives from index on.
+
+        Args:
+            index: First directive to re-evaluate
+            until: Directives before this index are re-evaluated unconditionally
+            changed: Macros whose value may differ from the last evaluation;
+                grows as branches change
+            boundary: Open groups before directive until in the last evaluation
+        """
+        directives = self.document.file_result.directives
+        outcomes = self._outcomes
+        frames = outcomes[id(directives[index - 1])].frames if index > 0 else ()
+        # Open groups before directive index in the last evaluation, once it is past until
+        expected = boundary if index == until else None
+        stepped = self._stepped = []
+        while index < len(directives):
+            if frames == expected:
+                # The open groups match the last evaluation, so later directives
+                # keep their outcomes unless a condition reads a changed macro
+                index = self._next_reader(changed, directives[index - 1].line_number if index > 0 else 0)
+                if index is None:
+                    break
+                frames = outcomes[id(directives[index - 1])].frames if index > 0 else ()
+            directive = directives[index]
+            outcome = outcomes[id(directive)]
+            was_active, old_frames = outcome.active, outcome.frames
+            frames = self._step(directive, outcome, frames)
+            stepped.append(directive)
+            if outcome.written is not None and outcome.active != was_active:
+                changed.add(outcome.written)
+            index += 1
+            expected = old_frames if index > until else boundary if index == until else None
+        self.last_evaluated = len(stepped)
+        self._result = None
+
+    def _opens_range(self, directive: Directive) -> bool:
+        """Whether a branch directive starts a skipped range: its branch is not taken but its group is active."""
+        frames = self._outcomes[id(directive)].frames
+        return (directive.type in BRANCH_TYPES and bool(frames)
+                and frames[-1][0] and not frames[-1][2])
+
+    def _closer(self, opener: Directive) -> Optional[Directive]:
+        """First directive after an opener that is not nested in its skipped range."""
+        directives = self.document.file_result.directives
+        outcomes = self._outcomes
+        for index in range(_bisect_line(directives, opener.line_number + 1), len(directives)):
+            directive = directives[index]
+            frames = outcomes[id(directive)].frames
+            if not frames or frames[-1][2] or self._opens_range(directive):
+                return directive
+        return None
+
+    def _rebuild_ranges(self) -> None:
+        """Find every skipped range."""
+        self._openers = [d for d in self.document.file_result.directives if self._opens_range(d)]
+        self._closers = {id(opener): self._closer(opener) for opener in self._openers}
+
+    def _update_ranges(self, removed: List[Directive], first_line: int) -> None:
+        """
+        Re-find the skipped ranges an edit and the walk after it may have changed.
+
+        Args:
+            removed: Directives the edit removed
+            first_line: First edited line, as _first_edited_line gives it
+        """
+        stepped = self._stepped
+        if len(stepped) * 8 > len(self.document.file_result.directives):
+            self._rebuild_ranges()
+            return
+        openers, closers = self._openers, self._closers
+        for directive in removed:
+            if closers.pop(id(directive), False) is not False:
+                _remove_by_line(openers, directive, first_line)
+        stale = {}
+        for directive in stepped:
+            opens = self._opens_range(directive)
+            if opens != (id(directive) in closers):
+                if opens:
+                    _insert_by_line(openers, directive)
+                else:
+                    del closers[id(directive)]
+                    _remove_by_line(openers, directive)
+            if opens:
+                stale[id(directive)] = directive
+        # A range reaching past a changed directive or the edited lines may now end elsewhere
+        for line_number in [first_line] + [directive.line_number for directive in stepped]:
+            index = _bisect_line(openers, line_number) - 1
+            if index >= 0:
+                opener = openers[index]
+                closer = closers.get(id(opener))
+                if closer is None or closer.line_number >= line_number:
+                    stale[id(opener)] = opener
+        for key, opener in stale.items():
+            closers[key] = self._closer(opener)
+
+    @property
+    def inactive_ranges(self) -> List[Tuple[int, int]]:
+        """Skipped line ranges, 1-based and inclusive, as EvaluationResult.inactive_ranges."""
+        line_count = self.document.file_result.line_count
+        ranges = []
+        for opener in self._openers:
+            closer = self._closers[id(opener)]
+            start, end = opener.line_number + 1, closer.line_number - 1 if closer else line_count
+            if start <= end:
+                ranges.append((start, end))
+        return ranges
+
+    def is_line_active(self, line_number: int) -> bool:
+        """Check whether a line is compiled, without materializing the result."""
+        index = _bisect_line(self._openers, line_number) - 1
+        if index < 0:
+            return True
+        closer = self._closers[id(self._openers[index])]
+        end = closer.line_number - 1 if closer else self.document.file_result.line_count
+        return line_number > end
+
+    def _next_reader(self, names: Set[str], line_number: int) -> Optional[int]:
+        """Index of the first directive after a line whose condition read one of names."""
+        first = None
+        for name in names:
+            readers = self._readers.get(name)
+            if readers:
+                position = _bisect_line(readers, line_number + 1)
+                if position < len(readers) and (first is None or readers[position].line_number < first):
+                    first = readers[position].line_number
+        if first is None:
+            return None
+        return _bisect_line(self.document.file_result.directives, first)
+
+    def _step(self, directive: Directive, outcome: _Outcome, frames: tuple) -> tuple:
+        """Evaluate one directive given the open groups before it; returns the groups after it."""
+        outcome.active = not frames or frames[-1][2]
+        outcome.taken = None
+        outcome.unparsed = False
+        directive_type = directive.type
+        if directive_type in OPENING_TYPES:
+            taken = self._decide(directive, outcome, outcome.active, False)
+            frames = frames + ((outcome.active, taken, taken),)
+        elif directive_type in (DirectiveType.ELIF, DirectiveType.ELSE):
+            if frames:
+                parent_active, any_taken, _ = frames[-1]
+                taken = self._decide(directive, outcome, parent_active, any_taken)
+                frames = frames[:-1] + ((parent_active, any_taken or taken, taken),)
+            else:
+                self._set_reads(directive, outcome, ())
+        elif directive_type == DirectiveType.ENDIF:
+            frames = frames[:-1]
+        outcome.frames = frames
+        return frames
+
+    def _decide(self, directive: Directive, outcome: _Outcome, parent_active: bool, any_taken: bool) -> bool:
+        """Decide whether a branch is taken, as ConfigurationEvaluator does."""
+        reads = ()
+        if not parent_active or any_taken:
+            taken = False
+        elif directive.type == DirectiveType.ELSE:
+            taken = True
+        else:
+            macros = _MacrosBefore(self, directive.line_number)
+            scratch = EvaluationResult()
+            taken = self.evaluator._condition_holds(directive, macros, scratch)
+            outcome.unparsed = bool(scratch.unparsed_lines)
+            reads = macros.reads
+        self._set_reads(directive, outcome, reads)
+        outcome.taken = taken
+        return taken
+
+    @property
+    def result(self) -> EvaluationResult:
+        """The EvaluationResult ConfigurationEvaluator.evaluate gives for the current text."""
+        if self._result is None:
+            self._result = self._materialize()
+        return self._result
+
+    def _materialize(self) -> EvaluationResult:
+        result = EvaluationResult(inactive_ranges=self.inactive_ranges)
+        outcomes = self._outcomes
+        for directive in self.document.file_result.directives:
+            outcome = outcomes[id(directive)]
+            if outcome.taken is not None:
+                result.taken[directive.line_number] = outcome.taken
+                if outcome.unparsed:
+                    result.unparsed_lines.append(directive.line_number)
+            elif directive.type == DirectiveType.ERROR and outcome.active:
+                result.errors.append(directive)
+
+        macros = dict(self.initial)
+        for name, writes in self._writes.items():
+            for directive in reversed(writes):
+                outcome = outcomes[id(directive)]
+                if outcome.active:
+                    if outcome.value is None:
+                        macros.pop(name, None)
+                    else:
+                        macros[name] = outcome.value
+                    break
+        result.macros = macros
+        return result
@@ -0,0 +1,450 @@
+"""
+Language Server Protocol frontend for the C++ Preprocessor Directive Analysis Tool.
+Serves hover contexts, inactive-region hints and validation diagnostics over
+stdio. Documents are kept in memory and updated incrementally on each edit,
+along with their validation errors, configuration evaluation and serialized
+diagnostics; diagnostics are published once a burst of edits pauses.
+"""
+
+import io
+import json
+import select
+import sys
+from typing import Any, BinaryIO, Dict, List, Optional, Set, Tuple
+
+from .data_models import Configuration, Directive, ErrorSeverity, ValidationError
+from .preprocessor_parser import PreprocessorParser
+from .context_analyzer import ContextAnalyzer
+from .configuration_evaluator import ConfigurationEvaluator
+from .incremental import DirectiveEdit, IncrementalDocument, IncrementalEvaluation, IncrementalValidation
+from .macro_timeline import MacroTimeline
+from .validation import DirectiveValidator
+
+
+# LSP constants
+TEXT_DOCUMENT_SYNC_INCREMENTAL = 2
+DIAGNOSTIC_SEVERITY = {
+    ErrorSeverity.CRITICAL: 1,
+    ErrorSeverity.ERROR: 1,
+    ErrorSeverity.WARNING: 2,
+}
+DIAGNOSTIC_SEVERITY_HINT = 4
+DIAGNOSTIC_TAG_UNNECESSARY = 1
+METHOD_NOT_FOUND = -32601
+INTERNAL_ERROR = -32603
+MESSAGE_TYPE_ERROR = 1
+DIAGNOSTIC_SOURCE = "cpp-preprocessor-analyzer"
+
+# Quiet time after a message before pending diagnostics are published, so a
+# burst of keystrokes publishes them once
+PUBLISH_DELAY_SECONDS = 0.05
+# Most bytes taken from the input stream per read
+READ_CHUNK_SIZE = 65536
+# Start of a diagnostic covering whole lines first..last, up to a UTF-16 column of last
+RANGE_JSON = '{"range":{"start":{"line":%d,"character":0},"end":{"line":%d,"character":%d}},'
+
+
+def utf16_to_index(line: str, offset: int) -> int:
+    """Convert an LSP UTF-16 column to a code point index."""
+    if line.isascii():
+        return min(offset, len(line))
+    units = 0
+    for index, char in enumerate(line):
+        if units >= offset:
+            return index
+        units += 2 if ord(char) > 0xFFFF else 1
+    return len(line)
+
+
+def index_to_utf16(line: str, index: int) -> int:
+    """Convert a code point index to an LSP UTF-16 column."""
+    prefix = line[:index]
+    if prefix.isascii():
+        return len(prefix)
+    return sum(2 if ord(char) > 0xFFFF else 1 for char in prefix)
+
+
+def _diagnostic_tail(severity: int, message: str, tags: Optional[List[int]] = None) -> str:
+    """JSON of a diagnostic's fields after its range, to append to RANGE_JSON."""
+    fields: Dict[str, Any] = {"severity": severity}
+    if tags:
+        fields["tags"] = tags
+    fields["source"] = DIAGNOSTIC_SOURCE
+    fields["message"] = message
+    return json.dumps(fields, separators=(',', ':'))[1:]
+
+
+def _error_tail(error: ValidationError) -> str:
+    return _diagnostic_tail(DIAGNOSTIC_SEVERITY[error.severity], error.message)
+
+
+class DocumentDiagnostics:
+    """
+    Diagnostics of one open document, serialized per directive.
+
+    A directive's errors are serialized when it is new or its errors may
+    have changed; edits elsewhere only move it, and its line is read when
+    the diagnostics are published. Skipped ranges come from the
+    IncrementalEvaluation, which keeps them per branch directive.
+    """
+
+    def __init__(self,
+                 document: IncrementalDocument,
+                 validation: IncrementalValidation,
+                 evaluation: IncrementalEvaluation):
+        self.document = document
+        self.validation = validation
+        self.evaluation = evaluation
+        # id() of a directive -> (directive, UTF-16 length of its line, diagnostics after their range)
+        self._entries: Dict[int, Tuple[Directive, int, List[str]]] = {}
+        for directive in document.file_result.directives:
+            self._refresh(directive)
+        # After the validation and evaluation listeners, whose results it reads
+        document.listeners.append(self.update)
+
+    def update(self, edit: DirectiveEdit) -> None:
+        """Follow an edit of the document."""
+        for directive in edit.removed:
+            self._entries.pop(id(directive), None)
+        reanalyzed = max(edit.inserted, edit.reanalyzed)
+        for directive in self.document.file_result.directives[edit.start:edit.start + reanalyzed]:
+            self._refresh(directive)
+        for directive in self.validation.changed:
+            self._refresh(directive)
+
+    def _refresh(self, directive: Directive) -> None:
+        errors = self.document.errors_of(directive) + self.validation.errors_of(directive)
+        if not errors:
+            self._entries.pop(id(directive), None)
+            return
+        line = self.document.lines[directive.line_number - 1]
+        self._entries[id(directive)] = (directive, index_to_utf16(line, len(line)),
+                                        [_error_tail(error) for error in errors])
+
+    def to_json(self, configuration_name: str) -> str:
+        """
+        The diagnostics as a JSON array.
+
+        Args:
+            configuration_name: Configuration named in inactive-range hints
+        """
+        items = []
+        for directive, end, tails in self._entries.values():
+            line = directive.line_number - 1
+            head = RANGE_JSON % (line, line, end)
+            items.extend(head + tail for tail in tails)
+        for error in self.document.end_errors:
+            line = max(error.line_number - 1, 0)
+            items.append(self._range_json(line, line) + _error_tail(error))
+        hint = _diagnostic_tail(DIAGNOSTIC_SEVERITY_HINT, f"Inactive under configuration '{configuration_name}'",
+                                [DIAGNOSTIC_TAG_UNNECESSARY])
+        for start, end in self.evaluation.inactive_ranges:
+            items.append(self._range_json(start - 1, end - 1) + hint)
+        return "[" + ",".join(items) + "]"
+
+    def _range_json(self, first: int, last: int) -> str:
+        """RANGE_JSON covering whole lines first..last (0-based), clamped to the document."""
+        lines = self.document.lines
+        last = min(last, len(lines) - 1)
+        first = min(first, last)
+        return RANGE_JSON % (first, last, index_to_utf16(lines[last], len(lines[last])))
+
+
+class LanguageServer:
+    """
+    Minimal stdio language server.
+
+    Supports textDocument/didOpen, didChange (incremental), didClose, hover
+    and workspace/didChangeConfiguration. The configuration used to grey out
+    inactive regions comes from the command line, initializationOptions or
+    the "defines"/"undefs" settings.
+    """
+
+    def __init__(self,
+                 configuration: Optional[Configuration] = None,
+                 reader: Optional[BinaryIO] = None,
+                 writer: Optional[BinaryIO] = None):
+        self.configuration = configuration or Configuration()
+        self.reader = reader or sys.stdin.buffer
+        self.writer = writer or sys.stdout.buffer
+        self.parser = PreprocessorParser()
+        self.context_analyzer = ContextAnalyzer()
+        self.evaluator = ConfigurationEvaluator()
+        self.validator = DirectiveValidator()
+        self.documents: Dict[str, IncrementalDocument] = {}
+        self.validations: Dict[str, IncrementalValidation] = {}
+        self.evaluations: Dict[str, IncrementalEvaluation] = {}
+        self.diagnostics: Dict[str, DocumentDiagnostics] = {}
+        # Documents whose diagnostics changed since they were last published
+        self.pending_diagnostics: Set[str] = set()
+        self._input = bytearray()
+        # Follows every document edit, so hovers never reindex a document
+        self.timeline = MacroTimeline()
+        self.shutdown_requested = False
+        self.running = True
+
+    # Transport
+
+    def serve(self) -> int:
+        """
+        Process messages until exit; returns the process exit code.
+
+        Pending diagnostics are published once no message arrives for
+        PUBLISH_DELAY_SECONDS, so typing publishes them once per pause
+        instead of once per keystroke.
+        """
+        while self.running:
+            if self.pending_diagnostics and not self._input_waiting(PUBLISH_DELAY_SECONDS):
+                self.publish_pending()
+            message = self.read_message()
+            if message is None:
+                break
+            self.handle_message(message)
+        return 0 if self.shutdown_requested else 1
+
+    def read_message(self) -> Optional[Dict[str, Any]]:
+        """Read one Content-Length framed JSON-RPC message."""
+        header_end = self._input.find(b"\r\n\r\n")
+        while header_end < 0:
+            if not self._fill():
+                return None
+            header_end = self._input.find(b"\r\n\r\n")
+        content_length = None
+        for header in bytes(self._input[:header_end]).split(b"\r\n"):
+            name, _, value = header.decode('ascii').partition(':')
+            if name.strip().lower() == 'content-length':
+                content_length = int(value.strip())
+        if content_length is None:
+            return None
+        end = header_end + 4 + content_length
+        while len(self._input) < end:
+            if not self._fill():
+                return None
+        body = bytes(self._input[header_end + 4:end])
+        del self._input[:end]
+        return json.loads(body.decode('utf-8'))
+
+    def _fill(self) -> bool:
+        """Append the next chunk of input to the buffer; False at end of input."""
+        # read1 also empties the reader's own buffer, so select() sees all unread input
+        chunk = self.reader.read1(READ_CHUNK_SIZE)
+        self._input += chunk
+        return bool(chunk)
+
+    def _input_waiting(self, timeout: float) -> bool:
+        """Whether another message arrives within timeout seconds."""
+        if self._input:
+            return True
+        try:
+            ready, _, _ = select.select([self.reader], [], [], timeout)
+        except (OSError, ValueError, io.UnsupportedOperation):
+            # In-memory streams, or a platform whose select() only takes sockets
+            return False
+        return bool(ready)
+
+    def send(self, message: Dict[str, Any]) -> None:
+        """Write one JSON-RPC message."""
+        message["jsonrpc"] = "2.0"
+        self._write(json.dumps(message, separators=(',', ':')).encode('utf-8'))
+
+    def _write(self, body: bytes) -> None:
+        """Write one Content-Length framed message body."""
+        self.writer.write(f"Content-Length: {len(body)}\r\n\r\n".encode('ascii') + body)
+        self.writer.flush()
+
+    def notify(self, method: str, params: Dict[str, Any]) -> None:
+        """Send a notification to the client."""
+        self.send({"method": method, "params": params})
+
+    def handle_message(self, message: Dict[str, Any]) -> None:
+        """Dispatch a request or notification to its handler."""
+        method = message.get("method")
+        handler = getattr(self, "_on_" + (method or "").replace('/', '_').replace('$', '_'), None)
+        request_id = message.get("id")
+
+        if handler is None:
+            if request_id is not None and method is not None:
+                self.send({"id": request_id,
+                           "error": {"code": METHOD_NOT_FOUND, "message": f"Unsupported method: {method}"}})
+            return
+
+        # A failing handler must not end the session: requests get an error
+        # response, failed notifications are logged to the client
+        try:
+            result = handler(message.get("params") or {})
+        except Exception as e:
+            error = f"{method} failed: {type(e).__name__}: {e}"
+            if request_id is not None:
+                self.send({"id": request_id, "error": {"code": INTERNAL_ERROR, "message": error}})
+            else:
+                self.notify("window/logMessage", {"type": MESSAGE_TYPE_ERROR, "message": error})
+            return
+        if request_id is not None:
+            self.send({"id": request_id, "result": result})
+
+    # Lifecycle
+
+    def _on_initialize(self, params: Dict[str, Any]) -> Dict[str, Any]:
+        self._update_configuration(params.get("initializationOptions"))
+        return {
+            "capabilities": {
+                "textDocumentSync": {"openClose": True, "change": TEXT_DOCUMENT_SYNC_INCREMENTAL},
+                "hoverProvider": True,
+            },
+            "serverInfo": {"name": "cpp-preprocessor-analyzer"},
+        }
+
+    def _on_initialized(self, params: Dict[str, Any]) -> None:
+        return None
+
+    def _on_shutdown(self, params: Dict[str, Any]) -> None:
+        self.shutdown_requested = True
+        return None
+
+    def _on_exit(self, params: Dict[str, Any]) -> None:
+        self.running = False
+
+    def _on_workspace_didChangeConfiguration(self, params: Dict[str, Any]) -> None:
+        self._update_configuration(params.get("settings"))
+        for uri in self.documents:
+            self.evaluations[uri].set_configuration(self.configuration)
+            self.pending_diagnostics.add(uri)
+
+    def _update_configuration(self, settings: Optional[Dict[str, Any]]) -> None:
+        """Apply "defines"/"undefs" settings to the active configuration."""
+        if not settings or ("defines" not in settings and "undefs" not in settings):
+            return
+        self.configuration = Configuration(
+            name=settings.get("name", self.configuration.name),
+            defines={name: "" if value is None else str(value)
+                     for name, value in settings.get("defines", {}).items()},
+            undefs=list(settings.get("undefs", []))
+        )
+
+    # Document synchronization
+
+    def _on_textDocument_didOpen(self, params: Dict[str, Any]) -> None:
+        item = params["textDocument"]
+        document = self.documents[item["uri"]] = IncrementalDocument(
+            item["uri"], item.get("text", ""), self.parser, self.context_analyzer
+        )
+        self.validations[item["uri"]] = IncrementalValidation(document, self.validator)
+        self.evaluations[item["uri"]] = IncrementalEvaluation(document, self.configuration, self.evaluator)
+        self.timeline.replace_file(item["uri"], document.file_result.directives)
+        document.listeners.append(
+            lambda edit: self.timeline.apply_edit(document.file_path, document.file_result.directives, edit)
+        )
+        self.diagnostics[item["uri"]] = DocumentDiagnostics(
+            document, self.validations[item["uri"]], self.evaluations[item["uri"]]
+        )
+        self.pending_diagnostics.add(item["uri"])
+
+    def _on_textDocument_didChange(self, params: Dict[str, Any]) -> None:
+        uri = params["textDocument"]["uri"]
+        document = self.documents.get(uri)
+        if document is None:
+            return
+        for change in params.get("contentChanges", []):
+            change_range = change.get("range")
+            if change_range is None:
+                document.set_text(change["text"])
+                continue
+            document.apply_change(
+                self._position(document, change_range["start"]),
+                self._position(document, change_range["end"]),
+                change["text"]
+            )
+        self.pending_diagnostics.add(uri)
+
+    def _on_textDocument_didClose(self, params: Dict[str, Any]) -> None:
+        uri = params["textDocument"]["uri"]
+        self.documents.pop(uri, None)
+        self.validations.pop(uri, None)
+        self.evaluations.pop(uri, None)
+        self.diagnostics.pop(uri, None)
+        self.pending_diagnostics.discard(uri)
+        self.timeline.remove_file(uri)
+        self.notify("textDocument/publishDiagnostics", {"uri": uri, "diagnostics": []})
+
+    def _position(self, document: IncrementalDocument, position: Dict[str, int]):
+        """Convert an LSP position to a (line, code point column) pair."""
+        line = position["line"]
+        if line >= len(document.lines):
+            return len(document.lines) - 1, len(document.lines[-1])
+        return line, utf16_to_index(document.lines[line], position["character"])
+
+    # Features
+
+    def publish_diagnostics(self, uri: str) -> None:
+        """Send validation diagnostics and inactive-region hints for a document."""
+        # The diagnostics are already JSON; splice them in rather than re-encode them
+        body = '{"jsonrpc":"2.0","method":"textDocument/publishDiagnostics","params":{"uri":%s,"diagnostics":%s}}' % (
+            json.dumps(uri), self.diagnostics[uri].to_json(self.configuration.name))
+        self._write(body.encode('utf-8'))
+
+    def publish_pending(self) -> None:
+        """Publish the diagnostics of every document changed since they were last published."""
+        pending, self.pending_diagnostics = self.pending_diagnostics, set()
+        for uri in sorted(pending):
+            try:
+                self.publish_diagnostics(uri)
+            except Exception as e:
+                self.notify("window/logMessage", {
+                    "type": MESSAGE_TYPE_ERROR,
+                    "message": f"textDocument/publishDiagnostics failed: {type(e).__name__}: {e}",
+                })
+
+    def compute_diagnostics(self, uri: str) -> List[Dict[str, Any]]:
+        """Build the LSP diagnostics for an open document."""
+        return json.loads(self.diagnostics[uri].to_json(self.configuration.name))
+
+    def _on_textDocument_hover(self, params: Dict[str, Any]) -> Optional[Dict[str, Any]]:
+        uri = params["textDocument"]["uri"]
+        document = self.documents.get(uri)
+        if document is None:
+            return None
+        line = params["position"]["line"]
+        if line >= len(document.lines):
+            return None
+
+        sections = [f"**Context:** `{self.context_at(document, line + 1) or 'global'}`"]
+
+        state = "active" if self.evaluations[uri].is_line_active(line + 1) else "inactive"
+        sections.append(f"Line is {state} under configuration `{self.configuration.name}`")
+
+        symbol = self._word_at(document.lines[line], utf16_to_index(document.lines[line], params["position"]["character"]))
+        if symbol:
+            definitions = [event for event in self.timeline.events_of(symbol, uri) if event.kind == "define"]
+            if definitions:
+                sections.append(f"**{symbol}** is defined {len(definitions)} time(s):")
+                for define in definitions:
+                    context = " && ".join(define.context) or "global"
+                    sections.append(f"- line {define.line_number}: `{symbol}{define.parameters or ''} {define.value}`"
+                                    f" when `{context}`")
+            state = self.timeline.state_at(symbol, uri, line + 1)
+            if state.status == "defined":
+                sections.append(f"**{symbol}** is `{state.value}` here (line {state.events[-1].line_number})")
+            elif state.status == "undefined":
+                sections.append(f"**{symbol}** is undefined here (line {state.events[-1].line_number})")
+            elif state.status == "conditional":
+                lines = ", ".join(str(event.line_number) for event in reversed(state.events))
+                sections.append(f"**{symbol}** here depends on the configuration (lines {lines})")
+
+        return {"contents": {"kind": "markdown", "value": "\n\n".join(sections)}}
+
+    def context_at(self, document: IncrementalDocument, line_number: int) -> str:
+        """Get the conditional context of a 1-based line as an expression."""
+        return " && ".join(self.timeline.context_at(document.file_path, line_number))
+
+    def _word_at(self, line: str, index: int) -> Optional[str]:
+        """Return the identifier under a column, if any."""
+        start = index
+        while start > 0 and (line[start - 1].isalnum() or line[start - 1] == '_'):
+            start -= 1
+        end = index
+        while end < len(line) and (line[end].isalnum() or line[end] == '_'):
+            end += 1
+        word = line[start:end]
+        if word and (word[0].isalpha() or word[0] == '_'):
+            return word
+        return None
@@ -0,0 +1,223 @@
+"""
+Macro conflict detection module.
+Finds, per translation unit, macros that two reachable files define with
+different values, so the value seen depends on include order. Each macro's
+definitions are grouped once by value and context, with a bitset of the
+files defining each group; a translation unit has a conflict when its
+include closure reaches two groups with different values and compatible
+contexts. Only the groups a closure reaches are compared, so a macro every
+file defines differently costs linear, not quadratic, time.
+"""
+
+import os
+import re
+from dataclasses import dataclass, field
+from typing import Any, Dict, FrozenSet, Iterable, List, Optional, Set, Tuple
+
+from .data_models import Configuration, Directive, FileAnalysisResult
+from .include_graph import IncludeGraph, IncludeResolver
+from .symbol_index import MacroDefinition, SymbolIndex
+
+
+DEFINED_ATOM = re.compile(r'^defined\s*(?:\(\s*([A-Za-z_]\w*)\s*\)|([A-Za-z_]\w*))$')
+
+
+@dataclass
+class MacroConflict:
+    """
+    A macro defined differently by files reachable from one translation unit.
+
+    Attributes:
+        translation_unit: Translation unit the conflict was found in
+        macro: Macro name
+        definitions: The conflicting definitions, ordered by file and line
+    """
+    translation_unit: str
+    macro: str
+    definitions: List[MacroDefinition] = field(default_factory=list)
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert conflict to dictionary for serialization."""
+        return {
+            "translation_unit": self.translation_unit,
+            "macro": self.macro,
+            "definitions": [d.to_dict() for d in self.definitions]
+        }
+
+
+def _literals(context: List[str]) -> Set[Tuple[str, bool]]:
+    """Reduce context conditions to (atom, negated) pairs; defined(X) becomes X."""
+    literals = set()
+    for condition in context:
+        text = condition.strip()
+        negated = False
+        while text.startswith("!"):
+            negated = not negated
+            text = text[1:].strip()
+        match = DEFINED_ATOM.match(text)
+        if match:
+            text = match.group(1) or match.group(2)
+        literals.add((text, negated))
+    return literals
+
+
+class _DefinitionGroup:
+    """Definitions of one macro sharing a value and a context."""
+    __slots__ = ('value', 'literals', 'files', 'definitions')
+
+    def __init__(self, value: str, literals: FrozenSet[Tuple[str, bool]]):
+        self.value = value
+        self.literals = literals
+        # Bitset of the files holding the definitions
+        self.files = 0
+        # (file bit, definition) pairs
+        self.definitions: List[Tuple[int, MacroDefinition]] = []
+
+    def excludes(self, other: '_DefinitionGroup') -> bool:
+        """Check whether the contexts of two groups contradict each other."""
+        return any((atom, not negated) in other.literals for atom, negated in self.literals)
+
+
+class MacroConflictDetector:
+    """
+    Detects include-order dependent macro definitions per translation unit.
+
+    Two definitions conflict when they are in different files, have
+    different values, and their contexts do not contradict each other.
+    Definitions guarded by `#ifndef NAME` only supply a default and never
+    conflict.
+    """
+
+    def __init__(self, graph: IncludeGraph, index: SymbolIndex):
+        self.graph = graph
+        self.index = index
+        # macro -> (bitset of files defining it, file position -> groups defined there)
+        self._groups: Dict[str, Tuple[int, Dict[int, List[_DefinitionGroup]]]] = {}
+        self._prepare()
+
+    @classmethod
+    def from_translation_units(cls, translation_units: Iterable[Tuple[str, Optional[Configuration]]],
+                               analyzer=None, deps_log=None) -> 'MacroConflictDetector':
+        """
+        Build the include graph and symbol index for a set of translation units.
+
+        Args:
+            translation_units: (file, configuration) pairs; only the
+                configuration's include paths are used
+            analyzer: Analyzer used to parse files (default: Analyzer())
+            deps_log: NinjaDepsLog supplying the headers of units it has a
+                fresh entry for, instead of resolving their #includes
+
+        Returns:
+            MacroConflictDetector over every file the units can reach
+        """
+        if analyzer is None:
+            from .api import Analyzer
+            analyzer = Analyzer()
+
+        results: Dict[str, FileAnalysisResult] = {}
+        resolvers: Dict[Tuple[str, ...], IncludeResolver] = {}
+
+        def load(file_path: str) -> List[Directive]:
+            if file_path not in results:
+                results[file_path] = analyzer.analyze_file(file_path)
+            return results[file_path].directives
+
+        sources = []
+        for file_path, configuration in translation_units:
+            file_path = os.path.normpath(os.path.abspath(file_path))
+            include_paths = tuple(configuration.include_paths) if configuration else ()
+            if include_paths not in resolvers:
+                resolvers[include_paths] = IncludeResolver(include_paths)
+            sources.append((file_path, resolvers[include_paths]))
+
+        if deps_log is None:
+            graph = IncludeGraph.build(sources, load)
+        else:
+            from .ninja_deps import build_include_graph
+            graph = build_include_graph(sources, load, deps_log)[0]
+            for file_path in graph.paths:
+                if os.path.isfile(file_path):
+                    load(file_path)
+        return cls(graph, SymbolIndex.from_results(results.values()))
+
+    def _prepare(self) -> None:
+        """Group each macro's definitions among files in the graph by value and context."""
+        for name, definitions in self.index.definitions.items():
+            groups: Dict[Tuple[str, FrozenSet[Tuple[str, bool]]], _DefinitionGroup] = {}
+            for definition in definitions:
+                position = self.graph.position(definition.file_path)
+                literals = frozenset(_literals(definition.context))
+                if position is None or (name, True) in literals:
+                    continue
+                group = groups.get((definition.value, literals))
+                if group is None:
+                    group = groups[definition.value, literals] = _DefinitionGroup(definition.value, literals)
+                group.files |= 1 << position
+                group.definitions.append((1 << position, definition))
+            if len({group.value for group in groups.values()}) < 2:
+                continue
+
+            files = 0
+            by_file: Dict[int, List[_DefinitionGroup]] = {}
+            for group in groups.values():
+                files |= group.files
+                bits = group.files
+                while bits:
+                    lowest = bits & -bits
+                    by_file.setdefault(lowest.bit_length() - 1, []).append(group)
+                    bits ^= lowest
+            if files & (files - 1):
+                self._groups[name] = (files, by_file)
+
+    def conflicts(self, file_path: str) -> List[MacroConflict]:
+        """
+        Get the conflicting macros reachable from a translation unit.
+
+        Args:
+            file_path: Translation unit added to the graph
+
+        Returns:
+            Conflicts sorted by macro name
+        """
+        file_path = os.path.normpath(os.path.abspath(file_path))
+        closure = self.graph.closure(file_path)
+        conflicts = []
+        for name, (files, by_file) in self._groups.items():
+            reachable = files & closure
+            if not reachable & (reachable - 1):
+                continue  # Fewer than two of the files are included
+
+            groups: Dict[int, Tuple[_DefinitionGroup, int]] = {}
+            while reachable:
+                lowest = reachable & -reachable
+                for group in by_file[lowest.bit_length() - 1]:
+                    groups[id(group)] = (group, group.files & closure)
+                reachable ^= lowest
+
+            involved: Dict[int, MacroDefinition] = {}
+            reached = list(groups.values())
+            for i, (first, first_files) in enumerate(reached):
+                for second, second_files in reached[i + 1:]:
+                    both = first_files | second_files
+                    if first.value == second.value or not both & (both - 1) or first.excludes(second):
+                        continue
+                    # A definition conflicts with the other group's definitions in other files
+                    for group, other_files in ((first, second_files), (second, first_files)):
+                        for bit, definition in group.definitions:
+                            if bit & closure and other_files & ~bit:
+                                involved[id(definition)] = definition
+            if involved:
+                definitions = sorted(involved.values(), key=lambda d: (d.file_path, d.line_number))
+                conflicts.append(MacroConflict(file_path, name, definitions))
+        conflicts.sort(key=lambda c: c.macro)
+        return conflicts
+
+    def detect(self, translation_units: Iterable[str]) -> Dict[str, List[MacroConflict]]:
+        """Get the conflicts of each translation unit that has any."""
+        found = {}
+        for file_path in translation_units:
+            conflicts = self.conflicts(file_path)
+            if conflicts:
+                found[file_path] = conflicts
+        return found
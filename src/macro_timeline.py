@@ -0,0 +1,342 @@
+"""
+Macro timeline module.
+Keeps, per macro and per file, the #define and #undef events sorted by
+line, so "is LOG_BUFFER_SIZE defined at line 300 of logger.h?" is answered
+by a binary search instead of replaying the file. Events guarded by
+conditions are weighed against the conditional context of the queried
+line: an event the line's context implies settles the answer, one it
+excludes is skipped, and any other makes the answer conditional.
+"""
+
+from bisect import bisect_left, bisect_right
+from dataclasses import dataclass, field
+from typing import Any, Dict, Iterable, List, Optional, Tuple
+
+from .configuration_evaluator import split_define
+from .context_query import ContextSemantics
+from .data_models import AnalysisResult, Directive, DirectiveType
+
+
+# Directives that are macro events
+EVENT_TYPES = {DirectiveType.DEFINE, DirectiveType.UNDEF}
+
+# Directives whose recorded context is the context of the lines following them
+CONTEXT_TYPES = {
+    DirectiveType.IFDEF, DirectiveType.IFNDEF, DirectiveType.IF,
+    DirectiveType.ELIF, DirectiveType.ELSE, DirectiveType.ENDIF,
+    DirectiveType.DEFINE, DirectiveType.UNDEF,
+    DirectiveType.ERROR, DirectiveType.WARNING, DirectiveType.PRAGMA,
+}
+
+
+@dataclass
+class MacroEvent:
+    """
+    A #define or #undef of a macro.
+
+    Attributes:
+        kind: "define" or "undef"
+        line_number: Line of the directive (1-based)
+        context: Conditions the directive is nested in
+        value: Replacement text, for defines
+        parameters: Parameter list of function-like defines
+    """
+    kind: str
+    line_number: int
+    context: List[str] = field(default_factory=list)
+    value: Optional[str] = None
+    parameters: Optional[str] = None
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert event to dictionary for serialization."""
+        return {
+            "kind": self.kind,
+            "line_number": self.line_number,
+            "context": list(self.context),
+            "value": self.value,
+            "parameters": self.parameters
+        }
+
+
+@dataclass
+class MacroState:
+    """
+    Whether a macro is defined at a line of a file.
+
+    Attributes:
+        name: Macro name
+        file_path: File queried
+        line_number: Line queried (1-based); events on it are not yet in effect
+        status: "defined" or "undefined" when an event settles it, "conditional"
+            when it depends on the configuration, "unknown" when the file has
+            no event reaching the line (the macro comes from outside the file)
+        value: Replacement text when defined
+        events: Events that may be in effect, latest first; the last one
+            settles the state unless the status is "conditional"
+    """
+    name: str
+    file_path: str
+    line_number: int
+    status: str
+    value: Optional[str] = None
+    events: List[MacroEvent] = field(default_factory=list)
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert state to dictionary for serialization."""
+        return {
+            "name": self.name,
+            "file_path": self.file_path,
+            "line_number": self.line_number,
+            "status": self.status,
+            "value": self.value,
+            "events": [event.to_dict() for event in self.events]
+        }
+
+
+class MacroTimeline:
+    """
+    Sorted #define/#undef events per macro and file, with the context of
+    each file's lines.
+
+    Files are indexed independently, so an editor or incremental engine
+    replaces one file's events when it changes without touching the rest.
+    Conditions are treated as fixed by the configuration, i.e. a macro
+    defined between a condition and the queried line is not assumed to
+    change that condition.
+    """
+
+    def __init__(self):
+        self.events: Dict[str, Dict[str, List[MacroEvent]]] = {}
+        self._lines: Dict[str, Dict[str, List[int]]] = {}
+        self._symbols: Dict[str, List[str]] = {}
+        self._context_lines: Dict[str, List[int]] = {}
+        self._contexts: Dict[str, List[List[str]]] = {}
+        self.semantics = ContextSemantics()
+
+    @classmethod
+    def from_analysis(cls, result: AnalysisResult) -> 'MacroTimeline':
+        """Index every file of an analysis result."""
+        timeline = cls()
+        for file_result in result.file_results.values():
+            timeline.replace_file(file_result.file_path, file_result.directives)
+        return timeline
+
+    @classmethod
+    def from_analysis_dict(cls, data: Dict[str, Any]) -> 'MacroTimeline':
+        """Index the directives of saved analysis results."""
+        timeline = cls()
+        for file_path, file_data in data.get("file_results", {}).items():
+            timeline.replace_file(file_path, [Directive.from_dict(d) for d in file_data.get("directives", [])])
+        return timeline
+
+    def replace_file(self, file_path: str, directives: Iterable[Directive]) -> None:
+        """
+        Index the events of one file, replacing any previous ones.
+
+        Args:
+            file_path: File the directives come from
+            directives: The file's analyzed directives, in line order
+        """
+        self.remove_file(file_path)
+        lines: Dict[str, List[int]] = {}
+        events: Dict[str, List[MacroEvent]] = {}
+        context_lines: List[int] = []
+        contexts: List[List[str]] = []
+        for directive in directives:
+            if directive.type in CONTEXT_TYPES:
+                context_lines.append(directive.line_number)
+                contexts.append(list(directive.context))
+            event = self._event(directive)
+            if event is None:
+                continue
+            lines.setdefault(directive.symbol_name, []).append(directive.line_number)
+            events.setdefault(directive.symbol_name, []).append(event)
+
+        for name, symbol_lines in lines.items():
+            symbol_events = events[name]
+            if any(a > b for a, b in zip(symbol_lines, symbol_lines[1:])):
+                order = sorted(range(len(symbol_lines)), key=symbol_lines.__getitem__)
+                symbol_lines = [symbol_lines[i] for i in order]
+                symbol_events = [symbol_events[i] for i in order]
+            self._lines.setdefault(name, {})[file_path] = symbol_lines
+            self.events.setdefault(name, {})[file_path] = symbol_events
+        self._symbols[file_path] = list(lines)
+        self._context_lines[file_path] = context_lines
+        self._contexts[file_path] = contexts
+
+    def remove_file(self, file_path: str) -> None:
+        """Forget the events of a file."""
+        for name in self._symbols.pop(file_path, []):
+            del self._lines[name][file_path]
+            del self.events[name][file_path]
+            if not self.events[name]:
+                del self._lines[name]
+                del self.events[name]
+        self._context_lines.pop(file_path, None)
+        self._contexts.pop(file_path, None)
+
+    def apply_edit(self, file_path: str, directives: List[Directive], edit: 'DirectiveEdit') -> None:
+        """
+        Follow an edit of an IncrementalDocument without reindexing the file.
+
+        Events and contexts of removed directives are dropped, those of new
+        ones added and later ones shifted by the edit's line delta; contexts
+        are refreshed only for directives the document reanalyzed.
+
+        Args:
+            file_path: File indexed with replace_file
+            directives: The document's directives after the edit
+            edit: DirectiveEdit reported by the document
+        """
+        if not edit.first_line or file_path not in self._symbols:
+            self.replace_file(file_path, directives)
+            return
+        first_line, delta = edit.first_line, edit.line_delta
+        new = directives[edit.start:edit.start + edit.inserted]
+
+        # Removed directives keep their old line numbers, all in the edited
+        # span, so their entries are the first ones at or after first_line
+        context_lines = self._context_lines[file_path]
+        contexts = self._contexts[file_path]
+        added = [directive for directive in new if directive.type in CONTEXT_TYPES]
+        low = bisect_left(context_lines, first_line)
+        high = low + sum(1 for directive in edit.removed if directive.type in CONTEXT_TYPES)
+        context_lines[low:high] = [directive.line_number for directive in added]
+        contexts[low:high] = [list(directive.context) for directive in added]
+        if delta:
+            for index in range(low + len(added), len(context_lines)):
+                context_lines[index] += delta
+
+        removed_events: Dict[str, int] = {}
+        for directive in edit.removed:
+            if directive.symbol_name and directive.type in EVENT_TYPES:
+                removed_events[directive.symbol_name] = removed_events.get(directive.symbol_name, 0) + 1
+        added_events: Dict[str, List[MacroEvent]] = {}
+        for directive in new:
+            event = self._event(directive)
+            if event is not None:
+                added_events.setdefault(directive.symbol_name, []).append(event)
+
+        symbols = self._symbols[file_path]
+        names = set(removed_events) | set(added_events)
+        for name in (set(symbols) | names) if delta else names:
+            lines = self._lines.get(name, {}).get(file_path)
+            if lines is None:
+                symbols.append(name)
+                lines = self._lines.setdefault(name, {})[file_path] = []
+                self.events.setdefault(name, {})[file_path] = []
+            events = self.events[name][file_path]
+            inserted = added_events.get(name, [])
+            low = bisect_left(lines, first_line)
+            high = low + removed_events.get(name, 0)
+            lines[low:high] = [event.line_number for event in inserted]
+            events[low:high] = inserted
+            if delta:
+                for index in range(low + len(inserted), len(lines)):
+                    lines[index] += delta
+                    events[index].line_number += delta
+            if not lines:
+                symbols.remove(name)
+                del self._lines[name][file_path]
+                del self.events[name][file_path]
+                if not self.events[name]:
+                    del self._lines[name]
+                    del self.events[name]
+
+        # Past the new directives, reanalysis only changes contexts
+        for directive in directives[edit.start + edit.inserted:edit.start + edit.reanalyzed]:
+            if directive.type in CONTEXT_TYPES:
+                contexts[bisect_left(context_lines, directive.line_number)] = list(directive.context)
+            if directive.symbol_name and directive.type in EVENT_TYPES:
+                lines = self._lines[directive.symbol_name][file_path]
+                event = self.events[directive.symbol_name][file_path][bisect_left(lines, directive.line_number)]
+                event.context = list(directive.context)
+
+    @staticmethod
+    def _event(directive: Directive) -> Optional[MacroEvent]:
+        if not directive.symbol_name:
+            return None
+        if directive.type == DirectiveType.DEFINE:
+            _, parameters, value = split_define(directive.content)
+            return MacroEvent("define", directive.line_number, list(directive.context), value, parameters)
+        if directive.type == DirectiveType.UNDEF:
+            return MacroEvent("undef", directive.line_number, list(directive.context))
+        return None
+
+    @property
+    def files(self) -> List[str]:
+        """Files indexed, in indexing order."""
+        return list(self._symbols)
+
+    def symbols(self) -> List[str]:
+        """Macros with at least one event, sorted."""
+        return sorted(self.events)
+
+    def events_of(self, name: str, file_path: Optional[str] = None) -> List[MacroEvent]:
+        """Events of a macro in one file, or in every file in indexing order."""
+        by_file = self.events.get(name, {})
+        if file_path is not None:
+            return list(by_file.get(file_path, []))
+        return [event for file_events in by_file.values() for event in file_events]
+
+    def context_at(self, file_path: str, line_number: int) -> List[str]:
+        """Conditional context of a line, from the directive preceding it."""
+        index = bisect_right(self._context_lines.get(file_path, []), line_number) - 1
+        return list(self._contexts[file_path][index]) if index >= 0 else []
+
+    def state_at(self, name: str, file_path: str, line_number: int,
+                 context: Optional[List[str]] = None) -> MacroState:
+        """
+        Answer whether a macro is defined at a line of a file.
+
+        Events before the line are found by binary search and walked back
+        from the latest: one the line's context excludes never ran, one it
+        implies (or an unconditional one) settles the state, and any other
+        may or may not have run.
+
+        Args:
+            name: Macro name
+            file_path: File indexed with replace_file
+            line_number: Line (1-based); a directive on it is not yet in effect
+            context: Context of the line, instead of the one recorded for it
+
+        Returns:
+            State of the macro with the events it depends on
+        """
+        state = MacroState(name, file_path, line_number, "unknown")
+        lines = self._lines.get(name, {}).get(file_path)
+        if not lines:
+            return state
+        events = self.events[name][file_path]
+        semantics = self.semantics
+        line_context = semantics.context_id(self.context_at(file_path, line_number) if context is None else context)
+        for index in range(bisect_left(lines, line_number) - 1, -1, -1):
+            event = events[index]
+            certain, excluded = self._relation(line_context, event.context)
+            if excluded:
+                continue
+            state.events.append(event)
+            if certain:
+                if state.status == "unknown":
+                    state.status = "defined" if event.kind == "define" else "undefined"
+                    state.value = event.value
+                return state
+            state.status = "conditional"
+        return state
+
+    def _relation(self, line_context: int, event_context: List[str]) -> Tuple[bool, bool]:
+        """Whether an event's context is implied by, or excluded by, a line's context."""
+        if not event_context:
+            return True, False
+        semantics = self.semantics
+        formula = semantics.formula(semantics.context_id(event_context))
+        if semantics.implies(line_context, formula):
+            return True, False
+        return False, bool(semantics.excludes(line_context, formula))
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert timeline to dictionary for serialization."""
+        return {
+            name: {file_path: [event.to_dict() for event in events] for file_path, events in by_file.items()}
+            for name, by_file in sorted(self.events.items())
+        }
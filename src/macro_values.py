@@ -0,0 +1,205 @@
+"""
+Macro value module.
+Folds the object-like macros in effect after a translation unit to integer
+or string constants, per configuration, and lays them out as a
+symbol x configuration matrix so configurations can be diffed without
+compiling. Folding is memoized per configuration and, for a given
+replacement text and folded dependencies, across configurations.
+"""
+
+import re
+from dataclasses import dataclass, field
+from typing import Any, Dict, Iterable, List, Mapping, Optional, Tuple, Union
+
+from .condition_parser import (
+    Binary, ConditionSyntaxError, Call, Defined, evaluate, parse_condition, referenced_symbols
+)
+from .data_models import Configuration
+from .header_summary import HeaderSummaryCache
+
+
+STRING_LITERALS = re.compile(r'^(?:\s*"(?:[^"\\]|\\.)*")+\s*$')
+STRING_LITERAL = re.compile(r'"((?:[^"\\]|\\.)*)"')
+IDENTIFIER = re.compile(r'^[A-Za-z_][A-Za-z0-9_]*$')
+
+# Folded value: an integer, a string literal (quoted, adjacent literals
+# concatenated), the raw replacement text when it does not fold, or None
+# when the macro is not defined
+MacroValue = Union[int, str, None]
+
+# Cached analysis of a replacement text: its expression tree and the
+# identifiers it needs, or None when it cannot be an integer expression
+_Expression = Optional[Tuple[Any, Tuple[str, ...]]]
+
+
+@dataclass
+class MacroValueMatrix:
+    """
+    Values of macros under several configurations.
+
+    Attributes:
+        file_path: Translation unit the values are taken at the end of
+        configurations: Configuration names, one per column
+        rows: Macro name mapped to its value in each configuration
+    """
+    file_path: str
+    configurations: List[str] = field(default_factory=list)
+    rows: Dict[str, List[MacroValue]] = field(default_factory=dict)
+
+    def differing(self) -> Dict[str, List[MacroValue]]:
+        """Rows whose value is not the same in every configuration."""
+        return {name: values for name, values in self.rows.items()
+                if any(value != values[0] for value in values[1:])}
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert matrix to dictionary for serialization."""
+        return {
+            "file_path": self.file_path,
+            "configurations": list(self.configurations),
+            "rows": {name: list(values) for name, values in self.rows.items()}
+        }
+
+
+class MacroValueFolder:
+    """
+    Computes folded macro tables through a shared HeaderSummaryCache.
+
+    Integer expressions are evaluated with preprocessor arithmetic, but
+    unlike in #if an identifier that is not a macro with a constant value
+    makes the whole value non-constant rather than 0. A value that is just
+    another macro's name takes that macro's folded value, strings included.
+    """
+
+    def __init__(self, cache: Optional[HeaderSummaryCache] = None):
+        self.cache = cache or HeaderSummaryCache()
+        self._tables: Dict[Tuple, Dict[str, MacroValue]] = {}
+        self._expressions: Dict[str, _Expression] = {}
+        self._folded: Dict[Tuple, MacroValue] = {}
+
+    def values(self, file_path: str, configuration: Optional[Configuration] = None) -> Dict[str, MacroValue]:
+        """
+        Get the folded object-like macros defined after preprocessing a file.
+
+        Args:
+            file_path: Translation unit
+            configuration: Predefined macros and include paths
+
+        Returns:
+            Macro name mapped to its folded value, in name order
+        """
+        configuration = configuration or Configuration()
+        key = (file_path, self._configuration_key(configuration))
+        table = self._tables.get(key)
+        if table is None:
+            macros = self.cache.effective_macros(file_path, configuration)
+            function_like = self.cache.function_like_macros()
+            memo: Dict[str, MacroValue] = {}
+            table = {name: self._fold(name, macros, memo, ())
+                     for name in sorted(macros) if name not in function_like}
+            self._tables[key] = table
+        return table
+
+    def matrix(self, file_path: str, configurations: Iterable[Configuration]) -> MacroValueMatrix:
+        """
+        Build the symbol x configuration value matrix of a translation unit.
+
+        Args:
+            file_path: Translation unit
+            configurations: One column per configuration
+
+        Returns:
+            MacroValueMatrix with a row for every macro defined in any column
+        """
+        tables = []
+        result = MacroValueMatrix(file_path=file_path)
+        for configuration in configurations:
+            result.configurations.append(configuration.name)
+            tables.append(self.values(file_path, configuration))
+        for name in sorted(set().union(*tables) if tables else ()):
+            result.rows[name] = [table.get(name) for table in tables]
+        return result
+
+    def _fold(self, name: str, macros: Mapping[str, str],
+              memo: Dict[str, MacroValue], expanding: Tuple[str, ...]) -> MacroValue:
+        """Fold one macro of a configuration's table."""
+        if name in memo:
+            return memo[name]
+        value = macros[name].strip()
+        folded: MacroValue = value
+
+        if STRING_LITERALS.match(value):
+            folded = '"' + "".join(STRING_LITERAL.findall(value)) + '"'
+        elif IDENTIFIER.match(value) and value in macros and value not in expanding:
+            folded = self._fold(value, macros, memo, expanding + (name,))
+        else:
+            expression = self._expression(value)
+            if expression is not None:
+                tree, identifiers = expression
+                dependencies = []
+                for identifier in identifiers:
+                    dependency = None
+                    if identifier in macros and identifier not in expanding:
+                        dependency = self._fold(identifier, macros, memo, expanding + (name,))
+                    if not isinstance(dependency, int):
+                        break
+                    dependencies.append(dependency)
+                else:
+                    folded = self._evaluate(value, tree, identifiers, tuple(dependencies))
+
+        memo[name] = folded
+        return folded
+
+    def _expression(self, value: str) -> _Expression:
+        """Parse a replacement text as an integer expression, once per text."""
+        if value not in self._expressions:
+            expression = None
+            if value:
+                try:
+                    tree = parse_condition(value)
+                    if not _contains(tree, (Defined, Call)):
+                        expression = (tree, tuple(sorted(referenced_symbols(tree))))
+                except ConditionSyntaxError:
+                    pass
+            self._expressions[value] = expression
+        return self._expressions[value]
+
+    def _evaluate(self, value: str, tree, identifiers: Tuple[str, ...],
+                  dependencies: Tuple[int, ...]) -> MacroValue:
+        """Evaluate an expression whose identifiers all folded to integers."""
+        key = (value, dependencies)
+        if key not in self._folded:
+            macros = {n: str(v) for n, v in zip(identifiers, dependencies)}
+            # evaluate() makes x / 0 zero like #if does; a folded value must not invent it
+            self._folded[key] = value if _divides_by_zero(tree, macros) else evaluate(tree, macros)
+        return self._folded[key]
+
+    def _configuration_key(self, configuration: Configuration) -> Tuple:
+        return (
+            tuple(sorted(configuration.defines.items())),
+            tuple(sorted(configuration.undefs)),
+            tuple(configuration.include_paths)
+        )
+
+
+def _contains(tree, types) -> bool:
+    """Check whether an expression tree has a node of the given types."""
+    stack = [tree]
+    while stack:
+        node = stack.pop()
+        if isinstance(node, types):
+            return True
+        stack.extend(child for child in getattr(node, '__dict__', {}).values()
+                     if not isinstance(child, (str, int, tuple)))
+    return False
+
+
+def _divides_by_zero(tree, macros: Mapping[str, str]) -> bool:
+    """Check whether an expression has a / or % whose divisor evaluates to 0."""
+    stack = [tree]
+    while stack:
+        node = stack.pop()
+        if isinstance(node, Binary) and node.op in ('/', '%') and evaluate(node.right, macros) == 0:
+            return True
+        stack.extend(child for child in getattr(node, '__dict__', {}).values()
+                     if not isinstance(child, (str, int, tuple)))
+    return False
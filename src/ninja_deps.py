@@ -0,0 +1,281 @@
+"""
+Ninja deps log module.
+Reads the `.ninja_deps` binary log in which ninja records the headers the
+compiler reported for every output, so the include graph of a built tree is
+known without resolving a single #include. Entries that are missing or older
+than their inputs fall back to static resolution, and the two can be
+cross-checked.
+"""
+
+import os
+import struct
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, Iterable, List, Optional, Tuple
+
+from .build_log import SOURCE_EXTENSIONS
+from .data_models import Directive
+from .include_graph import IncludeGraph, IncludeResolver
+
+
+DEPS_SIGNATURE = b"# ninjadeps\n"
+SUPPORTED_VERSIONS = (3, 4)
+# Records larger than this are corrupt (matches ninja's own limit)
+MAX_RECORD_SIZE = (1 << 19) - 1
+
+
+@dataclass
+class DepsEntry:
+    """
+    Headers recorded for one compiled translation unit.
+
+    Attributes:
+        output: Output the record belongs to, usually an object file
+        source: Translation unit, the first source file among the inputs
+        mtime: Output timestamp ninja recorded, in the log's units
+        headers: Every other input the compiler reported, in log order
+    """
+    output: str
+    source: str
+    mtime: int
+    headers: List[str] = field(default_factory=list)
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert entry to dictionary for serialization."""
+        return {
+            "output": self.output,
+            "source": self.source,
+            "mtime": self.mtime,
+            "headers": list(self.headers)
+        }
+
+
+@dataclass
+class IncludeDiscrepancy:
+    """
+    Difference between the headers ninja recorded and static resolution.
+
+    Attributes:
+        translation_unit: Source file
+        missing: Recorded headers static resolution does not reach, which
+            points at missing include paths or computed #includes
+        extra: Headers static resolution reaches but the compiler did not
+            read, normally from inactive branches
+    """
+    translation_unit: str
+    missing: List[str] = field(default_factory=list)
+    extra: List[str] = field(default_factory=list)
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert discrepancy to dictionary for serialization."""
+        return {
+            "translation_unit": self.translation_unit,
+            "missing": list(self.missing),
+            "extra": list(self.extra)
+        }
+
+
+class NinjaDepsLog:
+    """
+    Parsed `.ninja_deps` file.
+
+    The log is a signature and version, then records each starting with a
+    little-endian uint32 whose high bit tells a deps record from a path
+    record. Path records name the next node id and end in its complement
+    as a checksum; deps records hold an output id, its mtime (32-bit
+    seconds in version 3, 64-bit in version 4) and the input ids. A later
+    deps record for the same output replaces the earlier one, and a
+    truncated final record is ignored, as ninja does.
+    """
+
+    def __init__(self, build_directory: str = "", version: int = 4):
+        self.build_directory = os.path.abspath(build_directory or os.getcwd())
+        self.version = version
+        self.paths: List[str] = []
+        self.deps: Dict[int, Tuple[int, List[int]]] = {}
+
+    @classmethod
+    def load(cls, path: str) -> 'NinjaDepsLog':
+        """
+        Read a deps log.
+
+        Args:
+            path: `.ninja_deps` file, or the build directory containing it
+
+        Returns:
+            NinjaDepsLog whose paths are resolved against the build directory
+
+        Raises:
+            ValueError: If the file is not a deps log of a supported version
+        """
+        if os.path.isdir(path):
+            path = os.path.join(path, ".ninja_deps")
+        with open(path, 'rb') as f:
+            data = f.read()
+        return cls.parse(data, os.path.dirname(os.path.abspath(path)))
+
+    @classmethod
+    def parse(cls, data: bytes, build_directory: str = "") -> 'NinjaDepsLog':
+        """Parse the contents of a deps log (see load)."""
+        header_size = len(DEPS_SIGNATURE) + 4
+        if not data.startswith(DEPS_SIGNATURE) or len(data) < header_size:
+            raise ValueError("Not a ninja deps log")
+        version = struct.unpack_from('<I', data, len(DEPS_SIGNATURE))[0]
+        if version not in SUPPORTED_VERSIONS:
+            raise ValueError(f"Unsupported ninja deps log version {version}")
+
+        log = cls(build_directory, version)
+        mtime_words = 2 if version >= 4 else 1
+        offset = header_size
+        end = len(data)
+        while offset + 4 <= end:
+            header = struct.unpack_from('<I', data, offset)[0]
+            size = header & 0x7FFFFFFF
+            if size > MAX_RECORD_SIZE or size % 4 or offset + 4 + size > end:
+                break  # Truncated or corrupt tail
+            body = offset + 4
+            offset = body + size
+
+            if header & 0x80000000:
+                if size < 4 * (1 + mtime_words):
+                    break
+                words = struct.unpack_from(f'<{size // 4}I', data, body)
+                mtime = words[1] | (words[2] << 32) if mtime_words == 2 else words[1]
+                log.deps[words[0]] = (mtime, list(words[1 + mtime_words:]))
+            else:
+                if size < 4:
+                    break
+                checksum = struct.unpack_from('<I', data, offset - 4)[0]
+                if checksum != ~len(log.paths) & 0xFFFFFFFF:
+                    break
+                name = data[body:offset - 4].rstrip(b'\0').decode('utf-8', errors='surrogateescape')
+                log.paths.append(os.path.normpath(os.path.join(log.build_directory, name)))
+        return log
+
+    def dependencies(self, output: str) -> Optional[List[str]]:
+        """Get the recorded inputs of an output, or None if it has no record."""
+        output = os.path.normpath(os.path.join(self.build_directory, output))
+        for node, (_, inputs) in self.deps.items():
+            if node < len(self.paths) and self.paths[node] == output:
+                return [self.paths[i] for i in inputs if i < len(self.paths)]
+        return None
+
+    def entries(self) -> Dict[str, DepsEntry]:
+        """
+        Map each recorded translation unit to its headers.
+
+        The translation unit of a record is its first input with a source
+        file extension; records without one (such as linked outputs) are
+        skipped. When several outputs compile the same source, the most
+        recently built wins.
+        """
+        entries: Dict[str, DepsEntry] = {}
+        count = len(self.paths)
+        for node, (mtime, inputs) in self.deps.items():
+            if node >= count:
+                continue
+            paths = [self.paths[i] for i in inputs if i < count]
+            source = next((p for p in paths if os.path.splitext(p)[1] in SOURCE_EXTENSIONS), None)
+            if source is None:
+                continue
+            previous = entries.get(source)
+            if previous is None or mtime >= previous.mtime:
+                entries[source] = DepsEntry(
+                    output=self.paths[node],
+                    source=source,
+                    mtime=mtime,
+                    headers=[p for p in paths if p != source]
+                )
+        return entries
+
+    def is_fresh(self, entry: DepsEntry) -> bool:
+        """
+        Check that an entry still describes its translation unit.
+
+        An entry is stale, as it is for ninja, when its source or a header
+        is gone or newer than the recorded output timestamp.
+        """
+        # Version 4 timestamps are nanoseconds, version 3 ones seconds
+        divisor = 1 if self.version >= 4 else 1000000000
+        for path in [entry.source] + entry.headers:
+            try:
+                if os.stat(path).st_mtime_ns // divisor > entry.mtime:
+                    return False
+            except OSError:
+                return False
+        return True
+
+
+def build_include_graph(sources: Iterable[Tuple[str, IncludeResolver]],
+                        load: Callable[[str], List[Directive]],
+                        deps_log: NinjaDepsLog) -> Tuple[IncludeGraph, List[str]]:
+    """
+    Build the include graph of translation units from a deps log.
+
+    A translation unit with a fresh entry gets an edge to every header the
+    compiler read, so its closure is exact without loading a file; the
+    headers themselves have no edges. Other units are expanded by
+    resolving their #includes, as IncludeGraph.build does.
+
+    Args:
+        sources: (file, resolver for its include paths) pairs, files absolute
+        load: Returns the directives of a file, for the fallback
+        deps_log: Parsed deps log
+
+    Returns:
+        (graph, translation units that fell back to static resolution)
+    """
+    entries = deps_log.entries()
+    recorded = []
+    fallback = []
+    graph = IncludeGraph()
+    for file_path, resolver in sources:
+        entry = entries.get(os.path.normpath(file_path))
+        if entry is not None and deps_log.is_fresh(entry):
+            recorded.append(entry)
+        else:
+            fallback.append(file_path)
+            graph.expand(file_path, resolver, load)
+    # Added after expansion, which stops at files already in the graph and
+    # would otherwise not follow the includes of a recorded header
+    for entry in recorded:
+        graph.node(entry.source)
+        for header in entry.headers:
+            graph.add_include(entry.source, header)
+    return graph, fallback
+
+
+def cross_check(sources: Iterable[Tuple[str, IncludeResolver]],
+                load: Callable[[str], List[Directive]],
+                deps_log: NinjaDepsLog) -> List[IncludeDiscrepancy]:
+    """
+    Compare the headers ninja recorded with those static resolution reaches.
+
+    Args:
+        sources: (file, resolver for its include paths) pairs, files absolute
+        load: Returns the directives of a file
+        deps_log: Parsed deps log
+
+    Returns:
+        One discrepancy per translation unit with a deps entry whose header
+        sets differ, in input order
+    """
+    entries = deps_log.entries()
+    static = IncludeGraph()
+    checked = []
+    for file_path, resolver in sources:
+        entry = entries.get(os.path.normpath(file_path))
+        if entry is not None:
+            static.expand(file_path, resolver, load)
+            checked.append((file_path, entry))
+
+    discrepancies = []
+    for file_path, entry in checked:
+        reached = set(static.files(static.closure(file_path))) - {file_path}
+        recorded = set(entry.headers)
+        if reached != recorded:
+            discrepancies.append(IncludeDiscrepancy(
+                translation_unit=file_path,
+                missing=sorted(recorded - reached),
+                extra=sorted(reached - recorded)
+            ))
+    return discrepancies
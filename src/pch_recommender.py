@@ -0,0 +1,283 @@
+"""
+Precompiled header recommender module.
+Ranks headers by how many translation units include them times the bytes
+they pull in, keeps those whose active branches are identical in every
+configuration they are compiled under, and proposes a PCH per target
+directory. Include closures and per-header usage counts are computed with
+integer bitsets, so the whole analysis is a handful of big-integer
+operations per translation unit.
+"""
+
+import os
+from dataclasses import dataclass, field
+from typing import Any, Dict, List, Optional, Tuple
+
+from .data_models import Configuration
+from .header_summary import HeaderSummary, HeaderSummaryCache
+
+
+@dataclass
+class PchCandidate:
+    """
+    A header ranked for precompilation.
+
+    Attributes:
+        path: Header file
+        translation_units: Number of translation units that include it
+        transitive_bytes: Size of the header plus everything it includes
+        score: translation_units * transitive_bytes
+    """
+    path: str
+    translation_units: int
+    transitive_bytes: int
+    score: int
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert candidate to dictionary for serialization."""
+        return {
+            "path": self.path,
+            "translation_units": self.translation_units,
+            "transitive_bytes": self.transitive_bytes,
+            "score": self.score
+        }
+
+
+@dataclass
+class PchRecommendation:
+    """
+    Suggested precompiled header for one target directory.
+
+    Attributes:
+        directory: Directory containing the target's translation units
+        translation_units: Number of translation units in the directory
+        headers: Headers to include from the PCH, ranked by score
+        pch_bytes: Bytes of source the PCH covers
+        estimated_bytes_saved: Bytes no longer parsed per build, net of building the PCH once
+    """
+    directory: str
+    translation_units: int
+    headers: List[PchCandidate] = field(default_factory=list)
+    pch_bytes: int = 0
+    estimated_bytes_saved: int = 0
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert recommendation to dictionary for serialization."""
+        return {
+            "directory": self.directory,
+            "translation_units": self.translation_units,
+            "headers": [h.to_dict() for h in self.headers],
+            "pch_bytes": self.pch_bytes,
+            "estimated_bytes_saved": self.estimated_bytes_saved
+        }
+
+
+class _BitCounter:
+    """
+    Bit-sliced counters: adds bitsets and counts, per bit position, how
+    many of the added bitsets had it set.
+    """
+
+    def __init__(self):
+        self.planes: List[int] = []
+
+    def add(self, bits: int) -> None:
+        carry = bits
+        for index, plane in enumerate(self.planes):
+            if not carry:
+                return
+            self.planes[index] = plane ^ carry
+            carry &= plane
+        if carry:
+            self.planes.append(carry)
+
+    def count(self, position: int) -> int:
+        total = 0
+        for index, plane in enumerate(self.planes):
+            total |= ((plane >> position) & 1) << index
+        return total
+
+    def any(self) -> int:
+        """Bitset of positions counted at least once."""
+        bits = 0
+        for plane in self.planes:
+            bits |= plane
+        return bits
+
+
+def _iter_bits(bits: int):
+    """Yield the positions of set bits, lowest first."""
+    while bits:
+        lowest = bits & -bits
+        yield lowest.bit_length() - 1
+        bits ^= lowest
+
+
+class PchRecommender:
+    """
+    Recommends precompiled headers from the translation units of a build.
+
+    Each translation unit is summarized under its own configuration through
+    a shared HeaderSummaryCache, so headers are only re-evaluated for inputs
+    that actually change their branches.
+    """
+
+    def __init__(self, cache: Optional[HeaderSummaryCache] = None):
+        self.cache = cache or HeaderSummaryCache()
+        self.paths: List[str] = []
+        self._index: Dict[str, int] = {}
+        self._closures: Dict[int, int] = {}
+        self._sizes: Dict[int, int] = {}
+        self.translation_units: List[Tuple[str, int]] = []
+
+    def add_translation_unit(self, file_path: str,
+                             configuration: Optional[Configuration] = None) -> None:
+        """Summarize a translation unit and record the headers it includes."""
+        summary = self.cache.summarize_translation_unit(file_path, configuration)
+        self.translation_units.append((file_path, self._closure(summary)))
+
+    def _bit(self, path: str) -> int:
+        """Bit position assigned to a header."""
+        position = self._index.get(path)
+        if position is None:
+            position = len(self.paths)
+            self._index[path] = position
+            self.paths.append(path)
+        return position
+
+    def _closure(self, summary: HeaderSummary) -> int:
+        """Bitset of every header a summary includes, directly or not."""
+        key = id(summary)
+        bits = self._closures.get(key)
+        if bits is None:
+            bits = 0
+            for child in summary.children:
+                bits |= (1 << self._bit(child.path)) | self._closure(child)
+            self._closures[key] = bits
+        return bits
+
+    def _size(self, position: int) -> int:
+        size = self._sizes.get(position)
+        if size is None:
+            try:
+                size = os.path.getsize(self.paths[position])
+            except OSError:
+                size = 0
+            self._sizes[position] = size
+        return size
+
+    def _bytes(self, bits: int) -> int:
+        return sum(self._size(position) for position in _iter_bits(bits))
+
+    def stable_headers(self) -> int:
+        """
+        Bitset of headers whose active branches are the same in every
+        configuration they were preprocessed under.
+        """
+        stable = 0
+        for position, path in enumerate(self.paths):
+            branches = {tuple(sorted(v.taken.items())) for v in self.cache.variants(path)}
+            if len(branches) <= 1:
+                stable |= 1 << position
+        return stable
+
+    def header_closure(self, position: int) -> int:
+        """Bitset of a header and everything any of its summaries include."""
+        bits = 1 << position
+        for variant in self.cache.variants(self.paths[position]):
+            bits |= self._closure(variant)
+        return bits
+
+    def rank(self, translation_units: Optional[List[Tuple[str, int]]] = None,
+             stable: Optional[int] = None) -> List[PchCandidate]:
+        """
+        Rank safe headers by translation units including them times transitive bytes.
+
+        Args:
+            translation_units: (file, closure) pairs to count over (default: all)
+            stable: Bitset from stable_headers(), to avoid recomputing it
+
+        Returns:
+            Candidates whose whole include closure is stable, best first
+        """
+        if translation_units is None:
+            translation_units = self.translation_units
+        if stable is None:
+            stable = self.stable_headers()
+
+        counter = _BitCounter()
+        for _, closure in translation_units:
+            counter.add(closure)
+
+        candidates = []
+        for position in _iter_bits(counter.any() & stable):
+            closure = self.header_closure(position)
+            if closure & ~stable:
+                continue
+            count = counter.count(position)
+            transitive_bytes = self._bytes(closure)
+            candidates.append(PchCandidate(
+                path=self.paths[position],
+                translation_units=count,
+                transitive_bytes=transitive_bytes,
+                score=count * transitive_bytes
+            ))
+        candidates.sort(key=lambda c: (-c.score, c.path))
+        return candidates
+
+    def recommend(self, min_share: float = 0.5,
+                  max_headers: Optional[int] = None) -> List[PchRecommendation]:
+        """
+        Suggest a PCH per target directory.
+
+        Args:
+            min_share: Minimum fraction of the directory's translation units
+                that must include a header for it to go into the PCH
+            max_headers: Maximum number of headers listed per PCH
+
+        Returns:
+            One recommendation per directory where a PCH saves anything,
+            largest estimated saving first
+        """
+        stable = self.stable_headers()
+        by_directory: Dict[str, List[Tuple[str, int]]] = {}
+        for file_path, closure in self.translation_units:
+            by_directory.setdefault(os.path.dirname(file_path), []).append((file_path, closure))
+
+        recommendations = []
+        for directory, units in sorted(by_directory.items()):
+            threshold = max(1, min_share * len(units))
+            chosen = []
+            covered = 0
+            for candidate in self.rank(units, stable):
+                if candidate.translation_units < threshold:
+                    continue
+                position = self._index[candidate.path]
+                if covered >> position & 1:
+                    continue  # Already pulled in by a higher-ranked header
+                chosen.append(candidate)
+                covered |= self.header_closure(position)
+                if max_headers is not None and len(chosen) >= max_headers:
+                    break
+            if not chosen:
+                continue
+
+            # Every unit that already included a covered header stops parsing it;
+            # the PCH itself is parsed once
+            counter = _BitCounter()
+            for _, closure in units:
+                counter.add(closure & covered)
+            parsed = sum(counter.count(p) * self._size(p) for p in _iter_bits(covered))
+            pch_bytes = self._bytes(covered)
+            if parsed <= pch_bytes:
+                continue
+
+            recommendations.append(PchRecommendation(
+                directory=directory,
+                translation_units=len(units),
+                headers=chosen,
+                pch_bytes=pch_bytes,
+                estimated_bytes_saved=parsed - pch_bytes
+            ))
+
+        recommendations.sort(key=lambda r: (-r.estimated_bytes_saved, r.directory))
+        return recommendations
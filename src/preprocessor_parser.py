@@ -1,6 +1,7 @@
 """
 Preprocessor parser module for tokenizing and parsing C++ preprocessor directives.
-Handles extraction and analysis of #define, #ifdef, #ifndef, #if, #else, #elif, #endif directives.
+Handles extraction and analysis of #define, #ifdef, #ifndef, #if, #else, #elif, #endif,
+#undef, #include, #error, #warning and #pragma directives.
 """
 
 import re
@@ -16,6 +17,9 @@ class PreprocessorParser:
     """
     Parser for C++ preprocessor directives.
     Extracts directives from source files and creates structured representations.
+    
+    Parsing keeps all state in locals and the returned result, so one parser
+    can be shared by any number of threads.
     """
     
     # Regex patterns for different directive types
@@ -29,14 +33,18 @@ class PreprocessorParser:
         DirectiveType.ENDIF: re.compile(r'^\s*#\s*endif\s*(?://.*)?$'),
         DirectiveType.UNDEF: re.compile(r'^\s*#\s*undef\s+([A-Za-z_][A-Za-z0-9_]*)\s*(?://.*)?$'),
         DirectiveType.INCLUDE: re.compile(r'^\s*#\s*include\s+[<"]([^">]+)[">]\s*(?://.*)?$'),
+        DirectiveType.ERROR: re.compile(r'^\s*#\s*error\b\s*(.*?)\s*$'),
+        DirectiveType.WARNING: re.compile(r'^\s*#\s*warning\b\s*(.*?)\s*$'),
+        DirectiveType.PRAGMA: re.compile(r'^\s*#\s*pragma\b\s*(.*?)\s*(?://.*)?$'),
     }
     
     # General directive detection pattern
     GENERAL_DIRECTIVE = re.compile(r'^\s*#\s*([A-Za-z_][A-Za-z0-9_]*)')
     
-    def __init__(self):
-        self.current_file = ""
-        self.line_number = 0
+    # Directive keyword to type, so each line is matched against one pattern only
+    KEYWORD_TYPES = {directive_type.value: directive_type for directive_type in DIRECTIVE_PATTERNS}
+    
+    IDENTIFIER = re.compile(r'^[A-Za-z_][A-Za-z0-9_]*$')
     
     def parse_file(self, file_path: str) -> FileAnalysisResult:
         """
@@ -49,7 +57,6 @@ class PreprocessorParser:
             FileAnalysisResult containing all found directives and metadata
         """
         result = FileAnalysisResult(file_path=file_path)
-        self.current_file = file_path
         
         if not os.path.exists(file_path):
             error = ValidationError(
@@ -65,14 +72,7 @@ class PreprocessorParser:
             with open(file_path, 'r', encoding='utf-8', errors='ignore') as f:
                 lines = f.readlines()
             
-            result.line_count = len(lines)
-            
-            for line_num, line in enumerate(lines, 1):
-                self.line_number = line_num
-                directive = self._parse_line(line, line_num, file_path)
-                
-                if directive:
-                    result.add_directive(directive)
+            self._parse_into(result, lines)
         
         except Exception as e:
             error = ValidationError(
@@ -85,6 +85,37 @@ class PreprocessorParser:
         
         return result
     
+    def parse_buffer(self, text, file_path: str = "<buffer>") -> FileAnalysisResult:
+        """
+        Parse an in-memory buffer for preprocessor directives.
+        
+        Unlike parse_file, no filesystem access happens: the buffer is
+        attributed to file_path purely for reporting purposes.
+        
+        Args:
+            text: Buffer contents, either a string or a list of lines
+            file_path: Path identifier for the buffer
+        
+        Returns:
+            FileAnalysisResult containing all found directives and metadata
+        """
+        result = FileAnalysisResult(file_path=file_path)
+        
+        lines = text.splitlines() if isinstance(text, str) else text
+        self._parse_into(result, lines)
+        
+        return result
+    
+    def _parse_into(self, result: FileAnalysisResult, lines: List[str]) -> None:
+        """Parse lines into an existing file result."""
+        result.line_count = len(lines)
+        
+        for line_num, line in enumerate(lines, 1):
+            directive = self._parse_line(line, line_num, result.file_path)
+            
+            if directive:
+                result.add_directive(directive)
+    
     def _parse_line(self, line: str, line_number: int, file_path: str) -> Optional[Directive]:
         """
         Parse a single line for preprocessor directives.
@@ -103,22 +134,23 @@ class PreprocessorParser:
         if not line.strip().startswith('#'):
             return None
         
-        # Try to match against each directive type
-        for directive_type, pattern in self.DIRECTIVE_PATTERNS.items():
-            match = pattern.match(line)
+        general_match = self.GENERAL_DIRECTIVE.match(line)
+        if not general_match:
+            return None
+        
+        # Dispatch on the directive keyword to its specific pattern
+        directive_type = self.KEYWORD_TYPES.get(general_match.group(1))
+        if directive_type is not None:
+            match = self.DIRECTIVE_PATTERNS[directive_type].match(line)
             if match:
                 return self._create_directive(
                     directive_type, line, line_number, file_path, match
                 )
         
-        # Check for unknown directive
-        general_match = self.GENERAL_DIRECTIVE.match(line)
-        if general_match:
-            return self._create_directive(
-                DirectiveType.UNKNOWN, line, line_number, file_path, general_match
-            )
-        
-        return None
+        # Unknown or malformed directive
+        return self._create_directive(
+            DirectiveType.UNKNOWN, line, line_number, file_path, general_match
+        )
     
     def _create_directive(self, 
                          directive_type: DirectiveType, 
@@ -231,7 +263,7 @@ class PreprocessorParser:
                 line_number=directive.line_number,
                 directive_content=directive.content
             ))
-        elif not re.match(r'^[A-Za-z_][A-Za-z0-9_]*$', directive.symbol_name):
+        elif not self.IDENTIFIER.match(directive.symbol_name):
             errors.append(ValidationError(
                 severity=ErrorSeverity.ERROR,
                 message=f"Invalid symbol name: {directive.symbol_name}",
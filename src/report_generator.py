@@ -140,6 +140,15 @@ class ReportGenerator:
                 lines.append(f"{condition:50} {count:4} times")
             lines.append("")
         
+        atoms_usage = data.get('atoms_usage', {})
+        if atoms_usage:
+            lines.append("CONDITION ATOM USAGE")
+            lines.append("-" * 40)
+            sorted_atoms = sorted(atoms_usage.items(), key=lambda x: x[1], reverse=True)
+            for atom, count in sorted_atoms:
+                lines.append(f"{atom:50} {count:4} conditions")
+            lines.append("")
+        
         # Dependencies
         if show_dependencies:
             dependency_graph = data.get('dependency_graph', {})
@@ -361,6 +370,19 @@ class ReportGenerator:
             
             lines.append("")
         
+        atoms_usage = data.get('atoms_usage', {})
+        if atoms_usage:
+            lines.append("## Condition Atom Usage")
+            lines.append("")
+            lines.append("| Atom | Conditions |")
+            lines.append("|------|------------|")
+            
+            sorted_atoms = sorted(atoms_usage.items(), key=lambda x: x[1], reverse=True)
+            for atom, count in sorted_atoms:
+                lines.append(f"| `{atom}` | {count} |")
+            
+            lines.append("")
+        
         # Dependencies
         if show_dependencies:
             dependency_graph = data.get('dependency_graph', {})
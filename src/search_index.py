@@ -0,0 +1,349 @@
+"""
+Search index module.
+Trigram inverted index over the unique condition strings and define values
+of an analysis, for substring and regex search without scanning every
+directive. A query looks up the posting lists of the trigrams it must
+contain, intersects them starting from the shortest, and only verifies the
+few strings left. Modules needed only to index directives are imported
+when indexing, so searching a saved search table stays cheap to start.
+"""
+
+from bisect import bisect_left
+from typing import Any, Dict, Iterable, List, Optional, Tuple
+import re
+
+
+# Regex characters that end a run of literal text
+REGEX_SPECIAL = set(".^$*+?{}[]()|\\")
+
+
+def trigrams(text: str) -> List[str]:
+    """Get the distinct trigrams of a text, lowercased."""
+    text = text.lower()
+    return list({text[i:i + 3] for i in range(len(text) - 2)})
+
+
+def required_literals(pattern: str) -> Optional[List[str]]:
+    """
+    Find literal substrings every match of a regular expression contains.
+
+    Only runs of plain characters outside groups and character classes
+    are used, and a character followed by a quantifier that allows zero
+    repetitions is dropped. Alternation anywhere makes nothing required.
+
+    Returns:
+        Required literals, or None when the pattern uses alternation
+    """
+    literals = []
+    run: List[str] = []
+
+    def flush():
+        if len(run) >= 3:
+            literals.append("".join(run))
+        del run[:]
+
+    depth = 0
+    index = 0
+    end = len(pattern)
+    while index < end:
+        char = pattern[index]
+        index += 1
+        literal = None
+        if char == '\\' and index < end:
+            escaped = pattern[index]
+            index += 1
+            # Escaped punctuation is itself; \d, \n, \x41, \1, ... are not decoded
+            if not escaped.isalnum():
+                literal = escaped
+        elif char == '|':
+            return None
+        elif char == '[':
+            # Skip the class, including a leading ] or ^]
+            if index < end and pattern[index] == '^':
+                index += 1
+            if index < end and pattern[index] == ']':
+                index += 1
+            while index < end and pattern[index] != ']':
+                index += 2 if pattern[index] == '\\' else 1
+            index += 1
+        elif char == '(':
+            depth += 1
+        elif char == ')':
+            depth = max(0, depth - 1)
+        elif char in "*?{":
+            if run:
+                run.pop()  # The quantified character may not occur
+            if char == '{':
+                closing = pattern.find('}', index)
+                index = end if closing < 0 else closing + 1
+        elif char == '+':
+            # The repeated character may occur several times: what precedes
+            # and what follows it are separate literals
+            last = run[-1:] if run else []
+            flush()
+            run.extend(last)
+            continue
+        elif char not in REGEX_SPECIAL:
+            literal = char
+
+        if literal is not None and depth == 0:
+            run.append(literal)
+        else:
+            flush()
+    flush()
+    return literals
+
+
+class TrigramIndex:
+    """
+    Inverted index from lowercase trigrams to the ids of the strings containing them.
+
+    Strings are numbered in insertion order, so posting lists stay sorted
+    as strings are added. Lowercase trigrams serve case-insensitive queries
+    directly; case-sensitive ones are checked when verifying candidates.
+    """
+
+    def __init__(self, strings: Iterable[str] = ()):
+        self.strings: List[str] = []
+        self.postings: Dict[str, List[int]] = {}
+        self._ids: Dict[str, int] = {}
+        for string in strings:
+            self.add(string)
+
+    def add(self, string: str) -> int:
+        """Add a string, returning its id; adding it again returns the same id."""
+        string_id = self._ids.get(string)
+        if string_id is None:
+            string_id = len(self.strings)
+            self._ids[string] = string_id
+            self.strings.append(string)
+            for trigram in trigrams(string):
+                self.postings.setdefault(trigram, []).append(string_id)
+        return string_id
+
+    def candidates(self, literals: Iterable[str]) -> Optional[List[int]]:
+        """
+        Ids of the strings containing every trigram of the literals.
+
+        Returns:
+            Sorted ids, or None when the literals have no trigram and every
+            string is a candidate
+        """
+        wanted = set()
+        for literal in literals:
+            wanted.update(trigrams(literal))
+        if not wanted:
+            return None
+        lists = []
+        for trigram in wanted:
+            postings = self.postings.get(trigram)
+            if not postings:
+                return []
+            lists.append(postings)
+        lists.sort(key=len)
+        result = lists[0]
+        for postings in lists[1:]:
+            result = _intersect(result, postings)
+            if not result:
+                break
+        return list(result)
+
+    def search(self, query: str, ignore_case: bool = False) -> List[int]:
+        """Ids of the strings containing a substring."""
+        ids = self.candidates([query])
+        if ids is None:
+            ids = range(len(self.strings))
+        if ignore_case:
+            needle = query.lower()
+            return [i for i in ids if needle in self.strings[i].lower()]
+        return [i for i in ids if query in self.strings[i]]
+
+    def search_regex(self, pattern: str, flags: int = 0) -> List[int]:
+        """Ids of the strings a regular expression matches somewhere."""
+        compiled = re.compile(pattern, flags)
+        literals = required_literals(pattern)
+        ids = self.candidates(literals) if literals is not None else None
+        if ids is None:
+            ids = range(len(self.strings))
+        return [i for i in ids if compiled.search(self.strings[i])]
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert index to dictionary for serialization."""
+        return {"strings": list(self.strings), "postings": self.postings}
+
+    @classmethod
+    def from_dict(cls, data: Dict[str, Any]) -> 'TrigramIndex':
+        """Restore an index without recomputing its posting lists."""
+        index = cls()
+        index.strings = list(data.get("strings", []))
+        index.postings = {k: list(v) for k, v in data.get("postings", {}).items()}
+        index._ids = {string: i for i, string in enumerate(index.strings)}
+        return index
+
+
+def _intersect(small: List[int], large: List[int]) -> List[int]:
+    """Intersect two sorted lists, searching the larger for each item of the smaller."""
+    result = []
+    low = 0
+    for item in small:
+        low = bisect_left(large, item, low)
+        if low == len(large):
+            break
+        if large[low] == item:
+            result.append(item)
+    return result
+
+
+class SearchMatch:
+    """
+    A directive whose condition or define value matched a query.
+
+    A plain class rather than a dataclass, since importing dataclasses
+    costs more than a search of a saved table.
+
+    Attributes:
+        kind: "condition" or "define"
+        text: Canonical condition, or the define's replacement text
+        file_path: File containing the directive
+        line_number: Line of the directive (1-based)
+        symbol: Macro defined, for define matches
+    """
+    __slots__ = ("kind", "text", "file_path", "line_number", "symbol")
+
+    def __init__(self, kind: str, text: str, file_path: str, line_number: int,
+                 symbol: Optional[str] = None):
+        self.kind = kind
+        self.text = text
+        self.file_path = file_path
+        self.line_number = line_number
+        self.symbol = symbol
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert match to dictionary for serialization."""
+        return {
+            "kind": self.kind,
+            "text": self.text,
+            "file_path": self.file_path,
+            "line_number": self.line_number,
+            "symbol": self.symbol
+        }
+
+
+class DirectiveSearchIndex:
+    """
+    Trigram indexes over the conditions and define values of an analysis.
+
+    Each unique string is indexed once, with the locations of the
+    directives using it: (file id, line) for conditions, (file id, line,
+    macro name) for defines. Conditions are indexed in canonical form.
+    """
+
+    KINDS = ("condition", "define")
+
+    def __init__(self):
+        self.files: List[str] = []
+        self.indexes: Dict[str, TrigramIndex] = {kind: TrigramIndex() for kind in self.KINDS}
+        self.locations: Dict[str, List[List[Tuple]]] = {kind: [] for kind in self.KINDS}
+        self._file_ids: Dict[str, int] = {}
+
+    @classmethod
+    def from_analysis(cls, result: 'AnalysisResult') -> 'DirectiveSearchIndex':
+        """Index every file of an analysis result."""
+        index = cls()
+        for file_result in result.file_results.values():
+            index.add_directives(file_result.file_path, file_result.directives)
+        return index
+
+    @classmethod
+    def from_analysis_dict(cls, data: Dict[str, Any]) -> 'DirectiveSearchIndex':
+        """Index the directives of a saved analysis."""
+        from .data_models import Directive
+        index = cls()
+        for file_path, file_data in data.get("file_results", {}).items():
+            index.add_directives(file_path, (Directive.from_dict(d) for d in file_data.get("directives", [])))
+        return index
+
+    def add_directives(self, file_path: str, directives: Iterable['Directive']) -> None:
+        """Index the conditions and define values of one file."""
+        from .condition_normalizer import directive_condition
+        from .configuration_evaluator import split_define
+        from .data_models import DirectiveType
+        file_id = self._file_ids.get(file_path)
+        if file_id is None:
+            file_id = self._file_ids[file_path] = len(self.files)
+            self.files.append(file_path)
+        for directive in directives:
+            if directive.type == DirectiveType.DEFINE:
+                name, _, value = split_define(directive.content)
+                if name is not None:
+                    self._add("define", value, (file_id, directive.line_number, name))
+                continue
+            condition = directive_condition(directive)
+            if condition is not None:
+                self._add("condition", condition, (file_id, directive.line_number))
+
+    def _add(self, kind: str, text: str, location: Tuple) -> None:
+        string_id = self.indexes[kind].add(text)
+        locations = self.locations[kind]
+        if string_id == len(locations):
+            locations.append([])
+        locations[string_id].append(location)
+
+    def search(self, query: str, kinds: Iterable[str] = KINDS, regex: bool = False,
+               ignore_case: bool = False, limit: Optional[int] = None) -> List[SearchMatch]:
+        """
+        Find the directives whose condition or define value contains a query.
+
+        Args:
+            query: Substring, or regular expression if regex is set
+            kinds: Which of "condition" and "define" to search
+            regex: Treat the query as a regular expression (re.search)
+            ignore_case: Match case-insensitively
+            limit: Stop after this many matches
+
+        Returns:
+            Matches grouped by matching string, in index order
+        """
+        matches: List[SearchMatch] = []
+        for kind in kinds:
+            index = self.indexes[kind]
+            if regex:
+                ids = index.search_regex(query, re.IGNORECASE if ignore_case else 0)
+            else:
+                ids = index.search(query, ignore_case)
+            for string_id in ids:
+                for location in self.locations[kind][string_id]:
+                    matches.append(SearchMatch(
+                        kind=kind,
+                        text=index.strings[string_id],
+                        file_path=self.files[location[0]],
+                        line_number=location[1],
+                        symbol=location[2] if len(location) > 2 else None
+                    ))
+                    if limit is not None and len(matches) >= limit:
+                        return matches
+        return matches
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert index to dictionary for serialization."""
+        return {
+            "files": list(self.files),
+            **{kind: {
+                "index": self.indexes[kind].to_dict(),
+                "locations": [[list(location) for location in locations]
+                              for locations in self.locations[kind]]
+            } for kind in self.KINDS}
+        }
+
+    @classmethod
+    def from_dict(cls, data: Dict[str, Any]) -> 'DirectiveSearchIndex':
+        """Restore a saved index."""
+        index = cls()
+        index.files = list(data.get("files", []))
+        index._file_ids = {path: i for i, path in enumerate(index.files)}
+        for kind in cls.KINDS:
+            section = data.get(kind, {})
+            index.indexes[kind] = TrigramIndex.from_dict(section.get("index", {}))
+            index.locations[kind] = [[tuple(location) for location in locations]
+                                     for locations in section.get("locations", [])]
+        return index
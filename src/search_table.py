@@ -0,0 +1,287 @@
+"""
+Search table file module.
+Writes a directive search index to a single file of sorted trigram keys,
+posting lists, strings and directive locations, and searches a memory map
+of it, so a query reads only the posting lists it intersects and the
+strings and locations of its candidates instead of loading an analysis.
+"""
+
+import mmap
+import os
+import struct
+import sys
+from array import array
+
+from .search_index import DirectiveSearchIndex, TrigramIndex
+from .symbol_table import FILE_REF, STRING_LENGTH, symbol_key
+
+
+MAGIC = b"PPSEARCH"
+VERSION = 1
+# magic, version, flags, file count, and the offsets of the file and string regions
+HEADER = struct.Struct('<8sIIQQQ')
+# Per kind: string count, trigram count, and the offsets of its key, trigram,
+# posting, entry and location regions
+SECTION = struct.Struct('<QQQQQQQ')
+# Sorted 64-bit trigram keys, searched by bisection
+KEY = struct.Struct('<Q')
+# first posting, posting count
+TRIGRAM = struct.Struct('<QQ')
+# string id
+POSTING_SIZE = 4
+# text string ref, first location, location count
+ENTRY = struct.Struct('<QQQ')
+# file id, line, macro name string ref (NO_SYMBOL for conditions)
+LOCATION = struct.Struct('<IIQ')
+NO_SYMBOL = 2 ** 64 - 1
+
+
+def trigram_key(trigram: str) -> int:
+    """64-bit key of a lowercase trigram."""
+    return symbol_key(trigram.encode('utf-8', errors='surrogatepass'))
+
+
+class _MappedStrings:
+    """Indexed strings of one section, decoded on access."""
+
+    def __init__(self, table: 'SearchTable', count: int, entries: int):
+        self._table = table
+        self._count = count
+        self._entries = entries
+
+    def __len__(self) -> int:
+        return self._count
+
+    def __getitem__(self, string_id: int) -> str:
+        ref = ENTRY.unpack_from(self._table._map, self._entries + string_id * ENTRY.size)[0]
+        return self._table._string(ref)
+
+
+class _MappedPostings:
+    """Posting lists of one section, found by bisecting its sorted keys."""
+
+    def __init__(self, table: 'SearchTable', count: int, keys: int, trigrams: int, postings: int):
+        self._table = table
+        self._count = count
+        self._keys = keys
+        self._trigrams = trigrams
+        self._postings = postings
+
+    def get(self, trigram: str):
+        key = trigram_key(trigram)
+        data = self._table._map
+        low, high = 0, self._count
+        while low < high:
+            middle = (low + high) // 2
+            if KEY.unpack_from(data, self._keys + middle * KEY.size)[0] < key:
+                low = middle + 1
+            else:
+                high = middle
+        if low == self._count or KEY.unpack_from(data, self._keys + low * KEY.size)[0] != key:
+            return None
+        first, count = TRIGRAM.unpack_from(data, self._trigrams + low * TRIGRAM.size)
+        start = self._postings + first * POSTING_SIZE
+        postings = array('I')
+        postings.frombytes(data[start:start + count * POSTING_SIZE])
+        if sys.byteorder != 'little':
+            postings.byteswap()
+        return postings
+
+
+class _MappedTrigrams(TrigramIndex):
+    """Read-only TrigramIndex over one section of a search table."""
+
+    def __init__(self, strings: _MappedStrings, postings: _MappedPostings):
+        self.strings = strings
+        self.postings = postings
+
+    def add(self, string: str) -> int:
+        raise TypeError("search tables are read-only")
+
+
+class _MappedLocations:
+    """Directive locations of each string of one section, read on access."""
+
+    def __init__(self, table: 'SearchTable', entries: int, locations: int):
+        self._table = table
+        self._entries = entries
+        self._locations = locations
+
+    def __getitem__(self, string_id: int):
+        data = self._table._map
+        _, first, count = ENTRY.unpack_from(data, self._entries + string_id * ENTRY.size)
+        position = self._locations + first * LOCATION.size
+        locations = []
+        for _ in range(count):
+            file_id, line_number, symbol_ref = LOCATION.unpack_from(data, position)
+            position += LOCATION.size
+            if symbol_ref == NO_SYMBOL:
+                locations.append((file_id, line_number))
+            else:
+                locations.append((file_id, line_number, self._table._string(symbol_ref)))
+        return locations
+
+
+class _MappedFiles:
+    """File names of a search table, decoded once each."""
+
+    def __init__(self, table: 'SearchTable', count: int, start: int):
+        self._table = table
+        self._count = count
+        self._start = start
+        self._names = {}
+
+    def __len__(self) -> int:
+        return self._count
+
+    def __getitem__(self, file_id: int) -> str:
+        name = self._names.get(file_id)
+        if name is None:
+            ref = FILE_REF.unpack_from(self._table._map, self._start + file_id * FILE_REF.size)[0]
+            name = self._names[file_id] = self._table._string(ref)
+        return name
+
+
+class SearchTable(DirectiveSearchIndex):
+    """
+    Read-only DirectiveSearchIndex over a memory-mapped search table file.
+
+    The file is a header, one section header per kind, and for each kind
+    its sorted trigram keys, the posting list range of each key, the
+    posting lists, one entry per indexed string and the directive
+    locations of every string; then a table of file names and a region of
+    length-prefixed strings. Trigrams whose keys collide share one merged
+    posting list, which only adds candidates that verification drops.
+    """
+
+    def __init__(self, path: str):
+        with open(path, 'rb') as f:
+            try:
+                self._map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+            except ValueError:
+                raise ValueError(f"'{path}' is not a search table") from None
+        if len(self._map) < HEADER.size + SECTION.size * len(self.KINDS):
+            self._map.close()
+            raise ValueError(f"'{path}' is not a search table")
+        magic, version, _, file_count, files, self._strings = HEADER.unpack_from(self._map, 0)
+        if magic != MAGIC or version != VERSION:
+            self._map.close()
+            raise ValueError(f"'{path}' is not a version {VERSION} search table")
+        self.files = _MappedFiles(self, file_count, files)
+        self.indexes = {}
+        self.locations = {}
+        for number, kind in enumerate(self.KINDS):
+            (string_count, trigram_count, keys, trigrams, postings,
+             entries, locations) = SECTION.unpack_from(self._map, HEADER.size + number * SECTION.size)
+            self.indexes[kind] = _MappedTrigrams(
+                _MappedStrings(self, string_count, entries),
+                _MappedPostings(self, trigram_count, keys, trigrams, postings))
+            self.locations[kind] = _MappedLocations(self, entries, locations)
+
+    def close(self) -> None:
+        """Unmap the file."""
+        self._map.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc_info):
+        self.close()
+
+    def add_directives(self, file_path, directives) -> None:
+        raise TypeError("search tables are read-only")
+
+    def _string(self, ref: int) -> str:
+        start = self._strings + ref
+        length = STRING_LENGTH.unpack_from(self._map, start)[0]
+        start += STRING_LENGTH.size
+        return self._map[start:start + length].decode('utf-8', errors='surrogateescape')
+
+
+def write_search_table(index: DirectiveSearchIndex, path: str) -> int:
+    """
+    Write a directive search index as a search table file.
+
+    The file is written next to its destination and renamed over it, so
+    processes that have the previous table mapped keep a consistent view.
+
+    Args:
+        index: In-memory DirectiveSearchIndex
+        path: Destination file
+
+    Returns:
+        Number of strings written, over all kinds
+    """
+    strings = bytearray()
+    string_refs = {}
+
+    def intern(text: str) -> int:
+        ref = string_refs.get(text)
+        if ref is None:
+            encoded = text.encode('utf-8', errors='surrogateescape')
+            ref = string_refs[text] = len(strings)
+            strings.extend(STRING_LENGTH.pack(len(encoded)))
+            strings.extend(encoded)
+        return ref
+
+    body = bytearray()
+    start = HEADER.size + SECTION.size * len(index.KINDS)
+
+    def region(data) -> int:
+        # Regions start 8-byte aligned
+        body.extend(bytes(-len(body) % 8))
+        offset = start + len(body)
+        body.extend(data)
+        return offset
+
+    sections = []
+    written = 0
+    for kind in index.KINDS:
+        trigram_index = index.indexes[kind]
+        merged = {}
+        for trigram, postings in trigram_index.postings.items():
+            key = trigram_key(trigram)
+            if key in merged:
+                merged[key] = sorted(set(merged[key]).union(postings))
+            else:
+                merged[key] = postings
+        keys = sorted(merged)
+        ids = array('I')
+        ranges = bytearray()
+        for key in keys:
+            ranges.extend(TRIGRAM.pack(len(ids), len(merged[key])))
+            ids.extend(merged[key])
+        if sys.byteorder != 'little':
+            ids.byteswap()
+
+        entries = bytearray()
+        locations = bytearray()
+        count = 0
+        for string_id, text in enumerate(trigram_index.strings):
+            string_locations = index.locations[kind][string_id]
+            entries.extend(ENTRY.pack(intern(text), count, len(string_locations)))
+            for location in string_locations:
+                symbol = intern(location[2]) if len(location) > 2 else NO_SYMBOL
+                locations.extend(LOCATION.pack(location[0], location[1], symbol))
+            count += len(string_locations)
+        written += len(trigram_index.strings)
+
+        sections.append(SECTION.pack(
+            len(trigram_index.strings), len(keys),
+            region(b"".join(KEY.pack(key) for key in keys)),
+            region(ranges),
+            region(ids.tobytes()),
+            region(entries),
+            region(locations)
+        ))
+
+    files_offset = region(b"".join(FILE_REF.pack(intern(file_path)) for file_path in index.files))
+    strings_offset = region(strings)
+
+    temporary = f"{path}.tmp{os.getpid()}"
+    with open(temporary, 'wb') as f:
+        f.write(HEADER.pack(MAGIC, VERSION, 0, len(index.files), files_offset, strings_offset))
+        f.write(b"".join(sections))
+        f.write(body)
+    os.replace(temporary, path)
+    return written
@@ -0,0 +1,97 @@
+"""
+Symbol index module.
+Indexes every #define and #undef by macro name across analyzed files, so
+questions like "where is this macro defined, and to what" are answered
+without rescanning directives.
+"""
+
+from dataclasses import dataclass, field
+from typing import Any, Dict, Iterable, List
+
+from .configuration_evaluator import split_define
+from .data_models import AnalysisResult, Directive, DirectiveType, FileAnalysisResult
+
+
+@dataclass
+class MacroDefinition:
+    """
+    One #define of a macro.
+
+    Attributes:
+        name: Macro name
+        value: Replacement text, prefixed by the parameter list for function-like macros
+        file_path: File containing the #define
+        line_number: Line of the #define (1-based)
+        context: Conditions the #define is nested in
+    """
+    name: str
+    value: str
+    file_path: str
+    line_number: int
+    context: List[str] = field(default_factory=list)
+
+    @classmethod
+    def from_directive(cls, directive: Directive) -> 'MacroDefinition':
+        """Create a definition from a #define directive."""
+        name, parameters, value = split_define(directive.content)
+        return cls(
+            name=name or directive.symbol_name or "",
+            value=value if parameters is None else f"{parameters} {value}".rstrip(),
+            file_path=directive.file_path,
+            line_number=directive.line_number,
+            context=list(directive.context)
+        )
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert definition to dictionary for serialization."""
+        return {
+            "name": self.name,
+            "value": self.value,
+            "file_path": self.file_path,
+            "line_number": self.line_number,
+            "context": self.context.copy()
+        }
+
+
+class SymbolIndex:
+    """
+    Global index of macro definitions and undefinitions by name.
+
+    Directives are expected to carry their contexts, i.e. to come from
+    files that went through the context analyzer.
+    """
+
+    def __init__(self):
+        self.definitions: Dict[str, List[MacroDefinition]] = {}
+        self.undefinitions: Dict[str, List[Directive]] = {}
+
+    @classmethod
+    def from_results(cls, file_results: Iterable[FileAnalysisResult]) -> 'SymbolIndex':
+        """Index the directives of several files."""
+        index = cls()
+        for file_result in file_results:
+            index.add_file_result(file_result)
+        return index
+
+    @classmethod
+    def from_analysis(cls, analysis_result: AnalysisResult) -> 'SymbolIndex':
+        """Index every file of an analysis."""
+        return cls.from_results(analysis_result.file_results.values())
+
+    def add_file_result(self, file_result: FileAnalysisResult) -> None:
+        """Add a file's #define and #undef directives to the index."""
+        for directive in file_result.directives:
+            if directive.type == DirectiveType.DEFINE:
+                definition = MacroDefinition.from_directive(directive)
+                if definition.name:
+                    self.definitions.setdefault(definition.name, []).append(definition)
+            elif directive.type == DirectiveType.UNDEF and directive.symbol_name:
+                self.undefinitions.setdefault(directive.symbol_name, []).append(directive)
+
+    def names(self) -> List[str]:
+        """Get every defined macro name, sorted."""
+        return sorted(self.definitions)
+
+    def definitions_of(self, name: str) -> List[MacroDefinition]:
+        """Get every #define of a macro, in indexing order."""
+        return self.definitions.get(name, [])
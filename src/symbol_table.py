@@ -0,0 +1,264 @@
+"""
+Symbol table file module.
+Writes the global symbol index as an open-addressing hash table in a single
+file, and answers lookups by probing a memory map of it, so a query starts
+without deserializing (or even reading) anything but the slots and records
+it touches. Imports are kept to the standard library's cheapest modules,
+since a lookup usually runs in a fresh process.
+"""
+
+import mmap
+import os
+import struct
+import sys
+import zlib
+
+
+MAGIC = b"PPSYMTAB"
+VERSION = 1
+# magic, version, flags, slot count, symbol count, file count, and the
+# offsets of the file, record and string regions
+HEADER = struct.Struct('<8sIIQQQQQQ')
+# 64-bit key of the name (0 marks an empty slot), record offset
+SLOT = struct.Struct('<QQ')
+# name length, #define count, #undef count; followed by the name and entries
+RECORD = struct.Struct('<III')
+# file id, line, value string, context string
+ENTRY = struct.Struct('<IIQQ')
+STRING_LENGTH = struct.Struct('<I')
+FILE_REF = struct.Struct('<Q')
+# Slots are kept at most this full, so probe sequences stay short
+MAX_LOAD = 0.75
+# Joins the conditions of a context in the string region
+CONTEXT_SEPARATOR = "\0"
+
+
+def symbol_key(name: bytes) -> int:
+    """64-bit probing key of a symbol name, never 0."""
+    return (zlib.crc32(name) | (zlib.crc32(name, 0x5BD1E995) << 32)) or 1
+
+
+class TableEntry:
+    """
+    One #define or #undef read from a symbol table.
+
+    Attributes:
+        name: Macro name
+        value: Replacement text as in MacroDefinition, or None for an #undef
+        file_path: File containing the directive
+        line_number: Line of the directive (1-based)
+        context: Conditions the directive is nested in
+    """
+    __slots__ = ("name", "value", "file_path", "line_number", "context")
+
+    def __init__(self, name, value, file_path, line_number, context):
+        self.name = name
+        self.value = value
+        self.file_path = file_path
+        self.line_number = line_number
+        self.context = context
+
+    def to_dict(self):
+        """Convert entry to dictionary for serialization."""
+        return {
+            "name": self.name,
+            "value": self.value,
+            "file_path": self.file_path,
+            "line_number": self.line_number,
+            "context": list(self.context)
+        }
+
+
+class SymbolTable:
+    """
+    Read-only view of a symbol table file.
+
+    The file is a header, a power-of-two array of slots probed linearly
+    from the name's key, a table of file names, one record per symbol with
+    its #define and #undef entries, and a region of length-prefixed strings
+    shared by values and contexts. Offsets in each region are relative to
+    the region's start.
+    """
+
+    def __init__(self, path: str):
+        with open(path, 'rb') as f:
+            try:
+                self._map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+            except ValueError:
+                raise ValueError(f"'{path}' is not a symbol table") from None
+        if len(self._map) < HEADER.size:
+            self._map.close()
+            raise ValueError(f"'{path}' is not a symbol table")
+        (magic, version, _, self.slot_count, self.symbol_count, self.file_count,
+         self._files, self._records, self._strings) = HEADER.unpack_from(self._map, 0)
+        if magic != MAGIC or version != VERSION:
+            self._map.close()
+            raise ValueError(f"'{path}' is not a version {VERSION} symbol table")
+        self._mask = self.slot_count - 1
+        self._file_names = {}
+
+    def close(self) -> None:
+        """Unmap the file."""
+        self._map.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc_info):
+        self.close()
+
+    def __len__(self) -> int:
+        return self.symbol_count
+
+    def __contains__(self, name: str) -> bool:
+        return self._find(name) is not None
+
+    def definitions_of(self, name: str):
+        """Get every #define of a macro, in indexing order."""
+        return self._entries(name)[0]
+
+    def undefinitions_of(self, name: str):
+        """Get every #undef of a macro, in indexing order (values are None)."""
+        return self._entries(name)[1]
+
+    def names(self):
+        """Get every symbol name, sorted (reads every record)."""
+        names = []
+        for slot in range(self.slot_count):
+            key, offset = SLOT.unpack_from(self._map, HEADER.size + slot * SLOT.size)
+            if key:
+                start = self._records + offset
+                length = RECORD.unpack_from(self._map, start)[0]
+                start += RECORD.size
+                names.append(self._map[start:start + length].decode('utf-8'))
+        return sorted(names)
+
+    def _find(self, name: str):
+        """Get the absolute offset of a symbol's record, or None."""
+        encoded = name.encode('utf-8')
+        key = symbol_key(encoded)
+        data = self._map
+        slot = key & self._mask
+        while True:
+            slot_key, offset = SLOT.unpack_from(data, HEADER.size + slot * SLOT.size)
+            if slot_key == 0:
+                return None
+            if slot_key == key:
+                start = self._records + offset
+                length = RECORD.unpack_from(data, start)[0]
+                name_start = start + RECORD.size
+                if length == len(encoded) and data[name_start:name_start + length] == encoded:
+                    return start
+            slot = (slot + 1) & self._mask
+
+    def _entries(self, name: str):
+        start = self._find(name)
+        if start is None:
+            return [], []
+        length, define_count, undef_count = RECORD.unpack_from(self._map, start)
+        position = start + RECORD.size + length
+        entries = ([], [])
+        for index in range(define_count + undef_count):
+            file_id, line_number, value_ref, context_ref = ENTRY.unpack_from(self._map, position)
+            position += ENTRY.size
+            context = self._string(context_ref)
+            entry = TableEntry(
+                name,
+                self._string(value_ref) if index < define_count else None,
+                self._file(file_id),
+                line_number,
+                context.split(CONTEXT_SEPARATOR) if context else []
+            )
+            entries[index >= define_count].append(entry)
+        return entries
+
+    def _string(self, ref: int) -> str:
+        start = self._strings + ref
+        length = STRING_LENGTH.unpack_from(self._map, start)[0]
+        start += STRING_LENGTH.size
+        return self._map[start:start + length].decode('utf-8', errors='surrogateescape')
+
+    def _file(self, file_id: int) -> str:
+        name = self._file_names.get(file_id)
+        if name is None:
+            ref = FILE_REF.unpack_from(self._map, self._files + file_id * FILE_REF.size)[0]
+            name = self._file_names[file_id] = self._string(ref)
+        return name
+
+
+def write_symbol_table(index, path: str) -> int:
+    """
+    Write a symbol index as a symbol table file.
+
+    The file is written next to its destination and renamed over it, so
+    processes that have the previous table mapped keep a consistent view.
+
+    Args:
+        index: SymbolIndex (anything with its definitions and undefinitions)
+        path: Destination file
+
+    Returns:
+        Number of symbols written
+    """
+    from array import array
+    names = sorted(set(index.definitions) | set(index.undefinitions))
+    slot_count = 8
+    while slot_count * MAX_LOAD < len(names):
+        slot_count *= 2
+    mask = slot_count - 1
+    slots = array('Q', bytes(slot_count * SLOT.size))
+
+    strings = bytearray()
+    string_refs = {}
+
+    def intern(text: str) -> int:
+        ref = string_refs.get(text)
+        if ref is None:
+            encoded = text.encode('utf-8', errors='surrogateescape')
+            ref = string_refs[text] = len(strings)
+            strings.extend(STRING_LENGTH.pack(len(encoded)))
+            strings.extend(encoded)
+        return ref
+
+    file_ids = {}
+    empty = intern("")
+    records = bytearray()
+    for name in names:
+        encoded = name.encode('utf-8')
+        definitions = index.definitions.get(name, [])
+        undefinitions = index.undefinitions.get(name, [])
+        key = symbol_key(encoded)
+        slot = key & mask
+        while slots[slot * 2]:
+            slot = (slot + 1) & mask
+        slots[slot * 2] = key
+        slots[slot * 2 + 1] = len(records)
+
+        records.extend(RECORD.pack(len(encoded), len(definitions), len(undefinitions)))
+        records.extend(encoded)
+        for item, value in [(d, d.value) for d in definitions] + [(u, None) for u in undefinitions]:
+            file_id = file_ids.setdefault(item.file_path, len(file_ids))
+            records.extend(ENTRY.pack(
+                file_id,
+                item.line_number,
+                empty if value is None else intern(value),
+                intern(CONTEXT_SEPARATOR.join(item.context))
+            ))
+
+    if sys.byteorder != 'little':
+        slots.byteswap()
+    files = b"".join(FILE_REF.pack(intern(file_path)) for file_path in file_ids)
+    files_offset = HEADER.size + slot_count * SLOT.size
+    records_offset = files_offset + len(files)
+    strings_offset = records_offset + len(records)
+
+    temporary = f"{path}.tmp{os.getpid()}"
+    with open(temporary, 'wb') as f:
+        f.write(HEADER.pack(MAGIC, VERSION, 0, slot_count, len(names), len(file_ids),
+                            files_offset, records_offset, strings_offset))
+        f.write(slots.tobytes())
+        f.write(files)
+        f.write(records)
+        f.write(strings)
+    os.replace(temporary, path)
+    return len(names)
@@ -0,0 +1,236 @@
+"""
+Unity build planner module.
+Groups translation units into unity (jumbo) batches that cannot change each
+other's meaning: no two files in a batch leave a macro behind that the other
+defines differently or reads with a different value. Batches only mix files
+built with the same configuration and are balanced by source size.
+"""
+
+import math
+import os
+from bisect import insort
+from dataclasses import dataclass, field
+from typing import Any, Dict, List, Optional, Tuple
+
+from .data_models import Configuration
+from .header_summary import HeaderSummaryCache
+
+
+# Default upper bound on the source bytes of one batch
+DEFAULT_MAX_BATCH_BYTES = 512 * 1024
+
+
+@dataclass
+class UnityBatch:
+    """
+    One unity translation unit.
+
+    Attributes:
+        name: Suggested file name for the generated unity source
+        configuration: Configuration shared by every file in the batch
+        files: Translation units to #include, in order
+        bytes: Total source bytes of the files
+    """
+    name: str
+    configuration: Configuration
+    files: List[str] = field(default_factory=list)
+    bytes: int = 0
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert batch to dictionary for serialization."""
+        return {
+            "name": self.name,
+            "configuration": self.configuration.to_dict(),
+            "files": list(self.files),
+            "bytes": self.bytes
+        }
+
+
+@dataclass
+class UnityPlan:
+    """
+    Batching of a build's translation units.
+
+    Attributes:
+        batches: Unity batches, largest first within each configuration
+        conflicting_macros: Macros with more than one value among files of the
+            same configuration, mapped to the number of files involved
+    """
+    batches: List[UnityBatch] = field(default_factory=list)
+    conflicting_macros: Dict[str, int] = field(default_factory=dict)
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert plan to dictionary for serialization."""
+        return {
+            "batch_count": len(self.batches),
+            "file_count": sum(len(b.files) for b in self.batches),
+            "batches": [b.to_dict() for b in self.batches],
+            "conflicting_macros": dict(self.conflicting_macros)
+        }
+
+
+class _Unit:
+    """A translation unit with the macros that can conflict in a batch."""
+    __slots__ = ('path', 'size', 'configuration', 'effects', 'inputs', 'writes', 'reads')
+
+    def __init__(self, path, size, configuration, effects, inputs):
+        self.path = path
+        self.size = size
+        self.configuration = configuration
+        self.effects = effects
+        self.inputs = inputs
+        self.writes: Dict[str, Optional[str]] = {}
+        self.reads: Dict[str, Optional[str]] = {}
+
+
+class _OpenBatch:
+    """Batch being filled, with the macro values its files fix."""
+    __slots__ = ('batch', 'written', 'read')
+
+    def __init__(self, batch: UnityBatch):
+        self.batch = batch
+        self.written: Dict[str, Optional[str]] = {}
+        self.read: Dict[str, Optional[str]] = {}
+
+    def __lt__(self, other: '_OpenBatch') -> bool:
+        return (self.batch.bytes, self.batch.name) < (other.batch.bytes, other.batch.name)
+
+    def conflicts(self, unit: _Unit) -> bool:
+        """Check whether adding unit could change the meaning of any file."""
+        written = self.written
+        read = self.read
+        for name, value in unit.writes.items():
+            if written.get(name, value) != value or read.get(name, value) != value:
+                return True
+        for name, value in unit.reads.items():
+            if written.get(name, value) != value:
+                return True
+        return False
+
+    def add(self, unit: _Unit) -> None:
+        self.batch.files.append(unit.path)
+        self.batch.bytes += unit.size
+        self.written.update(unit.writes)
+        for name, value in unit.reads.items():
+            self.read.setdefault(name, value)
+
+
+class UnityPlanner:
+    """
+    Plans unity batches for a set of translation units.
+
+    What each file leaves defined and which incoming macros it depends on
+    come from its HeaderSummary. Only macros that take more than one value
+    among files of a configuration can ever conflict, so everything else is
+    dropped before batching; conflicts are then checked against per-batch
+    macro tables instead of materializing a pairwise conflict graph.
+    """
+
+    def __init__(self, cache: Optional[HeaderSummaryCache] = None):
+        self.cache = cache or HeaderSummaryCache()
+        self.units: List[_Unit] = []
+
+    def add_translation_unit(self, file_path: str,
+                             configuration: Optional[Configuration] = None) -> None:
+        """Summarize a translation unit for planning."""
+        configuration = configuration or Configuration()
+        summary = self.cache.summarize_translation_unit(file_path, configuration)
+        marker = self.cache.is_include_marker
+        try:
+            size = os.path.getsize(file_path)
+        except OSError:
+            size = 0
+        self.units.append(_Unit(
+            path=file_path,
+            size=size,
+            configuration=configuration,
+            effects={n: v for n, v in summary.effects.items() if not marker(n)},
+            inputs={n: v for n, v in summary.inputs.items() if not marker(n)}
+        ))
+
+    def plan(self, max_batch_bytes: int = DEFAULT_MAX_BATCH_BYTES,
+             max_files: Optional[int] = None) -> UnityPlan:
+        """
+        Group the translation units into conflict-free, size-balanced batches.
+
+        Files are placed largest-conflict-set first, then largest first, each
+        into the least loaded compatible batch that still has room. The
+        number of batches starts at what the size limits require and only
+        grows when conflicts force it.
+
+        Args:
+            max_batch_bytes: Maximum source bytes per batch (a single larger
+                file still gets its own batch)
+            max_files: Maximum number of files per batch
+
+        Returns:
+            UnityPlan with the batches and the macros that constrained them
+        """
+        result = UnityPlan()
+        groups: Dict[Tuple, List[_Unit]] = {}
+        for unit in self.units:
+            groups.setdefault(self._configuration_key(unit.configuration), []).append(unit)
+
+        for group_index, units in enumerate(groups.values()):
+            self._prepare(units, result.conflicting_macros)
+            units.sort(key=lambda u: (-(len(u.writes) + len(u.reads)), -u.size, u.path))
+
+            total = sum(unit.size for unit in units)
+            count = max(1, math.ceil(total / max_batch_bytes) if max_batch_bytes else 1)
+            if max_files:
+                count = max(count, math.ceil(len(units) / max_files))
+
+            batches: List[_OpenBatch] = []
+            for _ in range(count):
+                insort(batches, self._new_batch(group_index, len(batches), units[0].configuration))
+
+            for unit in units:
+                chosen = None
+                for index, candidate in enumerate(batches):
+                    batch = candidate.batch
+                    if batch.files and batch.bytes + unit.size > max_batch_bytes:
+                        break  # Batches are ordered by size, so none of the rest fit
+                    if max_files and len(batch.files) >= max_files:
+                        continue
+                    if not candidate.conflicts(unit):
+                        chosen = batches.pop(index)
+                        break
+                if chosen is None:
+                    chosen = self._new_batch(group_index, len(batches) + len(result.batches),
+                                             unit.configuration)
+                chosen.add(unit)
+                insort(batches, chosen)
+
+            group_batches = [b.batch for b in batches if b.batch.files]
+            group_batches.sort(key=lambda b: (-b.bytes, b.name))
+            result.batches.extend(group_batches)
+
+        for index, batch in enumerate(result.batches):
+            batch.name = f"unity_{index}.cpp"
+        return result
+
+    def _prepare(self, units: List[_Unit], conflicting: Dict[str, int]) -> None:
+        """Keep only the macros that take more than one value within a group."""
+        values: Dict[str, set] = {}
+        for unit in units:
+            for table in (unit.effects, unit.inputs):
+                for name, value in table.items():
+                    values.setdefault(name, set()).add(value)
+        hot = {name for name, seen in values.items() if len(seen) > 1}
+
+        for unit in units:
+            unit.writes = {n: v for n, v in unit.effects.items() if n in hot}
+            unit.reads = {n: v for n, v in unit.inputs.items() if n in hot}
+            for name in unit.writes.keys() | unit.reads.keys():
+                conflicting[name] = conflicting.get(name, 0) + 1
+
+    def _new_batch(self, group: int, index: int, configuration: Configuration) -> _OpenBatch:
+        return _OpenBatch(UnityBatch(name=f"unity_{group}_{index}.cpp", configuration=configuration))
+
+    def _configuration_key(self, configuration: Configuration) -> Tuple:
+        """Files can share a batch only if they are compiled identically."""
+        return (
+            tuple(sorted(configuration.defines.items())),
+            tuple(sorted(configuration.undefs)),
+            tuple(configuration.include_paths)
+        )
@@ -3,6 +3,7 @@ Validation module for syntax checking and error detection in preprocessor direct
 Provides comprehensive validation of directive syntax, nesting, and semantic correctness.
 """
 
+import re
 from typing import List, Dict, Set, Optional
 from .data_models import (
     Directive, DirectiveType, FileAnalysisResult, 
@@ -13,12 +14,13 @@ from .data_models import (
 class DirectiveValidator:
     """
     Validates preprocessor directives for syntax errors, nesting issues, and semantic problems.
+    
+    Options are passed with each call and nothing is stored on the instance,
+    so one validator can be shared by concurrent analyses.
     """
     
-    def __init__(self):
-        self.strict_mode = False
-        self.check_balance = True
-        
+    IDENTIFIER = re.compile(r'^[A-Za-z_][A-Za-z0-9_]*$')
+    
     def validate(self, 
                  file_result: FileAnalysisResult, 
                  strict: bool = False, 
@@ -34,21 +36,18 @@ class DirectiveValidator:
         Returns:
             List of validation errors found
         """
-        self.strict_mode = strict
-        self.check_balance = check_balance
-        
         errors = []
         
         # Basic syntax validation for each directive
         for directive in file_result.directives:
-            errors.extend(self._validate_directive_syntax(directive))
+            errors.extend(self._validate_directive_syntax(directive, strict))
         
         # Check directive nesting and balance
         if check_balance:
             errors.extend(self._validate_directive_balance(file_result.directives))
         
         # Semantic validation
-        errors.extend(self._validate_semantic_rules(file_result))
+        errors.extend(self._validate_semantic_rules(file_result, strict))
         
         # Strict mode additional checks
         if strict:
@@ -56,12 +55,13 @@ class DirectiveValidator:
         
         return errors
     
-    def _validate_directive_syntax(self, directive: Directive) -> List[ValidationError]:
+    def _validate_directive_syntax(self, directive: Directive, strict: bool = False) -> List[ValidationError]:
         """
         Validate the syntax of a single directive.
         
         Args:
             directive: Directive to validate
+            strict: Enable strict validation rules
         
         Returns:
             List of validation errors
@@ -69,15 +69,15 @@ class DirectiveValidator:
         errors = []
         
         if directive.type == DirectiveType.DEFINE:
-            errors.extend(self._validate_define_directive(directive))
+            errors.extend(self._validate_define_directive(directive, strict))
         elif directive.type == DirectiveType.IFDEF:
             errors.extend(self._validate_ifdef_directive(directive))
         elif directive.type == DirectiveType.IFNDEF:
             errors.extend(self._validate_ifndef_directive(directive))
         elif directive.type == DirectiveType.IF:
-            errors.extend(self._validate_if_directive(directive))
+            errors.extend(self._validate_if_directive(directive, strict))
         elif directive.type == DirectiveType.ELIF:
-            errors.extend(self._validate_elif_directive(directive))
+            errors.extend(self._validate_elif_directive(directive, strict))
         elif directive.type == DirectiveType.UNDEF:
             errors.extend(self._validate_undef_directive(directive))
         elif directive.type == DirectiveType.INCLUDE:
@@ -93,7 +93,7 @@ class DirectiveValidator:
         
         return errors
     
-    def _validate_define_directive(self, directive: Directive) -> List[ValidationError]:
+    def _validate_define_directive(self, directive: Directive, strict: bool = False) -> List[ValidationError]:
         """Validate #define directive."""
         errors = []
         
@@ -119,7 +119,7 @@ class DirectiveValidator:
                 ))
             
             # Check for reserved identifiers in strict mode
-            if self.strict_mode and self._is_reserved_identifier(directive.symbol_name):
+            if strict and self._is_reserved_identifier(directive.symbol_name):
                 errors.append(ValidationError(
                     severity=ErrorSeverity.WARNING,
                     message=f"Symbol name '{directive.symbol_name}' may conflict with reserved identifiers",
@@ -179,7 +179,7 @@ class DirectiveValidator:
         
         return errors
     
-    def _validate_if_directive(self, directive: Directive) -> List[ValidationError]:
+    def _validate_if_directive(self, directive: Directive, strict: bool = False) -> List[ValidationError]:
         """Validate #if directive."""
         errors = []
         
@@ -194,11 +194,11 @@ class DirectiveValidator:
             ))
         else:
             # Validate condition syntax
-            errors.extend(self._validate_condition_expression(directive))
+            errors.extend(self._validate_condition_expression(directive, strict))
         
         return errors
     
-    def _validate_elif_directive(self, directive: Directive) -> List[ValidationError]:
+    def _validate_elif_directive(self, directive: Directive, strict: bool = False) -> List[ValidationError]:
         """Validate #elif directive."""
         errors = []
         
@@ -213,7 +213,7 @@ class DirectiveValidator:
             ))
         else:
             # Validate condition syntax
-            errors.extend(self._validate_condition_expression(directive))
+            errors.extend(self._validate_condition_expression(directive, strict))
         
         return errors
     
@@ -257,7 +257,7 @@ class DirectiveValidator:
         
         return errors
     
-    def _validate_condition_expression(self, directive: Directive) -> List[ValidationError]:
+    def _validate_condition_expression(self, directive: Directive, strict: bool = False) -> List[ValidationError]:
         """Validate a conditional expression."""
         errors = []
         condition = directive.condition
@@ -284,7 +284,7 @@ class DirectiveValidator:
             ))
         
         # Check for suspicious patterns in strict mode
-        if self.strict_mode:
+        if strict:
             errors.extend(self._validate_condition_patterns(directive))
         
         return errors
@@ -370,7 +370,7 @@ class DirectiveValidator:
         
         return errors
     
-    def _validate_semantic_rules(self, file_result: FileAnalysisResult) -> List[ValidationError]:
+    def _validate_semantic_rules(self, file_result: FileAnalysisResult, strict: bool = False) -> List[ValidationError]:
         """Validate semantic rules and best practices."""
         errors = []
         
@@ -381,7 +381,7 @@ class DirectiveValidator:
         errors.extend(self._check_undefined_symbols(file_result))
         
         # Check for include guard patterns
-        if self.strict_mode:
+        if strict:
             errors.extend(self._check_include_guards(file_result))
         
         return errors
@@ -406,15 +406,7 @@ class DirectiveValidator:
         for directive in file_result.directives:
             if directive.type == DirectiveType.DEFINE and directive.symbol_name:
                 if directive.symbol_name in defined_symbols:
-                    first_def = defined_symbols[directive.symbol_name]
-                    errors.append(ValidationError(
-                        severity=ErrorSeverity.WARNING,
-                        message=f"Symbol '{directive.symbol_name}' redefined",
-                        file_path=directive.file_path,
-                        line_number=directive.line_number,
-                        directive_content=directive.content,
-                        suggestion=f"First defined at line {first_def.line_number}"
-                    ))
+                    errors.append(self._redefinition_error(directive, defined_symbols[directive.symbol_name]))
                 else:
                     defined_symbols[directive.symbol_name] = directive
         
@@ -434,17 +426,32 @@ class DirectiveValidator:
         for directive in file_result.directives:
             if directive.type in [DirectiveType.IFDEF, DirectiveType.IFNDEF] and directive.symbol_name:
                 if directive.symbol_name not in defined_symbols:
-                    errors.append(ValidationError(
-                        severity=ErrorSeverity.WARNING,
-                        message=f"Reference to potentially undefined symbol '{directive.symbol_name}'",
-                        file_path=directive.file_path,
-                        line_number=directive.line_number,
-                        directive_content=directive.content,
-                        suggestion="Ensure the symbol is defined before use"
-                    ))
+                    errors.append(self._undefined_symbol_error(directive))
         
         return errors
     
+    def _redefinition_error(self, directive: Directive, first_def: Directive) -> ValidationError:
+        """Warning for a #define of a symbol the file already defined."""
+        return ValidationError(
+            severity=ErrorSeverity.WARNING,
+            message=f"Symbol '{directive.symbol_name}' redefined",
+            file_path=directive.file_path,
+            line_number=directive.line_number,
+            directive_content=directive.content,
+            suggestion=f"First defined at line {first_def.line_number}"
+        )
+    
+    def _undefined_symbol_error(self, directive: Directive) -> ValidationError:
+        """Warning for an #ifdef/#ifndef of a symbol the file never defines."""
+        return ValidationError(
+            severity=ErrorSeverity.WARNING,
+            message=f"Reference to potentially undefined symbol '{directive.symbol_name}'",
+            file_path=directive.file_path,
+            line_number=directive.line_number,
+            directive_content=directive.content,
+            suggestion="Ensure the symbol is defined before use"
+        )
+    
     def _check_include_guards(self, file_result: FileAnalysisResult) -> List[ValidationError]:
         """Check for proper include guard patterns in header files."""
         errors = []
@@ -530,8 +537,7 @@ class DirectiveValidator:
     
     def _is_valid_identifier(self, identifier: str) -> bool:
         """Check if a string is a valid C++ identifier."""
-        import re
-        return bool(re.match(r'^[A-Za-z_][A-Za-z0-9_]*$', identifier))
+        return bool(self.IDENTIFIER.match(identifier))
     
     def _is_reserved_identifier(self, identifier: str) -> bool:
         """Check if an identifier might be reserved."""
@@ -0,0 +1,38 @@
+"""
+Shared fixture for tests that analyze a small source tree on disk.
+"""
+
+import unittest
+import tempfile
+import shutil
+import os
+
+
+def write_tree(root, files):
+    """
+    Write files under a root directory, creating parent directories.
+
+    Args:
+        root: Directory to write into
+        files: Dictionary mapping relative paths to file contents
+    """
+    for name, text in files.items():
+        path = os.path.join(root, name)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, 'w') as f:
+            f.write(text)
+
+
+class SourceTreeTestCase(unittest.TestCase):
+    """Test case that writes FILES to a temporary root for each test."""
+
+    FILES = {}
+
+    def setUp(self):
+        """Set up a small source tree."""
+        self.root = tempfile.mkdtemp()
+        write_tree(self.root, self.FILES)
+
+    def tearDown(self):
+        """Clean up the source tree."""
+        shutil.rmtree(self.root)
@@ -0,0 +1,153 @@
+"""
+Unit tests for the library API module.
+Tests batch analysis of paths and in-memory buffers.
+"""
+
+import unittest
+import tempfile
+import os
+import sys
+import threading
+from unittest import mock
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.api import Analyzer, AnalysisOptions, analyze_paths, iter_file_results, analyze_buffers
+from src.data_models import AnalysisResult, DirectiveType
+
+
+class TestAnalysisAPI(unittest.TestCase):
+    """Test cases for the analysis API."""
+
+    def setUp(self):
+        """Set up test fixtures."""
+        self.temp_dir = tempfile.mkdtemp()
+
+        self.test_files = {
+            'main.cpp': '#include "config.h"\n#ifdef DEBUG\n#define TRACE 1\n#endif\n',
+            'config.h': '#ifndef CONFIG_H\n#define CONFIG_H\n#define LEVEL BASE_LEVEL\n#endif\n',
+        }
+
+        for file_path, content in self.test_files.items():
+            with open(os.path.join(self.temp_dir, file_path), 'w') as f:
+                f.write(content)
+
+    def tearDown(self):
+        """Clean up test fixtures."""
+        import shutil
+        shutil.rmtree(self.temp_dir)
+
+    def test_analyze_paths_directory(self):
+        """Test analyzing a directory returns an aggregated result."""
+        result = analyze_paths([self.temp_dir], AnalysisOptions(include_headers=True))
+
+        self.assertIsInstance(result, AnalysisResult)
+        self.assertEqual(result.total_files, 2)
+        self.assertEqual(result.total_defines, 3)
+        self.assertIn("LEVEL", result.dependency_graph)
+
+        trace = [d for d in result.get_all_defines() if d.symbol_name == "TRACE"][0]
+        self.assertEqual(trace.context, ["DEBUG"])
+
+    def test_iter_file_results_is_lazy(self):
+        """Test that file results are yielded one at a time."""
+        iterator = iter_file_results(self.temp_dir)
+        first = next(iterator)
+
+        self.assertTrue(first.file_path.endswith('main.cpp'))
+        self.assertEqual(len(list(iterator)), 0)
+
+    def test_analyze_buffers(self):
+        """Test analyzing in-memory buffers without touching the filesystem."""
+        results = analyze_buffers({
+            "unsaved.h": "#if defined(WIN32)\n#define PLATFORM 1\n#endif\n"
+        })
+
+        result = results["unsaved.h"]
+        self.assertEqual(result.line_count, 3)
+        self.assertEqual(result.errors, [])
+        self.assertEqual(result.defines[0].context, ["defined(WIN32)"])
+
+    def test_buffers_combined_with_paths(self):
+        """Test analyzing paths and buffers in one call."""
+        result = analyze_paths(
+            os.path.join(self.temp_dir, 'main.cpp'),
+            buffers={"extra.cpp": ["#define EXTRA 1"]}
+        )
+
+        self.assertEqual(result.total_files, 2)
+        self.assertIn("extra.cpp", result.file_results)
+
+    def test_validation_option(self):
+        """Test that validation errors are attached when requested."""
+        analyzer = Analyzer(AnalysisOptions(validate=True))
+        result = analyzer.analyze_buffer("#define A 1\n#define A 2\n", "dup.cpp")
+
+        messages = [e.message for e in result.errors]
+        self.assertTrue(any("redefined" in m for m in messages))
+
+    def test_dependency_graph_reset_between_calls(self):
+        """Test that reusing an Analyzer does not leak dependencies."""
+        analyzer = Analyzer()
+        analyzer.analyze_paths(buffers={"a.h": "#define A B\n"})
+        result = analyzer.analyze_paths(buffers={"b.h": "#define C D\n"})
+
+        self.assertEqual(result.dependency_graph, {"C": ["D"]})
+
+    def test_worker_threads_match_sequential(self):
+        """Test that analysis on worker threads gives the sequential result, in order."""
+        buffers = {
+            f"f{i}.h": f"#if LEVEL > {i}\n#define F{i} G{i}\n#else\n#undef F{i}\n#endif\n#endif\n"
+            for i in range(40)
+        }
+        expected = Analyzer(AnalysisOptions(validate=True)).analyze_paths([self.temp_dir], buffers)
+
+        with mock.patch('src.api.free_threading_enabled', return_value=True):
+            analyzer = Analyzer(AnalysisOptions(validate=True, workers=4))
+            self.assertEqual(analyzer.workers, 4)
+            result = analyzer.analyze_paths([self.temp_dir], buffers)
+
+        self.assertEqual(list(result.file_results), list(expected.file_results))
+        self.assertEqual(result.to_dict()["file_results"], expected.to_dict()["file_results"])
+        self.assertEqual(result.dependency_graph, expected.dependency_graph)
+
+    def test_workers_fall_back_with_gil(self):
+        """Test that workers are not used where threads do not run in parallel."""
+        with mock.patch('src.api.free_threading_enabled', return_value=False):
+            analyzer = Analyzer(AnalysisOptions(workers=8))
+            self.assertEqual(analyzer.workers, 1)
+            self.assertEqual(list(analyzer.map(str, [1, 2])), ["1", "2"])
+
+    def test_shared_analyzer_across_threads(self):
+        """Test that one Analyzer analyzes different buffers from several threads at once."""
+        analyzer = Analyzer()
+        texts = {f"t{i}.h": "".join(f"#ifdef T{i}_{d}\n" for d in range(20)) + "#define X 1\n" + "#endif\n" * 20
+                 for i in range(8)}
+        results = {}
+        barrier = threading.Barrier(len(texts))
+
+        def run(name):
+            barrier.wait()
+            for _ in range(20):
+                results[name] = analyzer.analyze_buffer(texts[name], name)
+
+        threads = [threading.Thread(target=run, args=(name,)) for name in texts]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        for i in range(8):
+            result = results[f"t{i}.h"]
+            self.assertEqual(result.errors, [])
+            self.assertEqual(result.defines[0].context, [f"T{i}_{d}" for d in range(20)])
+
+    def test_missing_path_raises(self):
+        """Test that a missing path raises ValueError."""
+        with self.assertRaises(ValueError):
+            analyze_paths(os.path.join(self.temp_dir, 'missing'))
+
+
+if __name__ == '__main__':
+    unittest.main()
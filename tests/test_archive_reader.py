@@ -0,0 +1,108 @@
+"""
+Unit tests for the archive reader module.
+Tests streaming C++ members out of tar and zip archives with the scanner's
+extension and exclude rules applied to member names.
+"""
+
+import unittest
+import tarfile
+import tempfile
+import zipfile
+import shutil
+import io
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.archive_reader import is_archive, iter_archive_sources
+
+
+MEMBERS = {
+    "zlib-1.3/zlib.cc": "#ifdef DEBUG\r\n#define TRACE 1\r\n#endif\r\n",
+    "zlib-1.3/zlib.h": "#ifndef ZLIB_H\n#define ZLIB_H\n#endif\n",
+    "zlib-1.3/contrib/minizip.cpp": "#define MINI 1\n",
+    "zlib-1.3/README": "#define NOT_CODE\n",
+}
+
+
+class TestArchiveReader(unittest.TestCase):
+    """Test cases for iter_archive_sources."""
+
+    def setUp(self):
+        """Set up test fixtures."""
+        self.temp_dir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        """Clean up test fixtures."""
+        shutil.rmtree(self.temp_dir)
+
+    def write_tar(self, name, mode):
+        path = os.path.join(self.temp_dir, name)
+        with tarfile.open(path, mode) as archive:
+            directory = tarfile.TarInfo("zlib-1.3")
+            directory.type = tarfile.DIRTYPE
+            archive.addfile(directory)
+            for member, text in MEMBERS.items():
+                data = text.encode('utf-8')
+                info = tarfile.TarInfo("./" + member)
+                info.size = len(data)
+                archive.addfile(info, io.BytesIO(data))
+            link = tarfile.TarInfo("zlib-1.3/link.h")
+            link.type = tarfile.SYMTYPE
+            link.linkname = "zlib.h"
+            archive.addfile(link)
+        return path
+
+    def write_zip(self):
+        path = os.path.join(self.temp_dir, "drop.zip")
+        with zipfile.ZipFile(path, 'w', zipfile.ZIP_DEFLATED) as archive:
+            archive.writestr("zlib-1.3/", "")
+            for member, text in MEMBERS.items():
+                archive.writestr(member, text)
+        return path
+
+    def test_is_archive(self):
+        """Test archive detection by suffix."""
+        for name in ["a.tar", "a.tar.gz", "A.TGZ", "a.tar.xz", "a.tar.bz2", "a.zip"]:
+            self.assertTrue(is_archive(name), name)
+        for name in ["a.gz", "a.cpp", "tar"]:
+            self.assertFalse(is_archive(name), name)
+
+    def test_tar_formats(self):
+        """Test that plain and compressed tarballs yield the same members."""
+        for name, mode in [("src.tar", "w"), ("src.tar.gz", "w:gz"), ("src.tar.xz", "w:xz")]:
+            path = self.write_tar(name, mode)
+            sources = dict(iter_archive_sources(path, include_headers=True))
+            self.assertEqual(sorted(sources), [
+                f"{path}/zlib-1.3/contrib/minizip.cpp", f"{path}/zlib-1.3/zlib.cc", f"{path}/zlib-1.3/zlib.h"
+            ], name)
+            # Lines are decoded like files on disk, with universal newlines
+            self.assertEqual(sources[f"{path}/zlib-1.3/zlib.cc"][1], "#define TRACE 1\n")
+
+    def test_zip_and_filters(self):
+        """Test zip members with header and exclude filtering."""
+        path = self.write_zip()
+        names = [name for name, _ in iter_archive_sources(path)]
+        self.assertEqual(names, [f"{path}/zlib-1.3/zlib.cc", f"{path}/zlib-1.3/contrib/minizip.cpp"])
+        names = [name for name, _ in iter_archive_sources(path, True, ["contrib"])]
+        self.assertEqual(names, [f"{path}/zlib-1.3/zlib.cc", f"{path}/zlib-1.3/zlib.h"])
+
+    def test_members_analyze_like_files(self):
+        """Test that member lines feed the analyzer directly."""
+        from src.api import Analyzer
+        path = self.write_tar("src.tar.gz", "w:gz")
+        analyzer = Analyzer()
+        results = [analyzer.analyze_buffer(lines, name) for name, lines in iter_archive_sources(path)]
+        defines = {d.symbol_name: d.context for r in results for d in r.defines}
+        self.assertEqual(defines, {"TRACE": ["DEBUG"], "MINI": []})
+
+    def test_not_an_archive(self):
+        """Test that other files are rejected."""
+        with self.assertRaises(ValueError):
+            list(iter_archive_sources(os.path.join(self.temp_dir, "a.cpp")))
+
+
+if __name__ == '__main__':
+    unittest.main()
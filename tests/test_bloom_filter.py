@@ -0,0 +1,121 @@
+"""
+Unit tests for the Bloom filter module.
+Tests filter sizing, identifier extraction and pruned mention queries, and
+benchmarks the measured false positive rate and query time per target rate.
+"""
+
+import unittest
+import os
+import sys
+import time
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.bloom_filter import (
+    BloomFilter, FileFilterIndex, code_identifiers, directive_identifiers
+)
+from src.data_models import AnalysisResult, Directive, DirectiveType, FileAnalysisResult
+from tests.test_startup import RUN_BENCHMARKS
+
+
+# Files, identifiers per file and absent symbols probed by the benchmark
+BENCHMARK_FILES = 2000
+BENCHMARK_IDENTIFIERS = 40
+BENCHMARK_PROBES = 200
+BENCHMARK_RATES = (0.05, 0.01, 0.001)
+
+
+class TestBloomFilter(unittest.TestCase):
+    """Test cases for Bloom filters and per-file filter queries."""
+
+    def test_sizing(self):
+        """Test filters grow with capacity and shrink with the rate."""
+        loose = BloomFilter.for_capacity(1000, 0.05)
+        tight = BloomFilter.for_capacity(1000, 0.001)
+
+        self.assertLess(loose.size, tight.size)
+        self.assertLess(loose.hash_count, tight.hash_count)
+        self.assertEqual(BloomFilter.for_capacity(0).size, 64)
+        with self.assertRaises(ValueError):
+            BloomFilter.for_capacity(10, 1.5)
+
+    def test_membership_and_serialization(self):
+        """Test added symbols are always found, also after a round trip."""
+        bloom = BloomFilter.for_capacity(100)
+        names = [f"MACRO_{i}" for i in range(100)]
+        for name in names:
+            bloom.add(name)
+        restored = BloomFilter.from_dict(bloom.to_dict())
+
+        for name in names:
+            self.assertIn(name, bloom)
+            self.assertIn(name, restored)
+        self.assertEqual(restored.bits, bloom.bits)
+
+    def test_identifiers(self):
+        """Test directive keywords and include names are left out."""
+        directives = [
+            Directive(DirectiveType.IF, "#if defined(USE_SSL) && LEVEL > 1", 1, "a.c", condition="defined(USE_SSL) && LEVEL > 1"),
+            Directive(DirectiveType.DEFINE, "#define TLS_VERSION(x) (x + BASE)", 2, "a.c", symbol_name="TLS_VERSION"),
+            Directive(DirectiveType.INCLUDE, "#include <openssl/ssl.h>", 3, "a.c"),
+        ]
+
+        self.assertEqual(directive_identifiers(directives),
+                         {"defined", "USE_SSL", "LEVEL", "TLS_VERSION", "x", "BASE"})
+        self.assertEqual(code_identifiers("#ifdef A\nint b = CALL(c);\n"), {"int", "b", "CALL", "c"})
+
+    def test_query_verifies_candidates(self):
+        """Test only filter hits are loaded, and false positives are rejected."""
+        result = AnalysisResult()
+        for name, content in (("a.h", "#define ALPHA BETA"), ("b.h", "#define GAMMA 1"), ("c.h", "#define ALPHA 2")):
+            result.add_file_result(FileAnalysisResult(file_path=name, directives=[
+                Directive(DirectiveType.DEFINE, content, 1, name, symbol_name=content.split()[1])
+            ]))
+        index = FileFilterIndex.from_analysis(result)
+        exact = {path: directive_identifiers(r.directives) for path, r in result.file_results.items()}
+        loaded = []
+
+        def load(path):
+            loaded.append(path)
+            return exact[path]
+
+        outcome = index.query(["ALPHA", "BETA"], load)
+        self.assertEqual(outcome.files, ["a.h"])
+        self.assertEqual(loaded, index.candidates(["ALPHA", "BETA"]))
+        self.assertEqual(index.query(["ALPHA", "GAMMA"], exact.get, any_symbol=True).files, ["a.h", "b.h", "c.h"])
+
+        # A filter that says "maybe" to everything still gives exact answers
+        index.filters["b.h"].bits = bytearray(b"\xff" * len(index.filters["b.h"].bits))
+        outcome = index.query(["ALPHA"], exact.get)
+        self.assertEqual(outcome.files, ["a.h", "c.h"])
+        self.assertEqual(outcome.false_positives, 1)
+
+        restored = FileFilterIndex.from_dict(index.to_dict())
+        self.assertEqual(restored.candidates(["ALPHA"]), index.candidates(["ALPHA"]))
+
+    @unittest.skipUnless(RUN_BENCHMARKS, "set CPP_ANALYZER_BENCHMARKS=1 to run timed benchmarks")
+    def test_false_positive_benchmark(self):
+        """Benchmark measured false positive rates, filter sizes and query time."""
+        files = {f"file_{i}.h": {f"SYM_{i}_{j}" for j in range(BENCHMARK_IDENTIFIERS)}
+                 for i in range(BENCHMARK_FILES)}
+        probes = [f"ABSENT_{i}" for i in range(BENCHMARK_PROBES)]
+        for rate in BENCHMARK_RATES:
+            index = FileFilterIndex(rate)
+            for path, identifiers in files.items():
+                index.add_file(path, identifiers)
+
+            start = time.perf_counter()
+            hits = sum(len(index.candidates([probe])) for probe in probes)
+            filter_ms = (time.perf_counter() - start) * 1000 / len(probes)
+            measured = hits / (len(probes) * len(files))
+            size = sum(len(bloom.bits) for bloom in index.filters.values())
+
+            summary = (f"rate {rate}: measured {measured:.4f}, {size / len(files):.1f} bytes/file, "
+                       f"{filter_ms:.2f}ms per query over {len(files)} files")
+            self.assertLess(measured, rate * 2, summary)
+            self.assertIn("file_7.h", index.candidates(["SYM_7_3"]))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,112 @@
+"""
+Unit tests for the build log module.
+Tests shell tokenizing, compiler command recognition and configuration
+interning for make, ninja and raw compiler logs.
+"""
+
+import unittest
+import tempfile
+import shutil
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.build_log import (
+    compiled_sources, distinct_configurations, load_build_log, parse_build_log, tokenize_command_line
+)
+
+
+class TestTokenizeCommandLine(unittest.TestCase):
+    """Test cases for the shell tokenizer."""
+
+    def test_plain_words(self):
+        """Test unquoted words are split on whitespace."""
+        self.assertEqual(tokenize_command_line("g++  -c a.cpp\t-o a.o"),
+                         [["g++", "-c", "a.cpp", "-o", "a.o"]])
+
+    def test_quoting(self):
+        """Test single quotes, double quotes and escapes are removed."""
+        line = """cc '-DNAME="a b"' -DPATH=\\"/usr\\" "-DMSG=\\"hi there\\"" -DX=a\\ b"""
+        self.assertEqual(tokenize_command_line(line),
+                         [["cc", '-DNAME="a b"', '-DPATH="/usr"', '-DMSG="hi there"', "-DX=a b"]])
+
+    def test_separators(self):
+        """Test commands are split at unquoted ;, && and |."""
+        self.assertEqual(tokenize_command_line("cd build && cc -c ../a.c; echo 'x;y' | cat"),
+                         [["cd", "build"], ["cc", "-c", "../a.c"], ["echo", "x;y"], ["cat"]])
+
+
+class TestBuildLog(unittest.TestCase):
+    """Test cases for build log parsing."""
+
+    def setUp(self):
+        """Set up a temporary build directory."""
+        self.root = tempfile.mkdtemp()
+
+    def tearDown(self):
+        """Clean up the build directory."""
+        shutil.rmtree(self.root)
+
+    def test_compiled_sources(self):
+        """Test compilers are recognized behind launchers and outputs are skipped."""
+        self.assertEqual(compiled_sources(["ccache", "/usr/bin/x86_64-linux-gnu-g++-12", "-c", "a.cpp",
+                                           "-o", "b.cpp", "-MF", "a.d"]), ["a.cpp"])
+        self.assertEqual(compiled_sources(["CC=gcc", "clang", "x.c", "y.cc"]), ["x.c", "y.cc"])
+        self.assertEqual(compiled_sources(["echo", "a.cpp"]), [])
+        self.assertEqual(compiled_sources(["ar", "rcs", "lib.a", "a.o"]), [])
+
+    def test_make_dry_run(self):
+        """Test make -n output with continuations and directory messages."""
+        log = [
+            "make[1]: Entering directory '%s/lib'\n" % self.root,
+            "g++ -DLIB -DLEVEL=2 -Iinclude \\\n",
+            "    -c util.cpp -o util.o\n",
+            "make[1]: Leaving directory '%s/lib'\n" % self.root,
+            "g++ -DAPP -I include -c main.cpp -o main.o\n",
+            "g++ main.o lib/util.o -o app\n",
+        ]
+        commands = parse_build_log(log, self.root)
+
+        self.assertEqual([c.file for c in commands],
+                         [os.path.join(self.root, "lib", "util.cpp"), os.path.join(self.root, "main.cpp")])
+        library = commands[0].configuration
+        self.assertEqual(library.defines, {"LIB": "1", "LEVEL": "2"})
+        self.assertEqual(library.include_paths, [os.path.join(self.root, "lib", "include")])
+        self.assertEqual(commands[1].configuration.include_paths, [os.path.join(self.root, "include")])
+
+    def test_ninja_commands_intern_configurations(self):
+        """Test identical flag sets share one configuration."""
+        log = [
+            "cd %s/build && /usr/bin/c++ -DNDEBUG -I../src -O2 -c ../src/a.cpp -o a.o\n" % self.root,
+            "cd %s/build && /usr/bin/c++ -I../src -DNDEBUG -O0 -c ../src/b.cpp -o b.o\n" % self.root,
+            "/usr/bin/c++ -DDEBUG -c c.cpp\n",
+            "/usr/bin/c++ a.o b.o -o app\n",
+        ]
+        commands = parse_build_log(log, self.root)
+
+        self.assertEqual(len(commands), 3)
+        self.assertEqual(commands[0].file, os.path.join(self.root, "src", "a.cpp"))
+        self.assertEqual(commands[0].directory, os.path.join(self.root, "build"))
+        self.assertIs(commands[0].configuration, commands[1].configuration)
+        self.assertEqual(commands[2].file, os.path.join(self.root, "c.cpp"))
+
+        configurations = distinct_configurations(commands)
+        self.assertEqual([c.name for c in configurations], ["build-1", "build-2"])
+        self.assertEqual(configurations[1].defines, {"DEBUG": "1"})
+
+    def test_load_build_log(self):
+        """Test paths are relative to the log's directory by default."""
+        path = os.path.join(self.root, "build.log")
+        with open(path, 'w') as f:
+            f.write("[1/2] clang -UFOO -DBAR=\"x y\" -c src/a.c\n")
+        commands = load_build_log(path)
+
+        self.assertEqual(commands[0].file, os.path.join(self.root, "src", "a.c"))
+        self.assertEqual(commands[0].configuration.defines, {"BAR": "x y"})
+        self.assertEqual(commands[0].configuration.undefs, ["FOO"])
+
+
+if __name__ == '__main__':
+    unittest.main()
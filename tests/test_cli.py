@@ -0,0 +1,451 @@
+"""
+Unit tests for the command-line interface.
+Tests subcommand routing and standard input handling.
+"""
+
+import unittest
+import tempfile
+import io
+import json
+import os
+import sys
+import time
+from contextlib import redirect_stdout
+from unittest import mock
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.cli import CLI
+
+
+class TestCLI(unittest.TestCase):
+    """Test cases for the CLI class."""
+
+    def setUp(self):
+        """Set up test fixtures."""
+        self.cli = CLI()
+        self.temp_dir = tempfile.mkdtemp()
+
+    def tearDown(self):
+        """Clean up test fixtures."""
+        import shutil
+        shutil.rmtree(self.temp_dir)
+
+    def run_cli(self, args, stdin_text=""):
+        """Run the CLI with the given arguments and standard input."""
+        stdin = io.TextIOWrapper(io.BytesIO(stdin_text.encode('utf-8')))
+        output = io.StringIO()
+        with mock.patch.object(sys, 'stdin', stdin), redirect_stdout(output):
+            exit_code = self.cli.run(args)
+        return exit_code, output.getvalue()
+
+    def test_analyze_stdin(self):
+        """Test analyzing a buffer read from standard input."""
+        output_file = os.path.join(self.temp_dir, 'out.json')
+        exit_code, _ = self.run_cli(
+            ['analyze', '-', '--stdin-name', 'edit.h', '-o', output_file],
+            "#ifdef DEBUG\n#define TRACE 1\n#endif\n"
+        )
+
+        self.assertEqual(exit_code, 0)
+        with open(output_file) as f:
+            data = json.load(f)
+        self.assertEqual(list(data['file_results']), ['edit.h'])
+        self.assertEqual(data['file_results']['edit.h']['defines'][0]['context'], ['DEBUG'])
+
+    def test_validate_stdin(self):
+        """Test validating standard input reports errors under the buffer name."""
+        exit_code, output = self.run_cli(
+            ['validate', '-', '--stdin-name', 'piped.cpp', '--check-balance'],
+            "#define A 1\n#endif\n"
+        )
+
+        self.assertEqual(exit_code, 1)
+        self.assertIn("piped.cpp:2: error: Orphaned #endif", output)
+
+    def test_validate_stdin_given_twice(self):
+        """Test that a repeated '-' is rejected instead of validating an empty second read."""
+        exit_code, output = self.run_cli(['validate', '-', '-'], "#endif\n")
+
+        self.assertEqual(exit_code, 1)
+        self.assertIn("may be given only once", output)
+        self.assertNotIn("Orphaned", output)
+
+    def test_macros_command(self):
+        """Test printing effective macros of a sample translation unit."""
+        sample = os.path.join(os.path.dirname(__file__), '..', 'samples', 'main.cpp')
+        exit_code, output = self.run_cli(['macros', sample, '-D', 'LINUX', '-D', 'DEBUG'])
+
+        self.assertEqual(exit_code, 0)
+        self.assertIn('#define PLATFORM_NAME "Linux"', output)
+        self.assertIn('#define LOG_LEVEL 3', output)
+
+    def test_pch_command(self):
+        """Test PCH recommendations for the sample translation units."""
+        samples = os.path.join(os.path.dirname(__file__), '..', 'samples')
+        output_path = os.path.join(self.temp_dir, 'pch.json')
+        exit_code, _ = self.run_cli(['pch', os.path.join(samples, 'main.cpp'),
+                                     os.path.join(samples, 'network.cpp'), '--output', output_path])
+
+        self.assertEqual(exit_code, 0)
+        with open(output_path) as f:
+            data = json.load(f)
+        headers = [h["path"] for r in data["recommendations"] for h in r["headers"]]
+        self.assertEqual([os.path.basename(h) for h in headers], ["config.h"])
+
+    def test_unity_command(self):
+        """Test writing a unity plan for the sample translation units."""
+        samples = os.path.join(os.path.dirname(__file__), '..', 'samples')
+        output_path = os.path.join(self.temp_dir, 'unity.json')
+        exit_code, output = self.run_cli(['unity', os.path.join(samples, 'main.cpp'),
+                                          os.path.join(samples, 'network.cpp'), '--output', output_path])
+
+        self.assertEqual(exit_code, 0)
+        with open(output_path) as f:
+            data = json.load(f)
+        self.assertEqual(data["file_count"], 2)
+        self.assertIn("unity batches", output)
+
+    def test_conflicts_command(self):
+        """Test that include-order dependent macros fail the conflicts command."""
+        for name, text in (("small.h", "#define SIZE 1\n"), ("large.h", "#define SIZE 2\n"),
+                           ("a.cpp", '#include "small.h"\n#include "large.h"\n'),
+                           ("b.cpp", '#include "small.h"\n')):
+            with open(os.path.join(self.temp_dir, name), 'w') as f:
+                f.write(text)
+
+        exit_code, output = self.run_cli(['conflicts', os.path.join(self.temp_dir, 'a.cpp'),
+                                          os.path.join(self.temp_dir, 'b.cpp')])
+
+        self.assertEqual(exit_code, 1)
+        self.assertIn("a.cpp: 1 conflicting macro(s)", output)
+        self.assertNotIn("b.cpp:", output)
+
+    def test_deps_command(self):
+        """Test loading and cross-checking the headers of a ninja deps log."""
+        from tests.test_ninja_deps import write_deps_log
+        samples = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', 'samples'))
+        future = (int(time.time()) + 3600) * 1000000000
+        with open(os.path.join(self.temp_dir, 'generated.h'), 'w') as f:
+            f.write("#define GENERATED 1\n")
+        write_deps_log(os.path.join(self.temp_dir, '.ninja_deps'), [
+            ("path", "main.o"), ("path", os.path.join(samples, "main.cpp")),
+            ("path", os.path.join(samples, "config.h")), ("path", "generated.h"),
+            ("deps", 0, future, [1, 2, 3]),
+        ])
+        exit_code, output = self.run_cli(['deps', self.temp_dir, '--check'])
+
+        self.assertEqual(exit_code, 0)
+        self.assertIn("1 of 1 loaded from the log", output)
+        self.assertIn("main.cpp: 2 header(s)", output)
+        self.assertIn("1 recorded header(s) not resolved", output)
+        self.assertIn("  - " + os.path.join(self.temp_dir, 'generated.h'), output)
+
+    def test_configs_command(self):
+        """Test that enumerated configurations skip those reaching an #error."""
+        config_h = os.path.join(os.path.dirname(__file__), '..', 'samples', 'config.h')
+        output_path = os.path.join(self.temp_dir, 'configs.json')
+        exit_code, output = self.run_cli(['configs', config_h, '--limit', '5000', '--output', output_path])
+
+        self.assertEqual(exit_code, 0)
+        self.assertIn("1 #error constraint(s)", output)
+        with open(output_path) as f:
+            data = json.load(f)
+        self.assertEqual(len(data["configurations"]), 2 ** len(data["symbols"]) * 3 // 4)
+        self.assertFalse(any({"DEBUG", "RELEASE"} <= set(c["defines"]) for c in data["configurations"]))
+
+    def test_configs_build_log(self):
+        """Test checking the configurations a build log uses against #error constraints."""
+        samples = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', 'samples'))
+        log_path = os.path.join(self.temp_dir, 'build.log')
+        with open(log_path, 'w') as f:
+            f.write(f"[1/2] g++ -DDEBUG -DRELEASE -c {samples}/main.cpp -o main.o\n")
+            f.write(f"[2/2] g++ -DLINUX -c {samples}/network.cpp -o network.o\n")
+        exit_code, output = self.run_cli(['configs', os.path.join(samples, 'config.h'), '--build-log', log_path])
+
+        self.assertEqual(exit_code, 1)
+        self.assertIn("2 configuration(s) built", output)
+        self.assertIn("build-1: -DDEBUG -DRELEASE (reaches #error at", output)
+        self.assertIn("build-2: -DLINUX\n", output)
+
+    def test_cnf_command(self):
+        """Test exporting the sample configuration header as DIMACS CNF."""
+        config_h = os.path.join(os.path.dirname(__file__), '..', 'samples', 'config.h')
+        output_path = os.path.join(self.temp_dir, 'model.cnf')
+        map_path = os.path.join(self.temp_dir, 'variables.json')
+        exit_code, output = self.run_cli(['cnf', config_h, '--output', output_path,
+                                          '--variable-map', map_path])
+
+        self.assertEqual(exit_code, 0)
+        with open(map_path) as f:
+            variables = json.load(f)
+        with open(output_path) as f:
+            lines = f.read().splitlines()
+        header = next(line for line in lines if line.startswith("p cnf"))
+        self.assertIn(f"c {variables['DEBUG']} DEBUG", lines)
+        # ENABLE_NETWORKING implies MAX_CONNECTIONS is defined
+        self.assertIn(f"-{variables['ENABLE_NETWORKING']} {variables['MAX_CONNECTIONS']} 0", lines)
+        self.assertEqual(int(header.split()[3]), len(lines) - lines.index(header) - 1)
+
+    def test_values_command(self):
+        """Test the value matrix of the sample configuration header."""
+        config_h = os.path.join(os.path.dirname(__file__), '..', 'samples', 'config.h')
+        exit_code, output = self.run_cli(['values', config_h,
+                                          '--config', 'debug-win: -DDEBUG -DWINDOWS',
+                                          '--config', 'linux: -DLINUX'])
+
+        self.assertEqual(exit_code, 0)
+        lines = output.splitlines()
+        self.assertEqual(lines[1].split(), ["MACRO", "debug-win", "linux"])
+        self.assertIn(["LOG_LEVEL", "3", "1"], [line.split() for line in lines])
+        self.assertFalse(any(line.startswith("VERSION_MAJOR") for line in lines))
+
+    def test_cost_command(self):
+        """Test the active line table of the sample configuration header."""
+        config_h = os.path.join(os.path.dirname(__file__), '..', 'samples', 'config.h')
+        exit_code, output = self.run_cli(['cost', config_h,
+                                          '--config', 'debug-win: -DDEBUG -DWINDOWS',
+                                          '--config', 'linux: -DLINUX'])
+
+        self.assertEqual(exit_code, 0)
+        lines = output.splitlines()
+        self.assertEqual(lines[0].split(), ["TRANSLATION", "UNIT", "debug-win", "lines",
+                                            "debug-win", "bytes", "linux", "lines", "linux", "bytes"])
+        self.assertTrue(lines[-1].startswith("TOTAL"))
+        total_lines = [int(cell.split('/')[1]) for cell in lines[-1].split()[1::2]]
+        active_lines = [int(cell.split('/')[0]) for cell in lines[-1].split()[1::2]]
+        self.assertEqual(total_lines[0], total_lines[1])
+        self.assertTrue(all(active < total for active, total in zip(active_lines, total_lines)))
+
+    def test_coverage_command(self):
+        """Test reporting a branch gcov never saw executed."""
+        with open(os.path.join(self.temp_dir, 'flags.cpp'), 'w') as f:
+            f.write("#ifdef FAST\nint fast;\n#else\nint slow;\n#endif\n")
+        gcov_dir = os.path.join(self.temp_dir, 'coverage')
+        os.makedirs(gcov_dir)
+        with open(os.path.join(gcov_dir, 'flags.cpp.gcov'), 'w') as f:
+            f.write("        -:    0:Source:../flags.cpp\n"
+                    "        -:    2:int fast;\n"
+                    "    #####:    4:int slow;\n")
+        exit_code, output = self.run_cli(['coverage', self.temp_dir])
+
+        self.assertEqual(exit_code, 0)
+        self.assertIn("1 .gcov file(s), 1 source file(s)", output)
+        self.assertIn("  !FAST: 1 line(s) in 1 file(s), first at", output)
+
+    def test_search_command(self):
+        """Test searching a search table and saved results indexed on the fly."""
+        with open(os.path.join(self.temp_dir, 'tls.cpp'), 'w') as f:
+            f.write("#if defined HAVE_OPENSSL && OPENSSL_VERSION >= 3\n#define TLS \"openssl\"\n#endif\n")
+        plain = os.path.join(self.temp_dir, 'plain.json')
+        indexed = os.path.join(self.temp_dir, 'search.idx')
+        self.assertEqual(self.run_cli(['analyze', self.temp_dir, '-o', plain])[0], 0)
+        self.assertEqual(self.run_cli(['analyze', self.temp_dir, '--search-index', indexed])[0], 0)
+
+        for input_path in (plain, indexed):
+            exit_code, output = self.run_cli(['search', input_path, 'openssl', '-i'])
+            self.assertEqual(exit_code, 0)
+            self.assertIn(":1: #if OPENSSL_VERSION >= 3 && defined(HAVE_OPENSSL)", output)
+            self.assertIn(':2: #define TLS "openssl"', output)
+            self.assertIn("2 match(es)", output)
+        exit_code, output = self.run_cli(['search', indexed, r'VERSION >= \d', '--regex', '--defines'])
+        self.assertEqual(exit_code, 1)
+        self.assertIn("0 match(es)", output)
+
+    def test_query_command(self):
+        """Test querying saved results by context implication."""
+        with open(os.path.join(self.temp_dir, 'log.cpp'), 'w') as f:
+            f.write("#ifdef ENABLE_LOGGING\n#ifndef WINDOWS\n#define LOG_SINK 1\n#endif\n"
+                    "#define LOG_ALL 2\n#endif\n")
+        output_file = os.path.join(self.temp_dir, 'analysis.json')
+        self.assertEqual(self.run_cli(['analyze', self.temp_dir, '-o', output_file])[0], 0)
+
+        exit_code, output = self.run_cli(['query', output_file,
+                                          'defines where context implies ENABLE_LOGGING and not WINDOWS'])
+        self.assertEqual(exit_code, 0)
+        self.assertIn("log.cpp:3: #define LOG_SINK 1 [ENABLE_LOGGING && !WINDOWS]", output)
+        self.assertIn("1 match(es) among 2 defines; 2 distinct context(s)", output)
+        exit_code, output = self.run_cli(['query', output_file, 'defines where context was'])
+        self.assertEqual(exit_code, 1)
+        self.assertIn("Query failed:", output)
+
+    def test_lookup_command(self):
+        """Test looking up macros in a symbol table written by analyze."""
+        with open(os.path.join(self.temp_dir, 'log.h'), 'w') as f:
+            f.write("#ifdef DEBUG\n#define LOG_LEVEL 3\n#endif\n#undef LOG_LEVEL\n")
+        table = os.path.join(self.temp_dir, 'symbols.tab')
+        self.assertEqual(self.run_cli(['analyze', self.temp_dir, '--include-headers',
+                                       '--symbol-table', table])[0], 0)
+
+        exit_code, output = self.run_cli(['lookup', table, 'LOG_LEVEL'])
+        self.assertEqual(exit_code, 0)
+        self.assertIn("log.h:2: #define LOG_LEVEL 3 [DEBUG]", output)
+        self.assertIn("log.h:4: #undef LOG_LEVEL", output)
+        exit_code, output = self.run_cli(['lookup', table, 'LOG_LEVEL', 'MISSING'])
+        self.assertEqual(exit_code, 1)
+        self.assertIn("MISSING: not defined", output)
+
+    def test_timeline_command(self):
+        """Test listing a macro's events and querying its state at a line."""
+        with open(os.path.join(self.temp_dir, 'logger.h'), 'w') as f:
+            f.write("#ifdef DEBUG\n#define LOG_BUFFER_SIZE 64\n#else\n#define LOG_BUFFER_SIZE 32\n#endif\n"
+                    "int a;\n#undef LOG_BUFFER_SIZE\nint b;\n")
+        output_file = os.path.join(self.temp_dir, 'analysis.json')
+        self.assertEqual(self.run_cli(['analyze', self.temp_dir, '--include-headers', '-o', output_file])[0], 0)
+
+        exit_code, output = self.run_cli(['timeline', output_file, 'LOG_BUFFER_SIZE'])
+        self.assertEqual(exit_code, 0)
+        self.assertIn("logger.h:2: #define LOG_BUFFER_SIZE 64 [DEBUG]", output)
+        self.assertIn("logger.h:7: #undef LOG_BUFFER_SIZE", output)
+        exit_code, output = self.run_cli(['timeline', output_file, 'LOG_BUFFER_SIZE', '--at', 'logger.h:6'])
+        self.assertEqual(exit_code, 0)
+        self.assertIn("defined or not depending on the configuration", output)
+        exit_code, output = self.run_cli(['timeline', output_file, 'LOG_BUFFER_SIZE', '--at', 'logger.h:8'])
+        self.assertIn(": undefined", output)
+        self.assertEqual(self.run_cli(['timeline', output_file, 'MISSING'])[0], 1)
+
+    def test_mentions_command(self):
+        """Test finding files through saved Bloom filters, with code lines scanned."""
+        with open(os.path.join(self.temp_dir, 'ssl.cpp'), 'w') as f:
+            f.write("#ifdef USE_SSL\n#define TLS 1\n#endif\nint x = HELPER;\n")
+        with open(os.path.join(self.temp_dir, 'other.cpp'), 'w') as f:
+            f.write("#define OTHER 2\n")
+        output_file = os.path.join(self.temp_dir, 'analysis.json')
+        filters = os.path.join(self.temp_dir, 'filters.bin')
+        self.assertEqual(self.run_cli(['analyze', self.temp_dir, '-o', output_file, '--bloom-filters', filters,
+                                       '--bloom-rate', '0.001', '--scan-code'])[0], 0)
+
+        exit_code, output = self.run_cli(['mentions', filters, 'USE_SSL', 'HELPER'])
+        self.assertEqual(exit_code, 0)
+        self.assertIn("ssl.cpp", output)
+        self.assertIn("1 file(s) mention USE_SSL and HELPER", output)
+        for input_path in (filters, output_file):
+            exit_code, output = self.run_cli(['mentions', input_path, 'TLS', 'OTHER', '--any'])
+            self.assertIn("2 file(s) mention TLS or OTHER", output)
+            exit_code, output = self.run_cli(['mentions', input_path, 'MISSING'])
+            self.assertEqual(exit_code, 1)
+        exit_code, output = self.run_cli(['analyze', self.temp_dir, '--bloom-filters', filters])
+        self.assertEqual(exit_code, 1)
+        self.assertIn("--bloom-filters needs JSON results saved with --output", output)
+
+    def test_analyze_archive(self):
+        """Test analyzing the members of a compressed tarball without extracting it."""
+        import tarfile
+        archive = os.path.join(self.temp_dir, 'vendor.tar.gz')
+        with tarfile.open(archive, 'w:gz') as tar:
+            for name, text in [("lib/a.cpp", "#ifdef X\n#define A 1\n#endif\n"),
+                               ("lib/a.h", "#define H 1\n"), ("lib/test/t.cpp", "#define T 1\n")]:
+                info = tarfile.TarInfo(name)
+                info.size = len(text)
+                tar.addfile(info, io.BytesIO(text.encode('utf-8')))
+        output_file = os.path.join(self.temp_dir, 'out.json')
+
+        exit_code, _ = self.run_cli(['analyze', archive, '--include-headers', '--exclude', 'test',
+                                     '-o', output_file])
+        self.assertEqual(exit_code, 0)
+        with open(output_file) as f:
+            data = json.load(f)
+        self.assertEqual(sorted(data['file_results']), [f"{archive}/lib/a.cpp", f"{archive}/lib/a.h"])
+        self.assertEqual(data['file_results'][f"{archive}/lib/a.cpp"]['defines'][0]['context'], ['X'])
+
+    def test_analyze_malformed_literal(self):
+        """Test that a file with an invalid octal literal is still analyzed with the rest."""
+        with open(os.path.join(self.temp_dir, 'octal.cpp'), 'w') as f:
+            f.write("#if X == 08\n#define A 1\n#endif\n")
+        with open(os.path.join(self.temp_dir, 'plain.cpp'), 'w') as f:
+            f.write("#define B 1\n")
+        output_file = os.path.join(self.temp_dir, 'octal.json')
+
+        exit_code, _ = self.run_cli(['analyze', self.temp_dir, '-o', output_file])
+        self.assertEqual(exit_code, 0)
+        with open(output_file) as f:
+            data = json.load(f)
+        self.assertEqual(sorted(os.path.basename(p) for p in data['file_results']), ['octal.cpp', 'plain.cpp'])
+
+    def test_analyze_reduction_failure_skips_file(self):
+        """Test that a file failing to merge into the results does not abort the run."""
+        with open(os.path.join(self.temp_dir, 'bad.cpp'), 'w') as f:
+            f.write("#if BROKEN\n#endif\n")
+        with open(os.path.join(self.temp_dir, 'good.cpp'), 'w') as f:
+            f.write("#if GOOD\n#define G 1\n#endif\n")
+        output_file = os.path.join(self.temp_dir, 'partial.json')
+
+        from src import condition_normalizer
+        original = condition_normalizer.condition_atoms
+
+        def condition_atoms(condition):
+            if "BROKEN" in condition:
+                raise RuntimeError("cannot canonicalize")
+            return original(condition)
+
+        with mock.patch.object(condition_normalizer, 'condition_atoms', condition_atoms):
+            exit_code, output = self.run_cli(['analyze', self.temp_dir, '-o', output_file])
+
+        self.assertEqual(exit_code, 0)
+        self.assertIn("Failed to process", output)
+        with open(output_file) as f:
+            data = json.load(f)
+        self.assertEqual([os.path.basename(p) for p in data['file_results']], ['good.cpp'])
+        self.assertEqual(data['total_files'], 1)
+
+    def test_analyze_jobs(self):
+        """Test that analyzing on worker threads saves the same results."""
+        for i in range(12):
+            with open(os.path.join(self.temp_dir, f'job{i}.cpp'), 'w') as f:
+                f.write(f"#ifdef J{i}\n#define V{i} {i}\n#endif\n")
+        outputs = []
+        for jobs in ('1', '4'):
+            output_file = os.path.join(self.temp_dir, f'jobs{jobs}.json')
+            with mock.patch('src.api.free_threading_enabled', return_value=True):
+                self.assertEqual(self.run_cli(['analyze', self.temp_dir, '-j', jobs, '-o', output_file])[0], 0)
+            with open(output_file) as f:
+                outputs.append(json.load(f)['file_results'])
+
+        self.assertEqual(list(outputs[1]), list(outputs[0]))
+        self.assertEqual(outputs[1], outputs[0])
+
+    def test_analyze_git_revision(self):
+        """Test analyzing a directory as of a git revision."""
+        from tests.test_git_history import commit_files, git
+        git(self.temp_dir, "init", "-q")
+        commit_files(self.temp_dir, "First", {"a.cpp": "#define OLD 1\n"})
+        commit_files(self.temp_dir, "Second", {"a.cpp": "#define NEW 1\n"})
+        output_file = os.path.join(self.temp_dir, 'out.json')
+
+        self.assertEqual(self.run_cli(['analyze', self.temp_dir, '--rev', 'HEAD~1', '-o', output_file])[0], 0)
+        with open(output_file) as f:
+            defines = json.load(f)['file_results'][os.path.join(self.temp_dir, 'a.cpp')]['defines']
+        self.assertEqual([d['symbol_name'] for d in defines], ['OLD'])
+        self.assertEqual(self.run_cli(['analyze', self.temp_dir, '--rev', 'missing'])[0], 1)
+
+    def test_history_command(self):
+        """Test printing a metrics time series over git commits."""
+        from tests.test_git_history import commit_files, git
+        git(self.temp_dir, "init", "-q")
+        commit_files(self.temp_dir, "First", {"a.cpp": "#ifdef A\n#endif\n"})
+        commit_files(self.temp_dir, "Second", {"b.cpp": "#if B > 1\n#ifdef C\n#endif\n#endif\n"})
+
+        exit_code, output = self.run_cli(['history', self.temp_dir])
+        self.assertEqual(exit_code, 0)
+        lines = output.splitlines()
+        self.assertEqual(lines[0].split()[:4], ["COMMIT", "TIMESTAMP", "FILES", "DIRECTIVES"])
+        self.assertEqual(lines[2].split()[2:], ["2", "6", "3", "3", "2", "0", "1"])
+        self.assertIn("2 commit(s) measured; 2 blob(s) parsed", output)
+
+        output_file = os.path.join(self.temp_dir, 'history.json')
+        self.assertEqual(self.run_cli(['history', self.temp_dir, '-n', '1', '-o', output_file])[0], 0)
+        with open(output_file) as f:
+            self.assertEqual([point["subject"] for point in json.load(f)], ["Second"])
+        self.assertEqual(self.run_cli(['history', self.temp_dir, '--rev', 'missing'])[0], 1)
+
+    def test_missing_command_prints_help(self):
+        """Test that running without a command prints help."""
+        exit_code, output = self.run_cli([])
+
+        self.assertEqual(exit_code, 1)
+        self.assertIn("validate", output)
+
+
+if __name__ == '__main__':
+    unittest.main()
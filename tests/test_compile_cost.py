@@ -0,0 +1,95 @@
+"""
+Unit tests for the compile cost module.
+Tests active line and byte counts per file and their aggregation over the
+headers a translation unit includes.
+"""
+
+import unittest
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.compile_cost import CompileCostEstimator
+from src.data_models import Configuration
+from tests.source_tree import SourceTreeTestCase
+
+
+FILES = {
+    "common.h": "#pragma once\nint common;\n",
+    "platform.h": """#ifndef PLATFORM_H
+#define PLATFORM_H
+#include "common.h"
+#ifdef WINDOWS
+int windows_a;
+int windows_b;
+#else
+int posix;
+#endif
+#endif
+""",
+    "tu.cpp": '#include "platform.h"\n#include "common.h"\n#include "platform.h"\nint main;\n',
+}
+
+
+class TestCompileCostEstimator(SourceTreeTestCase):
+    """Test cases for the CompileCostEstimator class."""
+
+    FILES = FILES
+
+    def setUp(self):
+        """Set up a small source tree."""
+        super().setUp()
+        self.source = os.path.join(self.root, "tu.cpp")
+        self.estimator = CompileCostEstimator()
+
+    def size(self, name):
+        return len(FILES[name].encode())
+
+    def test_line_offsets(self):
+        """Test line start offsets end with the file size."""
+        offsets = self.estimator.line_offsets(os.path.join(self.root, "common.h"))
+        self.assertEqual(offsets, [0, 13, 25])
+        self.assertEqual(self.estimator.line_offsets(os.path.join(self.root, "missing.h")), [0])
+
+    def test_estimate_default(self):
+        """Test skipped branches are subtracted and every file entered is counted."""
+        cost = self.estimator.estimate(self.source)
+
+        # tu.cpp, platform.h and common.h; guarded headers are entered once
+        self.assertEqual(cost.files, 3)
+        self.assertEqual(cost.lines, 4 + 10 + 2)
+        self.assertEqual(cost.bytes, self.size("tu.cpp") + self.size("platform.h") + self.size("common.h"))
+        self.assertEqual(cost.active_lines, 4 + 8 + 2)
+        skipped = len("int windows_a;\nint windows_b;\n")
+        self.assertEqual(cost.active_bytes, cost.bytes - skipped)
+
+    def test_estimate_per_configuration(self):
+        """Test configurations select different branches."""
+        windows = self.estimator.estimate(self.source, Configuration(name="win", defines={"WINDOWS": "1"}))
+        posix = self.estimator.estimate(self.source, Configuration(name="posix"))
+
+        self.assertEqual(windows.configuration, "win")
+        self.assertEqual(windows.lines, posix.lines)
+        self.assertEqual(windows.files, 3)
+        self.assertEqual(windows.active_lines, posix.active_lines + 1)
+        self.assertEqual(windows.active_bytes - posix.active_bytes,
+                         len("int windows_a;\nint windows_b;\n") - len("int posix;\n"))
+
+    def test_matrix_totals(self):
+        """Test the matrix has a column per configuration and totals per column."""
+        header = os.path.join(self.root, "common.h")
+        configurations = [Configuration(name="a"), Configuration(name="b", defines={"WINDOWS": "1"})]
+        matrix = self.estimator.matrix([(self.source, configurations), (header, configurations)])
+
+        self.assertEqual(matrix.configurations, ["a", "b"])
+        self.assertEqual(sorted(matrix.rows), sorted([self.source, header]))
+        totals = matrix.totals()
+        self.assertEqual(totals[0].active_lines,
+                         matrix.rows[self.source][0].active_lines + matrix.rows[header][0].active_lines)
+        self.assertEqual(matrix.to_dict()["totals"][1]["configuration"], "b")
+
+
+if __name__ == '__main__':
+    unittest.main()
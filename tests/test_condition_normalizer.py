@@ -0,0 +1,82 @@
+"""
+Unit tests for the condition normalizer module.
+Tests canonical forms of equivalent conditions, atoms, and canonical usage
+statistics in AnalysisResult.
+"""
+
+import unittest
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.condition_normalizer import condition_atoms, directive_condition, normalize_condition
+from src.data_models import AnalysisResult, Directive, DirectiveType, FileAnalysisResult
+
+
+class TestConditionNormalizer(unittest.TestCase):
+    """Test cases for condition canonicalization."""
+
+    def test_defined_forms(self):
+        """Test every spelling of a defined() test is the same."""
+        for text in ("defined(DEBUG)", "defined DEBUG", "  defined( DEBUG )", "(defined(DEBUG))",
+                     "defined(DEBUG) /* debug builds */"):
+            self.assertEqual(normalize_condition(text), "defined(DEBUG)")
+
+    def test_commutative_operands(self):
+        """Test operands of commutative operators are sorted and regrouped."""
+        self.assertEqual(normalize_condition("defined(B) && defined(A)"),
+                         normalize_condition("defined A&&defined B"))
+        self.assertEqual(normalize_condition("C || (B || A)"), "A || B || C")
+        self.assertEqual(normalize_condition("VERSION == 2"), normalize_condition("2 == VERSION"))
+        self.assertEqual(normalize_condition("A && A && B"), "A && B")
+        self.assertEqual(normalize_condition("C && (B || A)"), "(A || B) && C")
+
+    def test_order_sensitive_operators(self):
+        """Test operators whose operand order matters are left alone."""
+        self.assertNotEqual(normalize_condition("A - B"), normalize_condition("B - A"))
+        self.assertEqual(normalize_condition("LEVEL  >  1"), "LEVEL > 1")
+
+    def test_unparsable(self):
+        """Test conditions that cannot be parsed keep their text, whitespace collapsed."""
+        self.assertEqual(normalize_condition("A  &&  (B"), "A && (B")
+        self.assertEqual(condition_atoms("A  &&  (B"), ("A && (B",))
+
+    def test_atoms(self):
+        """Test atoms are what the logical operators combine."""
+        self.assertEqual(condition_atoms("!defined(A) && (LEVEL > 1 || defined B)"),
+                         ("LEVEL > 1", "defined(A)", "defined(B)"))
+
+    def test_directive_condition(self):
+        """Test #ifdef and #ifndef map onto defined() tests."""
+        ifdef = Directive(DirectiveType.IFDEF, "#ifdef DEBUG", 1, "a.h", condition="DEBUG", symbol_name="DEBUG")
+        ifndef = Directive(DirectiveType.IFNDEF, "#ifndef DEBUG", 2, "a.h", condition="!DEBUG", symbol_name="DEBUG")
+        include = Directive(DirectiveType.INCLUDE, '#include "b.h"', 3, "a.h", condition="b.h")
+
+        self.assertEqual(directive_condition(ifdef), "defined(DEBUG)")
+        self.assertEqual(directive_condition(ifndef), "!defined(DEBUG)")
+        self.assertIsNone(directive_condition(include))
+
+    def test_analysis_usage(self):
+        """Test usage statistics count canonical conditions and atoms."""
+        result = FileAnalysisResult(file_path="a.h")
+        result.add_directive(Directive(DirectiveType.IFDEF, "#ifdef DEBUG", 1, "a.h",
+                                       condition="DEBUG", symbol_name="DEBUG"))
+        result.add_directive(Directive(DirectiveType.IF, "#if defined DEBUG", 3, "a.h",
+                                       condition="defined DEBUG"))
+        result.add_directive(Directive(DirectiveType.IF, "#if  defined( DEBUG ) && X", 5, "a.h",
+                                       condition=" defined( DEBUG ) && X"))
+        result.add_directive(Directive(DirectiveType.IFNDEF, "#ifndef DEBUG", 7, "a.h",
+                                       condition="!DEBUG", symbol_name="DEBUG"))
+        analysis = AnalysisResult()
+        analysis.add_file_result(result)
+
+        self.assertEqual(analysis.conditions_usage,
+                         {"defined(DEBUG)": 2, "X && defined(DEBUG)": 1, "!defined(DEBUG)": 1})
+        self.assertEqual(analysis.atoms_usage, {"defined(DEBUG)": 4, "X": 1})
+        self.assertIn("atoms_usage", analysis.to_dict())
+
+
+if __name__ == '__main__':
+    unittest.main()
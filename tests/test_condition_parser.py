@@ -0,0 +1,92 @@
+"""
+Unit tests for the condition parser module.
+Tests tokenizing, parsing and evaluating #if expressions.
+"""
+
+import unittest
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.condition_parser import (
+    parse_condition, evaluate_condition, referenced_symbols, format_condition,
+    ConditionSyntaxError, Binary, Defined, Identifier, Number, Unary, Call
+)
+
+
+class TestConditionParser(unittest.TestCase):
+    """Test cases for condition parsing and evaluation."""
+
+    def test_parse_defined_forms(self):
+        """Test that all spellings of defined parse to the same node."""
+        for text in ("defined(DEBUG)", "defined DEBUG", "defined ( DEBUG )"):
+            self.assertEqual(parse_condition(text), Defined("DEBUG"))
+
+    def test_operator_precedence(self):
+        """Test that && binds tighter than || and comparisons tighter than &&."""
+        node = parse_condition("A || B && C > 2")
+        self.assertEqual(node, Binary('||', Identifier('A'),
+                                      Binary('&&', Identifier('B'),
+                                             Binary('>', Identifier('C'), Number(2)))))
+
+    def test_literals(self):
+        """Test integer and character literals with suffixes."""
+        self.assertEqual(parse_condition("0x1FUL"), Number(31))
+        self.assertEqual(parse_condition("010"), Number(8))
+        self.assertEqual(parse_condition("'A'"), Number(65))
+
+    def test_function_like_call(self):
+        """Test that unknown function-like macros parse as calls."""
+        self.assertEqual(parse_condition("__has_include(<vector>)"),
+                         Call("__has_include", ("< vector >",)))
+
+    def test_syntax_errors(self):
+        """Test that malformed expressions raise ConditionSyntaxError."""
+        for text in ("", "A &&", "(A", "A B", "defined()", "X == 08", "0x", "0b2"):
+            with self.assertRaises(ConditionSyntaxError):
+                parse_condition(text)
+
+    def test_evaluate(self):
+        """Test evaluating conditions against a macro table."""
+        macros = {"DEBUG": "", "LEVEL": "(1 + 2)", "ALIAS": "LEVEL"}
+
+        self.assertTrue(evaluate_condition("defined(DEBUG) && !defined(RELEASE)", macros))
+        self.assertTrue(evaluate_condition("ALIAS >= 3", macros))
+        self.assertFalse(evaluate_condition("UNDEFINED_SYMBOL", macros))
+        self.assertTrue(evaluate_condition("LEVEL == 3 ? 1 : 0", macros))
+        self.assertFalse(evaluate_condition("1 / 0", macros))
+        self.assertIsNone(evaluate_condition("A &&", macros))
+
+    def test_division_truncates_exactly(self):
+        """Test that / and % truncate toward zero and stay exact beyond 2**53."""
+        self.assertTrue(evaluate_condition("BIG / 1 == 9007199254740993 && BIG % 10 == 3",
+                                           {"BIG": "9007199254740993"}))
+        self.assertTrue(evaluate_condition("-7 / 2 == -3 && -7 % 2 == -1 && 7 % -2 == 1", {}))
+
+    def test_self_referential_macro(self):
+        """Test that recursive macro definitions terminate."""
+        self.assertFalse(evaluate_condition("LOOP", {"LOOP": "LOOP + 0"}))
+
+    def test_referenced_symbols(self):
+        """Test collecting referenced macro names."""
+        node = parse_condition("defined(A) && (B > 2 || !C)")
+        self.assertEqual(referenced_symbols(node), {"A", "B", "C"})
+
+    def test_format_condition(self):
+        """Test formatting trees back to text with only the needed parentheses."""
+        cases = {
+            "((defined A)) && (B > 2 || !C)": "defined(A) && (B > 2 || !C)",
+            "a - (b - c)": "a - (b - c)",
+            "(a ? b : c) + 1": "(a ? b : c) + 1",
+            "- -x": "- -x",
+        }
+        for text, expected in cases.items():
+            formatted = format_condition(parse_condition(text))
+            self.assertEqual(formatted, expected)
+            self.assertEqual(parse_condition(formatted), parse_condition(text))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,96 @@
+"""
+Unit tests for the configuration evaluator module.
+Tests branch selection, skipped ranges and macro tracking.
+"""
+
+import unittest
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.configuration_evaluator import ConfigurationEvaluator, split_define
+from src.preprocessor_parser import PreprocessorParser
+from src.data_models import Configuration
+
+
+SOURCE = """#ifndef CONFIG_H
+#define CONFIG_H
+#ifdef WINDOWS
+    #define PLATFORM 1
+#elif defined(LINUX)
+    #define PLATFORM 2
+#else
+    #define PLATFORM 0
+#endif
+#if PLATFORM == 2 && LEVEL > 1
+    #define VERBOSE
+#endif
+#endif
+"""
+
+
+class TestConfigurationEvaluator(unittest.TestCase):
+    """Test cases for the ConfigurationEvaluator class."""
+
+    def setUp(self):
+        """Set up test fixtures."""
+        self.evaluator = ConfigurationEvaluator()
+        self.file_result = PreprocessorParser().parse_buffer(SOURCE, "config.h")
+
+    def evaluate(self, configuration):
+        return self.evaluator.evaluate(
+            self.file_result.directives, configuration, self.file_result.line_count
+        )
+
+    def test_default_configuration(self):
+        """Test that the #else branch is taken when nothing is defined."""
+        result = self.evaluate(Configuration())
+
+        self.assertEqual(result.macros["PLATFORM"], "0")
+        self.assertNotIn("VERBOSE", result.macros)
+        self.assertEqual(result.inactive_ranges, [(4, 4), (6, 6), (11, 11)])
+
+    def test_elif_branch_and_values(self):
+        """Test #elif selection and macro values feeding later conditions."""
+        result = self.evaluate(Configuration.from_flags(["LINUX", "LEVEL=2"]))
+
+        self.assertEqual(result.macros["PLATFORM"], "2")
+        self.assertIn("VERBOSE", result.macros)
+        self.assertTrue(result.is_line_active(6))
+        self.assertFalse(result.is_line_active(8))
+
+    def test_include_guard_already_defined(self):
+        """Test that a predefined guard skips the whole file body."""
+        result = self.evaluate({"CONFIG_H": ""})
+
+        self.assertEqual(result.inactive_ranges, [(2, 12)])
+        self.assertEqual(result.inactive_line_count(), 11)
+
+    def test_reached_errors_recorded(self):
+        """Test that only #error directives in active branches are reported."""
+        file_result = PreprocessorParser().parse_buffer(
+            '#if defined(DEBUG) && defined(RELEASE)\n#error "both"\n#endif\n', "build.h")
+
+        reached = self.evaluator.evaluate(file_result.directives, Configuration.from_flags(["DEBUG", "RELEASE"]))
+        clean = self.evaluator.evaluate(file_result.directives, Configuration.from_flags(["DEBUG"]))
+
+        self.assertEqual([d.line_number for d in reached.errors], [2])
+        self.assertEqual(clean.errors, [])
+
+    def test_undefs_applied_after_defines(self):
+        """Test that -U removes a macro given with -D."""
+        configuration = Configuration.from_flags(["WINDOWS"], ["WINDOWS"])
+        self.assertEqual(configuration.initial_macros(), {})
+
+    def test_split_define(self):
+        """Test splitting define content into name, parameters and value."""
+        self.assertEqual(split_define("#define MAX(a, b) ((a) > (b)) // max"),
+                         ("MAX", "(a, b)", "((a) > (b))"))
+        self.assertEqual(split_define("#define EMPTY"), ("EMPTY", None, ""))
+        self.assertEqual(split_define("#define SIZE /* bytes */ 64"), ("SIZE", None, "64"))
+
+
+if __name__ == '__main__':
+    unittest.main()
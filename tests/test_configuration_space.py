@@ -0,0 +1,105 @@
+"""
+Unit tests for the configuration space module.
+Tests #error constraint extraction, pruned enumeration and sampling.
+"""
+
+import unittest
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.configuration_space import ConfigurationSpace, extract_constraints
+from src.preprocessor_parser import PreprocessorParser
+from src.data_models import Configuration
+
+
+SOURCE = """#ifndef BUILD_H
+#define BUILD_H
+#if defined(DEBUG) && defined(RELEASE)
+#error "Cannot define both DEBUG and RELEASE"
+#endif
+#ifdef WINDOWS
+#define PLATFORM 1
+#elif defined(LINUX)
+#define PLATFORM 2
+#else
+#error "Unsupported platform"
+#endif
+#ifdef FAST
+#warning "FAST is experimental"
+#endif
+#endif
+"""
+
+
+class TestConfigurationSpace(unittest.TestCase):
+    """Test cases for constraint extraction and the ConfigurationSpace class."""
+
+    def setUp(self):
+        """Set up test fixtures."""
+        self.file_result = PreprocessorParser().parse_buffer(SOURCE, "build.h")
+        self.space = ConfigurationSpace.from_file_results([self.file_result])
+
+    def test_extract_constraints(self):
+        """Test path conditions of #error directives, without the include guard."""
+        constraints = extract_constraints(self.file_result.directives)
+
+        self.assertEqual([c.line_number for c in constraints], [4, 11])
+        self.assertEqual(constraints[0].condition, "(defined(DEBUG) && defined(RELEASE))")
+        self.assertEqual(constraints[0].message, '"Cannot define both DEBUG and RELEASE"')
+        self.assertEqual(constraints[1].condition, "!(defined(WINDOWS)) && !(defined(LINUX))")
+        self.assertEqual(constraints[1].symbols, ["LINUX", "WINDOWS"])
+
+    def test_feature_symbols_exclude_guard(self):
+        """Test that every conditional symbol but the include guard is a feature."""
+        self.assertEqual(self.space.symbols, ["DEBUG", "FAST", "LINUX", "RELEASE", "WINDOWS"])
+
+    def test_enumerate_prunes_error_configurations(self):
+        """Test that enumeration yields exactly the configurations reaching no #error."""
+        configurations = list(self.space.enumerate())
+
+        # 32 combinations; 8 have DEBUG and RELEASE, 8 have no platform, 2 have both
+        self.assertEqual(len(configurations), 32 - 8 - 8 + 2)
+        self.assertTrue(all(self.space.is_valid(c) for c in configurations))
+        self.assertEqual(len({c.name for c in configurations}), len(configurations))
+        self.assertEqual(configurations[0].name, "WINDOWS")
+
+    def test_enumerate_limit_and_base(self):
+        """Test the limit and that base defines are fixed rather than enumerated."""
+        space = ConfigurationSpace.from_file_results(
+            [self.file_result], Configuration.from_flags(["WINDOWS"], ["DEBUG"]))
+
+        self.assertEqual(space.symbols, ["FAST", "LINUX", "RELEASE"])
+        self.assertEqual(len(list(space.enumerate())), 8)
+        self.assertEqual(len(list(space.enumerate(limit=3))), 3)
+        self.assertTrue(all(c.defines["WINDOWS"] == "1" for c in space.enumerate()))
+
+    def test_sample_is_valid_distinct_and_reproducible(self):
+        """Test that samples respect constraints and depend only on the seed."""
+        first = self.space.sample(6, seed=7)
+        second = self.space.sample(6, seed=7)
+
+        self.assertEqual(len(first), 6)
+        self.assertEqual([c.name for c in first], [c.name for c in second])
+        self.assertEqual(len({c.name for c in first}), 6)
+        self.assertTrue(all(self.space.is_valid(c) for c in first))
+
+    def test_unconditional_error_empties_space(self):
+        """Test that an #error outside any conditional forbids every configuration."""
+        file_result = PreprocessorParser().parse_buffer("#ifdef A\n#endif\n#error stop\n", "stop.h")
+        space = ConfigurationSpace.from_file_results([file_result])
+
+        self.assertEqual(list(space.enumerate()), [])
+        self.assertEqual(space.sample(3, seed=1), [])
+
+    def test_violations(self):
+        """Test reporting the constraints a configuration violates."""
+        violations = self.space.violations(Configuration.from_flags(["DEBUG", "RELEASE"]))
+
+        self.assertEqual([c.line_number for c in violations], [4, 11])
+
+
+if __name__ == '__main__':
+    unittest.main()
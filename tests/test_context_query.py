@@ -0,0 +1,127 @@
+"""
+Unit tests for the context query module.
+Tests query parsing, truth-table implication and satisfiability, and that
+semantic predicates are evaluated once per distinct context.
+"""
+
+import unittest
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.api import Analyzer
+from src.condition_parser import parse_condition
+from src.context_query import (
+    MAX_ATOMS, ContextSemantics, QuerySyntaxError, parse_query, run_query
+)
+
+
+SOURCE = """#ifdef ENABLE_LOGGING
+#ifndef WINDOWS
+#define LOG_SINK 1
+#endif
+#define LOG_ALL 2
+#endif
+#if defined(A) && !defined(A)
+#define DEAD 1
+#endif
+#if ENABLE_LOGGING && !WINDOWS && LEVEL > 2
+#define LOG_VERBOSE 1
+#endif
+#define GLOBAL 1
+"""
+
+
+class TestContextQuery(unittest.TestCase):
+    """Test cases for context queries."""
+
+    def setUp(self):
+        """Set up analyzed directives."""
+        self.directives = Analyzer().analyze_buffer(SOURCE, "log.h").directives
+
+    def select(self, text, semantics=None):
+        """Names (or contents) of the directives a query selects."""
+        result = run_query(parse_query(text), self.directives, semantics)
+        return [d.symbol_name or d.content for d in result.matches]
+
+    def test_implication(self):
+        """Test implication is semantic, not textual."""
+        self.assertEqual(self.select("defines where context implies ENABLE_LOGGING and not WINDOWS"),
+                         ["LOG_SINK", "LOG_VERBOSE"])
+        self.assertEqual(self.select("defines where context implies defined(ENABLE_LOGGING) || WINDOWS"),
+                         ["LOG_SINK", "LOG_ALL", "LOG_VERBOSE"])
+        self.assertEqual(self.select("defines where context excludes WINDOWS"), ["LOG_SINK", "LOG_VERBOSE"])
+        self.assertEqual(self.select("defines where context implies LEVEL > 2"), ["LOG_VERBOSE"])
+
+    def test_satisfiability(self):
+        """Test unreachable contexts are found and imply nothing."""
+        self.assertEqual(self.select("directives where context is unsatisfiable"),
+                         ["#if defined(A) && !defined(A)", "DEAD"])
+        self.assertNotIn("DEAD", self.select("defines where context implies A"))
+        self.assertEqual(self.select("defines where context is global"), ["GLOBAL"])
+        self.assertEqual(len(self.select("defines where context is not global")), 4)
+
+    def test_boolean_structure(self):
+        """Test where clauses combine predicates with and, or, not and parentheses."""
+        self.assertEqual(
+            self.select("defines where symbol matches '^LOG' and not (context implies LEVEL > 2 or symbol is LOG_ALL)"),
+            ["LOG_SINK"])
+        self.assertEqual(self.select("defines where file matches '*.h' and context implies WINDOWS or symbol is DEAD"),
+                         ["DEAD"])
+        self.assertEqual(self.select("conditions where context implies A"), [])
+
+    def test_elif_and_else_exclude_earlier_branches(self):
+        """Test that #elif and #else contexts carry the negation of every earlier branch."""
+        self.directives = Analyzer().analyze_buffer(
+            "#ifdef WINDOWS\n#define SEP 1\n#elif defined(LINUX) && X == 8\n#define SEP 2\n"
+            "#else\n#define SEP 3\n#endif\n", "sep.h").directives
+
+        self.assertEqual(self.directives[5].context, ["!WINDOWS && !(defined(LINUX) && X == 8)"])
+        self.assertEqual([d.line_number for d in run_query(parse_query("defines where context implies X == 8"),
+                                                           self.directives).matches], [4])
+        self.assertEqual([d.line_number for d in run_query(parse_query("defines where context excludes WINDOWS"),
+                                                           self.directives).matches], [4, 6])
+
+    def test_memoized_per_context(self):
+        """Test truth tables are computed once per distinct context, across queries."""
+        directives = []
+        for index in range(50):
+            directives.extend(Analyzer().analyze_buffer(SOURCE, f"f{index}.h").directives)
+        semantics = ContextSemantics()
+        query = parse_query("directives where context implies ENABLE_LOGGING and context is satisfiable")
+
+        result = run_query(query, directives, semantics)
+        self.assertEqual(result.directives, 50 * len(self.directives))
+        self.assertLessEqual(result.evaluations, 2 * result.contexts)
+        self.assertEqual(run_query(query, directives, semantics).evaluations, 0)
+
+    def test_undecided_contexts(self):
+        """Test contexts over too many atoms are reported, not decided."""
+        condition = " && ".join(f"defined(F{i})" for i in range(MAX_ATOMS + 1))
+        directives = Analyzer().analyze_buffer(f"#if {condition}\n#define WIDE 1\n#endif\n", "w.h").directives
+        result = run_query(parse_query("defines where context implies F0"), directives)
+
+        self.assertEqual(result.matches, [])
+        self.assertEqual(result.undecided, 1)
+        for text in ("defines where not context implies F0", "defines where not context is satisfiable",
+                     "defines where context implies F0 or not context excludes F1"):
+            self.assertEqual(run_query(parse_query(text), directives).matches, [], text)
+        self.assertEqual(len(run_query(parse_query("defines where not context implies F0 or symbol is WIDE"),
+                                       directives).matches), 1)
+        semantics = ContextSemantics()
+        context = semantics.context_id(["A && B", "!C"])
+        self.assertTrue(semantics.implies(context, parse_condition("A || C")))
+
+    def test_syntax_errors(self):
+        """Test malformed queries are rejected with a QuerySyntaxError."""
+        for text in ("things", "defines where", "defines where context implies",
+                     "defines where context is sometimes", "defines where (symbol is A",
+                     "defines where context implies (A", "defines where symbol is A B"):
+            with self.assertRaises(QuerySyntaxError, msg=text):
+                parse_query(text)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,130 @@
+"""
+Unit tests for the coverage mapping module.
+Tests gcov parsing, context intervals and grouping coverage by context.
+"""
+
+import unittest
+import tempfile
+import shutil
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.api import Analyzer
+from src.coverage_mapper import ContextIntervals, CoverageMapper, parse_gcov
+
+
+SOURCE = """int setup() { return 0; }
+#ifdef FEATURE_A
+int a() { return 1; }
+#if LEVEL > 1
+int deep() { return 2; }
+#endif
+#else
+int not_a() { return 3; }
+#endif
+int main() { return setup(); }
+"""
+
+GCOV = """        -:    0:Source:feature.cpp
+        -:    0:Graph:feature.gcno
+        1:    1:int setup() { return 0; }
+        -:    2:#ifdef FEATURE_A
+        -:    3:int a() { return 1; }
+        -:    4:#if LEVEL > 1
+        -:    5:int deep() { return 2; }
+        -:    6:#endif
+        -:    7:#else
+    #####:    8:int not_a() { return 3; }
+        -:    9:#endif
+       1*:   10:int main() { return setup(); }
+function main called 1 returned 100% blocks executed 100%
+"""
+
+GCOV_WITH_FEATURE = """        -:    0:Source:feature.cpp
+        1:    1:int setup() { return 0; }
+      2.1k:    3:int a() { return 1; }
+    =====:    5:int deep() { return 2; }
+------------------
+_Z4deepv:
+        1:    5:int deep() { return 2; }
+------------------
+    #####:   10:int main() { return setup(); }
+        -:    0:Source:missing.cpp
+        1:    1:int gone;
+"""
+
+
+class TestCoverageMapper(unittest.TestCase):
+    """Test cases for mapping gcov coverage onto contexts."""
+
+    def setUp(self):
+        """Set up a source file."""
+        self.root = tempfile.mkdtemp()
+        self.source = os.path.join(self.root, "feature.cpp")
+        with open(self.source, 'w') as f:
+            f.write(SOURCE)
+        self.mapper = CoverageMapper(Analyzer())
+
+    def tearDown(self):
+        """Clean up the source file."""
+        shutil.rmtree(self.root)
+
+    def test_parse_gcov(self):
+        """Test executable, unexecuted and non-executable lines."""
+        records = list(parse_gcov(GCOV.splitlines(True)))
+
+        self.assertEqual(records[0], ("feature.cpp", 1, True))
+        self.assertIn(("feature.cpp", 8, False), records)
+        self.assertIn(("feature.cpp", 10, True), records)
+        self.assertIn(("feature.cpp", 2, None), records)
+        self.assertEqual(len(records), 10)
+
+    def test_context_intervals(self):
+        """Test each line gets the context of the conditional before it."""
+        intervals = ContextIntervals.from_directives(Analyzer().analyze_file(self.source).directives)
+
+        self.assertEqual(intervals.context_at(1), "")
+        self.assertEqual(intervals.context_at(3), "FEATURE_A")
+        self.assertEqual(intervals.context_at(5), "FEATURE_A && LEVEL > 1")
+        self.assertEqual(intervals.context_at(8), "!FEATURE_A")
+        self.assertEqual(intervals.context_at(10), "")
+
+    def test_unexercised_contexts(self):
+        """Test contexts whose executable lines never ran are reported."""
+        self.mapper.add_gcov_lines(GCOV.splitlines(True), self.root)
+        report = self.mapper.report()
+
+        self.assertEqual(report.source_files, [self.source])
+        self.assertEqual(report.contexts[""].executable_lines, 2)
+        self.assertEqual(report.contexts[""].covered_lines, 2)
+        unexercised = report.unexercised()
+        self.assertEqual([c.context for c in unexercised], ["!FEATURE_A"])
+        self.assertEqual(unexercised[0].locations, [(self.source, 8)])
+
+    def test_merge_runs(self):
+        """Test a line is covered when any run or instantiation executed it."""
+        self.mapper.add_gcov_lines(GCOV.splitlines(True), self.root)
+        self.mapper.add_gcov_lines(GCOV_WITH_FEATURE.splitlines(True), self.root)
+        report = self.mapper.report()
+
+        self.assertEqual(report.contexts["FEATURE_A"].covered_lines, 1)
+        self.assertEqual(report.contexts["FEATURE_A && LEVEL > 1"].covered_lines, 1)
+        self.assertEqual(report.contexts[""].covered_lines, 2)
+        self.assertEqual([c.context for c in report.unexercised()], ["!FEATURE_A"])
+        self.assertEqual(report.missing_files, [os.path.join(self.root, "missing.cpp")])
+
+    def test_add_gcov_file(self):
+        """Test sources are resolved against the .gcov file's directory."""
+        gcov_path = os.path.join(self.root, "feature.cpp.gcov")
+        with open(gcov_path, 'w') as f:
+            f.write(GCOV)
+        self.mapper.add_gcov_file(gcov_path)
+
+        self.assertEqual(self.mapper.report().to_dict()["unexercised"], ["!FEATURE_A"])
+
+
+if __name__ == '__main__':
+    unittest.main()
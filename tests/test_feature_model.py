@@ -0,0 +1,120 @@
+"""
+Unit tests for the feature model module.
+Tests Tseitin encoding against brute-force evaluation, define implications,
+DIMACS output and formula growth.
+"""
+
+import itertools
+import unittest
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.feature_model import TseitinEncoder, build_feature_model
+from src.condition_parser import evaluate_condition
+from src.preprocessor_parser import PreprocessorParser
+from src.data_models import Configuration
+
+
+SOURCE = """#ifndef NET_H
+#define NET_H
+#if defined(DEBUG) && defined(RELEASE)
+#error "Cannot define both DEBUG and RELEASE"
+#endif
+#ifdef ENABLE_NETWORKING
+#define MAX_CONNECTIONS 100
+#ifndef TIMEOUT
+#define TIMEOUT 30
+#endif
+#endif
+#if defined(MAX_CONNECTIONS) && !defined(ENABLE_NETWORKING)
+#error "MAX_CONNECTIONS needs networking"
+#endif
+#endif
+"""
+
+
+def models(formula, names):
+    """Assignments of the named variables that extend to a model of the formula."""
+    found = set()
+    for values in itertools.product((False, True), repeat=formula.variable_count):
+        if all(any(values[abs(l) - 1] == (l > 0) for l in clause) for clause in formula.clauses):
+            found.add(tuple(values[formula.variables[name] - 1] for name in names))
+    return found
+
+
+class TestFeatureModel(unittest.TestCase):
+    """Test cases for the TseitinEncoder class and build_feature_model."""
+
+    def test_encoding_matches_evaluation(self):
+        """Test that required conditions have exactly the models of the expression."""
+        for condition in ["A && (B || !C)", "!(A || B) || C && A", "A ? B : C", "A && !A", "1 || A"]:
+            encoder = TseitinEncoder()
+            for name in "ABC":
+                encoder.variable(name)
+            encoder.require(condition)
+
+            expected = set()
+            for values in itertools.product((False, True), repeat=3):
+                macros = {name: "1" for name, value in zip("ABC", values) if value}
+                if evaluate_condition(condition, macros):
+                    expected.add(values)
+            self.assertEqual(models(encoder.formula, "ABC"), expected, condition)
+
+    def test_opaque_comparisons_and_shared_gates(self):
+        """Test that comparisons become named variables and equal gates are reused."""
+        encoder = TseitinEncoder()
+        encoder.require("LEVEL > 2 && defined(A)")
+        clauses = len(encoder.formula.clauses)
+        encoder.require("defined(A) && (LEVEL>2)")
+
+        self.assertIn("LEVEL > 2", encoder.formula.variables)
+        self.assertEqual(len(encoder.formula.clauses), clauses + 1)
+
+    def test_feature_model_constraints(self):
+        """Test #error and define-implication clauses over a header."""
+        file_result = PreprocessorParser().parse_buffer(SOURCE, "net.h")
+        formula = build_feature_model([file_result])
+        names = ["DEBUG", "ENABLE_NETWORKING", "MAX_CONNECTIONS", "RELEASE"]
+        found = models(formula, names)
+
+        self.assertNotIn("NET_H", formula.variables)
+        self.assertFalse(any(debug and release for debug, _, _, release in found))
+        # Networking implies MAX_CONNECTIONS, and MAX_CONNECTIONS needs networking
+        self.assertTrue(all(networking == connections for _, networking, connections, _ in found))
+        self.assertEqual(len(found), 3 * 2)
+
+    def test_base_configuration_fixes_macros(self):
+        """Test that -D/-U macros become unit clauses."""
+        file_result = PreprocessorParser().parse_buffer(SOURCE, "net.h")
+        formula = build_feature_model([file_result], Configuration.from_flags(["DEBUG"], ["ENABLE_NETWORKING"]))
+        found = models(formula, ["DEBUG", "ENABLE_NETWORKING", "RELEASE"])
+
+        self.assertEqual(found, {(True, False, False)})
+
+    def test_dimacs_output(self):
+        """Test the DIMACS header, variable map comments and clause terminators."""
+        encoder = TseitinEncoder()
+        encoder.variable("A")
+        encoder.forbid("defined(A) && defined(B)")
+        lines = encoder.formula.to_dimacs().splitlines()
+
+        self.assertEqual(lines[:3], ["c 1 A", "c 2 B", "p cnf 3 4"])
+        self.assertTrue(all(line.endswith(" 0") for line in lines[3:]))
+
+    def test_formula_linear_in_expression_size(self):
+        """Test that clause count grows linearly for wide and deep conditions."""
+        flags = [f"FLAG_{i}" for i in range(5000)]
+        encoder = TseitinEncoder()
+        encoder.forbid(" || ".join(f"(defined({a}) && !defined({b}))" for a, b in zip(flags, flags[1:])))
+        formula = encoder.formula
+
+        self.assertEqual(len(formula.variables), 5000)
+        self.assertLess(len(formula.clauses), 5 * 5000)
+        self.assertLess(formula.variable_count, 2 * 5000 + 2)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,144 @@
+"""
+Unit tests for the filter table file module.
+Tests writing per-file Bloom filters that point into saved analysis results,
+reading single files' results back, and benchmarks a filtered `mentions`
+against one that has to load the whole analysis.
+"""
+
+import unittest
+import subprocess
+import tempfile
+import shutil
+import time
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.api import Analyzer
+from src.bloom_filter import FileFilterIndex
+from src.cli import CLI
+from src.data_models import AnalysisResult, Directive, DirectiveType, FileAnalysisResult
+from src.filter_table import FilterTable, write_filter_table
+from tests.test_startup import REPO_ROOT, RUN_BENCHMARKS
+
+
+# Files and directives per file in the benchmark analysis
+BENCHMARK_FILES = 3000
+BENCHMARK_DIRECTIVES = 100
+BENCHMARK_RUNS = 3
+
+
+class TestFilterTable(unittest.TestCase):
+    """Test cases for filter table files."""
+
+    def setUp(self):
+        """Set up an analysis saved as JSON."""
+        self.temp_dir = tempfile.mkdtemp()
+        self.analysis = os.path.join(self.temp_dir, 'analysis.json')
+        self.path = os.path.join(self.temp_dir, 'filters.bin')
+        analyzer = Analyzer()
+        self.result = AnalysisResult()
+        for file_path, text in (
+            ("a.h", "#ifdef ALPHA\n#define BETA 1\n#endif\n"),
+            ("b.h", "#if GAMMA > 1\n#undef ALPHA\n#endif\n"),
+            ("c.h", "#define DELTA ALPHA\n"),
+        ):
+            self.result.add_file_result(analyzer.analyze_buffer(text, file_path))
+        self.spans = CLI()._save_results(self.result, self.analysis, "json")
+
+    def tearDown(self):
+        """Clean up test fixtures."""
+        shutil.rmtree(self.temp_dir)
+
+    def test_round_trip(self):
+        """Test a mapped table passes the same files and reads back each file's results."""
+        index = FileFilterIndex.from_analysis(self.result, 0.001)
+        self.assertEqual(write_filter_table(index, self.spans, self.analysis, self.path), 3)
+
+        with FilterTable(self.path) as table:
+            self.assertEqual(len(table), 3)
+            self.assertEqual(table.false_positive_rate, 0.001)
+            self.assertFalse(table.code_usage)
+            for symbols in (["ALPHA"], ["ALPHA", "BETA"], ["GAMMA", "DELTA"], ["MISSING"]):
+                self.assertEqual(table.candidates(symbols), index.candidates(symbols))
+            self.assertEqual(table.candidates(["BETA", "DELTA"], any_symbol=True), ["a.h", "c.h"])
+            self.assertEqual(table.file_data("b.h"), self.result.file_results["b.h"].to_dict())
+            self.assertIsNone(table.file_data("missing.h"))
+
+    def test_analysis_found_relative_to_table(self):
+        """Test a table and its analysis can be moved together."""
+        write_filter_table(FileFilterIndex.from_analysis(self.result), self.spans, self.analysis, self.path)
+        moved = os.path.join(self.temp_dir, 'moved')
+        os.makedirs(moved)
+        for path in (self.analysis, self.path):
+            os.replace(path, os.path.join(moved, os.path.basename(path)))
+
+        with FilterTable(os.path.join(moved, 'filters.bin')) as table:
+            self.assertEqual(table.file_data("c.h")["file_path"], "c.h")
+
+    def test_rewritten_analysis_refused(self):
+        """Test byte ranges are not used once the analysis was rewritten."""
+        write_filter_table(FileFilterIndex.from_analysis(self.result), self.spans, self.analysis, self.path)
+        with open(self.analysis, 'a') as f:
+            f.write("\n")
+
+        with FilterTable(self.path) as table:
+            with self.assertRaises(ValueError):
+                table.file_data("a.h")
+
+    def test_rejects_other_files(self):
+        """Test files that are not filter tables are refused."""
+        for contents in (b"", b"{\"file_results\": {}}" * 10):
+            with open(self.path, 'wb') as f:
+                f.write(contents)
+            with self.assertRaises(ValueError):
+                FilterTable(self.path)
+
+
+class TestFilterTableBenchmark(unittest.TestCase):
+    """Cold `mentions` through a filter table against loading the analysis."""
+
+    @unittest.skipUnless(RUN_BENCHMARKS, "set CPP_ANALYZER_BENCHMARKS=1 to run timed benchmarks")
+    def test_filtering_beats_scan(self):
+        """Benchmark a filtered query and a full scan over 300,000 directives."""
+        temp_dir = tempfile.mkdtemp()
+        try:
+            result = AnalysisResult()
+            for number in range(BENCHMARK_FILES):
+                file_path = f"src/module_{number}.cpp"
+                directives = [
+                    Directive(type=DirectiveType.DEFINE, content=f"#define SYM_{number}_{i} {i}",
+                              line_number=i + 1, file_path=file_path, symbol_name=f"SYM_{number}_{i}",
+                              context=[f"FEATURE_{number % 50}"])
+                    for i in range(BENCHMARK_DIRECTIVES)
+                ]
+                result.add_file_result(FileAnalysisResult(file_path=file_path, directives=directives))
+            analysis = os.path.join(temp_dir, 'analysis.json')
+            table = os.path.join(temp_dir, 'filters.bin')
+            spans = CLI()._save_results(result, analysis, "json")
+            write_filter_table(FileFilterIndex.from_analysis(result), spans, analysis, table)
+            size_mb = os.path.getsize(analysis) / 1e6
+
+            probe = f"SYM_{BENCHMARK_FILES // 2}_7"
+            timings = {}
+            for name, input_path in (("filtered", table), ("scan", analysis)):
+                command = [sys.executable, os.path.join(REPO_ROOT, 'main.py'), 'mentions', input_path, probe]
+                runs = []
+                for _ in range(BENCHMARK_RUNS):
+                    start = time.perf_counter()
+                    output = subprocess.run(command, cwd=REPO_ROOT, capture_output=True, text=True).stdout
+                    runs.append((time.perf_counter() - start) * 1000)
+                    self.assertIn("1 file(s) mention", output)
+                timings[name] = min(runs)
+        finally:
+            shutil.rmtree(temp_dir)
+
+        summary = (f"{BENCHMARK_FILES * BENCHMARK_DIRECTIVES} directives ({size_mb:.0f}MB analysis): "
+                   f"filtered {timings['filtered']:.0f}ms, full scan {timings['scan']:.0f}ms")
+        self.assertLess(timings["filtered"] * 10, timings["scan"], summary)
+
+
+if __name__ == '__main__':
+    unittest.main()
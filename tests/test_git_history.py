@@ -0,0 +1,156 @@
+"""
+Unit tests for the git history module.
+Tests reading objects through the cat-file pipe, per-commit metrics, and
+that only blobs not seen in earlier commits are parsed.
+"""
+
+import unittest
+import subprocess
+import tempfile
+import shutil
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.git_history import GitError, GitObjectReader, HistoryMiner, iter_tree_sources, parse_tree
+
+
+def git(repository, *args):
+    """Run git in a repository with a fixed identity, returning its output."""
+    return subprocess.run(
+        ["git", "-C", repository, "-c", "user.name=Test", "-c", "user.email=test@example.com",
+         "-c", "commit.gpgsign=false", *args],
+        check=True, stdout=subprocess.PIPE, stderr=subprocess.PIPE
+    ).stdout.decode('utf-8').strip()
+
+
+def commit_files(repository, message, files):
+    """Write files (None deletes one) and commit them."""
+    for name, text in files.items():
+        path = os.path.join(repository, name)
+        if text is None:
+            os.remove(path)
+            continue
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, 'w') as f:
+            f.write(text)
+    git(repository, "add", "-A")
+    git(repository, "commit", "-q", "-m", message)
+    return git(repository, "rev-parse", "HEAD")
+
+
+@unittest.skipIf(shutil.which("git") is None, "git is not installed")
+class TestGitHistory(unittest.TestCase):
+    """Test cases for HistoryMiner and GitObjectReader."""
+
+    def setUp(self):
+        """Set up test fixtures."""
+        self.repository = tempfile.mkdtemp()
+        git(self.repository, "init", "-q")
+        self.commits = [
+            commit_files(self.repository, "Add logger", {
+                "src/logger.cpp": "#ifdef LOG\n#define BUF 64\n#endif\n",
+                "include/config.h": "#if defined(A) && B > 1\n#ifdef C\n#endif\n#endif\n",
+                "README": "#ifdef NOT_CODE\n",
+            }),
+            commit_files(self.repository, "Add net", {
+                "src/net/socket.cpp": "#ifndef WIN32\n#define POSIX 1\n#endif\n",
+            }),
+            commit_files(self.repository, "Break logger", {
+                "src/logger.cpp": "#ifdef LOG\n#define BUF 64\n",
+            }),
+            commit_files(self.repository, "Revert logger", {
+                "src/logger.cpp": "#ifdef LOG\n#define BUF 64\n#endif\n",
+            }),
+        ]
+
+    def tearDown(self):
+        """Clean up test fixtures."""
+        shutil.rmtree(self.repository)
+
+    def test_reader_reads_objects_and_trees(self):
+        """Test reading commits and trees through one cat-file process."""
+        with GitObjectReader(self.repository) as reader:
+            self.assertEqual(reader.rev_list(), list(reversed(self.commits)))
+            self.assertEqual(reader.rev_list(max_count=1), [self.commits[-1]])
+            object_type, data = reader.read(self.commits[0] + "^{tree}")
+            self.assertEqual(object_type, "tree")
+            entries = parse_tree(data)
+            self.assertEqual([name for _, name, _ in entries], ["README", "include", "src"])
+            self.assertEqual(entries[1][0], b"40000")
+            with self.assertRaises(GitError):
+                reader.read("0" * 40)
+            # The pipe is still usable after a missing object
+            self.assertEqual(reader.read(self.commits[0])[0], "commit")
+
+    def test_time_series(self):
+        """Test per-commit metrics, oldest first."""
+        with HistoryMiner(self.repository, include_headers=True) as miner:
+            points = miner.mine()
+
+        self.assertEqual([p.commit for p in points], self.commits)
+        self.assertEqual([p.subject for p in points][0], "Add logger")
+        first, second, broken, reverted = [p.metrics for p in points]
+        self.assertEqual((first.files, first.directives, first.conditionals), (2, 7, 3))
+        self.assertEqual(sorted(first.flags), ["A", "B", "C", "LOG"])
+        self.assertEqual(first.max_depth, 2)
+        self.assertEqual(first.errors, 0)
+        self.assertEqual((second.files, len(second.flags)), (3, 5))
+        self.assertGreater(broken.errors, 0)
+        self.assertEqual(reverted, second)
+        self.assertTrue(all(p.timestamp > 0 for p in points))
+
+    def test_only_changed_blobs_are_parsed(self):
+        """Test that unchanged files and reverted contents are not parsed again."""
+        with HistoryMiner(self.repository, include_headers=True) as miner:
+            points = miner.mine()
+            self.assertEqual([p.parsed_files for p in points], [2, 1, 1, 0])
+            self.assertEqual(miner.parsed_blobs, 4)
+            # include/ is unchanged after the first commit, src/net/ after the second
+            self.assertGreaterEqual(miner.cached_trees, 4)
+
+            # Mining again costs no parsing at all
+            again = miner.mine(max_count=2)
+            self.assertEqual([p.commit for p in again], self.commits[2:])
+            self.assertEqual(miner.parsed_blobs, 4)
+
+    def test_malformed_literal_does_not_abort(self):
+        """Test that a condition with an invalid literal is measured without its flags."""
+        commit = commit_files(self.repository, "Add octal", {"src/octal.cpp": "#if OCT == 08\n#endif\n"})
+        with HistoryMiner(self.repository) as miner:
+            last = miner.mine()[-1]
+
+        self.assertEqual(last.commit, commit)
+        self.assertEqual(last.metrics.files, 3)
+        self.assertNotIn("OCT", last.metrics.flags)
+
+    def test_filters(self):
+        """Test the scanner's extension and exclude rules on repository paths."""
+        with HistoryMiner(self.repository) as miner:
+            self.assertEqual(miner.mine()[0].metrics.files, 1)
+        with HistoryMiner(self.repository, include_headers=True, exclude_patterns=["net"]) as miner:
+            self.assertEqual(miner.mine()[-1].metrics.files, 2)
+
+    def test_tree_sources_of_revision(self):
+        """Test reading a directory's files as of a revision, not the working tree."""
+        with open(os.path.join(self.repository, "src", "logger.cpp"), 'w') as f:
+            f.write("#define UNCOMMITTED 1\n")
+        src = os.path.join(self.repository, "src")
+
+        sources = dict(iter_tree_sources(src, self.commits[2]))
+        self.assertEqual(sorted(sources), [os.path.join(src, "logger.cpp"), os.path.join(src, "net/socket.cpp")])
+        self.assertEqual(sources[os.path.join(src, "logger.cpp")], ["#ifdef LOG\n", "#define BUF 64\n"])
+        self.assertEqual(list(dict(iter_tree_sources(src, self.commits[0], exclude_patterns=["net"]))),
+                         [os.path.join(src, "logger.cpp")])
+
+    def test_bad_revision(self):
+        """Test that an unknown revision raises GitError."""
+        with HistoryMiner(self.repository) as miner:
+            with self.assertRaises(GitError):
+                miner.mine("no-such-branch")
+
+
+if __name__ == '__main__':
+    unittest.main()
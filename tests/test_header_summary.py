@@ -0,0 +1,211 @@
+"""
+Unit tests for the header summary module.
+Tests effective macro tables, summary reuse across configurations,
+include resolution and compilation database loading.
+"""
+
+import unittest
+import json
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.header_summary import HeaderSummaryCache
+from src.include_graph import IncludeResolver
+from src.compilation_database import configuration_from_arguments, load_compile_commands
+from src.data_models import Configuration
+from tests.source_tree import SourceTreeTestCase, write_tree
+
+
+FILES = {
+    "include/platform.h": """#ifndef PLATFORM_H
+#define PLATFORM_H
+#ifdef _WIN32
+#define PLATFORM 1
+#else
+#define PLATFORM 2
+#endif
+#undef LEGACY
+#endif
+""",
+    "include/once.h": """#pragma once
+#define ONCE_COUNT 1
+""",
+    "src/local.h": """#include <platform.h>
+#if PLATFORM == 1
+#define PATH_SEP '\\\\'
+#else
+#define PATH_SEP '/'
+#endif
+""",
+    "src/a.cpp": """#define LEGACY 1
+#include "local.h"
+#include "platform.h"
+#include <once.h>
+#include <once.h>
+#include <missing.h>
+#define AFTER 1
+""",
+}
+
+
+class TestHeaderSummary(SourceTreeTestCase):
+    """Test cases for the HeaderSummaryCache class."""
+
+    FILES = FILES
+
+    def setUp(self):
+        """Set up a small source tree."""
+        super().setUp()
+        self.source = os.path.join(self.root, "src", "a.cpp")
+        self.include = os.path.join(self.root, "include")
+        self.cache = HeaderSummaryCache()
+
+    def configuration(self, *defines):
+        configuration = Configuration.from_flags(list(defines))
+        configuration.include_paths = [self.include]
+        return configuration
+
+    def test_effective_macros(self):
+        """Test that includes are followed and defines/undefs applied in order."""
+        macros = self.cache.effective_macros(self.source, self.configuration())
+
+        self.assertEqual(macros["PLATFORM"], "2")
+        self.assertEqual(macros["PATH_SEP"], "'/'")
+        self.assertEqual(macros["ONCE_COUNT"], "1")
+        self.assertEqual(macros["AFTER"], "1")
+        self.assertNotIn("LEGACY", macros)
+
+    def test_configuration_selects_branches(self):
+        """Test that configuration macros flow into included headers."""
+        macros = self.cache.effective_macros(self.source, self.configuration("_WIN32"))
+
+        self.assertEqual(macros["PLATFORM"], "1")
+        self.assertEqual(macros["PATH_SEP"], "'\\\\'")
+
+    def test_summaries_shared_across_irrelevant_macros(self):
+        """Test that configurations differing only in unread macros reuse summaries."""
+        self.cache.effective_macros(self.source, self.configuration("FOO"))
+        computed = self.cache.stats()["summaries"]
+
+        macros = self.cache.effective_macros(self.source, self.configuration("BAR=2"))
+
+        self.assertEqual(self.cache.stats()["summaries"], computed)
+        self.assertEqual(macros["BAR"], "2")
+        self.assertNotIn("FOO", macros)
+
+        self.cache.effective_macros(self.source, self.configuration("_WIN32"))
+        self.assertGreater(self.cache.stats()["summaries"], computed)
+
+    def test_summaries_shared_across_guard_state(self):
+        """Test that a header's summary is reused whether or not its guarded includes were seen."""
+        first = os.path.join(self.root, "src", "first.cpp")
+        second = os.path.join(self.root, "src", "second.cpp")
+        third = os.path.join(self.root, "src", "third.cpp")
+        with open(first, 'w') as f:
+            f.write('#include <platform.h>\n#include "local.h"\n')
+        with open(second, 'w') as f:
+            f.write('#include "local.h"\n')
+        with open(third, 'w') as f:
+            f.write('#define EXTRA 1\n#include "local.h"\n')
+
+        self.cache.effective_macros(first, self.configuration())
+        macros = self.cache.effective_macros(second, self.configuration())
+        self.assertEqual(macros["PATH_SEP"], "'/'")
+        # Skipping platform.h after first.cpp included it leaves the same macros as entering it
+        self.assertEqual(len(self.cache.variants(os.path.join(self.root, "src", "local.h"))), 1)
+
+        computed = self.cache.stats()["summaries"]
+        self.cache.effective_macros(third, self.configuration())
+        self.assertEqual(self.cache.stats()["summaries"], computed + 1)
+
+    def test_guarded_reinclude_keeps_redefinition(self):
+        """Test that a header skipped by its guard does not undo a later redefinition."""
+        files = {
+            "c.h": "#ifndef C_H\n#define C_H\n#define X 1\n#endif\n",
+            "a.h": '#include "c.h"\n#undef X\n#define X 2\n',
+            "b.h": '#include "c.h"\n',
+            "tu.c": '#include "a.h"\n#include "b.h"\n',
+        }
+        write_tree(os.path.join(self.root, "src"), files)
+
+        macros = self.cache.effective_macros(os.path.join(self.root, "src", "tu.c"), self.configuration())
+        self.assertEqual(macros["X"], "2")
+
+        # b.h on its own enters c.h; after a.h redefined X it must not share that summary
+        self.cache.effective_macros(os.path.join(self.root, "src", "b.h"), self.configuration())
+        self.assertEqual(len(self.cache.variants(os.path.join(self.root, "src", "b.h"))), 2)
+
+    def test_summary_inputs_and_effects(self):
+        """Test that a header summary records only the macros it depends on."""
+        resolver = self.cache.resolver([self.include])
+        summary = self.cache.summarize(os.path.join(self.include, "platform.h"), {"OTHER": "1"}, resolver)
+
+        self.assertEqual(summary.inputs, {"PLATFORM_H": None, "_WIN32": None})
+        self.assertEqual(summary.effects, {"PLATFORM_H": "", "PLATFORM": "2", "LEGACY": None})
+
+    def test_macros_at_line(self):
+        """Test the macro table at a point inside the translation unit."""
+        before = self.cache.effective_macros(self.source, self.configuration(), line_number=2)
+        after = self.cache.effective_macros(self.source, self.configuration(), line_number=4)
+
+        self.assertEqual(before["LEGACY"], "1")
+        self.assertNotIn("PATH_SEP", before)
+        self.assertNotIn("LEGACY", after)
+        self.assertIn("PATH_SEP", after)
+        self.assertNotIn("ONCE_COUNT", after)
+
+    def test_unresolved_includes_recorded(self):
+        """Test that missing headers are skipped and reported."""
+        resolver = self.cache.resolver([self.include])
+        summary = self.cache.summarize(self.source, {}, resolver)
+
+        self.assertEqual(summary.unresolved, ["missing.h"])
+        self.assertEqual(len(summary.includes), 4)
+
+    def test_include_resolver(self):
+        """Test quoted lookups next to the includer before include paths."""
+        resolver = IncludeResolver([self.include])
+
+        self.assertEqual(resolver.resolve("local.h", self.source, quoted=True),
+                         os.path.join(self.root, "src", "local.h"))
+        self.assertIsNone(resolver.resolve("local.h", self.source, quoted=False))
+        self.assertEqual(resolver.resolve("platform.h", self.source, quoted=False),
+                         os.path.join(self.include, "platform.h"))
+
+    def test_configuration_from_arguments(self):
+        """Test extraction of -D/-U/-I flags in attached and separate forms."""
+        configuration = configuration_from_arguments(
+            ["c++", "-DA", "-D", "B=2", "-UC", "-Iinc", "-isystem", "/usr/x", "-c", "a.cpp"],
+            directory="/build"
+        )
+
+        self.assertEqual(configuration.defines, {"A": "1", "B": "2"})
+        self.assertEqual(configuration.undefs, ["C"])
+        self.assertEqual(configuration.include_paths, ["/build/inc", "/usr/x"])
+
+    def test_load_compile_commands(self):
+        """Test loading command and arguments entries."""
+        database = os.path.join(self.root, "compile_commands.json")
+        with open(database, 'w') as f:
+            json.dump([
+                {"directory": self.root, "file": "src/a.cpp",
+                 "command": "c++ -D_WIN32 -I include -c src/a.cpp"},
+                {"directory": self.root, "file": "src/b.cpp",
+                 "arguments": ["c++", "-DNAME=\"x y\"", "-c", "src/b.cpp"]},
+            ], f)
+
+        commands = load_compile_commands(self.root)
+
+        self.assertEqual(commands[0].file, self.source)
+        self.assertEqual(commands[0].configuration.include_paths, [self.include])
+        self.assertEqual(commands[1].configuration.defines, {"NAME": '"x y"'})
+
+        macros = self.cache.effective_macros(commands[0].file, commands[0].configuration)
+        self.assertEqual(macros["PLATFORM"], "1")
+
+
+if __name__ == '__main__':
+    unittest.main()
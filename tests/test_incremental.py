@@ -0,0 +1,254 @@
+"""
+Unit tests for the incremental document module.
+Tests directive reuse, line shifting and context re-convergence after edits.
+"""
+
+import unittest
+import random
+import time
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.incremental import IncrementalDocument, IncrementalEvaluation, IncrementalValidation
+from src.configuration_evaluator import ConfigurationEvaluator
+from src.validation import DirectiveValidator
+from tests.test_startup import RUN_BENCHMARKS
+
+
+# File sizes (in lines) for the edit latency benchmark
+BENCHMARK_SIZES = (1000, 5000, 20000, 50000)
+BENCHMARK_EDITS = 20
+
+SOURCE = "#ifdef DEBUG\n#define LEVEL 3\n#else\n#define LEVEL 1\n#endif\n"
+
+# Lines for random edits, mixing conditions on macros the edits define and undefine
+RANDOM_POOL = ["#ifdef A", "#ifndef B", "#if X > 1", "#elif Y", "#elif defined(A) && X", "#else",
+               "#endif", "#endif", "#define X 2", "#define X 0", "#define A", "#undef X", "#undef A",
+               "#define Y X + 1", "#if (", "#error stop", "#define", "int x;", ""]
+
+
+def snapshot(document):
+    """Comparable view of a document's analysis results."""
+    result = document.file_result
+    return (
+        [d.to_dict() for d in result.directives],
+        [d.to_dict() for d in result.defines],
+        [e.to_dict() for e in result.errors],
+        result.line_count,
+        result.directive_count,
+    )
+
+
+class TestIncrementalDocument(unittest.TestCase):
+    """Test cases for the IncrementalDocument class."""
+
+    def test_edit_reuses_and_shifts_directives(self):
+        """Test that directives after an edit are reused with shifted lines."""
+        document = IncrementalDocument("a.h", SOURCE)
+        endif = document.file_result.directives[-1]
+
+        document.apply_change((1, 0), (1, 0), "// comment\n// another\n")
+
+        self.assertIs(document.file_result.directives[-1], endif)
+        self.assertEqual(endif.line_number, 7)
+        self.assertEqual(document.text, "#ifdef DEBUG\n// comment\n// another\n#define LEVEL 3\n#else\n#define LEVEL 1\n#endif\n")
+
+    def test_edit_matches_full_parse(self):
+        """Test that incremental results match parsing the edited text."""
+        document = IncrementalDocument("a.h", SOURCE)
+        document.apply_change((2, 0), (3, 15), "#elif defined(TRACE)\n#define LEVEL 2")
+
+        self.assertEqual(snapshot(document), snapshot(IncrementalDocument("a.h", document.text)))
+        self.assertEqual(document.file_result.line_count, 5)
+        self.assertEqual(len(document.file_result.defines), 2)
+
+    def test_context_recompute_stops_at_convergence(self):
+        """Test that a local edit only reanalyzes directives up to re-convergence."""
+        blocks = [f"#ifdef F{i}\n#define V{i} {i}\n#endif\n" for i in range(100)]
+        document = IncrementalDocument("big.h", "".join(blocks))
+
+        document.apply_edit(152, 152, "#define V50 changed")
+
+        self.assertEqual(document.last_reanalyzed, 1)
+        self.assertEqual(document.file_result.defines[50].context, ["F50"])
+
+    def test_unbalancing_edit_propagates(self):
+        """Test that removing an #endif reanalyzes to the end and reports it."""
+        document = IncrementalDocument("a.h", "#ifdef A\n#endif\n#ifdef B\n#define X 1\n#endif\n")
+
+        document.apply_edit(2, 2, "")
+
+        self.assertEqual(document.file_result.defines[0].context, ["A", "B"])
+        self.assertEqual([e.line_number for e in document.file_result.errors], [4])
+        self.assertIn("1 unclosed", document.file_result.errors[0].message)
+
+        document.apply_edit(1, 0, "#endif")
+        messages = [e.message for e in document.file_result.errors]
+        self.assertTrue(any("Orphaned #endif" in m for m in messages))
+
+    def test_random_edits_match_full_parse(self):
+        """Test random line edits against from-scratch analysis."""
+        rng = random.Random(1234)
+        pool = ["#ifdef A", "#ifndef B", "#if X > 1", "#elif Y", "#else", "#endif",
+                "#define D 1", "#undef D", "int x;", ""]
+        document = IncrementalDocument("r.h", "\n".join(rng.choice(pool) for _ in range(60)))
+
+        for _ in range(200):
+            first = rng.randint(1, len(document.lines))
+            last = rng.randint(first - 1, min(first + 3, len(document.lines)))
+            replacement = "\n".join(rng.choice(pool) for _ in range(rng.randint(0, 3)))
+            document.apply_edit(first, last, replacement)
+
+            self.assertEqual(snapshot(document), snapshot(IncrementalDocument("r.h", document.text)))
+
+
+def validation_snapshot(errors):
+    """Comparable view of validation errors, independent of their order."""
+    return sorted((e.line_number, e.message, e.suggestion or "") for e in errors)
+
+
+class TestIncrementalValidation(unittest.TestCase):
+    """Test cases for the IncrementalValidation class."""
+
+    def full_validation(self, document):
+        return DirectiveValidator().validate(IncrementalDocument("r.h", document.text).file_result,
+                                             check_balance=False)
+
+    def test_redefinition_follows_first_definition(self):
+        """Test that removing the first #define moves the redefinition warning."""
+        document = IncrementalDocument("a.h", "#define A 1\n#define A 2\n#define A 3\n#ifdef B\n#endif\n")
+        validation = IncrementalValidation(document)
+        self.assertEqual(validation_snapshot(validation.errors),
+                         validation_snapshot(self.full_validation(document)))
+
+        document.apply_edit(1, 1, "")
+        document.apply_edit(3, 3, "#ifdef C")
+        self.assertEqual([e.line_number for e in validation.errors], [2, 3])
+        self.assertIn("First defined at line 1", validation.errors[0].suggestion)
+        self.assertIn("undefined symbol 'C'", validation.errors[1].message)
+
+    def test_random_edits_match_full_validation(self):
+        """Test random line edits against validating the edited text."""
+        rng = random.Random(4321)
+        document = IncrementalDocument("r.h", "\n".join(rng.choice(RANDOM_POOL) for _ in range(60)))
+        validation = IncrementalValidation(document)
+
+        for _ in range(200):
+            first = rng.randint(1, len(document.lines))
+            last = rng.randint(first - 1, min(first + 3, len(document.lines)))
+            document.apply_edit(first, last, "\n".join(rng.choice(RANDOM_POOL) for _ in range(rng.randint(0, 3))))
+
+            self.assertEqual(validation_snapshot(validation.errors),
+                             validation_snapshot(self.full_validation(document)))
+
+
+class TestIncrementalEvaluation(unittest.TestCase):
+    """Test cases for the IncrementalEvaluation class."""
+
+    def assertMatchesFullEvaluation(self, evaluation, configuration=None):
+        file_result = IncrementalDocument("r.h", evaluation.document.text).file_result
+        expected = ConfigurationEvaluator().evaluate(file_result.directives, configuration, file_result.line_count)
+        result = evaluation.result
+        self.assertEqual(result.inactive_ranges, expected.inactive_ranges)
+        self.assertEqual(result.taken, expected.taken)
+        self.assertEqual(result.macros, expected.macros)
+        self.assertEqual(result.unparsed_lines, expected.unparsed_lines)
+        self.assertEqual([d.line_number for d in result.errors], [d.line_number for d in expected.errors])
+        for line_number in range(1, file_result.line_count + 2):
+            self.assertEqual(evaluation.is_line_active(line_number), expected.is_line_active(line_number))
+
+    def test_define_change_reevaluates_readers_only(self):
+        """Test that changing a #define re-evaluates just the conditions reading it."""
+        blocks = [f"#if LEVEL > {i % 3}\nint f{i}(void);\n#endif\n#ifdef F{i}\n#endif\n" for i in range(50)]
+        document = IncrementalDocument("a.h", "#define LEVEL 1\n" + "".join(blocks))
+        evaluation = IncrementalEvaluation(document)
+        self.assertEqual(evaluation.result.taken[2], True)
+
+        document.apply_edit(1, 1, "#define LEVEL 0")
+
+        # The #define, the 50 conditions reading LEVEL and the #endif after each of the 17 that flipped
+        self.assertEqual(evaluation.last_evaluated, 68)
+        self.assertEqual(evaluation.result.taken[2], False)
+        self.assertMatchesFullEvaluation(evaluation)
+
+        document.apply_edit(198, 198, "int g(void);")
+        self.assertEqual(evaluation.last_evaluated, 0)
+
+    def test_configuration_change(self):
+        """Test that a new configuration re-evaluates the whole document."""
+        document = IncrementalDocument("a.h", SOURCE)
+        evaluation = IncrementalEvaluation(document)
+        self.assertEqual(evaluation.result.macros, {"LEVEL": "1"})
+
+        evaluation.set_configuration({"DEBUG": ""})
+        self.assertEqual(evaluation.result.macros, {"DEBUG": "", "LEVEL": "3"})
+        self.assertEqual(evaluation.result.inactive_ranges, [(4, 4)])
+
+    def test_random_edits_match_full_evaluation(self):
+        """Test random line edits against evaluating the edited text."""
+        rng = random.Random(2468)
+        configuration = {"B": "", "Y": "1"}
+        document = IncrementalDocument("r.h", "\n".join(rng.choice(RANDOM_POOL) for _ in range(60)))
+        evaluation = IncrementalEvaluation(document, configuration)
+
+        for _ in range(300):
+            first = rng.randint(1, max(len(document.lines), 1))
+            last = rng.randint(first - 1, min(first + 3, len(document.lines)))
+            document.apply_edit(first, last, "\n".join(rng.choice(RANDOM_POOL) for _ in range(rng.randint(0, 3))))
+
+            self.assertMatchesFullEvaluation(evaluation, configuration)
+
+
+def _synthetic_source(line_count):
+    """Nested conditional blocks with defines, about one directive per two lines."""
+    lines = []
+    block = 0
+    while len(lines) < line_count:
+        lines.extend([
+            f"#if defined(FEATURE_{block}) && VERSION > {block % 7}",
+            f"#  ifdef PLATFORM_{block % 5}",
+            f"#    define VALUE_{block} {block}",
+            "#  else",
+            f"#    define VALUE_{block} 0",
+            "#  endif",
+            f"int function_{block}(void);",
+            "#endif",
+            "",
+            f"static const int table_{block}[] = {{ {block}, {block + 1} }};",
+        ])
+        block += 1
+    return "\n".join(lines[:line_count])
+
+
+class TestIncrementalBenchmark(unittest.TestCase):
+    """Edit latency against file size, compared with a full reparse."""
+
+    @unittest.skipUnless(RUN_BENCHMARKS, "set CPP_ANALYZER_BENCHMARKS=1 to run timed benchmarks")
+    def test_edit_latency_vs_file_size(self):
+        """Benchmark single-line edits in the middle of growing files."""
+        for size in BENCHMARK_SIZES:
+            text = _synthetic_source(size)
+            start = time.perf_counter()
+            document = IncrementalDocument("bench.h", text)
+            full_ms = (time.perf_counter() - start) * 1000
+
+            middle = size // 2 - (size // 2) % 10 + 3
+            timings = []
+            for edit in range(BENCHMARK_EDITS):
+                start = time.perf_counter()
+                document.apply_edit(middle, middle, f"#    define VALUE_X {edit}")
+                timings.append((time.perf_counter() - start) * 1000)
+            timings.sort()
+            edit_ms = timings[len(timings) // 2]
+
+            summary = (f"{size} lines: full parse {full_ms:.2f}ms, median edit {edit_ms:.3f}ms, "
+                       f"{document.last_reanalyzed} directive(s) reanalyzed")
+            self.assertLess(document.last_reanalyzed, 5, summary)
+            if size >= 20000:
+                self.assertLess(edit_ms * 10, full_ms, summary)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,270 @@
+"""
+Unit tests for the Language Server Protocol frontend.
+Tests message framing, diagnostics, hover and incremental edits.
+"""
+
+import unittest
+import io
+import json
+import os
+import sys
+import time
+from unittest import mock
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.lsp_server import LanguageServer, utf16_to_index, index_to_utf16
+from src.data_models import Configuration
+from tests.test_incremental import _synthetic_source
+from tests.test_startup import RUN_BENCHMARKS
+
+
+URI = "file:///project/config.h"
+SOURCE = "#ifdef DEBUG\n#define LEVEL 3\n#else\n#define LEVEL 1\n#endif\n"
+
+# Keystroke benchmark: document size, keystrokes timed and median budget
+KEYSTROKE_LINES = 50000
+KEYSTROKE_EDITS = 40
+KEYSTROKE_BUDGET_MS = 5
+
+
+def frame(message):
+    """Encode a JSON-RPC message with its Content-Length header."""
+    body = json.dumps(message).encode('utf-8')
+    return f"Content-Length: {len(body)}\r\n\r\n".encode('ascii') + body
+
+
+def unframe(data):
+    """Decode all messages written by the server."""
+    messages = []
+    while data:
+        header, _, rest = data.partition(b"\r\n\r\n")
+        length = int(header.split(b":")[1])
+        messages.append(json.loads(rest[:length]))
+        data = rest[length:]
+    return messages
+
+
+class TestLanguageServer(unittest.TestCase):
+    """Test cases for the LanguageServer class."""
+
+    def setUp(self):
+        """Set up test fixtures."""
+        self.output = io.BytesIO()
+        self.server = LanguageServer(Configuration.from_flags(["DEBUG"], name="debug"),
+                                     reader=io.BytesIO(), writer=self.output)
+
+    def messages(self):
+        return unframe(self.output.getvalue())
+
+    def handle(self, message):
+        """Handle a message, then publish diagnostics as serve() does once input pauses."""
+        self.server.handle_message(message)
+        self.server.publish_pending()
+
+    def open_document(self, text=SOURCE):
+        self.handle({"method": "textDocument/didOpen",
+                     "params": {"textDocument": {"uri": URI, "text": text}}})
+
+    def last_diagnostics(self):
+        notifications = [m for m in self.messages() if m.get("method") == "textDocument/publishDiagnostics"]
+        return notifications[-1]["params"]["diagnostics"]
+
+    def test_session_over_stdio_framing(self):
+        """Test a full initialize/shutdown/exit session through serve()."""
+        requests = b"".join(frame(m) for m in [
+            {"id": 1, "method": "initialize", "params": {}},
+            {"method": "initialized", "params": {}},
+            {"id": 2, "method": "shutdown"},
+            {"method": "exit"},
+        ])
+        self.server.reader = io.BytesIO(requests)
+
+        self.assertEqual(self.server.serve(), 0)
+        responses = self.messages()
+        self.assertEqual(responses[0]["id"], 1)
+        self.assertTrue(responses[0]["result"]["capabilities"]["hoverProvider"])
+        self.assertEqual(responses[1], {"id": 2, "result": None, "jsonrpc": "2.0"})
+
+    def test_inactive_regions_greyed_out(self):
+        """Test that the untaken branch is published as an unnecessary hint."""
+        self.open_document()
+
+        hints = [d for d in self.last_diagnostics() if d.get("tags") == [1]]
+        self.assertEqual(len(hints), 1)
+        self.assertEqual(hints[0]["range"]["start"]["line"], 3)
+        self.assertEqual(hints[0]["range"]["end"]["line"], 3)
+
+    def test_configuration_from_initialization_options(self):
+        """Test that initializationOptions select the configuration."""
+        self.server.handle_message({"id": 1, "method": "initialize",
+                                    "params": {"initializationOptions": {"name": "release", "defines": {}}}})
+        self.open_document()
+
+        hints = [d for d in self.last_diagnostics() if d.get("tags") == [1]]
+        self.assertEqual(hints[0]["range"]["start"]["line"], 1)
+        self.assertIn("release", hints[0]["message"])
+
+    def test_incremental_change_updates_diagnostics(self):
+        """Test that an edit removing #endif produces an unmatched-block error."""
+        self.open_document()
+        self.handle({"method": "textDocument/didChange", "params": {
+            "textDocument": {"uri": URI, "version": 2},
+            "contentChanges": [{"range": {"start": {"line": 4, "character": 0},
+                                          "end": {"line": 4, "character": 6}},
+                                "text": ""}]
+        }})
+
+        messages = [d["message"] for d in self.last_diagnostics()]
+        self.assertTrue(any("Unmatched conditional" in m for m in messages))
+
+    def test_edits_and_settings_update_inactive_regions(self):
+        """Test that a #define edit and new settings re-evaluate later conditions."""
+        self.open_document("#define MODE 1\n#if MODE == 2\nint two;\n#endif\n")
+        hints = [d["range"]["start"]["line"] for d in self.last_diagnostics() if d.get("tags") == [1]]
+        self.assertEqual(hints, [2])
+
+        self.handle({"method": "textDocument/didChange", "params": {
+            "textDocument": {"uri": URI, "version": 2},
+            "contentChanges": [{"range": {"start": {"line": 0, "character": 13},
+                                          "end": {"line": 0, "character": 14}},
+                                "text": "2"}]
+        }})
+        self.assertEqual([d for d in self.last_diagnostics() if d.get("tags") == [1]], [])
+
+        self.handle({"method": "workspace/didChangeConfiguration", "params": {
+            "settings": {"name": "other", "defines": {}, "undefs": ["MODE"]}
+        }})
+        self.assertEqual([d for d in self.last_diagnostics() if d.get("tags") == [1]], [])
+        self.handle({"method": "textDocument/didChange", "params": {
+            "textDocument": {"uri": URI, "version": 3},
+            "contentChanges": [{"range": {"start": {"line": 0, "character": 0},
+                                          "end": {"line": 1, "character": 0}},
+                                "text": ""}]
+        }})
+        hints = [d for d in self.last_diagnostics() if d.get("tags") == [1]]
+        self.assertEqual([d["range"]["start"]["line"] for d in hints], [1])
+        self.assertIn("other", hints[0]["message"])
+
+    def test_hover_shows_context_and_definitions(self):
+        """Test hover content for a line inside a conditional block."""
+        self.open_document()
+        self.server.handle_message({"id": 7, "method": "textDocument/hover", "params": {
+            "textDocument": {"uri": URI}, "position": {"line": 3, "character": 10}
+        }})
+
+        hover = self.messages()[-1]["result"]["contents"]["value"]
+        self.assertIn("`!DEBUG`", hover)
+        self.assertIn("inactive", hover)
+        self.assertIn("**LEVEL** is defined 2 time(s)", hover)
+
+    def test_hover_shows_macro_state_at_line(self):
+        """Test that hover answers whether a macro is defined at the hovered line, after edits."""
+        self.open_document(SOURCE + "LEVEL;\n#undef LEVEL\nLEVEL;\n")
+
+        def hover(line):
+            self.server.handle_message({"id": 8, "method": "textDocument/hover", "params": {
+                "textDocument": {"uri": URI}, "position": {"line": line, "character": 1}
+            }})
+            return self.messages()[-1]["result"]["contents"]["value"]
+
+        self.assertIn("**LEVEL** here depends on the configuration (lines 2, 4)", hover(5))
+        self.assertIn("**LEVEL** is undefined here (line 7)", hover(7))
+        # The timeline follows edits itself; nothing reindexes the document
+        with mock.patch.object(self.server.timeline, 'replace_file', side_effect=AssertionError("reindexed")):
+            self.handle({"method": "textDocument/didChange", "params": {
+                "textDocument": {"uri": URI},
+                "contentChanges": [{"range": {"start": {"line": 6, "character": 0},
+                                              "end": {"line": 6, "character": 12}},
+                                    "text": "#define LEVEL 9"},
+                                   {"range": {"start": {"line": 0, "character": 0},
+                                              "end": {"line": 0, "character": 0}},
+                                    "text": "\n"}]
+            }})
+            self.assertIn("**LEVEL** is `9` here (line 8)", hover(8))
+            self.assertIn("**LEVEL** is defined 3 time(s)", hover(8))
+
+    def test_malformed_literal_reported_not_fatal(self):
+        """Test that an invalid octal literal does not stop the session."""
+        requests = b"".join(frame(m) for m in [
+            {"method": "textDocument/didOpen",
+             "params": {"textDocument": {"uri": URI, "text": "#if X == 08\n#define A 1\n#endif\n"}}},
+            {"id": 2, "method": "shutdown"},
+            {"method": "exit"},
+        ])
+        self.server.reader = io.BytesIO(requests)
+
+        self.assertEqual(self.server.serve(), 0)
+        self.assertEqual(self.messages()[-1], {"id": 2, "result": None, "jsonrpc": "2.0"})
+
+    def test_handler_errors_isolated(self):
+        """Test that a failing handler yields an error response or log message, not a dead server."""
+        self.open_document()
+        with mock.patch.object(self.server, 'context_at', side_effect=RuntimeError("boom")):
+            self.server.handle_message({"id": 4, "method": "textDocument/hover", "params": {
+                "textDocument": {"uri": URI}, "position": {"line": 2, "character": 0}}})
+        self.assertEqual(self.messages()[-1]["id"], 4)
+        self.assertEqual(self.messages()[-1]["error"]["code"], -32603)
+        self.assertIn("boom", self.messages()[-1]["error"]["message"])
+
+        with mock.patch.object(self.server, 'publish_diagnostics', side_effect=RuntimeError("bang")):
+            self.open_document()
+        self.assertEqual(self.messages()[-1]["method"], "window/logMessage")
+        self.assertIn("bang", self.messages()[-1]["params"]["message"])
+
+        self.server.handle_message({"id": 5, "method": "shutdown"})
+        self.assertEqual(self.messages()[-1], {"id": 5, "result": None, "jsonrpc": "2.0"})
+
+    def test_unknown_request_returns_error(self):
+        """Test that unsupported requests get a MethodNotFound error."""
+        self.server.handle_message({"id": 3, "method": "textDocument/completion", "params": {}})
+        self.assertEqual(self.messages()[-1]["error"]["code"], -32601)
+
+    def test_utf16_columns(self):
+        """Test UTF-16 column conversion for astral characters."""
+        line = "a\U0001F600b"
+        self.assertEqual(utf16_to_index(line, 3), 2)
+        self.assertEqual(index_to_utf16(line, 2), 3)
+
+
+class TestKeystrokeBenchmark(unittest.TestCase):
+    """didChange latency while typing in a large document."""
+
+    @unittest.skipUnless(RUN_BENCHMARKS, "set CPP_ANALYZER_BENCHMARKS=1 to run timed benchmarks")
+    def test_keystroke_latency(self):
+        """Benchmark typing into a #define and a code line of a 50,000-line file."""
+        output = io.BytesIO()
+        server = LanguageServer(Configuration.from_flags(["FEATURE_1", "PLATFORM_1"], name="bench"),
+                                reader=io.BytesIO(), writer=output)
+        server.handle_message({"method": "textDocument/didOpen",
+                               "params": {"textDocument": {"uri": URI, "text": _synthetic_source(KEYSTROKE_LINES)}}})
+        server.publish_pending()
+        middle = KEYSTROKE_LINES // 2 - (KEYSTROKE_LINES // 2) % 10
+
+        timings = []
+        for edit in range(KEYSTROKE_EDITS):
+            # Append a digit to a #define value, then to a declaration
+            for line in (middle + 2, middle + 9):
+                column = len(server.documents[URI].lines[line])
+                change = {"range": {"start": {"line": line, "character": column},
+                                    "end": {"line": line, "character": column}},
+                          "text": str(edit % 10)}
+                start = time.perf_counter()
+                server.handle_message({"method": "textDocument/didChange", "params": {
+                    "textDocument": {"uri": URI}, "contentChanges": [change]}})
+                timings.append((time.perf_counter() - start) * 1000)
+        timings.sort()
+        keystroke_ms = timings[len(timings) // 2]
+
+        published = len(output.getvalue())
+        start = time.perf_counter()
+        server.publish_pending()
+        publish_ms = (time.perf_counter() - start) * 1000
+        summary = (f"{KEYSTROKE_LINES} lines: median keystroke {keystroke_ms:.3f}ms, "
+                   f"publish {publish_ms:.1f}ms ({len(output.getvalue()) - published} bytes) once typing pauses")
+        self.assertLess(keystroke_ms, KEYSTROKE_BUDGET_MS, summary)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,149 @@
+"""
+Unit tests for the macro conflict detection module.
+Tests per translation unit conflicts, exclusive branches, default values,
+include cycles and the symbol index.
+"""
+
+import unittest
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.macro_conflicts import MacroConflictDetector
+from src.include_graph import IncludeGraph
+from src.symbol_index import SymbolIndex
+from src.api import Analyzer
+from src.data_models import Configuration
+from tests.source_tree import SourceTreeTestCase
+
+
+FILES = {
+    "include/small.h": "#ifndef SMALL_H\n#define SMALL_H\n#define BUFFER_SIZE 64\n#endif\n",
+    "include/large.h": "#ifndef LARGE_H\n#define LARGE_H\n#define BUFFER_SIZE 4096\n#endif\n",
+    "include/same.h": "#define BUFFER_SIZE 64\n",
+    "include/default.h": "#ifndef BUFFER_SIZE\n#define BUFFER_SIZE 1024\n#endif\n",
+    "include/win.h": "#ifdef _WIN32\n#define SEP '\\\\'\n#endif\n",
+    "include/posix.h": "#ifndef _WIN32\n#define SEP '/'\n#endif\n",
+    "include/cycle_a.h": '#include "cycle_b.h"\n#define CYCLE 1\n',
+    "include/cycle_b.h": '#include "cycle_a.h"\n#define CYCLE 2\n',
+    "src/both.cpp": "#include <small.h>\n#include <large.h>\n",
+    "src/nested.cpp": '#include "wrapper.h"\n#include <large.h>\n',
+    "src/wrapper.h": "#include <small.h>\n#include <same.h>\n",
+    "src/agree.cpp": "#include <small.h>\n#include <same.h>\n#include <default.h>\n",
+    "src/platform.cpp": "#include <win.h>\n#include <posix.h>\n",
+    "src/cycle.cpp": "#include <cycle_a.h>\n",
+}
+
+
+class TestMacroConflictDetector(SourceTreeTestCase):
+    """Test cases for the MacroConflictDetector class."""
+
+    FILES = FILES
+
+    def setUp(self):
+        """Set up a small source tree."""
+        super().setUp()
+        configuration = Configuration(include_paths=[os.path.join(self.root, "include")])
+        self.units = [os.path.join(self.root, "src", name)
+                      for name in ("both.cpp", "nested.cpp", "agree.cpp", "platform.cpp", "cycle.cpp")]
+        self.detector = MacroConflictDetector.from_translation_units(
+            [(unit, configuration) for unit in self.units])
+
+    def unit(self, name):
+        return os.path.join(self.root, "src", name)
+
+    def test_direct_conflict(self):
+        """Test two directly included headers defining different values."""
+        conflicts = self.detector.conflicts(self.unit("both.cpp"))
+
+        self.assertEqual([c.macro for c in conflicts], ["BUFFER_SIZE"])
+        self.assertEqual([d.value for d in conflicts[0].definitions], ["4096", "64"])
+
+    def test_transitive_conflict(self):
+        """Test conflicts between headers reached through other headers."""
+        conflicts = self.detector.conflicts(self.unit("nested.cpp"))
+
+        self.assertEqual(len(conflicts), 1)
+        files = sorted(os.path.basename(d.file_path) for d in conflicts[0].definitions)
+        self.assertEqual(files, ["large.h", "same.h", "small.h"])
+
+    def test_identical_values_and_defaults_do_not_conflict(self):
+        """Test that equal redefinitions and #ifndef defaults are ignored."""
+        self.assertEqual(self.detector.conflicts(self.unit("agree.cpp")), [])
+
+    def test_exclusive_branches_do_not_conflict(self):
+        """Test that definitions under contradicting conditions are ignored."""
+        self.assertEqual(self.detector.conflicts(self.unit("platform.cpp")), [])
+
+    def test_include_cycle(self):
+        """Test that files in an include cycle see each other's definitions."""
+        conflicts = self.detector.conflicts(self.unit("cycle.cpp"))
+
+        self.assertEqual([c.macro for c in conflicts], ["CYCLE"])
+
+    def test_detect_reports_only_conflicting_units(self):
+        """Test that detect maps only units with conflicts."""
+        found = self.detector.detect(self.units)
+
+        self.assertEqual(sorted(os.path.basename(p) for p in found),
+                         ["both.cpp", "cycle.cpp", "nested.cpp"])
+        self.assertEqual(found[self.unit("both.cpp")][0].to_dict()["macro"], "BUFFER_SIZE")
+
+    def test_many_units_defining_macro_differently(self):
+        """Test a macro each of 2000 units defines differently next to a shared header's definition."""
+        analyzer = Analyzer()
+        graph = IncludeGraph()
+        results = [analyzer.analyze_buffer('#define LOG_TAG "app"\n#define SHARED 1\n', "/log.h")]
+        units = [f"/unit{i}.cpp" for i in range(2000)]
+        for i, unit in enumerate(units):
+            graph.add_include(unit, "/log.h")
+            results.append(analyzer.analyze_buffer(f'#define LOG_TAG "unit{i}"\n#define SHARED 1\n', unit))
+        detector = MacroConflictDetector(graph, SymbolIndex.from_results(results))
+
+        found = detector.detect(units)
+
+        self.assertEqual(len(found), 2000)
+        conflict = found["/unit7.cpp"][0]
+        self.assertEqual(conflict.macro, "LOG_TAG")
+        self.assertEqual([d.value for d in conflict.definitions], ['"app"', '"unit7"'])
+
+
+class TestIncludeGraph(unittest.TestCase):
+    """Test cases for the IncludeGraph class."""
+
+    def test_closures_with_cycle(self):
+        """Test closures over a graph containing a cycle."""
+        graph = IncludeGraph()
+        graph.add_include("a", "b")
+        graph.add_include("b", "c")
+        graph.add_include("c", "b")
+        graph.add_include("c", "d")
+
+        self.assertEqual(sorted(graph.files(graph.closure("a"))), ["a", "b", "c", "d"])
+        self.assertEqual(sorted(graph.files(graph.closure("c"))), ["b", "c", "d"])
+        self.assertEqual(graph.files(graph.closure("d")), ["d"])
+        self.assertEqual(graph.closure("missing"), 0)
+
+
+class TestSymbolIndex(unittest.TestCase):
+    """Test cases for the SymbolIndex class."""
+
+    def test_index_buffers(self):
+        """Test indexing object-like and function-like definitions with contexts."""
+        analyzer = Analyzer()
+        index = SymbolIndex.from_results([
+            analyzer.analyze_buffer("#ifdef DEBUG\n#define LEVEL 2\n#endif\n#define SQ(x) ((x)*(x))\n", "a.h"),
+            analyzer.analyze_buffer("#define LEVEL 0\n#undef SQ\n", "b.h"),
+        ])
+
+        self.assertEqual(index.names(), ["LEVEL", "SQ"])
+        self.assertEqual([d.value for d in index.definitions_of("LEVEL")], ["2", "0"])
+        self.assertEqual(index.definitions_of("LEVEL")[0].context, ["DEBUG"])
+        self.assertEqual(index.definitions_of("SQ")[0].value, "(x) ((x)*(x))")
+        self.assertEqual(len(index.undefinitions["SQ"]), 1)
+
+
+if __name__ == '__main__':
+    unittest.main()
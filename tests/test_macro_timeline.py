@@ -0,0 +1,168 @@
+"""
+Unit tests for the macro timeline module.
+Tests per-file event ordering, point queries against conditional events,
+replacing one file's events and following incremental edits.
+"""
+
+import unittest
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.api import Analyzer
+from src.data_models import AnalysisResult
+from src.incremental import IncrementalDocument
+from src.macro_timeline import MacroTimeline
+
+
+LOGGER = """#define LOG_BUFFER_SIZE 16
+#ifdef LOG
+#define LOG_BUFFER_SIZE 64
+#else
+#define LOG_BUFFER_SIZE 32
+#endif
+int a;
+#ifdef LOG
+int b;
+#endif
+#undef LOG_BUFFER_SIZE
+int c;
+#if defined(LOG) && LEVEL > 1
+#define LOG_BUFFER_SIZE 128
+#endif
+"""
+
+
+def events_in(timeline, file_path):
+    """Serialized events of one file, per macro."""
+    return {name: by_file[file_path] for name, by_file in timeline.to_dict().items() if file_path in by_file}
+
+
+class TestMacroTimeline(unittest.TestCase):
+    """Test cases for MacroTimeline."""
+
+    def setUp(self):
+        """Set up test fixtures."""
+        self.analyzer = Analyzer()
+        self.timeline = MacroTimeline()
+        self.timeline.replace_file("logger.h", self.analyzer.analyze_buffer(LOGGER, "logger.h").directives)
+
+    def state(self, line, name="LOG_BUFFER_SIZE"):
+        return self.timeline.state_at(name, "logger.h", line)
+
+    def test_events_are_sorted_per_file(self):
+        """Test that each file keeps its own events in line order."""
+        events = self.timeline.events_of("LOG_BUFFER_SIZE", "logger.h")
+        self.assertEqual([e.line_number for e in events], [1, 3, 5, 11, 14])
+        self.assertEqual([e.kind for e in events], ["define"] * 3 + ["undef", "define"])
+        self.assertEqual(events[1].value, "64")
+        self.assertEqual(events[1].context, ["LOG"])
+        self.assertEqual(self.timeline.events_of("LOG_BUFFER_SIZE", "other.h"), [])
+
+    def test_unconditional_events(self):
+        """Test point queries before, on and after unconditional events."""
+        self.assertEqual(self.state(1).status, "unknown")
+        state = self.state(2)
+        self.assertEqual((state.status, state.value), ("defined", "16"))
+        self.assertEqual(self.state(12).status, "undefined")
+        self.assertEqual(self.state(12).events[0].line_number, 11)
+        self.assertEqual(self.timeline.state_at("MISSING", "logger.h", 5).status, "unknown")
+
+    def test_conditional_events_against_line_context(self):
+        """Test that the line's context settles, skips or keeps conditional events."""
+        state = self.state(7)
+        self.assertEqual(state.status, "conditional")
+        self.assertEqual([e.line_number for e in state.events], [5, 3, 1])
+
+        # Inside #ifdef LOG the #else branch is excluded and the #ifdef branch implied
+        state = self.state(9)
+        self.assertEqual((state.status, state.value), ("defined", "64"))
+        self.assertEqual([e.line_number for e in state.events], [3])
+
+        # An explicit context overrides the recorded one
+        state = self.timeline.state_at("LOG_BUFFER_SIZE", "logger.h", 9, ["!LOG"])
+        self.assertEqual((state.status, state.value), ("defined", "32"))
+
+        # After the #undef, a define under a stronger condition is only possible
+        state = self.timeline.state_at("LOG_BUFFER_SIZE", "logger.h", 16, ["LOG"])
+        self.assertEqual(state.status, "conditional")
+        self.assertEqual([e.line_number for e in state.events], [14, 11])
+        state = self.timeline.state_at("LOG_BUFFER_SIZE", "logger.h", 16, ["LOG", "LEVEL > 1"])
+        self.assertEqual((state.status, state.value), ("defined", "128"))
+
+    def test_elif_chain_excludes_earlier_branches(self):
+        """Test that an #else after #elif is excluded by the earlier branches' conditions."""
+        self.timeline.replace_file("mode.h", self.analyzer.analyze_buffer(
+            "#ifdef FAST\n#define MODE 1\n#elif SAFE\n#define MODE 2\n#else\n#define MODE 3\n#endif\n"
+            "#ifdef FAST\nint x;\n#endif\n", "mode.h").directives)
+
+        state = self.timeline.state_at("MODE", "mode.h", 9)
+        self.assertEqual((state.status, state.value), ("defined", "1"))
+        state = self.timeline.state_at("MODE", "mode.h", 9, ["!FAST", "!SAFE"])
+        self.assertEqual((state.status, state.value), ("defined", "3"))
+
+    def test_context_at(self):
+        """Test the context recorded for lines."""
+        self.assertEqual(self.timeline.context_at("logger.h", 1), [])
+        self.assertEqual(self.timeline.context_at("logger.h", 9), ["LOG"])
+        self.assertEqual(self.timeline.context_at("logger.h", 12), [])
+
+    def test_replace_and_remove_file(self):
+        """Test that replacing a file only changes that file's events."""
+        self.timeline.replace_file("other.h", self.analyzer.analyze_buffer(
+            "#define LOG_BUFFER_SIZE 8\n", "other.h").directives)
+        self.timeline.replace_file("logger.h", self.analyzer.analyze_buffer(
+            "#undef LOG_BUFFER_SIZE\n", "logger.h").directives)
+
+        self.assertEqual(len(self.timeline.events_of("LOG_BUFFER_SIZE")), 2)
+        self.assertEqual(self.state(2).status, "undefined")
+        self.assertEqual(self.timeline.state_at("LOG_BUFFER_SIZE", "other.h", 2).value, "8")
+
+        self.timeline.remove_file("logger.h")
+        self.timeline.remove_file("other.h")
+        self.assertEqual(self.timeline.symbols(), [])
+        self.assertEqual(self.timeline.files, [])
+
+    def test_apply_edit_matches_reindexing(self):
+        """Test that following document edits gives the same index as reindexing."""
+        document = IncrementalDocument("logger.h", LOGGER)
+        timeline = MacroTimeline()
+        timeline.replace_file("logger.h", document.file_result.directives)
+        timeline.replace_file("other.h", self.analyzer.analyze_buffer("#define LOG 1\n", "other.h").directives)
+        document.listeners.append(
+            lambda edit: timeline.apply_edit("logger.h", document.file_result.directives, edit))
+
+        edits = [
+            (1, 0, "#define EXTRA 1\n"),         # insert above everything
+            (7, 7, "int x;\n"),                  # dropping an #endif changes later contexts
+            (13, 13, "#undef LOG_BUFFER_SIZE\n#undef EXTRA\nint c;\n"),
+            (3, 3, "#if LOG\n"),                 # same line count, new condition
+            (7, 7, "#endif\n"),
+            (9, 11, ""),                         # delete a block
+            (1, 1, ""),
+        ]
+        for first, last, text in edits:
+            document.apply_edit(first, last, text)
+            expected = MacroTimeline()
+            expected.replace_file("logger.h", document.file_result.directives)
+            self.assertEqual(events_in(timeline, "logger.h"), events_in(expected, "logger.h"))
+            for line in range(1, len(document.lines) + 2):
+                self.assertEqual(timeline.context_at("logger.h", line), expected.context_at("logger.h", line))
+        self.assertEqual(timeline.state_at("LOG", "other.h", 2).value, "1")
+
+    def test_from_analysis_and_dict(self):
+        """Test building from analysis results and from their saved form."""
+        result = AnalysisResult()
+        result.add_file_result(self.analyzer.analyze_buffer(LOGGER, "logger.h"))
+        timeline = MacroTimeline.from_analysis(result)
+        saved = MacroTimeline.from_analysis_dict(result.to_dict())
+
+        self.assertEqual(timeline.to_dict(), saved.to_dict())
+        self.assertEqual(saved.state_at("LOG_BUFFER_SIZE", "logger.h", 9).value, "64")
+        self.assertEqual(list(timeline.to_dict()["LOG_BUFFER_SIZE"]), ["logger.h"])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,111 @@
+"""
+Unit tests for the macro value module.
+Tests constant folding of object-like macros, memoization and the
+symbol x configuration matrix.
+"""
+
+import unittest
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.macro_values import MacroValueFolder
+from src.data_models import Configuration
+from tests.source_tree import SourceTreeTestCase
+
+
+FILES = {
+    "values.h": """#ifndef VALUES_H
+#define VALUES_H
+#ifdef DEBUG
+#define LOG_LEVEL 3
+#else
+#define LOG_LEVEL 1
+#endif
+#define KB 1024
+#define BUFFER (4 * KB)
+#define MASK (BUFFER - 1) << 0x2
+#define NAME "pre" "processor"
+#define ALIAS NAME
+#define NEEDS_RUNTIME (BUFFER + sizeof(int))
+#define UNKNOWN_ID (KB + missing)
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define SELF SELF
+#define DIVIDE_BY_ZERO (KB / (BUFFER - 4096))
+#endif
+""",
+    "tu.cpp": '#include "values.h"\n#define TU_LEVEL (LOG_LEVEL * 10)\n',
+}
+
+
+class TestMacroValueFolder(SourceTreeTestCase):
+    """Test cases for the MacroValueFolder class."""
+
+    FILES = FILES
+
+    def setUp(self):
+        """Set up a small source tree."""
+        super().setUp()
+        self.source = os.path.join(self.root, "tu.cpp")
+        self.folder = MacroValueFolder()
+
+    def test_fold_constants(self):
+        """Test integer arithmetic, string concatenation and aliases."""
+        values = self.folder.values(self.source, Configuration())
+
+        self.assertEqual(values["KB"], 1024)
+        self.assertEqual(values["BUFFER"], 4096)
+        self.assertEqual(values["MASK"], 4095 << 2)
+        self.assertEqual(values["NAME"], '"preprocessor"')
+        self.assertEqual(values["ALIAS"], '"preprocessor"')
+        self.assertEqual(values["TU_LEVEL"], 10)
+
+    def test_unfoldable_values_kept_as_text(self):
+        """Test that non-constant values stay raw and function-like macros are skipped."""
+        values = self.folder.values(self.source, Configuration())
+
+        self.assertEqual(values["NEEDS_RUNTIME"], "(BUFFER + sizeof(int))")
+        self.assertEqual(values["UNKNOWN_ID"], "(KB + missing)")
+        self.assertEqual(values["SELF"], "SELF")
+        self.assertEqual(values["DIVIDE_BY_ZERO"], "(KB / (BUFFER - 4096))")
+        self.assertNotIn("MAX", values)
+
+    def test_malformed_literal_kept_as_text(self):
+        """Test that a value with an invalid octal literal is not folded."""
+        with open(self.source, 'a') as f:
+            f.write("#define OCTAL (08 + 1)\n")
+
+        self.assertEqual(self.folder.values(self.source, Configuration())["OCTAL"], "(08 + 1)")
+
+    def test_large_values_fold_exactly(self):
+        """Test that division keeps integers beyond 2**53 exact."""
+        with open(self.source, 'a') as f:
+            f.write("#define BIG 9007199254740993\n#define BIG_QUOTIENT (BIG / 1)\n")
+
+        self.assertEqual(self.folder.values(self.source, Configuration())["BIG_QUOTIENT"], 9007199254740993)
+
+    def test_matrix_per_configuration(self):
+        """Test the symbol x configuration matrix and its differing rows."""
+        matrix = self.folder.matrix(self.source, [
+            Configuration.from_flags(["DEBUG"], name="debug"),
+            Configuration(name="release"),
+        ])
+
+        self.assertEqual(matrix.configurations, ["debug", "release"])
+        self.assertEqual(matrix.rows["LOG_LEVEL"], [3, 1])
+        self.assertEqual(matrix.rows["DEBUG"], [1, None])
+        self.assertEqual(set(matrix.differing()), {"DEBUG", "LOG_LEVEL", "TU_LEVEL"})
+        self.assertEqual(matrix.to_dict()["rows"]["TU_LEVEL"], [30, 10])
+
+    def test_tables_memoized_per_configuration(self):
+        """Test that repeating a configuration reuses its folded table."""
+        first = self.folder.values(self.source, Configuration.from_flags(["DEBUG"], name="a"))
+        second = self.folder.values(self.source, Configuration.from_flags(["DEBUG"], name="b"))
+
+        self.assertIs(first, second)
+
+
+if __name__ == '__main__':
+    unittest.main()
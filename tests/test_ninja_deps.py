@@ -0,0 +1,167 @@
+"""
+Unit tests for the ninja deps log module.
+Tests parsing the binary .ninja_deps format, freshness, include graph
+construction with fallback, and the cross-check against static resolution.
+"""
+
+import unittest
+import tempfile
+import shutil
+import os
+import struct
+import sys
+import time
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.api import Analyzer
+from src.include_graph import IncludeResolver
+from src.macro_conflicts import MacroConflictDetector
+from src.ninja_deps import NinjaDepsLog, build_include_graph, cross_check
+
+
+def write_deps_log(path, records, version=4):
+    """Write a deps log from ("path", name) and ("deps", output id, mtime, [input ids]) records."""
+    data = bytearray(b"# ninjadeps\n" + struct.pack('<I', version))
+    paths = 0
+    for record in records:
+        if record[0] == "path":
+            name = record[1].encode()
+            name += b"\0" * (-len(name) % 4)
+            data += struct.pack('<I', len(name) + 4) + name + struct.pack('<I', ~paths & 0xFFFFFFFF)
+            paths += 1
+        else:
+            _, output, mtime, inputs = record
+            if version >= 4:
+                words = [output, mtime & 0xFFFFFFFF, mtime >> 32] + inputs
+            else:
+                words = [output, mtime] + inputs
+            data += struct.pack('<I', 0x80000000 | 4 * len(words)) + struct.pack(f'<{len(words)}I', *words)
+    with open(path, 'wb') as f:
+        f.write(bytes(data))
+
+
+FILES = {
+    "src/a.cpp": '#include "a.h"\n',
+    "src/a.h": '#define MODE 1\n',
+    "src/b.cpp": '#include "b.h"\n',
+    "src/b.h": '#define MODE 2\n',
+    "gen/generated.h": '#define MODE 3\n',
+}
+
+
+class TestNinjaDepsLog(unittest.TestCase):
+    """Test cases for reading .ninja_deps."""
+
+    def setUp(self):
+        """Set up a source tree and a build directory."""
+        self.root = tempfile.mkdtemp()
+        for name, text in FILES.items():
+            path = os.path.join(self.root, name)
+            os.makedirs(os.path.dirname(path), exist_ok=True)
+            with open(path, 'w') as f:
+                f.write(text)
+        self.build = os.path.join(self.root, "build")
+        os.makedirs(self.build)
+        self.future = (int(time.time()) + 3600) * 1000000000
+
+    def tearDown(self):
+        """Clean up the source tree."""
+        shutil.rmtree(self.root)
+
+    def path(self, name):
+        return os.path.join(self.root, name)
+
+    def write_log(self, b_mtime=None, version=4):
+        future = self.future if version >= 4 else self.future // 1000000000
+        write_deps_log(os.path.join(self.build, ".ninja_deps"), [
+            ("path", "a.o"), ("path", "../src/a.cpp"), ("path", "../src/a.h"), ("path", "../gen/generated.h"),
+            ("deps", 0, 1, [1]),
+            ("deps", 0, future, [1, 2, 3]),
+            ("path", "b.o"), ("path", "../src/b.cpp"), ("path", "../src/b.h"),
+            ("deps", 4, future if b_mtime is None else b_mtime, [5, 6]),
+        ], version)
+
+    def test_parse(self):
+        """Test paths, replaced deps records and entries."""
+        self.write_log()
+        log = NinjaDepsLog.load(self.build)
+
+        self.assertEqual(log.paths[1], self.path("src/a.cpp"))
+        self.assertEqual(log.dependencies("a.o"),
+                         [self.path("src/a.cpp"), self.path("src/a.h"), self.path("gen/generated.h")])
+        self.assertIsNone(log.dependencies("missing.o"))
+        entries = log.entries()
+        self.assertEqual(sorted(entries), [self.path("src/a.cpp"), self.path("src/b.cpp")])
+        self.assertEqual(entries[self.path("src/a.cpp")].headers,
+                         [self.path("src/a.h"), self.path("gen/generated.h")])
+        self.assertEqual(entries[self.path("src/a.cpp")].output, os.path.join(self.build, "a.o"))
+
+    def test_version_3_and_truncated_tail(self):
+        """Test 32-bit timestamps and that a cut-off final record is ignored."""
+        self.write_log(version=3)
+        deps_path = os.path.join(self.build, ".ninja_deps")
+        with open(deps_path, 'ab') as f:
+            f.write(struct.pack('<I', 0x80000000 | 64) + b"\0\0")
+        log = NinjaDepsLog.load(deps_path)
+
+        self.assertEqual(log.version, 3)
+        self.assertEqual(len(log.paths), 7)
+        self.assertTrue(log.is_fresh(log.entries()[self.path("src/b.cpp")]))
+
+    def test_rejects_other_files(self):
+        """Test a file without the signature is refused."""
+        path = os.path.join(self.build, "not_deps")
+        with open(path, 'wb') as f:
+            f.write(b"# ninja log v5\n")
+        with self.assertRaises(ValueError):
+            NinjaDepsLog.load(path)
+
+    def test_graph_with_fallback(self):
+        """Test fresh entries are used as recorded and stale ones resolved statically."""
+        self.write_log(b_mtime=1)
+        log = NinjaDepsLog.load(self.build)
+        resolver = IncludeResolver()
+        loaded = []
+
+        def load(file_path):
+            loaded.append(file_path)
+            return Analyzer().analyze_file(file_path).directives
+
+        sources = [(self.path("src/a.cpp"), resolver), (self.path("src/b.cpp"), resolver)]
+        graph, fallback = build_include_graph(sources, load, log)
+
+        self.assertEqual(fallback, [self.path("src/b.cpp")])
+        self.assertEqual(set(graph.files(graph.closure(self.path("src/a.cpp")))),
+                         {self.path("src/a.cpp"), self.path("src/a.h"), self.path("gen/generated.h")})
+        self.assertEqual(set(graph.files(graph.closure(self.path("src/b.cpp")))),
+                         {self.path("src/b.cpp"), self.path("src/b.h")})
+        self.assertNotIn(self.path("src/a.cpp"), loaded)
+
+    def test_cross_check(self):
+        """Test headers only the compiler found are reported as missing."""
+        self.write_log()
+        log = NinjaDepsLog.load(self.build)
+        resolver = IncludeResolver()
+        sources = [(self.path("src/a.cpp"), resolver), (self.path("src/b.cpp"), resolver)]
+        discrepancies = cross_check(sources, lambda p: Analyzer().analyze_file(p).directives, log)
+
+        self.assertEqual(len(discrepancies), 1)
+        self.assertEqual(discrepancies[0].translation_unit, self.path("src/a.cpp"))
+        self.assertEqual(discrepancies[0].missing, [self.path("gen/generated.h")])
+        self.assertEqual(discrepancies[0].extra, [])
+
+    def test_conflicts_use_recorded_headers(self):
+        """Test conflict detection sees headers only the deps log knows about."""
+        self.write_log()
+        detector = MacroConflictDetector.from_translation_units(
+            [(self.path("src/a.cpp"), None)], Analyzer(), NinjaDepsLog.load(self.build)
+        )
+        conflicts = detector.conflicts(self.path("src/a.cpp"))
+
+        self.assertEqual([c.macro for c in conflicts], ["MODE"])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,161 @@
+"""
+Unit tests for the precompiled header recommender module.
+Tests ranking, configuration stability filtering and per-directory plans.
+"""
+
+import unittest
+import tempfile
+import shutil
+import os
+import random
+import sys
+import time
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.pch_recommender import PchRecommender, _BitCounter
+from src.data_models import Configuration
+from tests.test_startup import RUN_BENCHMARKS
+
+
+FILES = {
+    "include/base.h": "#ifndef BASE_H\n#define BASE_H\n" + "int base;\n" * 100 + "#endif\n",
+    "include/common.h": "#ifndef COMMON_H\n#define COMMON_H\n#include <base.h>\n" + "int common;\n" * 50 + "#endif\n",
+    "include/tuned.h": "#ifndef TUNED_H\n#define TUNED_H\n#ifdef FAST\n#define MODE 1\n#else\n#define MODE 0\n#endif\n#endif\n",
+    "include/rare.h": "#ifndef RARE_H\n#define RARE_H\n" + "int rare;\n" * 500 + "#endif\n",
+    "app/one.cpp": "#include <common.h>\n#include <tuned.h>\n#include <rare.h>\n",
+    "app/two.cpp": "#include <common.h>\n#include <tuned.h>\n",
+    "app/three.cpp": "#include <base.h>\n#include <tuned.h>\n",
+    "lib/only.cpp": "#include <rare.h>\n",
+}
+
+
+class TestPchRecommender(unittest.TestCase):
+    """Test cases for the PchRecommender class."""
+
+    def setUp(self):
+        """Set up a small build tree."""
+        self.root = tempfile.mkdtemp()
+        for name, text in FILES.items():
+            path = os.path.join(self.root, name)
+            os.makedirs(os.path.dirname(path), exist_ok=True)
+            with open(path, 'w') as f:
+                f.write(text)
+
+        self.recommender = PchRecommender()
+        for name, defines in (("app/one.cpp", ["FAST"]), ("app/two.cpp", []),
+                              ("app/three.cpp", []), ("lib/only.cpp", [])):
+            configuration = Configuration.from_flags(defines)
+            configuration.include_paths = [os.path.join(self.root, "include")]
+            self.recommender.add_translation_unit(os.path.join(self.root, name), configuration)
+
+    def tearDown(self):
+        """Clean up the build tree."""
+        shutil.rmtree(self.root)
+
+    def header(self, name):
+        return os.path.join(self.root, "include", name)
+
+    def test_rank_by_units_times_bytes(self):
+        """Test that candidates are scored by including units times transitive bytes."""
+        ranking = {c.path: c for c in self.recommender.rank()}
+
+        base = ranking[self.header("base.h")]
+        common = ranking[self.header("common.h")]
+        self.assertEqual(base.translation_units, 3)
+        self.assertEqual(common.translation_units, 2)
+        self.assertEqual(common.transitive_bytes,
+                         os.path.getsize(self.header("common.h")) + os.path.getsize(self.header("base.h")))
+        self.assertEqual(common.score, 2 * common.transitive_bytes)
+        self.assertEqual(list(ranking)[0], self.header("rare.h"))
+
+    def test_unstable_headers_excluded(self):
+        """Test that headers with configuration-dependent branches are not proposed."""
+        ranking = [c.path for c in self.recommender.rank()]
+
+        self.assertNotIn(self.header("tuned.h"), ranking)
+
+    def test_recommend_per_directory(self):
+        """Test the per-directory PCH set and its estimated saving."""
+        recommendations = {r.directory: r for r in self.recommender.recommend(min_share=0.5)}
+
+        app = recommendations[os.path.join(self.root, "app")]
+        self.assertEqual(app.translation_units, 3)
+        # base.h is already covered by common.h, rare.h is used by one file in three
+        self.assertEqual([h.path for h in app.headers], [self.header("common.h")])
+
+        common = os.path.getsize(self.header("common.h"))
+        base = os.path.getsize(self.header("base.h"))
+        self.assertEqual(app.pch_bytes, common + base)
+        self.assertEqual(app.estimated_bytes_saved, 2 * common + 3 * base - (common + base))
+
+        # A single file gains nothing from a PCH
+        self.assertNotIn(os.path.join(self.root, "lib"), recommendations)
+
+    def test_closure_includes_headers_seen_earlier(self):
+        """Test that a header skipping an unstable include, already seen by its unit, is still unsafe."""
+        with open(self.header("wrapper.h"), 'w') as f:
+            f.write("#ifndef WRAPPER_H\n#define WRAPPER_H\n#include <tuned.h>\n#endif\n")
+        with open(os.path.join(self.root, "app", "four.cpp"), 'w') as f:
+            f.write("#include <tuned.h>\n#include <wrapper.h>\n")
+        configuration = Configuration()
+        configuration.include_paths = [os.path.join(self.root, "include")]
+        self.recommender.add_translation_unit(os.path.join(self.root, "app", "four.cpp"), configuration)
+
+        ranking = [c.path for c in self.recommender.rank()]
+
+        self.assertIn(self.header("common.h"), ranking)
+        self.assertNotIn(self.header("wrapper.h"), ranking)
+
+    def test_bit_counter(self):
+        """Test bit-sliced per-position counting."""
+        counter = _BitCounter()
+        for bits in (0b1011, 0b0011, 0b0001, 0b1000):
+            counter.add(bits)
+
+        self.assertEqual([counter.count(i) for i in range(4)], [3, 2, 0, 2])
+        self.assertEqual(counter.any(), 0b1011)
+
+
+class TestPchBenchmark(unittest.TestCase):
+    """Summary count and time as translation units grow."""
+
+    @unittest.skipUnless(RUN_BENCHMARKS, "set CPP_ANALYZER_BENCHMARKS=1 to run timed benchmarks")
+    def test_scaling(self):
+        """Benchmark 5,000 units over 500 guarded headers, each included in random order."""
+        headers, units, configurations = 500, 5000, 3
+        root = tempfile.mkdtemp()
+        try:
+            rng = random.Random(1)
+            os.makedirs(os.path.join(root, "include"))
+            for i in range(headers):
+                includes = "".join(f"#include <h{j}.h>\n" for j in rng.sample(range(i), min(i, 3)))
+                feature = f"#ifdef FEATURE_{i % configurations}\n#define F{i} 1\n#endif\n" if i % 50 == 49 else ""
+                with open(os.path.join(root, "include", f"h{i}.h"), 'w') as f:
+                    f.write(f"#ifndef H{i}_H\n#define H{i}_H\n{includes}#define M{i} {i}\n{feature}#endif\n")
+            for unit in range(units):
+                path = os.path.join(root, f"d{unit % 20}", f"u{unit}.c")
+                os.makedirs(os.path.dirname(path), exist_ok=True)
+                with open(path, 'w') as f:
+                    f.write("".join(f"#include <h{j}.h>\n" for j in rng.sample(range(headers), 8)))
+
+            start = time.perf_counter()
+            recommender = PchRecommender()
+            for unit in range(units):
+                configuration = Configuration.from_flags([f"FEATURE_{unit % configurations}"])
+                configuration.include_paths = [os.path.join(root, "include")]
+                recommender.add_translation_unit(os.path.join(root, f"d{unit % 20}", f"u{unit}.c"), configuration)
+            recommender.recommend()
+            elapsed = time.perf_counter() - start
+        finally:
+            shutil.rmtree(root)
+
+        summaries = recommender.cache.stats()["summaries"]
+        summary = f"{units} units over {headers} headers: {summaries} summaries in {elapsed:.1f}s"
+        # Each header needs at most one summary per configuration, however units order their includes
+        self.assertLessEqual(summaries, units + headers * configurations, summary)
+
+
+if __name__ == '__main__':
+    unittest.main()
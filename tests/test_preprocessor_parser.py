@@ -107,12 +107,24 @@ class TestPreprocessorParser(unittest.TestCase):
     
     def test_parse_unknown_directive(self):
         """Test parsing unknown directives."""
-        line = "#pragma once"
+        line = "#ident \"version 1\""
         directive = self.parser._parse_line(line, 1, "test.cpp")
         
         self.assertIsNotNone(directive)
         self.assertEqual(directive.type, DirectiveType.UNKNOWN)
     
+    def test_parse_diagnostic_and_pragma_directives(self):
+        """Test parsing #error, #warning and #pragma directives."""
+        cases = [
+            ("#pragma once", DirectiveType.PRAGMA),
+            ('#  error "Cannot define both DEBUG and RELEASE"', DirectiveType.ERROR),
+            ("#error", DirectiveType.ERROR),
+            ("#warning deprecated header", DirectiveType.WARNING),
+        ]
+        for line, expected in cases:
+            directive = self.parser._parse_line(line, 1, "test.cpp")
+            self.assertEqual(directive.type, expected, line)
+    
     def test_parse_non_directive_line(self):
         """Test parsing non-directive lines."""
         line = "int main() { return 0; }"
@@ -179,6 +191,16 @@ class TestPreprocessorParser(unittest.TestCase):
         finally:
             os.unlink(temp_file)
     
+    def test_parse_buffer(self):
+        """Test parsing an in-memory buffer without a backing file."""
+        result = self.parser.parse_buffer("#ifdef DEBUG\n#define TRACE 1\n#endif\n", "unsaved.h")
+        
+        self.assertEqual(result.file_path, "unsaved.h")
+        self.assertEqual(result.line_count, 3)
+        self.assertEqual(result.directive_count, 3)
+        self.assertEqual(result.errors, [])
+        self.assertEqual(result.directives[1].file_path, "unsaved.h")
+    
     def test_validate_define_syntax(self):
         """Test validating #define directive syntax."""
         # Valid define
@@ -14,6 +14,34 @@ sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
 from test_file_scanner import TestFileScanner
 from test_preprocessor_parser import TestPreprocessorParser
 from test_validation import TestDirectiveValidator
+from test_api import TestAnalysisAPI
+from test_startup import TestStartup
+from test_cli import TestCLI
+from test_condition_parser import TestConditionParser
+from test_configuration_evaluator import TestConfigurationEvaluator
+from test_lsp_server import TestLanguageServer
+from test_incremental import TestIncrementalDocument, TestIncrementalBenchmark
+from test_header_summary import TestHeaderSummary
+from test_pch_recommender import TestPchRecommender
+from test_unity_planner import TestUnityPlanner
+from test_macro_conflicts import TestMacroConflictDetector, TestIncludeGraph, TestSymbolIndex
+from test_configuration_space import TestConfigurationSpace
+from test_feature_model import TestFeatureModel
+from test_macro_values import TestMacroValueFolder
+from test_compile_cost import TestCompileCostEstimator
+from test_build_log import TestTokenizeCommandLine, TestBuildLog
+from test_ninja_deps import TestNinjaDepsLog
+from test_coverage_mapper import TestCoverageMapper
+from test_condition_normalizer import TestConditionNormalizer
+from test_search_index import TestSearchIndex
+from test_bloom_filter import TestBloomFilter
+from test_symbol_table import TestSymbolTable
+from test_search_table import TestSearchTable
+from test_filter_table import TestFilterTable, TestFilterTableBenchmark
+from test_macro_timeline import TestMacroTimeline
+from test_git_history import TestGitHistory
+from test_archive_reader import TestArchiveReader
+from test_context_query import TestContextQuery
 
 
 def run_all_tests():
@@ -26,6 +54,39 @@ def run_all_tests():
     test_suite.addTest(unittest.makeSuite(TestFileScanner))
     test_suite.addTest(unittest.makeSuite(TestPreprocessorParser))
     test_suite.addTest(unittest.makeSuite(TestDirectiveValidator))
+    test_suite.addTest(unittest.makeSuite(TestAnalysisAPI))
+    test_suite.addTest(unittest.makeSuite(TestStartup))
+    test_suite.addTest(unittest.makeSuite(TestCLI))
+    test_suite.addTest(unittest.makeSuite(TestConditionParser))
+    test_suite.addTest(unittest.makeSuite(TestConfigurationEvaluator))
+    test_suite.addTest(unittest.makeSuite(TestLanguageServer))
+    test_suite.addTest(unittest.makeSuite(TestIncrementalDocument))
+    test_suite.addTest(unittest.makeSuite(TestIncrementalBenchmark))
+    test_suite.addTest(unittest.makeSuite(TestHeaderSummary))
+    test_suite.addTest(unittest.makeSuite(TestPchRecommender))
+    test_suite.addTest(unittest.makeSuite(TestUnityPlanner))
+    test_suite.addTest(unittest.makeSuite(TestMacroConflictDetector))
+    test_suite.addTest(unittest.makeSuite(TestIncludeGraph))
+    test_suite.addTest(unittest.makeSuite(TestSymbolIndex))
+    test_suite.addTest(unittest.makeSuite(TestConfigurationSpace))
+    test_suite.addTest(unittest.makeSuite(TestFeatureModel))
+    test_suite.addTest(unittest.makeSuite(TestMacroValueFolder))
+    test_suite.addTest(unittest.makeSuite(TestCompileCostEstimator))
+    test_suite.addTest(unittest.makeSuite(TestTokenizeCommandLine))
+    test_suite.addTest(unittest.makeSuite(TestBuildLog))
+    test_suite.addTest(unittest.makeSuite(TestNinjaDepsLog))
+    test_suite.addTest(unittest.makeSuite(TestCoverageMapper))
+    test_suite.addTest(unittest.makeSuite(TestConditionNormalizer))
+    test_suite.addTest(unittest.makeSuite(TestSearchIndex))
+    test_suite.addTest(unittest.makeSuite(TestBloomFilter))
+    test_suite.addTest(unittest.makeSuite(TestSymbolTable))
+    test_suite.addTest(unittest.makeSuite(TestSearchTable))
+    test_suite.addTest(unittest.makeSuite(TestFilterTable))
+    test_suite.addTest(unittest.makeSuite(TestFilterTableBenchmark))
+    test_suite.addTest(unittest.makeSuite(TestMacroTimeline))
+    test_suite.addTest(unittest.makeSuite(TestGitHistory))
+    test_suite.addTest(unittest.makeSuite(TestArchiveReader))
+    test_suite.addTest(unittest.makeSuite(TestContextQuery))
     
     # Run tests
     runner = unittest.TextTestRunner(verbosity=2)
@@ -0,0 +1,120 @@
+"""
+Unit tests for the search index module.
+Tests trigram candidate filtering, required regex literals, and searching
+conditions and define values of analysis results, fresh and reloaded.
+"""
+
+import unittest
+import os
+import re
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.data_models import AnalysisResult, Directive, DirectiveType, FileAnalysisResult
+from src.search_index import DirectiveSearchIndex, TrigramIndex, required_literals
+
+
+def directive(type_, content, line_number, file_path, condition=None, symbol_name=None):
+    """Build a directive the way the parser reports it."""
+    return Directive(type=type_, content=content, line_number=line_number, file_path=file_path,
+                     condition=condition, symbol_name=symbol_name)
+
+
+class TestSearchIndex(unittest.TestCase):
+    """Test cases for trigram search over conditions and define values."""
+
+    def setUp(self):
+        """Set up an analysis of two files."""
+        self.result = AnalysisResult()
+        for file_path, directives in (
+            ("a.h", [
+                directive(DirectiveType.IFDEF, "#ifdef HAVE_OPENSSL", 1, "a.h", symbol_name="HAVE_OPENSSL"),
+                directive(DirectiveType.DEFINE, "#define TLS_BACKEND \"openssl\"", 2, "a.h",
+                          symbol_name="TLS_BACKEND"),
+                directive(DirectiveType.ENDIF, "#endif", 3, "a.h"),
+                directive(DirectiveType.IF, "#if OPENSSL_VERSION >= 0x30000000", 4, "a.h",
+                          condition="OPENSSL_VERSION >= 0x30000000"),
+                directive(DirectiveType.ENDIF, "#endif", 5, "a.h"),
+            ]),
+            ("b.c", [
+                directive(DirectiveType.IF, "#if defined HAVE_OPENSSL", 7, "b.c",
+                          condition="defined HAVE_OPENSSL"),
+                directive(DirectiveType.DEFINE, "#define MAX(a, b) ((a) > (b) ? (a) : (b))", 8, "b.c",
+                          symbol_name="MAX"),
+                directive(DirectiveType.ENDIF, "#endif", 9, "b.c"),
+            ]),
+        ):
+            self.result.add_file_result(FileAnalysisResult(file_path=file_path, directives=directives))
+
+    def test_trigram_candidates(self):
+        """Test candidates are the strings holding every trigram of the query."""
+        index = TrigramIndex(["defined(HAVE_SSL)", "defined(HAVE_ZLIB)", "LEVEL > 2"])
+
+        self.assertEqual(index.candidates(["HAVE_"]), [0, 1])
+        self.assertEqual(index.candidates(["zlib"]), [1])
+        self.assertEqual(index.candidates(["nothing"]), [])
+        self.assertIsNone(index.candidates(["> "]))
+        self.assertEqual(index.add("LEVEL > 2"), 2)
+
+    def test_substring_search(self):
+        """Test candidates are verified, and short queries scan every string."""
+        index = TrigramIndex(["abcd", "ABCD", "bcda", "xyz"])
+
+        self.assertEqual(index.search("bcd"), [0, 2])
+        self.assertEqual(index.search("bcd", ignore_case=True), [0, 1, 2])
+        # "dab" shares every trigram with nothing, "da" has no trigram at all
+        self.assertEqual(index.search("dab"), [])
+        self.assertEqual(index.search("da"), [2])
+
+    def test_required_literals(self):
+        """Test literals a regex match must contain are found conservatively."""
+        self.assertEqual(required_literals(r"HAVE_\w+_SSL"), ["HAVE_", "_SSL"])
+        self.assertEqual(required_literals(r"VERSION >= 0x[0-9a-f]+"), ["VERSION >= 0x"])
+        self.assertEqual(required_literals(r"colou?r"), ["colo"])
+        self.assertEqual(required_literals(r"abc+d"), ["abc"])
+        self.assertEqual(required_literals(r"x{2,3}abcd"), ["abcd"])
+        self.assertEqual(required_literals(r"defined\(FOO\)"), ["defined(FOO)"])
+        self.assertEqual(required_literals(r"(OPT)ION"), ["ION"])
+        self.assertIsNone(required_literals(r"SSL|TLS"))
+
+    def test_regex_search(self):
+        """Test regular expressions match the same strings a full scan would."""
+        strings = ["HAVE_OPEN_SSL", "HAVE_SSL", "abccd", "abcd", "SSL", "TLS"]
+        index = TrigramIndex(strings)
+        for pattern in (r"HAVE_\w+_SSL", r"abc+d", r"SSL|TLS", r"^.S", r"c{2}"):
+            expected = [i for i, s in enumerate(strings) if re.search(pattern, s)]
+            self.assertEqual(index.search_regex(pattern), expected, pattern)
+
+    def test_search_analysis(self):
+        """Test conditions match in canonical form and defines carry their macro."""
+        index = DirectiveSearchIndex.from_analysis(self.result)
+
+        matches = index.search("defined(HAVE_OPENSSL)", kinds=("condition",))
+        self.assertEqual([(m.file_path, m.line_number) for m in matches], [("a.h", 1), ("b.c", 7)])
+        # Both spellings share one indexed string
+        self.assertEqual(len(index.indexes["condition"].strings), 2)
+
+        matches = index.search("openssl", kinds=("define",))
+        self.assertEqual([(m.symbol, m.text) for m in matches], [("TLS_BACKEND", '"openssl"')])
+        self.assertEqual(len(index.search("OPENSSL", ignore_case=True)), 4)
+        self.assertEqual(len(index.search("OPENSSL", limit=2)), 2)
+        matches = index.search(r"\(a\) > \(b\)", regex=True)
+        self.assertEqual([m.symbol for m in matches], ["MAX"])
+
+    def test_serialization(self):
+        """Test saved indexes and saved analyses give the same matches."""
+        import json
+        fresh = DirectiveSearchIndex.from_analysis(self.result)
+        rebuilt = DirectiveSearchIndex.from_analysis_dict(json.loads(json.dumps(self.result.to_dict())))
+        restored = DirectiveSearchIndex.from_dict(json.loads(json.dumps(fresh.to_dict())))
+
+        for index in (rebuilt, restored):
+            for query in ("OPENSSL", "0x3", "(b)"):
+                self.assertEqual([m.to_dict() for m in index.search(query)],
+                                 [m.to_dict() for m in fresh.search(query)])
+
+
+if __name__ == '__main__':
+    unittest.main()
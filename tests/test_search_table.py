@@ -0,0 +1,134 @@
+"""
+Unit tests for the search table file module.
+Tests writing a directive search index to a memory-mapped file and searching
+it, and benchmarks a cold `search` against a large table.
+"""
+
+import unittest
+from unittest import mock
+import subprocess
+import tempfile
+import shutil
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.api import Analyzer
+from src.search_index import DirectiveSearchIndex
+from src.search_table import SearchTable, write_search_table
+from tests.test_startup import (
+    REFERENCE_INTERPRETER_MS, REPO_ROOT, _best_runs_ms, _bytecode_cache_env, _loaded_modules
+)
+
+
+# Directives in the benchmark table; a query only reads what it touches
+BENCHMARK_DIRECTIVES = int(os.environ.get('CPP_ANALYZER_SEARCH_DIRECTIVES', '50000'))
+# Budget for a cold `search TABLE QUERY`, overridable for slow machines
+SEARCH_BUDGET_MS = float(os.environ.get('CPP_ANALYZER_SEARCH_BUDGET_MS', '80'))
+
+QUERIES = [
+    ("OPENSSL", {}), ("openssl", {"ignore_case": True}), ("(b)", {}), ("0x3", {"kinds": ("condition",)}),
+    ("HAVE", {"limit": 2}), (r"\(a\) > \(b\)", {"regex": True}), (r"SSL|TLS", {"regex": True}),
+    ("> ", {}), ("nothing here", {}),
+]
+
+
+class TestSearchTable(unittest.TestCase):
+    """Test cases for search table files."""
+
+    def setUp(self):
+        """Set up test fixtures."""
+        self.temp_dir = tempfile.mkdtemp()
+        self.path = os.path.join(self.temp_dir, 'search.idx')
+        analyzer = Analyzer()
+        self.index = DirectiveSearchIndex()
+        for file_path, text in (
+            ("a.h", "#ifdef HAVE_OPENSSL\n#define TLS_BACKEND \"openssl\"\n#endif\n"
+                    "#if OPENSSL_VERSION >= 0x30000000\n#endif\n"),
+            ("b.c", "#if defined HAVE_OPENSSL\n#define MAX(a, b) ((a) > (b) ? (a) : (b))\n#endif\n"
+                    "#define HAVE_TLS 1\n#define EMPTY\n"),
+        ):
+            self.index.add_directives(file_path, analyzer.analyze_buffer(text, file_path).directives)
+
+    def tearDown(self):
+        """Clean up test fixtures."""
+        shutil.rmtree(self.temp_dir)
+
+    def assert_same_matches(self, table):
+        for query, options in QUERIES:
+            self.assertEqual([m.to_dict() for m in table.search(query, **options)],
+                             [m.to_dict() for m in self.index.search(query, **options)], query)
+
+    def test_round_trip(self):
+        """Test a mapped table finds what the in-memory index finds."""
+        self.assertEqual(write_search_table(self.index, self.path), 6)
+
+        with SearchTable(self.path) as table:
+            self.assertEqual(len(table.indexes["condition"].strings), 2)
+            self.assertEqual(list(table.files[i] for i in range(len(table.files))), ["a.h", "b.c"])
+            self.assert_same_matches(table)
+            self.assertEqual(table.search("openssl", kinds=("define",))[0].symbol, "TLS_BACKEND")
+
+    def test_colliding_trigram_keys(self):
+        """Test trigrams sharing a key still give exact matches."""
+        # Three keys for every trigram there is
+        with mock.patch('src.search_table.trigram_key', side_effect=lambda trigram: ord(trigram[0]) % 3):
+            write_search_table(self.index, self.path)
+            with SearchTable(self.path) as table:
+                self.assert_same_matches(table)
+
+    def test_search_reads_only_the_table(self):
+        """Test searching a table loads no analysis or parsing module."""
+        write_search_table(self.index, self.path)
+        modules = _loaded_modules(['search', self.path, 'OPENSSL'])
+
+        self.assertIn('src.search_table', modules)
+        self.assertNotIn('src.data_models', modules)
+        self.assertNotIn('src.condition_normalizer', modules)
+
+    def test_rejects_other_files(self):
+        """Test files that are not search tables are refused."""
+        for contents in (b"", b"{\"file_results\": {}}" * 10):
+            with open(self.path, 'wb') as f:
+                f.write(contents)
+            with self.assertRaises(ValueError):
+                SearchTable(self.path)
+
+    def test_cold_search_benchmark(self):
+        """Benchmark a cold `search` on a large table against the search budget."""
+        from src.data_models import Directive, DirectiveType
+        index = DirectiveSearchIndex()
+        for start in range(0, BENCHMARK_DIRECTIVES, 100):
+            directives = []
+            for i in range(start, min(start + 100, BENCHMARK_DIRECTIVES)):
+                if i % 2:
+                    directives.append(Directive(type=DirectiveType.IF, content=f"#if FEATURE_{i} > {i % 7}",
+                                                line_number=i - start + 1, file_path="",
+                                                condition=f"FEATURE_{i} > {i % 7}"))
+                else:
+                    directives.append(Directive(type=DirectiveType.DEFINE,
+                                                content=f"#define VALUE_{i} ({i} * SCALE)",
+                                                line_number=i - start + 1, file_path="", symbol_name=f"VALUE_{i}"))
+            index.add_directives(f"include/h{start // 100}.h", directives)
+        write_search_table(index, self.path)
+        size_mb = os.path.getsize(self.path) / 1e6
+
+        probe = f"FEATURE_{BENCHMARK_DIRECTIVES // 2 + 1} "
+        command = [sys.executable, os.path.join(REPO_ROOT, 'main.py'), 'search', self.path, probe]
+        with tempfile.TemporaryDirectory() as cache_dir:
+            env = _bytecode_cache_env(cache_dir)
+            # Populate the bytecode cache once; every timed run is a fresh process
+            output = subprocess.run(command, cwd=REPO_ROOT, capture_output=True, text=True, env=env).stdout
+            interpreter, best = _best_runs_ms([[sys.executable, '-c', 'pass'], command], env)
+
+        budget = SEARCH_BUDGET_MS * max(1.0, interpreter / REFERENCE_INTERPRETER_MS)
+        self.assertIn("1 match(es)", output)
+        self.assertLess(best, budget, f"cold search in {BENCHMARK_DIRECTIVES} directives ({size_mb:.1f}MB): "
+                                      f"best {best:.1f}ms (budget {budget:.0f}ms, "
+                                      f"bare interpreter {interpreter:.1f}ms)")
+
+
+if __name__ == '__main__':
+    unittest.main()
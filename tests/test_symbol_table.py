@@ -0,0 +1,125 @@
+"""
+Unit tests for the symbol table file module.
+Tests writing a symbol index to a memory-mapped hash table and probing it,
+and benchmarks a cold `lookup` against a large table.
+"""
+
+import unittest
+import subprocess
+import tempfile
+import shutil
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.api import Analyzer
+from src.symbol_index import MacroDefinition, SymbolIndex
+from src.symbol_table import SymbolTable, write_symbol_table
+from tests.test_startup import (
+    REFERENCE_INTERPRETER_MS, REPO_ROOT, _best_runs_ms, _bytecode_cache_env
+)
+
+
+# Symbols in the benchmark table; probing cost does not depend on it
+BENCHMARK_SYMBOLS = int(os.environ.get('CPP_ANALYZER_TABLE_SYMBOLS', '100000'))
+# Budget for a cold `lookup TABLE NAME`, overridable for slow machines
+LOOKUP_BUDGET_MS = float(os.environ.get('CPP_ANALYZER_LOOKUP_BUDGET_MS', '50'))
+
+
+class TestSymbolTable(unittest.TestCase):
+    """Test cases for symbol table files."""
+
+    def setUp(self):
+        """Set up test fixtures."""
+        self.temp_dir = tempfile.mkdtemp()
+        self.path = os.path.join(self.temp_dir, 'symbols.tab')
+
+    def tearDown(self):
+        """Clean up test fixtures."""
+        shutil.rmtree(self.temp_dir)
+
+    def test_round_trip(self):
+        """Test lookups give what the in-memory index holds."""
+        analyzer = Analyzer()
+        index = SymbolIndex.from_results([
+            analyzer.analyze_buffer("#ifdef DEBUG\n#if LEVEL > 1\n#define LOG 2\n#endif\n#endif\n"
+                                    "#define SQ(x) ((x)*(x))\n", "a.h"),
+            analyzer.analyze_buffer("#define LOG 0\n#undef SQ\n#undef ONLY_UNDEF\n", "b.h"),
+        ])
+        self.assertEqual(write_symbol_table(index, self.path), 3)
+
+        with SymbolTable(self.path) as table:
+            self.assertEqual(len(table), 3)
+            self.assertEqual(table.names(), ["LOG", "ONLY_UNDEF", "SQ"])
+            for name in index.names():
+                self.assertEqual([e.to_dict() for e in table.definitions_of(name)],
+                                 [d.to_dict() for d in index.definitions_of(name)])
+            self.assertEqual(table.definitions_of("LOG")[0].context, ["DEBUG", "LEVEL > 1"])
+            undef = table.undefinitions_of("SQ")[0]
+            self.assertEqual((undef.value, undef.file_path, undef.line_number), (None, "b.h", 2))
+            self.assertIn("ONLY_UNDEF", table)
+            self.assertNotIn("MISSING", table)
+            self.assertEqual(table.definitions_of("MISSING"), [])
+
+    def test_probe_chains(self):
+        """Test every name is found in a table filled to its load limit."""
+        index = SymbolIndex()
+        for i in range(6):
+            name = f"M{i}"
+            index.definitions[name] = [MacroDefinition(name, str(i), "m.h", i + 1)]
+        write_symbol_table(index, self.path)
+
+        with SymbolTable(self.path) as table:
+            self.assertEqual(table.slot_count, 8)
+            for i in range(6):
+                self.assertEqual(table.definitions_of(f"M{i}")[0].value, str(i))
+            self.assertNotIn("M6", table)
+
+    def test_rewrite_keeps_open_views(self):
+        """Test a table mapped before a rewrite keeps answering from the old contents."""
+        index = SymbolIndex()
+        index.definitions["A"] = [MacroDefinition("A", "1", "a.h", 1)]
+        write_symbol_table(index, self.path)
+        with SymbolTable(self.path) as old:
+            index.definitions["A"] = [MacroDefinition("A", "2", "a.h", 1)]
+            write_symbol_table(index, self.path)
+            with SymbolTable(self.path) as new:
+                self.assertEqual(old.definitions_of("A")[0].value, "1")
+                self.assertEqual(new.definitions_of("A")[0].value, "2")
+
+    def test_rejects_other_files(self):
+        """Test files that are not symbol tables are refused."""
+        for contents in (b"", b"#define A 1\n" * 10):
+            with open(self.path, 'wb') as f:
+                f.write(contents)
+            with self.assertRaises(ValueError):
+                SymbolTable(self.path)
+
+    def test_cold_lookup_benchmark(self):
+        """Benchmark a cold `lookup` on a large table against the lookup budget."""
+        index = SymbolIndex()
+        for i in range(BENCHMARK_SYMBOLS):
+            name = f"SYMBOL_{i}"
+            index.definitions[name] = [MacroDefinition(name, str(i), f"include/h{i % 997}.h", i % 400 + 1)]
+        write_symbol_table(index, self.path)
+        size_mb = os.path.getsize(self.path) / 1e6
+
+        probe = f"SYMBOL_{BENCHMARK_SYMBOLS // 2}"
+        command = [sys.executable, os.path.join(REPO_ROOT, 'main.py'), 'lookup', self.path, probe]
+        with tempfile.TemporaryDirectory() as cache_dir:
+            env = _bytecode_cache_env(cache_dir)
+            # Populate the bytecode cache once; every timed run is a fresh process
+            output = subprocess.run(command, cwd=REPO_ROOT, capture_output=True, text=True, env=env).stdout
+            interpreter, best = _best_runs_ms([[sys.executable, '-c', 'pass'], command], env)
+
+        budget = LOOKUP_BUDGET_MS * max(1.0, interpreter / REFERENCE_INTERPRETER_MS)
+        self.assertIn(f"#define {probe} {BENCHMARK_SYMBOLS // 2}", output)
+        self.assertLess(best, budget, f"cold lookup in {BENCHMARK_SYMBOLS} symbols ({size_mb:.1f}MB): "
+                                      f"best {best:.1f}ms (budget {budget:.0f}ms, "
+                                      f"bare interpreter {interpreter:.1f}ms)")
+
+
+if __name__ == '__main__':
+    unittest.main()
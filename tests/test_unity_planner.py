@@ -0,0 +1,120 @@
+"""
+Unit tests for the unity build planner module.
+Tests macro conflict detection, configuration grouping and size balancing.
+"""
+
+import unittest
+import os
+import sys
+
+# Add src to path
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'src'))
+
+from src.unity_planner import UnityPlanner
+from src.data_models import Configuration
+from tests.source_tree import SourceTreeTestCase
+
+
+FILES = {
+    "common.h": "#ifndef COMMON_H\n#define COMMON_H\n#define SHARED 1\n#endif\n",
+    "feature.h": "#ifndef FEATURE_H\n#define FEATURE_H\n#ifdef FAST_PATH\nint fast;\n#endif\n#endif\n",
+    "tag_a.cpp": '#include "common.h"\n#define LOG_TAG "a"\n',
+    "tag_b.cpp": '#include "common.h"\n#define LOG_TAG "b"\n',
+    "cleanup.cpp": '#define LOG_TAG "c"\n#undef LOG_TAG\n',
+    "cleanup2.cpp": '#define LOG_TAG "d"\n#undef LOG_TAG\n',
+    "fast.cpp": "#define FAST_PATH 1\nint f;\n",
+    "reader.cpp": '#include "feature.h"\n',
+    "plain.cpp": '#include "common.h"\nint plain;\n',
+}
+
+
+class TestUnityPlanner(SourceTreeTestCase):
+    """Test cases for the UnityPlanner class."""
+
+    FILES = FILES
+
+    def setUp(self):
+        """Set up a small source tree."""
+        super().setUp()
+        self.planner = UnityPlanner()
+
+    def add(self, *names, configuration=None):
+        for name in names:
+            self.planner.add_translation_unit(os.path.join(self.root, name), configuration)
+
+    def batch_of(self, plan):
+        return {os.path.basename(f): index for index, batch in enumerate(plan.batches) for f in batch.files}
+
+    def test_conflicting_definitions_split(self):
+        """Test that files leaving different values for a macro are separated."""
+        self.add("tag_a.cpp", "tag_b.cpp", "plain.cpp")
+        plan = self.planner.plan()
+        batches = self.batch_of(plan)
+
+        self.assertNotEqual(batches["tag_a.cpp"], batches["tag_b.cpp"])
+        self.assertEqual(len(plan.batches), 2)
+        self.assertEqual(plan.conflicting_macros, {"LOG_TAG": 2})
+
+    def test_undef_cleanup_does_not_conflict(self):
+        """Test that files undefining their local macros can share a batch."""
+        self.add("cleanup.cpp", "cleanup2.cpp")
+        plan = self.planner.plan()
+
+        self.assertEqual(len(plan.batches), 1)
+
+        # A file that leaves the macro defined still conflicts with them
+        self.add("tag_a.cpp")
+        self.assertEqual(len(self.planner.plan().batches), 2)
+
+    def test_leaked_macro_read_by_header(self):
+        """Test that a macro leaking into another file's header conditionals conflicts."""
+        self.add("fast.cpp", "reader.cpp")
+        plan = self.planner.plan()
+        batches = self.batch_of(plan)
+
+        self.assertNotEqual(batches["fast.cpp"], batches["reader.cpp"])
+        self.assertIn("FAST_PATH", plan.conflicting_macros)
+
+    def test_shared_headers_do_not_conflict(self):
+        """Test that identical definitions and include guards never conflict."""
+        self.add("tag_a.cpp", "plain.cpp", "reader.cpp")
+        plan = self.planner.plan()
+
+        self.assertEqual(len(plan.batches), 1)
+        self.assertEqual(plan.conflicting_macros, {})
+
+    def test_configurations_not_mixed(self):
+        """Test that files compiled with different flags get different batches."""
+        self.add("plain.cpp")
+        self.add("reader.cpp", configuration=Configuration.from_flags(["NDEBUG"]))
+        plan = self.planner.plan()
+
+        self.assertEqual(len(plan.batches), 2)
+        self.assertEqual(plan.batches[1].configuration.defines, {"NDEBUG": "1"})
+
+    def test_batches_balanced_by_size(self):
+        """Test that size limits produce evenly filled batches."""
+        for index in range(12):
+            with open(os.path.join(self.root, f"unit{index}.cpp"), 'w') as f:
+                f.write("int x;\n" * (10 + index))
+            self.add(f"unit{index}.cpp")
+
+        total = sum(os.path.getsize(os.path.join(self.root, f"unit{i}.cpp")) for i in range(12))
+        plan = self.planner.plan(max_batch_bytes=total // 3 + 100)
+        sizes = [batch.bytes for batch in plan.batches]
+
+        self.assertEqual(len(sizes), 3)
+        self.assertEqual(sum(sizes), total)
+        self.assertLess(max(sizes) - min(sizes), 100)
+        self.assertEqual(plan.to_dict()["file_count"], 12)
+
+    def test_max_files(self):
+        """Test the per-batch file limit."""
+        self.add("tag_a.cpp", "plain.cpp", "reader.cpp", "cleanup2.cpp")
+        plan = self.planner.plan(max_files=2)
+
+        self.assertEqual([len(b.files) for b in plan.batches], [2, 2])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -73,14 +73,13 @@ class TestDirectiveValidator(unittest.TestCase):
     
     def test_validate_define_reserved_identifier(self):
         """Test validation of #define with reserved identifier in strict mode."""
-        self.validator.strict_mode = True
         directive = self.create_directive(
             DirectiveType.DEFINE,
             "#define _RESERVED_NAME 42",
             symbol_name="_RESERVED_NAME"
         )
         
-        errors = self.validator._validate_define_directive(directive)
+        errors = self.validator._validate_define_directive(directive, strict=True)
         self.assertGreater(len(errors), 0)
         self.assertEqual(errors[0].severity, ErrorSeverity.WARNING)
     
@@ -319,6 +318,30 @@ class TestDirectiveValidator(unittest.TestCase):
         
         # Strict mode should produce more warnings
         self.assertGreaterEqual(len(errors_strict), len(errors_normal))
+    
+    def test_options_not_kept_between_calls(self):
+        """Test that a strict call leaves no state affecting later or concurrent calls."""
+        import threading
+        file_result = FileAnalysisResult("test.cpp")
+        file_result.add_directive(self.create_directive(
+            DirectiveType.DEFINE, "#define _reserved_name 1", "_reserved_name", line_number=1
+        ))
+        expected = {strict: len(self.validator.validate(file_result, strict=strict)) for strict in (False, True)}
+        self.assertGreater(expected[True], expected[False])
+        
+        mismatches = []
+        
+        def run(strict):
+            for _ in range(200):
+                if len(self.validator.validate(file_result, strict=strict)) != expected[strict]:
+                    mismatches.append(strict)
+        
+        threads = [threading.Thread(target=run, args=(i % 2 == 0,)) for i in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(mismatches, [])
 
 
 if __name__ == '__main__':